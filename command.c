@@ -755,6 +755,26 @@ bool command_play_replay_slot(command_t *cmd, const char *arg)
 #endif
 }
 
+bool command_rewind_seek(command_t *cmd, const char *arg)
+{
+#ifdef HAVE_REWIND
+   char reply[128]              = "";
+   runloop_state_t *runloop_st  = runloop_state_get_ptr();
+   unsigned steps               = (unsigned)strtoul(arg, NULL, 10);
+   bool ret                     = state_manager_seek(
+         &runloop_st->rewind_st, steps);
+
+   if (ret)
+      snprintf(reply, sizeof(reply) - 1, "REWIND_SEEK %u", steps);
+   else
+      strlcpy(reply, "REWIND_SEEK -1", sizeof(reply));
+
+   cmd->replier(cmd, reply, strlen(reply));
+   return ret;
+#else
+   return false;
+#endif
+}
 
 #if defined(HAVE_CHEEVOS)
 bool command_read_ram(command_t *cmd, const char *arg)
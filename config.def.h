@@ -1277,6 +1277,22 @@
 #define DEFAULT_REWIND_GRANULARITY 1
 #endif
 
+/* Number of threads used to diff savestates for the rewind
+ * buffer. States smaller than 256KB per thread are always
+ * diffed on the main thread. */
+#define DEFAULT_REWIND_THREADS 1
+
+/* Deflate older rewind history instead of keeping all of
+ * it raw. Gives a much longer rewind window for the same
+ * buffer size at the cost of a short stall when rewinding
+ * far back. */
+#define DEFAULT_REWIND_COMPRESS false
+
+/* Hash savestates in pages and only compare the pages
+ * whose hash changed. Pays off for big savestates of
+ * which little changes between rewind steps. */
+#define DEFAULT_REWIND_DIRTY_PAGES false
+
 /* Pause gameplay when window loses focus. */
 #if defined(EMSCRIPTEN)
 #define DEFAULT_PAUSE_NONACTIVE false
@@ -1424,10 +1440,23 @@
 /* When using the Run Ahead feature, use a secondary instance of the core. */
 #define DEFAULT_RUN_AHEAD_SECONDARY_INSTANCE true
 
+/* When using the Run Ahead feature without a secondary instance,
+ * keep the lookahead frames between frames and only roll back
+ * to the real frame when input changes. */
+#define DEFAULT_RUN_AHEAD_KEEP_TIMELINE false
+
+/* When using a secondary instance for Run Ahead, number of
+ * extra instances that run the lookahead on worker threads,
+ * each assuming a different input. */
+#define DEFAULT_RUN_AHEAD_SPECULATIONS 0
+
 /* Hide warning messages when using the Run Ahead feature. */
 #define DEFAULT_RUN_AHEAD_HIDE_WARNINGS false
 /* Hide warning messages when using Preemptive Frames. */
 #define DEFAULT_PREEMPT_HIDE_WARNINGS   false
+/* Lower the number of Preemptive Frames when replaying
+ * them would not fit in the frame time. */
+#define DEFAULT_PREEMPT_ADAPTIVE        false
 
 /* Enable stdin/network command interface. */
 #define DEFAULT_NETWORK_CMD_ENABLE false
@@ -1474,6 +1503,11 @@
 /* When creating/updating playlists, compress written data */
 #define DEFAULT_PLAYLIST_COMPRESSION false
 
+/* When creating/updating playlists, use the indexed
+ * binary format (small changes are appended instead
+ * of rewriting the whole file) */
+#define DEFAULT_PLAYLIST_BINARY_FORMAT false
+
 #ifdef HAVE_MENU
 /* Specify when to display 'core name' inline on playlist entries */
 #define DEFAULT_PLAYLIST_SHOW_INLINE_CORE_NAME PLAYLIST_INLINE_CORE_DISPLAY_HIST_FAV
@@ -1621,6 +1655,10 @@
 
 #define DEFAULT_GFX_THUMBNAIL_UPSCALE_THRESHOLD 0
 
+/* Size limit in MB of the decoded thumbnail cache
+ * (0 disables the cache) */
+#define DEFAULT_GFX_THUMBNAIL_CACHE_SIZE 0
+
 #ifdef HAVE_MENU
 #if defined(RS90) || defined(MIYOO)
 /* The RS-90 has a hardware clock that is neither
@@ -221,6 +221,7 @@ typedef struct settings
       unsigned libretro_log_level;
       unsigned rewind_granularity;
       unsigned rewind_buffer_size_step;
+      unsigned rewind_threads;
       unsigned autosave_interval;
       unsigned replay_checkpoint_interval;
       unsigned replay_max_keep;
@@ -275,6 +276,7 @@ typedef struct settings
       unsigned gfx_thumbnails;
       unsigned menu_left_thumbnails;
       unsigned gfx_thumbnail_upscale_threshold;
+      unsigned gfx_thumbnail_cache_size;
       unsigned menu_rgui_thumbnail_downscaler;
       unsigned menu_rgui_thumbnail_delay;
       unsigned menu_rgui_color_theme;
@@ -332,6 +334,7 @@ typedef struct settings
 #endif
 
       unsigned run_ahead_frames;
+      unsigned run_ahead_speculations;
 
       unsigned midi_volume;
       unsigned streaming_mode;
@@ -972,6 +975,8 @@ typedef struct settings
       bool history_list_enable;
       bool playlist_entry_rename;
       bool rewind_enable;
+      bool rewind_compress;
+      bool rewind_dirty_pages;
       bool fastforward_frameskip;
       bool vrr_runloop_enable;
       bool menu_throttle_framerate;
@@ -979,9 +984,11 @@ typedef struct settings
       bool apply_cheats_after_load;
       bool run_ahead_enabled;
       bool run_ahead_secondary_instance;
+      bool run_ahead_keep_timeline;
       bool run_ahead_hide_warnings;
       bool preemptive_frames_enable;
       bool preemptive_frames_hide_warnings;
+      bool preemptive_frames_adaptive;
       bool pause_nonactive;
       bool pause_on_disconnect;
       bool block_sram_overwrite;
@@ -1044,6 +1051,7 @@ typedef struct settings
       bool sustained_performance_mode;
       bool playlist_use_old_format;
       bool playlist_compression;
+      bool playlist_binary_format;
       bool content_runtime_log;
       bool content_runtime_log_aggregate;
 
@@ -469,35 +469,27 @@ char *bin_to_hex_alloc(const uint8_t *data, size_t len)
 static int database_cursor_iterate(libretrodb_cursor_t *cur,
       database_info_t *db_info)
 {
-   unsigned i;
-   struct rmsgpack_dom_value item;
+   libretrodb_view_t view;
+   struct rmsgpack_view_value key_value;
+   struct rmsgpack_view_value val_value;
    const char* str                = NULL;
 
-   if (libretrodb_cursor_read_item(cur, &item) != 0)
+   /* Only the strings kept in db_info are allocated */
+   if (libretrodb_cursor_read_view(cur, &view) != 0)
       return -1;
 
-   if (item.type != RDT_MAP)
-   {
-      rmsgpack_dom_value_free(&item);
-      return 1;
-   }
-
    db_info->analog_supported       = -1;
    db_info->rumble_supported       = -1;
    db_info->coop_supported         = -1;
 
-   for (i = 0; i < item.val.map.len; i++)
+   while (libretrodb_view_next(&view, &key_value, &val_value))
    {
-      struct rmsgpack_dom_value *key = &item.val.map.items[i].key;
-      struct rmsgpack_dom_value *val = &item.val.map.items[i].value;
-      const char *val_string         = NULL;
+      const struct rmsgpack_view_value *val = &val_value;
+      const char *val_string = libretrodb_view_string(&view, val);
 
-      if (!key || !val)
+      if (!(str = libretrodb_view_string(&view, &key_value)))
          continue;
 
-      val_string                     = val->val.string.buff;
-      str                            = key->val.string.buff;
-
       if (string_is_equal(str, "publisher"))
       {
          if (!string_is_empty(val_string))
@@ -685,16 +677,21 @@ static int database_cursor_iterate(libretrodb_cursor_t *cur,
          db_info->size                    = (unsigned)val->val.uint_;
       else if (string_is_equal(str, "crc"))
       {
+         /* Big-endian; the view may be unaligned */
+         const uint8_t *crc = (const uint8_t*)val->val.binary.buff;
          switch (val->val.binary.len)
          {
             case 1:
-               db_info->crc32 = *(uint8_t*)val->val.binary.buff;
+               db_info->crc32 = crc[0];
                break;
             case 2:
-               db_info->crc32 = swap_if_little16(*(uint16_t*)val->val.binary.buff);
+               db_info->crc32 = ((uint32_t)crc[0] << 8) | crc[1];
                break;
             case 4:
-               db_info->crc32 = swap_if_little32(*(uint32_t*)val->val.binary.buff);
+               db_info->crc32 = ((uint32_t)crc[0] << 24)
+                  | ((uint32_t)crc[1] << 16)
+                  | ((uint32_t)crc[2] <<  8)
+                  |  (uint32_t)crc[3];
                break;
             default:
                db_info->crc32 = 0;
@@ -709,8 +706,6 @@ static int database_cursor_iterate(libretrodb_cursor_t *cur,
                (uint8_t*)val->val.binary.buff, val->val.binary.len);
    }
 
-   rmsgpack_dom_value_free(&item);
-
    return 0;
 }
 
@@ -1083,3 +1078,370 @@ void database_info_list_free(database_info_list_t *database_info_list)
 
    free(database_info_list->list);
 }
+
+typedef struct
+{
+   uint64_t offset;
+   uint32_t key;
+   uint32_t next; /* 1-based, 0 ends the chain */
+   unsigned rdb;
+} database_info_index_entry_t;
+
+typedef struct
+{
+   database_info_index_entry_t *entries;
+   uint32_t *buckets;
+   size_t count;
+   size_t capacity;
+   size_t hashed;
+   uint32_t mask;
+} database_info_index_table_t;
+
+struct database_info_index
+{
+   database_info_index_table_t crc;
+   database_info_index_table_t serial;
+};
+
+static uint32_t database_info_index_hash_serial(
+      const uint8_t *data, size_t len)
+{
+   /* FNV-1a */
+   size_t i;
+   uint32_t hash = 0x811c9dc5;
+   for (i = 0; i < len; i++)
+   {
+      hash ^= data[i];
+      hash *= 0x01000193;
+   }
+   return hash;
+}
+
+static uint32_t database_info_index_bucket(
+      const database_info_index_table_t *table, uint32_t key)
+{
+   uint32_t hash = key * 0x9e3779b1;
+   return (hash ^ (hash >> 15)) & table->mask;
+}
+
+static bool database_info_index_table_push(
+      database_info_index_table_t *table,
+      uint32_t key, unsigned rdb, uint64_t offset)
+{
+   database_info_index_entry_t *entry = NULL;
+
+   if (table->count == table->capacity)
+   {
+      size_t capacity = table->capacity ? table->capacity * 2 : 1024;
+      database_info_index_entry_t *entries =
+         (database_info_index_entry_t*)realloc(table->entries,
+               capacity * sizeof(*entries));
+      if (!entries)
+         return false;
+      table->entries  = entries;
+      table->capacity = capacity;
+   }
+
+   entry         = &table->entries[table->count++];
+   entry->offset = offset;
+   entry->key    = key;
+   entry->next   = 0;
+   entry->rdb    = rdb;
+   return true;
+}
+
+/* Buckets are (re)built on the first lookup after
+ * databases have been added */
+static bool database_info_index_table_hash(
+      database_info_index_table_t *table)
+{
+   size_t i;
+   size_t size = 16;
+
+   if (table->hashed == table->count && table->buckets)
+      return true;
+
+   while (size < table->count * 2)
+      size <<= 1;
+
+   free(table->buckets);
+   if (!(table->buckets = (uint32_t*)calloc(size, sizeof(uint32_t))))
+      return false;
+
+   table->mask   = (uint32_t)(size - 1);
+   table->hashed = table->count;
+
+   /* Walk backwards so that chains stay in file order */
+   for (i = table->count; i-- > 0; )
+   {
+      uint32_t bucket = database_info_index_bucket(table,
+            table->entries[i].key);
+      table->entries[i].next = table->buckets[bucket];
+      table->buckets[bucket] = (uint32_t)(i + 1);
+   }
+
+   return true;
+}
+
+static int database_info_index_table_find(
+      database_info_index_table_t *table, unsigned from, uint32_t key)
+{
+   uint32_t i;
+   int found = -1;
+
+   if (!table->count || !database_info_index_table_hash(table))
+      return -1;
+
+   for (i  = table->buckets[database_info_index_bucket(table, key)];
+        i != 0; i = table->entries[i - 1].next)
+   {
+      const database_info_index_entry_t *entry = &table->entries[i - 1];
+      if (     entry->key == key
+            && entry->rdb >= from
+            && (found < 0 || entry->rdb < (unsigned)found))
+         found = (int)entry->rdb;
+   }
+
+   return found;
+}
+
+static size_t database_info_index_table_offsets(
+      database_info_index_table_t *table, unsigned rdb, uint32_t key,
+      uint64_t *offsets, size_t count, size_t len)
+{
+   uint32_t i;
+
+   if (!table->count || !database_info_index_table_hash(table))
+      return count;
+
+   for (i  = table->buckets[database_info_index_bucket(table, key)];
+        i != 0 && count < len; i = table->entries[i - 1].next)
+   {
+      const database_info_index_entry_t *entry = &table->entries[i - 1];
+      if (entry->key == key && entry->rdb == rdb)
+         offsets[count++] = entry->offset;
+   }
+
+   return count;
+}
+
+database_info_index_t *database_info_index_new(void)
+{
+   return (database_info_index_t*)calloc(1, sizeof(database_info_index_t));
+}
+
+void database_info_index_free(database_info_index_t *index)
+{
+   if (!index)
+      return;
+   free(index->crc.entries);
+   free(index->crc.buckets);
+   free(index->serial.entries);
+   free(index->serial.buckets);
+   free(index);
+}
+
+bool database_info_index_add(database_info_index_t *index,
+      const char *rdb_path, unsigned rdb)
+{
+   bool ret                 = false;
+   libretrodb_t *db         = libretrodb_new();
+   libretrodb_cursor_t *cur = libretrodb_cursor_new();
+
+   if (!index || !db || !cur)
+      goto end;
+
+   if (database_cursor_open(db, cur, rdb_path, NULL) != 0)
+      goto end;
+
+   ret = true;
+
+   for (;;)
+   {
+      libretrodb_view_t view;
+      struct rmsgpack_view_value key;
+      struct rmsgpack_view_value val;
+      uint64_t offset = libretrodb_cursor_tell(cur);
+
+      if (libretrodb_cursor_read_view(cur, &view) != 0)
+         break;
+
+      while (libretrodb_view_next(&view, &key, &val))
+      {
+         const uint8_t *buff = (const uint8_t*)val.val.binary.buff;
+
+         /* The scanner queries both fields as binary,
+          * so nothing else can match */
+         if (val.type != RDT_BINARY)
+            continue;
+
+         if (rmsgpack_view_string_is(&key, "crc"))
+         {
+            uint32_t crc;
+            if (val.val.binary.len != 4)
+               continue;
+            crc = ((uint32_t)buff[0] << 24) | ((uint32_t)buff[1] << 16)
+                | ((uint32_t)buff[2] <<  8) |  (uint32_t)buff[3];
+            if (crc)
+               ret = database_info_index_table_push(
+                     &index->crc, crc, rdb, offset) && ret;
+         }
+         else if (rmsgpack_view_string_is(&key, "serial"))
+         {
+            if (val.val.binary.len)
+               ret = database_info_index_table_push(&index->serial,
+                     database_info_index_hash_serial(buff,
+                        val.val.binary.len), rdb, offset) && ret;
+         }
+      }
+   }
+
+end:
+   if (db)
+   {
+      libretrodb_cursor_close(cur);
+      libretrodb_close(db);
+      libretrodb_free(db);
+   }
+   if (cur)
+      libretrodb_cursor_free(cur);
+
+   return ret;
+}
+
+int database_info_index_find_crc(database_info_index_t *index,
+      unsigned from, uint32_t crc, uint32_t archive_crc)
+{
+   int found     = -1;
+   int found_alt = -1;
+
+   if (!index)
+      return -1;
+
+   if (crc)
+      found     = database_info_index_table_find(&index->crc, from, crc);
+   if (archive_crc && archive_crc != crc)
+      found_alt = database_info_index_table_find(&index->crc, from,
+            archive_crc);
+
+   if (found < 0 || (found_alt >= 0 && found_alt < found))
+      return found_alt;
+   return found;
+}
+
+int database_info_index_find_serial(database_info_index_t *index,
+      unsigned from, const char *serial)
+{
+   if (!index || string_is_empty(serial))
+      return -1;
+   return database_info_index_table_find(&index->serial, from,
+         database_info_index_hash_serial((const uint8_t*)serial,
+            strlen(serial)));
+}
+
+static int database_info_index_offset_compare(
+      const void *left, const void *right)
+{
+   uint64_t l = *(const uint64_t*)left;
+   uint64_t r = *(const uint64_t*)right;
+   return (l > r) - (l < r);
+}
+
+static database_info_list_t *database_info_index_list_new(
+      const char *rdb_path, uint64_t *offsets, size_t count)
+{
+   size_t i;
+   database_info_list_t *database_info_list = NULL;
+   libretrodb_t *db                         = libretrodb_new();
+   libretrodb_cursor_t *cur                 = libretrodb_cursor_new();
+
+   if (!db || !cur)
+      goto end;
+
+   if (database_cursor_open(db, cur, rdb_path, NULL) != 0)
+      goto end;
+
+   if (!(database_info_list = (database_info_list_t*)
+         malloc(sizeof(*database_info_list))))
+      goto end;
+
+   database_info_list->count = 0;
+   database_info_list->list  = NULL;
+
+   if (count && !(database_info_list->list = (database_info_t*)
+            calloc(count, sizeof(database_info_t))))
+   {
+      free(database_info_list);
+      database_info_list = NULL;
+      goto end;
+   }
+
+   /* Read the entries in file order, as a query would have */
+   qsort(offsets, count, sizeof(*offsets),
+         database_info_index_offset_compare);
+
+   for (i = 0; i < count; i++)
+   {
+      database_info_t *db_info =
+         &database_info_list->list[database_info_list->count];
+
+      if (i > 0 && offsets[i] == offsets[i - 1])
+         continue;
+      if (libretrodb_cursor_seek(cur, offsets[i]) != 0)
+         continue;
+      if (database_cursor_iterate(cur, db_info) == 0)
+         database_info_list->count++;
+   }
+
+end:
+   if (db)
+   {
+      libretrodb_cursor_close(cur);
+      libretrodb_close(db);
+      libretrodb_free(db);
+   }
+   if (cur)
+      libretrodb_cursor_free(cur);
+
+   return database_info_list;
+}
+
+#define DATABASE_INFO_INDEX_MAX_MATCHES 256
+
+database_info_list_t *database_info_index_list_crc(
+      database_info_index_t *index, const char *rdb_path, unsigned rdb,
+      uint32_t crc, uint32_t archive_crc)
+{
+   uint64_t offsets[DATABASE_INFO_INDEX_MAX_MATCHES];
+   size_t count = 0;
+
+   if (!index)
+      return NULL;
+
+   if (crc)
+      count = database_info_index_table_offsets(&index->crc, rdb, crc,
+            offsets, count, DATABASE_INFO_INDEX_MAX_MATCHES);
+   if (archive_crc && archive_crc != crc)
+      count = database_info_index_table_offsets(&index->crc, rdb,
+            archive_crc, offsets, count, DATABASE_INFO_INDEX_MAX_MATCHES);
+
+   return database_info_index_list_new(rdb_path, offsets, count);
+}
+
+database_info_list_t *database_info_index_list_serial(
+      database_info_index_t *index, const char *rdb_path, unsigned rdb,
+      const char *serial)
+{
+   uint64_t offsets[DATABASE_INFO_INDEX_MAX_MATCHES];
+   size_t count = 0;
+
+   if (!index || string_is_empty(serial))
+      return NULL;
+
+   count = database_info_index_table_offsets(&index->serial, rdb,
+         database_info_index_hash_serial((const uint8_t*)serial,
+            strlen(serial)), offsets, count,
+         DATABASE_INFO_INDEX_MAX_MATCHES);
+
+   return database_info_index_list_new(rdb_path, offsets, count);
+}
@@ -141,6 +141,38 @@ database_info_list_t *database_info_list_new(const char *rdb_path,
 
 void database_info_list_free(database_info_list_t *list);
 
+/* In-memory CRC/serial index spanning a set of databases.
+ * Databases are identified by the caller-supplied @rdb number
+ * (in practice, their position in the scanner's database list). */
+typedef struct database_info_index database_info_index_t;
+
+database_info_index_t *database_info_index_new(void);
+
+void database_info_index_free(database_info_index_t *index);
+
+/* Reads every entry of @rdb_path once and records the
+ * location of its 'crc' and 'serial' fields. */
+bool database_info_index_add(database_info_index_t *index,
+      const char *rdb_path, unsigned rdb);
+
+/* Returns the lowest database number >= @from holding an
+ * entry that matches, or -1 if there is none. */
+int database_info_index_find_crc(database_info_index_t *index,
+      unsigned from, uint32_t crc, uint32_t archive_crc);
+
+int database_info_index_find_serial(database_info_index_t *index,
+      unsigned from, const char *serial);
+
+/* Equivalent to database_info_list_new() with a crc/serial
+ * query, but only reads the matching entries of @rdb_path. */
+database_info_list_t *database_info_index_list_crc(
+      database_info_index_t *index, const char *rdb_path, unsigned rdb,
+      uint32_t crc, uint32_t archive_crc);
+
+database_info_list_t *database_info_index_list_serial(
+      database_info_index_t *index, const char *rdb_path, unsigned rdb,
+      const char *serial);
+
 database_info_handle_t *database_info_dir_init(const char *dir,
       enum database_type type, retro_task_t *task,
       bool show_hidden_files);
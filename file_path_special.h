@@ -90,6 +90,7 @@ RETRO_BEGIN_DECLS
 #define FILE_PATH_CONTENT_IMAGE_HISTORY "content_image_history.lpl"
 #define FILE_PATH_CONTENT_MUSIC_HISTORY "content_music_history.lpl"
 #define FILE_PATH_CONTENT_VIDEO_HISTORY "content_video_history.lpl"
+#define FILE_PATH_EXPLORE_CACHE "explore.cache"
 #define FILE_PATH_CORE_OPTIONS_CONFIG "retroarch-core-options.cfg"
 #define FILE_PATH_MAIN_CONFIG "retroarch.cfg"
 #define FILE_PATH_SALAMANDER_CONFIG "retroarch-salamander.cfg"
@@ -106,6 +107,13 @@ RETRO_BEGIN_DECLS
 #define FILE_PATH_STANDALONE_EXEMPT_EXTENSION ".lsae"
 #define FILE_PATH_STANDALONE_EXEMPT_EXTENSION_NO_DOT "lsae"
 #define FILE_PATH_BACKUP_EXTENSION ".bak"
+#define FILE_PATH_MANUAL_SCAN_CACHE_EXTENSION ".lmsc"
+#define FILE_PATH_THUMBNAIL_CACHE_EXTENSION ".ltc"
+#define FILE_PATH_THUMBNAIL_CACHE_EXTENSION_NO_DOT "ltc"
+#define FILE_PATH_THUMBNAIL_CACHE_DIR "thumbnail_cache"
+#define FILE_PATH_SHADER_CACHE_EXTENSION ".lsc"
+#define FILE_PATH_SHADER_CACHE_EXTENSION_NO_DOT "lsc"
+#define FILE_PATH_SHADER_CACHE_DIR "shader_cache"
 #if defined(RARCH_MOBILE)
 #define FILE_PATH_DEFAULT_OVERLAY "gamepads/neo-retropad/neo-retropad.cfg"
 #endif
@@ -1524,7 +1524,9 @@ static bool gl1_frame(void *data, const void *frame,
                   width * (bits / 8));
       }
       else if (bits == 16)
-         conv_rgb565_argb8888(gl1->video_buf, frame, width, height, pot_width * sizeof(unsigned), pitch);
+         pixconv_get(SCALER_FMT_RGB565, SCALER_FMT_ARGB8888)(
+               gl1->video_buf, frame, width, height,
+               pot_width * sizeof(unsigned), pitch);
 
       frame_to_copy = gl1->video_buf;
    }
@@ -1581,7 +1583,8 @@ static bool gl1_frame(void *data, const void *frame,
 
       if (bits == 16 && gl1->menu_video_buf)
       {
-         conv_rgba4444_argb8888(gl1->menu_video_buf,
+         pixconv_get(SCALER_FMT_RGBA4444, SCALER_FMT_ARGB8888)(
+               gl1->menu_video_buf,
                gl1->menu_frame, width, height,
                pot_width * sizeof(unsigned), pitch);
 
@@ -18,6 +18,7 @@
 #include <stdlib.h>
 #include <string.h>
 
+#include <features/features_cpu.h>
 #include <gfx/scaler/scaler.h>
 #include <gfx/video_frame.h>
 #include "../../verbosity.h"
@@ -323,6 +324,7 @@ static void *sdl_gfx_init(const video_info_t *video,
    vid->scaler.scaler_type      = video->smooth ? SCALER_TYPE_BILINEAR : SCALER_TYPE_POINT;
    vid->scaler.in_fmt           = video->rgb32 ? SCALER_FMT_ARGB8888 : SCALER_FMT_RGB565;
    vid->scaler.out_fmt          = SCALER_FMT_ARGB8888;
+   vid->scaler.threads          = cpu_features_get_core_amount();
 
    vid->menu.scaler             = vid->scaler;
    vid->menu.scaler.scaler_type = SCALER_TYPE_BILINEAR;
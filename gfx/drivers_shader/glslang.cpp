@@ -27,6 +27,7 @@
 #endif
 #include <vector>
 #include <iostream>
+#include <cstdio>
 #include <cstring>
 #include <cstdlib>
 #include <mutex>
@@ -456,3 +457,11 @@ bool glslang::compile_spirv(const std::string &source, Stage stage,
    GlslangToSpv(*program.getIntermediate(language), *spirv);
    return true;
 }
+
+std::string glslang::version_string()
+{
+   char generator[32];
+   snprintf(generator, sizeof(generator), " (SPIR-V generator %d)",
+         GetSpirvGeneratorVersion());
+   return std::string(GetGlslVersionString()) + generator;
+}
@@ -18,6 +18,10 @@ namespace glslang
     };
 
     bool compile_spirv(const std::string &source, Stage stage, std::vector<uint32_t> *spirv);
+
+    /* Identifies the glslang build, so that cached SPIR-V
+     * can be thrown away when the compiler changes */
+    std::string version_string();
 }
 
 #endif
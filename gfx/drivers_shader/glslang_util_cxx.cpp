@@ -32,6 +32,7 @@
 #include "glslang_util_cxx.h"
 #if defined(HAVE_GLSLANG)
 #include "glslang.hpp"
+#include "slang_cache.hpp"
 #endif
 #include "../../verbosity.h"
 
@@ -214,33 +215,49 @@ bool glslang_compile_shader(const char *shader_path, glslang_output *output)
 {
 #if defined(HAVE_GLSLANG)
    struct string_list lines;
+   std::string vertex_source;
+   std::string fragment_source;
 
    if (!string_list_initialize(&lines))
       return false;
 
-   RARCH_LOG("[slang]: Compiling shader: \"%s\".\n", shader_path);
-
    if (!glslang_read_shader_file(shader_path, &lines, true))
       goto error;
    output->meta = glslang_meta{};
    if (!glslang_parse_meta(&lines, &output->meta))
       goto error;
 
-   if (!glslang::compile_spirv(build_stage_source(&lines, "vertex"),
+   vertex_source   = build_stage_source(&lines, "vertex");
+   fragment_source = build_stage_source(&lines, "fragment");
+   string_list_deinitialize(&lines);
+
+   /* The preprocessed source already contains every
+    * #include, so it is all the SPIR-V depends on */
+   if (slang_cache_load_spirv(vertex_source, fragment_source,
+            &output->vertex, &output->fragment))
+   {
+      RARCH_LOG("[slang]: Loaded cached shader: \"%s\".\n", shader_path);
+      return true;
+   }
+
+   RARCH_LOG("[slang]: Compiling shader: \"%s\".\n", shader_path);
+
+   if (!glslang::compile_spirv(vertex_source,
             glslang::StageVertex, &output->vertex))
    {
       RARCH_ERR("[slang]: Failed to compile vertex shader stage.\n");
-      goto error;
+      return false;
    }
 
-   if (!glslang::compile_spirv(build_stage_source(&lines, "fragment"),
+   if (!glslang::compile_spirv(fragment_source,
             glslang::StageFragment, &output->fragment))
    {
       RARCH_ERR("[slang]: Failed to compile fragment shader stage.\n");
-      goto error;
+      return false;
    }
 
-   string_list_deinitialize(&lines);
+   slang_cache_store_spirv(vertex_source, fragment_source,
+         output->vertex, output->fragment);
 
    return true;
 
@@ -0,0 +1,692 @@
+/*  RetroArch - A frontend for libretro.
+ *  Copyright (C) 2010-2020 - The RetroArch team
+ *
+ *  RetroArch is free software: you can redistribute it and/or modify it under the terms
+ *  of the GNU General Public License as published by the Free Software Found-
+ *  ation, either version 3 of the License, or (at your option) any later version.
+ *
+ *  RetroArch is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ *  without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ *  PURPOSE.  See the GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along with RetroArch.
+ *  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <algorithm>
+#include <utility>
+
+#include <compat/strl.h>
+#include <file/file_path.h>
+#include <lists/dir_list.h>
+#include <streams/file_stream.h>
+#include <string/stdstring.h>
+
+#ifdef HAVE_CONFIG_H
+#include "../../config.h"
+#endif
+
+#define XXH_INLINE_ALL
+#include "../../deps/xxHash/xxhash.h"
+
+#include "slang_cache.hpp"
+#if defined(HAVE_GLSLANG)
+#include "glslang.hpp"
+#endif
+#include "../../configuration.h"
+#include "../../file_path_special.h"
+#include "../../version.h"
+#ifdef HAVE_GIT_VERSION
+#include "../../version_git.h"
+#endif
+
+#include <spirv_cross_c.h>
+
+/* Shader cache
+ *
+ * Each entry is a single file in the cache directory,
+ * named after the 128-bit hash of whatever it was built
+ * from. Layout (native byte order):
+ * - header (slang_cache_header_t)
+ * - payload, 'size' bytes
+ *
+ * The payload of a SPIR-V entry is the word count of
+ * each stage followed by the words of each stage. The
+ * payload of a reflection entry is the serialised
+ * slang_reflection (see slang_cache_put_reflection()).
+ *
+ * Entries are only used by the exact build that wrote
+ * them: the RetroArch version (and git revision, if
+ * known), the glslang and SPIRV-Cross versions and
+ * SLANG_CACHE_VERSION all go into the toolchain hash.
+ * Bump SLANG_CACHE_VERSION whenever either layout, the
+ * glslang resource limits or the reflection code
+ * changes in a way that affects the output, so that
+ * builds without a git revision notice as well. */
+
+#define SLANG_CACHE_MAGIC    0x43534c52 /* 'RLSC' */
+#define SLANG_CACHE_VERSION  1
+
+/* Once per session, the oldest entries are removed
+ * if the cache has grown beyond this many bytes */
+#define SLANG_CACHE_MAX_SIZE (32 << 20)
+
+enum slang_cache_type
+{
+   SLANG_CACHE_TYPE_SPIRV = 0,
+   SLANG_CACHE_TYPE_REFLECTION
+};
+
+typedef struct
+{
+   uint32_t magic;
+   uint32_t version;
+   uint32_t type;
+   uint32_t size;
+   uint64_t toolchain;
+   uint64_t key_high;
+   uint64_t key_low;
+   uint64_t checksum;
+} slang_cache_header_t;
+
+typedef struct
+{
+   int64_t mtime;
+   int32_t size;
+   size_t idx;
+} slang_cache_file_t;
+
+static bool slang_cache_checked = false;
+
+/* Identifies everything other than the input that
+ * the cached output depends on */
+static uint64_t slang_cache_toolchain(void)
+{
+   static uint64_t toolchain = 0;
+
+   if (!toolchain)
+   {
+      char version[64];
+      std::string id = "slang";
+
+      snprintf(version, sizeof(version), " %d RetroArch %s SPIRV-Cross %d.%d.%d",
+            SLANG_CACHE_VERSION, PACKAGE_VERSION,
+            SPVC_C_API_VERSION_MAJOR, SPVC_C_API_VERSION_MINOR,
+            SPVC_C_API_VERSION_PATCH);
+      id += version;
+#ifdef HAVE_GIT_VERSION
+      id += " ";
+      id += retroarch_git_version;
+#endif
+#if defined(HAVE_GLSLANG)
+      id += " ";
+      id += glslang::version_string();
+#endif
+      toolchain = XXH64(id.data(), id.size(), 0) | 1;
+   }
+
+   return toolchain;
+}
+
+static void slang_cache_hash_reset(XXH3_state_t *state, uint32_t type)
+{
+   XXH3_128bits_reset(state);
+   XXH3_128bits_update(state, &type, sizeof(type));
+}
+
+/* Length-prefixed, so that the boundary between two
+ * consecutive inputs is part of the hash */
+static void slang_cache_hash_data(XXH3_state_t *state,
+      const void *data, size_t len)
+{
+   uint64_t len64 = len;
+   XXH3_128bits_update(state, &len64, sizeof(len64));
+   XXH3_128bits_update(state, data, len);
+}
+
+template <typename P>
+static void slang_cache_hash_map(XXH3_state_t *state,
+      const std::unordered_map<std::string, P> *map)
+{
+   size_t i;
+   uint64_t count = map ? (uint64_t)map->size() + 1 : 0;
+   std::vector<std::pair<std::string, P> > entries;
+
+   /* A missing map and an empty one are told apart */
+   XXH3_128bits_update(state, &count, sizeof(count));
+   if (!map)
+      return;
+
+   /* Iteration order of an unordered_map is not
+    * stable, so hash the entries sorted by name */
+   entries.reserve(map->size());
+   for (auto itr = map->begin(); itr != map->end(); ++itr)
+      entries.push_back(*itr);
+   std::sort(entries.begin(), entries.end(),
+         [](const std::pair<std::string, P> &a,
+            const std::pair<std::string, P> &b)
+         { return a.first < b.first; });
+
+   for (i = 0; i < entries.size(); i++)
+   {
+      uint32_t value[2];
+      value[0] = (uint32_t)entries[i].second.semantic;
+      value[1] = entries[i].second.index;
+      slang_cache_hash_data(state,
+            entries[i].first.data(), entries[i].first.size());
+      XXH3_128bits_update(state, value, sizeof(value));
+   }
+}
+
+static bool slang_cache_get_path(const XXH128_hash_t *key,
+      char *cache_dir, size_t dir_len, char *path, size_t len)
+{
+   char name[64];
+   settings_t *settings  = config_get_ptr();
+   const char *dir_cache = settings
+      ? settings->paths.directory_cache : NULL;
+
+   if (string_is_empty(dir_cache))
+      return false;
+
+   fill_pathname_join_special(cache_dir, dir_cache,
+         FILE_PATH_SHADER_CACHE_DIR, dir_len);
+   snprintf(name, sizeof(name), "%016llx%016llx"
+         FILE_PATH_SHADER_CACHE_EXTENSION,
+         (unsigned long long)key->high64,
+         (unsigned long long)key->low64);
+   fill_pathname_join_special(path, cache_dir, name, len);
+   return true;
+}
+
+static int slang_cache_file_cmp(const void *a, const void *b)
+{
+   const slang_cache_file_t *file_a = (const slang_cache_file_t*)a;
+   const slang_cache_file_t *file_b = (const slang_cache_file_t*)b;
+
+   if (file_a->mtime != file_b->mtime)
+      return (file_a->mtime < file_b->mtime) ? -1 : 1;
+   return 0;
+}
+
+/* Removes the oldest entries until the cache
+ * occupies no more than 3/4 of SLANG_CACHE_MAX_SIZE */
+static void slang_cache_prune(const char *cache_dir)
+{
+   size_t i;
+   uint64_t total            = 0;
+   slang_cache_file_t *files = NULL;
+   struct string_list *list  = dir_list_new(cache_dir,
+         FILE_PATH_SHADER_CACHE_EXTENSION_NO_DOT,
+         false, false, false, false);
+
+   if (!list)
+      return;
+
+   if (list->size && (files = (slang_cache_file_t*)
+            malloc(list->size * sizeof(*files))))
+   {
+      for (i = 0; i < list->size; i++)
+      {
+         const char *path = list->elems[i].data;
+         int32_t size     = path_get_size(path);
+
+         files[i].mtime   = path_get_mtime(path);
+         files[i].size    = (size > 0) ? size : 0;
+         files[i].idx     = i;
+         total           += (uint64_t)files[i].size;
+      }
+
+      if (total > SLANG_CACHE_MAX_SIZE)
+      {
+         uint64_t target = SLANG_CACHE_MAX_SIZE
+            - (SLANG_CACHE_MAX_SIZE >> 2);
+
+         qsort(files, list->size, sizeof(*files),
+               slang_cache_file_cmp);
+
+         for (i = 0; (i < list->size) && (total > target); i++)
+         {
+            if (!filestream_delete(list->elems[files[i].idx].data))
+               total -= (uint64_t)files[i].size;
+         }
+      }
+
+      free(files);
+   }
+
+   string_list_free(list);
+}
+
+/* Returns false if there is no valid entry for 'key' */
+static bool slang_cache_read(const XXH128_hash_t *key, uint32_t type,
+      std::vector<uint8_t> *payload)
+{
+   slang_cache_header_t header;
+   char cache_dir[PATH_MAX_LENGTH];
+   char path[PATH_MAX_LENGTH];
+   void *buf   = NULL;
+   int64_t len = 0;
+   bool ret    = false;
+
+   if (     !slang_cache_get_path(key, cache_dir, sizeof(cache_dir),
+            path, sizeof(path))
+         || !path_is_valid(path)
+         || !filestream_read_file(path, &buf, &len))
+      return false;
+
+   if ((size_t)len < sizeof(header))
+      goto end;
+
+   memcpy(&header, buf, sizeof(header));
+
+   if (     (header.magic     != SLANG_CACHE_MAGIC)
+         || (header.version   != SLANG_CACHE_VERSION)
+         || (header.type      != type)
+         || (header.toolchain != slang_cache_toolchain())
+         || (header.key_high  != key->high64)
+         || (header.key_low   != key->low64)
+         || ((size_t)len      != sizeof(header) + header.size)
+         || (header.checksum  != XXH64((const uint8_t*)buf
+               + sizeof(header), header.size, 0)))
+      goto end;
+
+   payload->assign((const uint8_t*)buf + sizeof(header),
+         (const uint8_t*)buf + len);
+   ret = true;
+
+end:
+   free(buf);
+   return ret;
+}
+
+/* The entry is written to a temporary file first,
+ * so that a reader never sees a partial entry */
+static void slang_cache_write(const XXH128_hash_t *key, uint32_t type,
+      const std::vector<uint8_t> &payload)
+{
+   slang_cache_header_t header;
+   char cache_dir[PATH_MAX_LENGTH];
+   char path[PATH_MAX_LENGTH];
+   char tmp_path[PATH_MAX_LENGTH];
+   bool ok     = false;
+   RFILE *file = NULL;
+
+   if (     payload.empty()
+         || !slang_cache_get_path(key, cache_dir, sizeof(cache_dir),
+            path, sizeof(path)))
+      return;
+
+   if (     !path_is_directory(cache_dir)
+         && !path_mkdir(cache_dir))
+      return;
+
+   if (!slang_cache_checked)
+   {
+      slang_cache_prune(cache_dir);
+      slang_cache_checked = true;
+   }
+
+   header.magic     = SLANG_CACHE_MAGIC;
+   header.version   = SLANG_CACHE_VERSION;
+   header.type      = type;
+   header.size      = (uint32_t)payload.size();
+   header.toolchain = slang_cache_toolchain();
+   header.key_high  = key->high64;
+   header.key_low   = key->low64;
+   header.checksum  = XXH64(payload.data(), payload.size(), 0);
+
+   strlcpy(tmp_path, path, sizeof(tmp_path));
+   strlcat(tmp_path, ".tmp", sizeof(tmp_path));
+
+   if (!(file = filestream_open(tmp_path,
+               RETRO_VFS_FILE_ACCESS_WRITE,
+               RETRO_VFS_FILE_ACCESS_HINT_NONE)))
+      return;
+
+   ok = (filestream_write(file, &header, sizeof(header))
+               == sizeof(header))
+      && (filestream_write(file, payload.data(), payload.size())
+               == (int64_t)payload.size());
+
+   if (filestream_close(file) != 0)
+      ok = false;
+
+   if (ok)
+   {
+      filestream_delete(path);
+      ok = (filestream_rename(tmp_path, path) == 0);
+   }
+
+   if (!ok)
+      filestream_delete(tmp_path);
+}
+
+static void slang_cache_put(std::vector<uint8_t> *out,
+      const void *data, size_t len)
+{
+   const uint8_t *bytes = (const uint8_t*)data;
+   out->insert(out->end(), bytes, bytes + len);
+}
+
+static bool slang_cache_get(const std::vector<uint8_t> &in,
+      size_t *offset, void *data, size_t len)
+{
+   if (len > in.size() - *offset)
+      return false;
+   memcpy(data, in.data() + *offset, len);
+   *offset += len;
+   return true;
+}
+
+#if defined(HAVE_GLSLANG)
+static XXH128_hash_t slang_cache_spirv_key(
+      const std::string &vertex_source,
+      const std::string &fragment_source)
+{
+   XXH3_state_t state;
+   slang_cache_hash_reset(&state, SLANG_CACHE_TYPE_SPIRV);
+   slang_cache_hash_data(&state, vertex_source.data(),
+         vertex_source.size());
+   slang_cache_hash_data(&state, fragment_source.data(),
+         fragment_source.size());
+   return XXH3_128bits_digest(&state);
+}
+
+bool slang_cache_load_spirv(
+      const std::string &vertex_source,
+      const std::string &fragment_source,
+      std::vector<uint32_t> *vertex,
+      std::vector<uint32_t> *fragment)
+{
+   uint32_t counts[2];
+   std::vector<uint8_t> payload;
+   size_t offset     = 0;
+   XXH128_hash_t key = slang_cache_spirv_key(
+         vertex_source, fragment_source);
+
+   if (     !slang_cache_read(&key, SLANG_CACHE_TYPE_SPIRV, &payload)
+         || !slang_cache_get(payload, &offset, counts, sizeof(counts))
+         || !counts[0]
+         || !counts[1]
+         || (payload.size() != sizeof(counts)
+            + ((size_t)counts[0] + counts[1]) * sizeof(uint32_t)))
+      return false;
+
+   vertex->resize(counts[0]);
+   fragment->resize(counts[1]);
+   slang_cache_get(payload, &offset, vertex->data(),
+         counts[0] * sizeof(uint32_t));
+   slang_cache_get(payload, &offset, fragment->data(),
+         counts[1] * sizeof(uint32_t));
+   return true;
+}
+
+void slang_cache_store_spirv(
+      const std::string &vertex_source,
+      const std::string &fragment_source,
+      const std::vector<uint32_t> &vertex,
+      const std::vector<uint32_t> &fragment)
+{
+   uint32_t counts[2];
+   std::vector<uint8_t> payload;
+   XXH128_hash_t key = slang_cache_spirv_key(
+         vertex_source, fragment_source);
+
+   if (vertex.empty() || fragment.empty())
+      return;
+
+   counts[0] = (uint32_t)vertex.size();
+   counts[1] = (uint32_t)fragment.size();
+
+   payload.reserve(sizeof(counts)
+         + (vertex.size() + fragment.size()) * sizeof(uint32_t));
+   slang_cache_put(&payload, counts, sizeof(counts));
+   slang_cache_put(&payload, vertex.data(),
+         vertex.size() * sizeof(uint32_t));
+   slang_cache_put(&payload, fragment.data(),
+         fragment.size() * sizeof(uint32_t));
+
+   slang_cache_write(&key, SLANG_CACHE_TYPE_SPIRV, payload);
+}
+#endif
+
+static XXH128_hash_t slang_cache_reflection_key(
+      const std::vector<uint32_t> &vertex,
+      const std::vector<uint32_t> &fragment,
+      const slang_reflection *reflection)
+{
+   XXH3_state_t state;
+   uint32_t layout[3];
+
+   /* Catches changes to the semantic enums, which
+    * the serialised reflection depends on */
+   layout[0] = SLANG_NUM_TEXTURE_SEMANTICS;
+   layout[1] = SLANG_NUM_SEMANTICS;
+   layout[2] = reflection->pass_number;
+
+   slang_cache_hash_reset(&state, SLANG_CACHE_TYPE_REFLECTION);
+   XXH3_128bits_update(&state, layout, sizeof(layout));
+   slang_cache_hash_data(&state, vertex.data(),
+         vertex.size() * sizeof(uint32_t));
+   slang_cache_hash_data(&state, fragment.data(),
+         fragment.size() * sizeof(uint32_t));
+   slang_cache_hash_map(&state, reflection->texture_semantic_map);
+   slang_cache_hash_map(&state, reflection->texture_semantic_uniform_map);
+   slang_cache_hash_map(&state, reflection->semantic_map);
+   return XXH3_128bits_digest(&state);
+}
+
+static void slang_cache_put_location(std::vector<uint8_t> *out,
+      const slang_semantic_location &location)
+{
+   int32_t values[4];
+   values[0] = location.ubo_vertex;
+   values[1] = location.push_vertex;
+   values[2] = location.ubo_fragment;
+   values[3] = location.push_fragment;
+   slang_cache_put(out, values, sizeof(values));
+}
+
+static bool slang_cache_get_location(const std::vector<uint8_t> &in,
+      size_t *offset, slang_semantic_location *location)
+{
+   int32_t values[4];
+   if (!slang_cache_get(in, offset, values, sizeof(values)))
+      return false;
+   location->ubo_vertex    = values[0];
+   location->push_vertex   = values[1];
+   location->ubo_fragment  = values[2];
+   location->push_fragment = values[3];
+   return true;
+}
+
+static void slang_cache_put_semantic(std::vector<uint8_t> *out,
+      const slang_semantic_meta &meta)
+{
+   uint64_t offsets[2];
+   uint32_t values[3];
+   offsets[0] = meta.ubo_offset;
+   offsets[1] = meta.push_constant_offset;
+   values[0]  = meta.num_components;
+   values[1]  = meta.uniform;
+   values[2]  = meta.push_constant;
+   slang_cache_put(out, offsets, sizeof(offsets));
+   slang_cache_put(out, values, sizeof(values));
+   slang_cache_put_location(out, meta.location);
+}
+
+static bool slang_cache_get_semantic(const std::vector<uint8_t> &in,
+      size_t *offset, slang_semantic_meta *meta)
+{
+   uint64_t offsets[2];
+   uint32_t values[3];
+   if (     !slang_cache_get(in, offset, offsets, sizeof(offsets))
+         || !slang_cache_get(in, offset, values, sizeof(values)))
+      return false;
+   meta->ubo_offset           = (size_t)offsets[0];
+   meta->push_constant_offset = (size_t)offsets[1];
+   meta->num_components       = values[0];
+   meta->uniform              = !!values[1];
+   meta->push_constant        = !!values[2];
+   return slang_cache_get_location(in, offset, &meta->location);
+}
+
+static void slang_cache_put_texture(std::vector<uint8_t> *out,
+      const slang_texture_semantic_meta &meta)
+{
+   uint64_t offsets[2];
+   uint32_t values[5];
+   offsets[0] = meta.ubo_offset;
+   offsets[1] = meta.push_constant_offset;
+   values[0]  = meta.binding;
+   values[1]  = meta.stage_mask;
+   values[2]  = meta.texture;
+   values[3]  = meta.uniform;
+   values[4]  = meta.push_constant;
+   slang_cache_put(out, offsets, sizeof(offsets));
+   slang_cache_put(out, values, sizeof(values));
+   slang_cache_put_location(out, meta.location);
+}
+
+static bool slang_cache_get_texture(const std::vector<uint8_t> &in,
+      size_t *offset, slang_texture_semantic_meta *meta)
+{
+   uint64_t offsets[2];
+   uint32_t values[5];
+   if (     !slang_cache_get(in, offset, offsets, sizeof(offsets))
+         || !slang_cache_get(in, offset, values, sizeof(values)))
+      return false;
+   meta->ubo_offset           = (size_t)offsets[0];
+   meta->push_constant_offset = (size_t)offsets[1];
+   meta->binding              = values[0];
+   meta->stage_mask           = values[1];
+   meta->texture              = !!values[2];
+   meta->uniform              = !!values[3];
+   meta->push_constant        = !!values[4];
+   return slang_cache_get_location(in, offset, &meta->location);
+}
+
+/* Serialises everything slang_reflect() fills in; the
+ * semantic maps and pass number are inputs, and are
+ * part of the key instead */
+static void slang_cache_put_reflection(std::vector<uint8_t> *out,
+      const slang_reflection *reflection)
+{
+   unsigned i;
+   size_t j;
+   uint64_t sizes[2];
+   uint32_t values[4];
+
+   sizes[0]  = reflection->ubo_size;
+   sizes[1]  = reflection->push_constant_size;
+   values[0] = reflection->ubo_binding;
+   values[1] = reflection->ubo_stage_mask;
+   values[2] = reflection->push_constant_stage_mask;
+   values[3] = (uint32_t)reflection->semantic_float_parameters.size();
+   slang_cache_put(out, sizes, sizeof(sizes));
+   slang_cache_put(out, values, sizeof(values));
+
+   for (i = 0; i < SLANG_NUM_TEXTURE_SEMANTICS; i++)
+   {
+      uint32_t count = (uint32_t)reflection->semantic_textures[i].size();
+      slang_cache_put(out, &count, sizeof(count));
+      for (j = 0; j < count; j++)
+         slang_cache_put_texture(out, reflection->semantic_textures[i][j]);
+   }
+
+   for (i = 0; i < SLANG_NUM_SEMANTICS; i++)
+      slang_cache_put_semantic(out, reflection->semantics[i]);
+
+   for (j = 0; j < reflection->semantic_float_parameters.size(); j++)
+      slang_cache_put_semantic(out,
+            reflection->semantic_float_parameters[j]);
+}
+
+static bool slang_cache_get_reflection(const std::vector<uint8_t> &in,
+      slang_reflection *reflection)
+{
+   unsigned i;
+   size_t j;
+   uint64_t sizes[2];
+   uint32_t values[4];
+   size_t offset = 0;
+
+   if (     !slang_cache_get(in, &offset, sizes, sizeof(sizes))
+         || !slang_cache_get(in, &offset, values, sizeof(values))
+         || (values[3] > in.size()))
+      return false;
+
+   reflection->ubo_size                 = (size_t)sizes[0];
+   reflection->push_constant_size       = (size_t)sizes[1];
+   reflection->ubo_binding              = values[0];
+   reflection->ubo_stage_mask           = values[1];
+   reflection->push_constant_stage_mask = values[2];
+
+   for (i = 0; i < SLANG_NUM_TEXTURE_SEMANTICS; i++)
+   {
+      uint32_t count;
+      if (     !slang_cache_get(in, &offset, &count, sizeof(count))
+            || (count > in.size()))
+         return false;
+      reflection->semantic_textures[i].clear();
+      reflection->semantic_textures[i].resize(count);
+      for (j = 0; j < count; j++)
+         if (!slang_cache_get_texture(in, &offset,
+                  &reflection->semantic_textures[i][j]))
+            return false;
+   }
+
+   for (i = 0; i < SLANG_NUM_SEMANTICS; i++)
+      if (!slang_cache_get_semantic(in, &offset,
+               &reflection->semantics[i]))
+         return false;
+
+   reflection->semantic_float_parameters.clear();
+   reflection->semantic_float_parameters.resize(values[3]);
+   for (j = 0; j < values[3]; j++)
+      if (!slang_cache_get_semantic(in, &offset,
+               &reflection->semantic_float_parameters[j]))
+         return false;
+
+   return offset == in.size();
+}
+
+bool slang_cache_load_reflection(
+      const std::vector<uint32_t> &vertex,
+      const std::vector<uint32_t> &fragment,
+      slang_reflection *reflection)
+{
+   std::vector<uint8_t> payload;
+   slang_reflection cached;
+   XXH128_hash_t key = slang_cache_reflection_key(
+         vertex, fragment, reflection);
+
+   if (!slang_cache_read(&key, SLANG_CACHE_TYPE_REFLECTION, &payload))
+      return false;
+
+   /* Decode into a copy, so that 'reflection' is left
+    * untouched if the entry turns out to be bad */
+   cached = *reflection;
+   if (!slang_cache_get_reflection(payload, &cached))
+      return false;
+
+   *reflection = std::move(cached);
+   return true;
+}
+
+void slang_cache_store_reflection(
+      const std::vector<uint32_t> &vertex,
+      const std::vector<uint32_t> &fragment,
+      const slang_reflection *reflection)
+{
+   std::vector<uint8_t> payload;
+   XXH128_hash_t key = slang_cache_reflection_key(
+         vertex, fragment, reflection);
+
+   slang_cache_put_reflection(&payload, reflection);
+   slang_cache_write(&key, SLANG_CACHE_TYPE_REFLECTION, payload);
+}
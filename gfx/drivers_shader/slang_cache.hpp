@@ -0,0 +1,65 @@
+/*  RetroArch - A frontend for libretro.
+ *  Copyright (C) 2010-2020 - The RetroArch team
+ *
+ *  RetroArch is free software: you can redistribute it and/or modify it under the terms
+ *  of the GNU General Public License as published by the Free Software Found-
+ *  ation, either version 3 of the License, or (at your option) any later version.
+ *
+ *  RetroArch is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ *  without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ *  PURPOSE.  See the GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along with RetroArch.
+ *  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef SLANG_CACHE_HPP_
+#define SLANG_CACHE_HPP_
+
+#include <string>
+#include <vector>
+#include <stdint.h>
+
+#include "slang_reflection.h"
+#include "slang_reflection.hpp"
+
+/* On-disk cache for slang shader passes, kept in
+ * <cache directory>/shader_cache.
+ *
+ * SPIR-V entries are keyed by the preprocessed source
+ * of both stages, reflection entries by the SPIR-V and
+ * the semantic maps it was reflected against. Every
+ * entry also records the RetroArch build, glslang and
+ * SPIRV-Cross versions it was made with; entries from
+ * any other combination are treated as missing and
+ * overwritten.
+ *
+ * Nothing is cached if no cache directory is set. */
+
+#if defined(HAVE_GLSLANG)
+bool slang_cache_load_spirv(
+      const std::string &vertex_source,
+      const std::string &fragment_source,
+      std::vector<uint32_t> *vertex,
+      std::vector<uint32_t> *fragment);
+
+void slang_cache_store_spirv(
+      const std::string &vertex_source,
+      const std::string &fragment_source,
+      const std::vector<uint32_t> &vertex,
+      const std::vector<uint32_t> &fragment);
+#endif
+
+/* 'reflection' must have its semantic maps and
+ * pass number set, as for slang_reflect_spirv() */
+bool slang_cache_load_reflection(
+      const std::vector<uint32_t> &vertex,
+      const std::vector<uint32_t> &fragment,
+      slang_reflection *reflection);
+
+void slang_cache_store_reflection(
+      const std::vector<uint32_t> &vertex,
+      const std::vector<uint32_t> &fragment,
+      const slang_reflection *reflection);
+
+#endif
@@ -22,6 +22,7 @@
 #include <compat/strl.h>
 #include <retro_miscellaneous.h>
 #include "glslang_util.h"
+#include "slang_cache.hpp"
 #include "../../verbosity.h"
 
 static const char *texture_semantic_names[] = {
@@ -746,6 +747,9 @@ bool slang_reflect_spirv(const std::vector<uint32_t> &vertex,
       const std::vector<uint32_t> &fragment,
       slang_reflection *reflection)
 {
+   if (slang_cache_load_reflection(vertex, fragment, reflection))
+      return true;
+
    try
    {
       spirv_cross::Compiler vertex_compiler(vertex);
@@ -764,6 +768,7 @@ bool slang_reflect_spirv(const std::vector<uint32_t> &vertex,
          return false;
       }
 
+      slang_cache_store_reflection(vertex, fragment, reflection);
       return true;
    }
    catch (const std::exception &e)
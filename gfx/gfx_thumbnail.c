@@ -24,26 +24,48 @@
 #include <string.h>
 #include <ctype.h>
 
+#include <array/rbuf.h>
 #include <features/features_cpu.h>
 #include <file/file_path.h>
 #include <string/stdstring.h>
+#include <lrc_hash.h>
 
 #include "gfx_display.h"
 #include "gfx_animation.h"
 
 #include "gfx_thumbnail.h"
 
+#include "../configuration.h"
+#include "../file_path_special.h"
+#include "../verbosity.h"
 #include "../tasks/tasks_internal.h"
 
 #define DEFAULT_GFX_THUMBNAIL_STREAM_DELAY  83.333333f
 #define DEFAULT_GFX_THUMBNAIL_FADE_DURATION 166.66667f
 
+/* Size in bytes of the textures kept by the texture
+ * cache that are not currently displayed */
+#if defined(RARCH_CONSOLE) || defined(RARCH_MOBILE)
+#define GFX_THUMBNAIL_CACHE_SIZE            (16 * 1024 * 1024)
+#else
+#define GFX_THUMBNAIL_CACHE_SIZE            (64 * 1024 * 1024)
+#endif
+
+/* Number of playlist entries loaded ahead of the
+ * most recent request, in the direction of movement */
+#define GFX_THUMBNAIL_PREFETCH_COUNT        3
+
 /* Utility structure, sent as userdata when pushing
  * an image load */
 typedef struct
 {
-   uint64_t list_id;
-   gfx_thumbnail_t *thumbnail;
+   uint64_t id;
+   uint64_t generation;
+   int64_t mtime;
+   unsigned upscale_threshold;
+   unsigned max_width;
+   unsigned max_height;
+   bool prefetch;
 } gfx_thumbnail_tag_t;
 
 static gfx_thumbnail_state_t gfx_thumb_st = {0}; /* uint64_t alignment */
@@ -89,6 +111,19 @@ void gfx_thumbnail_set_fade_missing(bool fade_missing)
    p_gfx_thumb->fade_missing = fade_missing;
 }
 
+/* Sets the largest size at which the menu driver
+ * draws thumbnails, outside of fullscreen views
+ * > Images kept in the on-disk thumbnail cache
+ *   are reduced to fit this size
+ * > A size of zero disables the on-disk cache */
+void gfx_thumbnail_set_target_size(unsigned width, unsigned height)
+{
+   gfx_thumbnail_state_t *p_gfx_thumb = &gfx_thumb_st;
+
+   p_gfx_thumb->target_width  = width;
+   p_gfx_thumb->target_height = height;
+}
+
 /* Callbacks */
 
 /* Fade animation callback - simply resets thumbnail
@@ -138,44 +173,257 @@ static void gfx_thumbnail_init_fade(
    }
 }
 
+/* Texture cache */
+
+static gfx_thumbnail_cache_entry_t *gfx_thumbnail_cache_find(
+      gfx_thumbnail_state_t *p_gfx_thumb,
+      const char *path, uint32_t hash)
+{
+   size_t i;
+   size_t len = RBUF_LEN(p_gfx_thumb->cache.entries);
+
+   for (i = 0; i < len; i++)
+   {
+      gfx_thumbnail_cache_entry_t *entry = &p_gfx_thumb->cache.entries[i];
+      if (     entry->path
+            && (entry->hash == hash)
+            && string_is_equal(entry->path, path))
+         return entry;
+   }
+
+   return NULL;
+}
+
+static gfx_thumbnail_cache_pending_t *gfx_thumbnail_cache_find_pending(
+      gfx_thumbnail_state_t *p_gfx_thumb,
+      const char *path, uint32_t hash)
+{
+   size_t i;
+   size_t len = RBUF_LEN(p_gfx_thumb->cache.pending);
+
+   for (i = 0; i < len; i++)
+   {
+      gfx_thumbnail_cache_pending_t *pending = &p_gfx_thumb->cache.pending[i];
+      if (     (pending->hash == hash)
+            && string_is_equal(pending->path, path))
+         return pending;
+   }
+
+   return NULL;
+}
+
+/* Unloads and removes the entry at index 'i'
+ * > Order of entries is not preserved */
+static void gfx_thumbnail_cache_remove(
+      gfx_thumbnail_state_t *p_gfx_thumb, size_t i)
+{
+   gfx_thumbnail_cache_entry_t *entries = p_gfx_thumb->cache.entries;
+   size_t len                           = RBUF_LEN(entries);
+
+   if (entries[i].texture)
+      video_driver_texture_unload(&entries[i].texture);
+   if (entries[i].path)
+      free(entries[i].path);
+
+   p_gfx_thumb->cache.size -= entries[i].size;
+   entries[i]               = entries[len - 1];
+   RBUF_RESIZE(p_gfx_thumb->cache.entries, len - 1);
+}
+
+/* Evicts least recently used entries that are not
+ * displayed until the cache fits within its size limit */
+static void gfx_thumbnail_cache_trim(gfx_thumbnail_state_t *p_gfx_thumb)
+{
+   while (p_gfx_thumb->cache.size > GFX_THUMBNAIL_CACHE_SIZE)
+   {
+      size_t i;
+      size_t len    = RBUF_LEN(p_gfx_thumb->cache.entries);
+      size_t oldest = len;
+
+      for (i = 0; i < len; i++)
+      {
+         gfx_thumbnail_cache_entry_t *entry = &p_gfx_thumb->cache.entries[i];
+         if (     (entry->refs == 0)
+               && (   (oldest == len)
+                   || (entry->last_used
+                     < p_gfx_thumb->cache.entries[oldest].last_used)))
+            oldest = i;
+      }
+
+      if (oldest == len)
+         break;
+
+      gfx_thumbnail_cache_remove(p_gfx_thumb, oldest);
+      p_gfx_thumb->cache.stats.evictions++;
+   }
+}
+
+/* Adds an uploaded texture to the cache
+ * > An existing entry for the same path is
+ *   superseded: it is removed immediately if
+ *   unused, otherwise when its last user is reset
+ * > Returns NULL if the entry could not be added */
+static gfx_thumbnail_cache_entry_t *gfx_thumbnail_cache_insert(
+      gfx_thumbnail_state_t *p_gfx_thumb,
+      char *path, uint32_t hash, uintptr_t texture,
+      struct texture_image *img, gfx_thumbnail_tag_t *thumbnail_tag)
+{
+   gfx_thumbnail_cache_entry_t entry;
+   gfx_thumbnail_cache_entry_t *existing = gfx_thumbnail_cache_find(
+         p_gfx_thumb, path, hash);
+
+   if (existing)
+   {
+      if (existing->refs == 0)
+         gfx_thumbnail_cache_remove(p_gfx_thumb,
+               existing - p_gfx_thumb->cache.entries);
+      else
+      {
+         free(existing->path);
+         existing->path = NULL;
+      }
+   }
+
+   if (!RBUF_TRYFIT(p_gfx_thumb->cache.entries,
+            RBUF_LEN(p_gfx_thumb->cache.entries) + 1))
+      return NULL;
+
+   entry.path              = path;
+   entry.texture           = texture;
+   entry.last_used         = ++p_gfx_thumb->cache.clock;
+   entry.mtime             = thumbnail_tag->mtime;
+   entry.size              = img->width * img->height * sizeof(uint32_t);
+   entry.hash              = hash;
+   entry.width             = img->width;
+   entry.height            = img->height;
+   entry.upscale_threshold = thumbnail_tag->upscale_threshold;
+   entry.max_width         = thumbnail_tag->max_width;
+   entry.max_height        = thumbnail_tag->max_height;
+   entry.refs              = 0;
+   entry.prefetched        = thumbnail_tag->prefetch;
+
+   RBUF_PUSH(p_gfx_thumb->cache.entries, entry);
+   p_gfx_thumb->cache.size += entry.size;
+
+   return &p_gfx_thumb->cache.entries[
+      RBUF_LEN(p_gfx_thumb->cache.entries) - 1];
+}
+
+/* Assigns the texture of a cache entry to 'thumbnail' */
+static void gfx_thumbnail_cache_borrow(
+      gfx_thumbnail_state_t *p_gfx_thumb,
+      gfx_thumbnail_cache_entry_t *entry,
+      gfx_thumbnail_t *thumbnail)
+{
+   thumbnail->texture    = entry->texture;
+   thumbnail->width      = entry->width;
+   thumbnail->height     = entry->height;
+   thumbnail->status     = GFX_THUMBNAIL_STATUS_AVAILABLE;
+   thumbnail->flags     |= GFX_THUMB_FLAG_CACHED;
+
+   entry->refs++;
+   entry->last_used      = ++p_gfx_thumb->cache.clock;
+
+   if (entry->prefetched)
+   {
+      p_gfx_thumb->cache.stats.prefetch_hits++;
+      entry->prefetched  = false;
+   }
+}
+
+/* Gives back a texture obtained via
+ * gfx_thumbnail_cache_borrow() */
+static void gfx_thumbnail_cache_release(
+      gfx_thumbnail_state_t *p_gfx_thumb, uintptr_t texture)
+{
+   size_t i;
+   size_t len = RBUF_LEN(p_gfx_thumb->cache.entries);
+
+   for (i = 0; i < len; i++)
+   {
+      gfx_thumbnail_cache_entry_t *entry = &p_gfx_thumb->cache.entries[i];
+
+      if (entry->texture != texture)
+         continue;
+
+      if (entry->refs > 0)
+         entry->refs--;
+
+      /* Superseded entries go as soon as they are unused */
+      if (!entry->path && (entry->refs == 0))
+         gfx_thumbnail_cache_remove(p_gfx_thumb, i);
+      break;
+   }
+
+   gfx_thumbnail_cache_trim(p_gfx_thumb);
+}
+
 /* Used to process thumbnail data following completion
  * of image load task */
 static void gfx_thumbnail_handle_upload(
       retro_task_t *task, void *task_data, void *user_data, const char *err)
 {
+   size_t i;
    gfx_thumbnail_state_t *p_gfx_thumb = &gfx_thumb_st;
    struct texture_image *img          = (struct texture_image*)task_data;
    gfx_thumbnail_tag_t *thumbnail_tag = (gfx_thumbnail_tag_t*)user_data;
-   bool fade_enabled                  = false;
+   gfx_thumbnail_t *thumbnail         = NULL;
+   gfx_thumbnail_cache_entry_t *entry = NULL;
+   char *path                         = NULL;
+   uint32_t hash                      = 0;
+   uintptr_t texture                  = 0;
 
    /* Sanity check */
    if (!thumbnail_tag)
       goto end;
 
-   /* Ensure that we are operating on the correct
-    * thumbnail... */
-   if (thumbnail_tag->list_id != p_gfx_thumb->list_id)
+   /* Ensure that the video context has not been
+    * destroyed since the load was requested... */
+   if (thumbnail_tag->generation != p_gfx_thumb->cache.generation)
       goto end;
 
-   /* Only process image if we are waiting for it */
-   if (thumbnail_tag->thumbnail->status != GFX_THUMBNAIL_STATUS_PENDING)
-      goto end;
+   /* Retrieve the pending load, and the thumbnail
+    * waiting for it (if any) */
+   for (i = 0; i < RBUF_LEN(p_gfx_thumb->cache.pending); i++)
+   {
+      gfx_thumbnail_cache_pending_t *pending = &p_gfx_thumb->cache.pending[i];
+
+      if (pending->id != thumbnail_tag->id)
+         continue;
+
+      path = pending->path;
+      hash = pending->hash;
+
+      /* Only process image if the thumbnail is
+       * still waiting for it */
+      if (     pending->waiter
+            && (pending->list_id == p_gfx_thumb->list_id)
+            && (pending->waiter->status == GFX_THUMBNAIL_STATUS_PENDING))
+         thumbnail = pending->waiter;
+
+      *pending = p_gfx_thumb->cache.pending[
+         RBUF_LEN(p_gfx_thumb->cache.pending) - 1];
+      RBUF_RESIZE(p_gfx_thumb->cache.pending,
+            RBUF_LEN(p_gfx_thumb->cache.pending) - 1);
+      break;
+   }
 
-   /* Sanity check: if thumbnail already has a texture,
-    * we're in some kind of weird error state - in this
-    * case, the best course of action is to just reset
-    * the thumbnail... */
-   if (thumbnail_tag->thumbnail->texture)
-      gfx_thumbnail_reset(thumbnail_tag->thumbnail);
+   if (!path)
+      goto end;
 
-   /* Set thumbnail 'missing' status by default
-    * (saves a number of checks later) */
-   thumbnail_tag->thumbnail->status = GFX_THUMBNAIL_STATUS_MISSING;
+   if (thumbnail)
+   {
+      /* Sanity check: if thumbnail already has a texture,
+       * we're in some kind of weird error state - in this
+       * case, the best course of action is to just reset
+       * the thumbnail... */
+      if (thumbnail->texture)
+         gfx_thumbnail_reset(thumbnail);
 
-   /* If we reach this stage, thumbnail 'fade in'
-    * animations should be applied (based on current
-    * thumbnail status and global configuration) */
-   fade_enabled = true;
+      /* Set thumbnail 'missing' status by default
+       * (saves a number of checks later) */
+      thumbnail->status = GFX_THUMBNAIL_STATUS_MISSING;
+   }
 
    /* Check we have a valid image */
    if (!img || (img->width < 1) || (img->height < 1))
@@ -183,19 +431,44 @@ static void gfx_thumbnail_handle_upload(
 
    /* Upload texture to GPU */
    if (!video_driver_texture_load(
-            img, TEXTURE_FILTER_MIPMAP_LINEAR,
-            &thumbnail_tag->thumbnail->texture))
+            img, TEXTURE_FILTER_MIPMAP_LINEAR, &texture))
       goto end;
 
-   /* Cache dimensions */
-   thumbnail_tag->thumbnail->width  = img->width;
-   thumbnail_tag->thumbnail->height = img->height;
+   /* Hand texture over to the cache; if that fails,
+    * the thumbnail owns it (or nobody needs it) */
+   if ((entry = gfx_thumbnail_cache_insert(p_gfx_thumb,
+               path, hash, texture, img, thumbnail_tag)))
+   {
+      path = NULL;
+      if (thumbnail)
+      {
+         /* Prefetch came too late to count as a hit */
+         entry->prefetched = false;
+         gfx_thumbnail_cache_borrow(p_gfx_thumb, entry, thumbnail);
+      }
+   }
+   else if (thumbnail)
+   {
+      thumbnail->texture = texture;
+      thumbnail->width   = img->width;
+      thumbnail->height  = img->height;
+      thumbnail->status  = GFX_THUMBNAIL_STATUS_AVAILABLE;
+      thumbnail->flags  &= ~GFX_THUMB_FLAG_CACHED;
+   }
+   else
+      video_driver_texture_unload(&texture);
 
-   /* Update thumbnail status */
-   thumbnail_tag->thumbnail->status = GFX_THUMBNAIL_STATUS_AVAILABLE;
+   gfx_thumbnail_cache_trim(p_gfx_thumb);
 
 end:
+   /* Trigger 'fade in' animation, if required */
+   if (thumbnail)
+      gfx_thumbnail_init_fade(p_gfx_thumb, thumbnail);
+
    /* Clean up */
+   if (path)
+      free(path);
+
    if (img)
    {
       image_texture_free(img);
@@ -203,13 +476,257 @@ end:
    }
 
    if (thumbnail_tag)
+      free(thumbnail_tag);
+}
+
+/* Gets the size that images loaded now are reduced to
+ * > Images that go through the on-disk cache are stored
+ *   at the target size set by the menu driver, all
+ *   others are only limited by the menu framebuffer
+ * > Returns true if the on-disk cache is used */
+static bool gfx_thumbnail_get_load_size(
+      gfx_thumbnail_state_t *p_gfx_thumb, settings_t *settings,
+      unsigned *width, unsigned *height)
+{
+   gfx_display_t *p_disp = disp_get_ptr();
+
+   if (     (settings->uints.gfx_thumbnail_cache_size > 0)
+         && (p_gfx_thumb->target_width  > 0)
+         && (p_gfx_thumb->target_height > 0)
+         && !string_is_empty(settings->paths.directory_cache))
    {
-      /* Trigger 'fade in' animation, if required */
-      if (fade_enabled)
-         gfx_thumbnail_init_fade(p_gfx_thumb,
-               thumbnail_tag->thumbnail);
+      *width  = p_gfx_thumb->target_width;
+      *height = p_gfx_thumb->target_height;
+      return true;
+   }
 
+   *width  = p_disp->framebuf_width;
+   *height = p_disp->framebuf_height;
+   return false;
+}
+
+/* Pushes an image load for the specified thumbnail,
+ * reduced to the size recorded in 'thumbnail_tag'
+ * > When 'cached' is true, images go through the
+ *   on-disk cache in the cache directory */
+static bool gfx_thumbnail_push_load(const char *thumbnail_path,
+      bool cached, gfx_thumbnail_tag_t *thumbnail_tag)
+{
+   settings_t *settings = config_get_ptr();
+
+   if (     (thumbnail_tag->max_width  == 0)
+         || (thumbnail_tag->max_height == 0))
+      return task_push_image_load(thumbnail_path,
+            video_driver_supports_rgba(),
+            thumbnail_tag->upscale_threshold,
+            gfx_thumbnail_handle_upload, thumbnail_tag);
+
+   if (cached)
+   {
+      char cache_dir[PATH_MAX_LENGTH];
+
+      fill_pathname_join_special(cache_dir,
+            settings->paths.directory_cache,
+            FILE_PATH_THUMBNAIL_CACHE_DIR, sizeof(cache_dir));
+
+      return task_push_image_load_cached(thumbnail_path,
+            cache_dir,
+            (uint64_t)settings->uints.gfx_thumbnail_cache_size << 20,
+            thumbnail_tag->max_width, thumbnail_tag->max_height,
+            video_driver_supports_rgba(),
+            thumbnail_tag->upscale_threshold,
+            gfx_thumbnail_handle_upload, thumbnail_tag);
+   }
+
+   /* No thumbnail is ever drawn larger than the
+    * framebuffer, so there is no point decoding
+    * (JPEG) images beyond that */
+   return task_push_image_load_cached(thumbnail_path,
+         NULL, 0,
+         thumbnail_tag->max_width, thumbnail_tag->max_height,
+         video_driver_supports_rgba(),
+         thumbnail_tag->upscale_threshold,
+         gfx_thumbnail_handle_upload, thumbnail_tag);
+}
+
+/* Provides the texture of the specified image file
+ * to 'thumbnail', either straight from the texture
+ * cache or by pushing an image load
+ * > If 'thumbnail' is NULL, the image is only loaded
+ *   into the cache (prefetch)
+ * > Returns the new status of the thumbnail */
+static enum gfx_thumbnail_status gfx_thumbnail_load(
+      gfx_thumbnail_state_t *p_gfx_thumb,
+      const char *path, unsigned upscale_threshold,
+      gfx_thumbnail_t *thumbnail)
+{
+   gfx_thumbnail_cache_pending_t pending;
+   unsigned max_width, max_height;
+   gfx_thumbnail_tag_t *thumbnail_tag = NULL;
+   bool cached                        = gfx_thumbnail_get_load_size(
+         p_gfx_thumb, config_get_ptr(), &max_width, &max_height);
+   uint32_t hash                      = djb2_calculate(path);
+   int64_t mtime                      = path_get_mtime(path);
+   gfx_thumbnail_cache_entry_t *entry = gfx_thumbnail_cache_find(
+         p_gfx_thumb, path, hash);
+   gfx_thumbnail_cache_pending_t *pending_load = NULL;
+
+   if (     entry
+         && (entry->mtime == mtime)
+         && (entry->upscale_threshold == upscale_threshold)
+         && (entry->max_width         == max_width)
+         && (entry->max_height        == max_height))
+   {
+      if (thumbnail)
+      {
+         gfx_thumbnail_cache_borrow(p_gfx_thumb, entry, thumbnail);
+         p_gfx_thumb->cache.stats.hits++;
+      }
+      return GFX_THUMBNAIL_STATUS_AVAILABLE;
+   }
+
+   /* If the image is already being loaded, wait
+    * for it rather than loading it twice */
+   if ((pending_load = gfx_thumbnail_cache_find_pending(
+               p_gfx_thumb, path, hash)))
+   {
+      if (!thumbnail)
+         return GFX_THUMBNAIL_STATUS_PENDING;
+
+      if (!pending_load->waiter)
+      {
+         pending_load->waiter  = thumbnail;
+         pending_load->list_id = p_gfx_thumb->list_id;
+         p_gfx_thumb->cache.stats.misses++;
+         return GFX_THUMBNAIL_STATUS_PENDING;
+      }
+   }
+
+   if (     !RBUF_TRYFIT(p_gfx_thumb->cache.pending,
+               RBUF_LEN(p_gfx_thumb->cache.pending) + 1)
+         || !(thumbnail_tag = (gfx_thumbnail_tag_t*)
+               malloc(sizeof(gfx_thumbnail_tag_t))))
+      return GFX_THUMBNAIL_STATUS_MISSING;
+
+   /* Configure user data */
+   thumbnail_tag->id                = ++p_gfx_thumb->cache.clock;
+   thumbnail_tag->generation        = p_gfx_thumb->cache.generation;
+   thumbnail_tag->mtime             = mtime;
+   thumbnail_tag->upscale_threshold = upscale_threshold;
+   thumbnail_tag->max_width         = max_width;
+   thumbnail_tag->max_height        = max_height;
+   thumbnail_tag->prefetch          = !thumbnail;
+
+   pending.path                     = strdup(path);
+   pending.waiter                   = thumbnail;
+   pending.id                       = thumbnail_tag->id;
+   pending.list_id                  = p_gfx_thumb->list_id;
+   pending.hash                     = hash;
+
+   /* Would like to cancel any existing image load tasks
+    * here, but can't see how to do it... */
+   if (     !pending.path
+         || !gfx_thumbnail_push_load(path, cached, thumbnail_tag))
+   {
+      if (pending.path)
+         free(pending.path);
       free(thumbnail_tag);
+      return GFX_THUMBNAIL_STATUS_MISSING;
+   }
+
+   RBUF_PUSH(p_gfx_thumb->cache.pending, pending);
+
+   if (thumbnail)
+      p_gfx_thumb->cache.stats.misses++;
+   else
+      p_gfx_thumb->cache.stats.prefetches++;
+
+   return GFX_THUMBNAIL_STATUS_PENDING;
+}
+
+/* Loads the thumbnails of the playlist entries
+ * following 'idx' into the texture cache, in the
+ * direction in which successive requests have moved */
+static void gfx_thumbnail_prefetch(
+      gfx_thumbnail_state_t *p_gfx_thumb,
+      gfx_thumbnail_path_data_t *path_data,
+      enum gfx_thumbnail_id thumbnail_id,
+      playlist_t *playlist, size_t idx,
+      unsigned upscale_threshold)
+{
+   size_t i, last;
+   int dir;
+   gfx_thumbnail_prefetch_t *prefetch =
+         &p_gfx_thumb->cache.prefetch[thumbnail_id];
+   size_t size                        = playlist_size(playlist);
+
+   if (playlist != prefetch->playlist)
+   {
+      prefetch->playlist = playlist;
+      prefetch->idx      = idx;
+      prefetch->dir      = 0;
+      return;
+   }
+
+   if (idx == prefetch->idx)
+      return;
+
+   dir           = (idx > prefetch->idx) ? 1 : -1;
+   prefetch->idx = idx;
+
+   /* When still moving in the same direction, carry
+    * on after the entries that were already prefetched */
+   if (     (dir == prefetch->dir)
+         && ((dir > 0)
+            ? (prefetch->next > idx)
+            : (prefetch->next < idx)))
+      i = prefetch->next;
+   else
+      i = idx;
+
+   if (dir > 0)
+      last = idx + GFX_THUMBNAIL_PREFETCH_COUNT;
+   else
+      last = (idx > GFX_THUMBNAIL_PREFETCH_COUNT)
+            ? idx - GFX_THUMBNAIL_PREFETCH_COUNT : 0;
+
+   prefetch->dir  = dir;
+   prefetch->next = i;
+
+   if (i == last)
+      return;
+
+   /* Paths are resolved in a copy of the path data,
+    * which belongs to the menu driver */
+   if (     !p_gfx_thumb->cache.path_data
+         && !(p_gfx_thumb->cache.path_data = gfx_thumbnail_path_init()))
+      return;
+
+   memcpy(p_gfx_thumb->cache.path_data, path_data,
+         sizeof(*path_data));
+
+   while (i != last)
+   {
+      const char *thumbnail_path = NULL;
+
+      i = (dir > 0) ? i + 1 : i - 1;
+      if (i >= size)
+         break;
+
+      if (     gfx_thumbnail_set_content_playlist(
+                  p_gfx_thumb->cache.path_data, playlist, i)
+            && gfx_thumbnail_is_enabled(
+                  p_gfx_thumb->cache.path_data, thumbnail_id)
+            && gfx_thumbnail_update_path(
+                  p_gfx_thumb->cache.path_data, thumbnail_id)
+            && gfx_thumbnail_get_path(
+                  p_gfx_thumb->cache.path_data, thumbnail_id,
+                  &thumbnail_path)
+            && path_is_valid(thumbnail_path))
+         gfx_thumbnail_load(p_gfx_thumb, thumbnail_path,
+               upscale_threshold, NULL);
+
+      prefetch->next = i;
    }
 }
 
@@ -266,25 +783,9 @@ void gfx_thumbnail_request(
          {
             /* Load thumbnail, if required */
             if (path_is_valid(thumbnail_path))
-            {
-               gfx_thumbnail_tag_t *thumbnail_tag =
-                  (gfx_thumbnail_tag_t*)malloc(sizeof(gfx_thumbnail_tag_t));
-
-               if (!thumbnail_tag)
-                  goto end;
-
-               /* Configure user data */
-               thumbnail_tag->thumbnail = thumbnail;
-               thumbnail_tag->list_id   = p_gfx_thumb->list_id;
-
-               /* Would like to cancel any existing image load tasks
-                * here, but can't see how to do it... */
-               if (task_push_image_load(
-                        thumbnail_path, video_driver_supports_rgba(),
-                        gfx_thumbnail_upscale_threshold,
-                        gfx_thumbnail_handle_upload, thumbnail_tag))
-                  thumbnail->status = GFX_THUMBNAIL_STATUS_PENDING;
-            }
+               thumbnail->status = gfx_thumbnail_load(p_gfx_thumb,
+                     thumbnail_path, gfx_thumbnail_upscale_threshold,
+                     thumbnail);
 #ifdef HAVE_NETWORKING
             /* Handle on demand thumbnail downloads */
             else if (network_on_demand_thumbnails)
@@ -343,6 +844,12 @@ void gfx_thumbnail_request(
 #endif
          }
       }
+
+      /* Prefetch the thumbnails most likely to be
+       * requested next */
+      if (playlist)
+         gfx_thumbnail_prefetch(p_gfx_thumb, path_data, thumbnail_id,
+               playlist, idx, gfx_thumbnail_upscale_threshold);
    }
 
 end:
@@ -365,7 +872,6 @@ void gfx_thumbnail_request_file(
       unsigned gfx_thumbnail_upscale_threshold)
 {
    gfx_thumbnail_state_t *p_gfx_thumb = &gfx_thumb_st;
-   gfx_thumbnail_tag_t *thumbnail_tag = NULL;
 
    if (!thumbnail)
       return;
@@ -381,20 +887,14 @@ void gfx_thumbnail_request_file(
       return;
 
    /* Load thumbnail */
-   if (!(thumbnail_tag = (gfx_thumbnail_tag_t*)malloc(sizeof(gfx_thumbnail_tag_t))))
-      return;
+   thumbnail->status = gfx_thumbnail_load(p_gfx_thumb, file_path,
+         gfx_thumbnail_upscale_threshold, thumbnail);
 
-   /* Configure user data */
-   thumbnail_tag->thumbnail = thumbnail;
-   thumbnail_tag->list_id   = p_gfx_thumb->list_id;
-
-   /* Would like to cancel any existing image load tasks
-    * here, but can't see how to do it... */
-   if (task_push_image_load(
-         file_path, video_driver_supports_rgba(),
-         gfx_thumbnail_upscale_threshold,
-         gfx_thumbnail_handle_upload, thumbnail_tag))
-      thumbnail->status = GFX_THUMBNAIL_STATUS_PENDING;
+   /* Textures found in the cache are available
+    * immediately, and fade in just as if they
+    * had been loaded */
+   if (thumbnail->status == GFX_THUMBNAIL_STATUS_AVAILABLE)
+      gfx_thumbnail_init_fade(p_gfx_thumb, thumbnail);
 }
 
 /* Resets (and free()s the current texture of) the
@@ -404,9 +904,23 @@ void gfx_thumbnail_reset(gfx_thumbnail_t *thumbnail)
    if (!thumbnail)
       return;
 
-   /* Unload texture */
+   /* Unload texture, or give it back to the cache */
    if (thumbnail->texture)
-      video_driver_texture_unload(&thumbnail->texture);
+   {
+      if (thumbnail->flags & GFX_THUMB_FLAG_CACHED)
+         gfx_thumbnail_cache_release(&gfx_thumb_st, thumbnail->texture);
+      else
+         video_driver_texture_unload(&thumbnail->texture);
+   }
+
+   /* Stop waiting for any pending image load */
+   if (thumbnail->status == GFX_THUMBNAIL_STATUS_PENDING)
+   {
+      size_t i;
+      for (i = 0; i < RBUF_LEN(gfx_thumb_st.cache.pending); i++)
+         if (gfx_thumb_st.cache.pending[i].waiter == thumbnail)
+            gfx_thumb_st.cache.pending[i].waiter = NULL;
+   }
 
    /* Ensure any 'fade in' animation is killed */
    if (thumbnail->flags & GFX_THUMB_FLAG_FADE_ACTIVE)
@@ -423,7 +937,64 @@ void gfx_thumbnail_reset(gfx_thumbnail_t *thumbnail)
    thumbnail->alpha       = 0.0f;
    thumbnail->delay_timer = 0.0f;
    thumbnail->flags      &= ~(GFX_THUMB_FLAG_FADE_ACTIVE
-                            | GFX_THUMB_FLAG_CORE_ASPECT);
+                            | GFX_THUMB_FLAG_CORE_ASPECT
+                            | GFX_THUMB_FLAG_CACHED);
+}
+
+/* Unloads all textures held by the texture cache
+ * >> **MUST** be called whenever the video context
+ *    is destroyed, after all thumbnails have been
+ *    reset */
+void gfx_thumbnail_flush_cache(void)
+{
+   size_t i;
+   gfx_thumbnail_state_t *p_gfx_thumb = &gfx_thumb_st;
+   gfx_thumbnail_cache_stats_t *stats = &p_gfx_thumb->cache.stats;
+
+   if (stats->hits || stats->misses || stats->prefetches)
+      RARCH_LOG("[Thumbnail]: Texture cache: %u hits (%u prefetched), "
+            "%u misses, %u prefetches, %u evictions.\n",
+            stats->hits, stats->prefetch_hits,
+            stats->misses, stats->prefetches, stats->evictions);
+
+   for (i = 0; i < RBUF_LEN(p_gfx_thumb->cache.entries); i++)
+   {
+      gfx_thumbnail_cache_entry_t *entry = &p_gfx_thumb->cache.entries[i];
+      if (entry->texture)
+         video_driver_texture_unload(&entry->texture);
+      if (entry->path)
+         free(entry->path);
+   }
+
+   /* Results of loads that are still in progress
+    * are discarded once they complete */
+   for (i = 0; i < RBUF_LEN(p_gfx_thumb->cache.pending); i++)
+      free(p_gfx_thumb->cache.pending[i].path);
+
+   RBUF_FREE(p_gfx_thumb->cache.entries);
+   RBUF_FREE(p_gfx_thumb->cache.pending);
+
+   if (p_gfx_thumb->cache.path_data)
+      free(p_gfx_thumb->cache.path_data);
+   p_gfx_thumb->cache.path_data = NULL;
+
+   memset(p_gfx_thumb->cache.prefetch, 0,
+         sizeof(p_gfx_thumb->cache.prefetch));
+   p_gfx_thumb->cache.size = 0;
+   p_gfx_thumb->cache.generation++;
+}
+
+/* Fetches the texture cache counters */
+void gfx_thumbnail_get_cache_stats(gfx_thumbnail_cache_stats_t *stats)
+{
+   gfx_thumbnail_state_t *p_gfx_thumb = &gfx_thumb_st;
+
+   if (!stats)
+      return;
+
+   *stats         = p_gfx_thumb->cache.stats;
+   stats->entries = (unsigned)RBUF_LEN(p_gfx_thumb->cache.entries);
+   stats->size    = p_gfx_thumb->cache.size;
 }
 
 /* Stream processing */
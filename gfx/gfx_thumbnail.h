@@ -66,7 +66,9 @@ enum gfx_thumbnail_shadow_type
 enum gfx_thumbnail_flags
 {
    GFX_THUMB_FLAG_FADE_ACTIVE = (1 << 0),
-   GFX_THUMB_FLAG_CORE_ASPECT = (1 << 1)
+   GFX_THUMB_FLAG_CORE_ASPECT = (1 << 1),
+   /* Texture is owned by the texture cache */
+   GFX_THUMB_FLAG_CACHED      = (1 << 2)
 };
 
 /* Holds all runtime parameters associated with
@@ -99,6 +101,57 @@ typedef struct
    enum gfx_thumbnail_shadow_type type;
 } gfx_thumbnail_shadow_t;
 
+/* Uploaded thumbnail texture, shared by all
+ * thumbnails showing the same image */
+typedef struct
+{
+   char *path;            /* NULL once superseded */
+   uintptr_t texture;
+   uint64_t last_used;
+   int64_t mtime;
+   size_t size;
+   uint32_t hash;
+   unsigned width;
+   unsigned height;
+   unsigned upscale_threshold;
+   unsigned max_width;
+   unsigned max_height;
+   unsigned refs;
+   bool prefetched;
+} gfx_thumbnail_cache_entry_t;
+
+/* Image load that has not completed yet */
+typedef struct
+{
+   char *path;
+   gfx_thumbnail_t *waiter;
+   uint64_t id;
+   uint64_t list_id;
+   uint32_t hash;
+} gfx_thumbnail_cache_pending_t;
+
+/* Direction tracking of successive requests,
+ * for each thumbnail type */
+typedef struct
+{
+   playlist_t *playlist;
+   size_t idx;
+   size_t next;
+   int dir;
+} gfx_thumbnail_prefetch_t;
+
+/* Texture cache counters */
+typedef struct
+{
+   unsigned hits;
+   unsigned prefetch_hits;
+   unsigned misses;
+   unsigned prefetches;
+   unsigned evictions;
+   unsigned entries;
+   size_t size;
+} gfx_thumbnail_cache_stats_t;
+
 /* Structure containing all gfx_thumbnail
  * variables */
 struct gfx_thumbnail_state
@@ -124,6 +177,29 @@ struct gfx_thumbnail_state
    /* Duration in ms of the thumbnail 'fade in' animation */
    float fade_duration;
 
+   /* Largest size at which the menu driver draws
+    * thumbnails (outside of fullscreen views), used
+    * for images kept in the on-disk thumbnail cache */
+   unsigned target_width;
+   unsigned target_height;
+
+   /* Uploaded textures are kept in a size-bounded
+    * LRU cache, so that entries scrolling back on
+    * screen do not have to be loaded again.
+    * Textures still in use by a thumbnail are never
+    * evicted */
+   struct
+   {
+      gfx_thumbnail_cache_entry_t *entries;   /* RBUF */
+      gfx_thumbnail_cache_pending_t *pending; /* RBUF */
+      gfx_thumbnail_path_data_t *path_data;
+      gfx_thumbnail_prefetch_t prefetch[2];
+      gfx_thumbnail_cache_stats_t stats;
+      uint64_t clock;
+      uint64_t generation;
+      size_t size;
+   } cache;
+
    /* When true, 'fade in' animation will also be
     * triggered for missing thumbnails */
    bool fade_missing;
@@ -151,6 +227,13 @@ void gfx_thumbnail_set_fade_duration(float duration);
  *   any 'thumbnail unavailable' notifications */
 void gfx_thumbnail_set_fade_missing(bool fade_missing);
 
+/* Sets the largest size at which the menu driver
+ * draws thumbnails, outside of fullscreen views
+ * > Images kept in the on-disk thumbnail cache
+ *   are reduced to fit this size
+ * > A size of zero disables the on-disk cache */
+void gfx_thumbnail_set_target_size(unsigned width, unsigned height);
+
 /* Core interface */
 
 /* When called, prevents the handling of any pending
@@ -192,9 +275,20 @@ void gfx_thumbnail_request_file(
       unsigned gfx_thumbnail_upscale_threshold);
 
 /* Resets (and free()s the current texture of) the
- * specified thumbnail */
+ * specified thumbnail
+ * > Textures owned by the texture cache are only
+ *   released, and stay available for later requests */
 void gfx_thumbnail_reset(gfx_thumbnail_t *thumbnail);
 
+/* Unloads all textures held by the texture cache
+ * >> **MUST** be called whenever the video context
+ *    is destroyed, after all thumbnails have been
+ *    reset */
+void gfx_thumbnail_flush_cache(void);
+
+/* Fetches the texture cache counters */
+void gfx_thumbnail_get_cache_stats(gfx_thumbnail_cache_stats_t *stats);
+
 /* Stream processing */
 
 /* Requests loading of the specified thumbnail via
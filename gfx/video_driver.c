@@ -2617,6 +2617,11 @@ void video_driver_build_info(video_frame_info_t *video_info)
    video_info->runahead_second_instance    = settings->bools.run_ahead_secondary_instance;
    video_info->preemptive_frames           = settings->bools.preemptive_frames_enable;
    video_info->runahead_frames             = settings->uints.run_ahead_frames;
+#ifdef HAVE_RUNAHEAD
+   /* Adaptive preemptive frames may run fewer than configured */
+   if (runloop_st->preempt_data)
+      video_info->runahead_frames          = runloop_st->preempt_data->frames;
+#endif
    video_info->fps_show                    = settings->bools.video_fps_show;
    video_info->memory_show                 = settings->bools.video_memory_show;
    video_info->statistics_show             = settings->bools.video_statistics_show;
@@ -29,6 +29,10 @@
 #include "../config.h"
 #endif
 
+#ifdef HAVE_THREADS
+#include <rthreads/rthreads.h>
+#endif
+
 #include "../frontend/frontend_driver.h"
 #include "../dynamic.h"
 #include "../performance_counters.h"
@@ -61,47 +65,78 @@ struct rarch_softfilter
    unsigned threads;
 
 #ifdef HAVE_THREADS
+   /* Persistent worker pool. The calling thread always
+    * processes packet 0 itself, worker i processes
+    * packet i + 1. */
    struct filter_thread_data *thread_data;
+   slock_t *pool_lock;
+   scond_t *pool_cond;
+   scond_t *pool_done_cond;
+   /* Bumped once per frame, workers run when it changes */
+   volatile unsigned pool_frame;
+   /* Number of workers still busy with the current frame */
+   volatile unsigned pool_pending;
+   unsigned pool_spin;
+   bool pool_die;
 #endif
 };
 
 #ifdef HAVE_THREADS
-#include <rthreads/rthreads.h>
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define FILTER_CPU_RELAX() _mm_pause()
+#else
+#define FILTER_CPU_RELAX() ((void)0)
+#endif
+
+/* Number of times a thread polls for new work (workers) or
+ * for the end of a frame (caller) before going to sleep on
+ * a condition variable. A worker that finishes its slice
+ * keeps polling for a few tens of microseconds, so a frame
+ * that follows shortly after (e.g. when fast-forwarding) is
+ * picked up without a wakeup. The polls are only hints: the
+ * counters are always re-checked with the lock held. */
+#define FILTER_THREAD_SPIN_COUNT 4096
 
 struct filter_thread_data
 {
    sthread_t *thread;
    const struct softfilter_work_packet *packet;
-   scond_t *cond;
-   slock_t *lock;
-   void *userdata;
-   bool die;
-   bool done;
+   rarch_softfilter_t *filt;
 };
 
 static void filter_thread_loop(void *data)
 {
    struct filter_thread_data *thr = (struct filter_thread_data*)data;
+   rarch_softfilter_t *filt       = thr->filt;
+   unsigned frame                 = 0;
 
    for (;;)
    {
       bool die;
-      slock_lock(thr->lock);
-      while (thr->done && !thr->die)
-         scond_wait(thr->cond, thr->lock);
-      die = thr->die;
-      slock_unlock(thr->lock);
+      unsigned spin;
+
+      for (spin = filt->pool_spin;
+            spin && filt->pool_frame == frame; spin--)
+         FILTER_CPU_RELAX();
+
+      slock_lock(filt->pool_lock);
+      while (filt->pool_frame == frame && !filt->pool_die)
+         scond_wait(filt->pool_cond, filt->pool_lock);
+      frame = filt->pool_frame;
+      die   = filt->pool_die;
+      slock_unlock(filt->pool_lock);
 
       if (die)
          break;
 
-      if (thr->packet && thr->packet->work)
-         thr->packet->work(thr->userdata, thr->packet->thread_data);
+      if (thr->packet->work)
+         thr->packet->work(filt->impl_data, thr->packet->thread_data);
 
-      slock_lock(thr->lock);
-      thr->done = true;
-      scond_signal(thr->cond);
-      slock_unlock(thr->lock);
+      slock_lock(filt->pool_lock);
+      if (--filt->pool_pending == 0)
+         scond_signal(filt->pool_done_cond);
+      slock_unlock(filt->pool_lock);
    }
 }
 #endif
@@ -237,22 +272,26 @@ static bool create_softfilter_graph(rarch_softfilter_t *filt,
    if (filt->threads > 1)
    {
       unsigned i;
+
+      if (     !(filt->pool_lock      = slock_new())
+            || !(filt->pool_cond      = scond_new())
+            || !(filt->pool_done_cond = scond_new()))
+         return false;
+
       if (!(filt->thread_data = (struct filter_thread_data*)
-         calloc(threads, sizeof(*filt->thread_data))))
+         calloc(threads - 1, sizeof(*filt->thread_data))))
          return false;
 
-      for (i = 0; i < threads; i++)
-      {
-         filt->thread_data[i].userdata = filt->impl_data;
-         filt->thread_data[i].done     = true;
+      /* Polling only pays off if every thread has
+       * a core of its own */
+      if (cpu_features_get_core_amount() >= threads)
+         filt->pool_spin = FILTER_THREAD_SPIN_COUNT;
 
-         filt->thread_data[i].lock     = slock_new();
-         if (!filt->thread_data[i].lock)
-            return false;
-         filt->thread_data[i].cond     = scond_new();
-         if (!filt->thread_data[i].cond)
-            return false;
-         filt->thread_data[i].thread   = sthread_create(
+      for (i = 0; i < threads - 1; i++)
+      {
+         filt->thread_data[i].filt   = filt;
+         filt->thread_data[i].packet = &filt->packets[i + 1];
+         filt->thread_data[i].thread = sthread_create(
                filter_thread_loop, &filt->thread_data[i]);
          if (!filt->thread_data[i].thread)
             return false;
@@ -483,6 +522,29 @@ void rarch_softfilter_free(rarch_softfilter_t *filt)
    if (!filt)
       return;
 
+#ifdef HAVE_THREADS
+   if (filt->thread_data)
+   {
+      slock_lock(filt->pool_lock);
+      filt->pool_die = true;
+      scond_broadcast(filt->pool_cond);
+      slock_unlock(filt->pool_lock);
+
+      for (i = 0; i < filt->threads - 1; i++)
+      {
+         if (filt->thread_data[i].thread)
+            sthread_join(filt->thread_data[i].thread);
+      }
+      free(filt->thread_data);
+   }
+   if (filt->pool_lock)
+      slock_free(filt->pool_lock);
+   if (filt->pool_cond)
+      scond_free(filt->pool_cond);
+   if (filt->pool_done_cond)
+      scond_free(filt->pool_done_cond);
+#endif
+
    free(filt->packets);
    if (filt->impl && filt->impl_data)
       filt->impl->destroy(filt->impl_data);
@@ -496,25 +558,6 @@ void rarch_softfilter_free(rarch_softfilter_t *filt)
    free(filt->plugs);
 #endif
 
-#ifdef HAVE_THREADS
-   if (filt->threads > 1)
-   {
-      for (i = 0; i < filt->threads; i++)
-      {
-         if (!filt->thread_data[i].thread)
-            continue;
-         slock_lock(filt->thread_data[i].lock);
-         filt->thread_data[i].die = true;
-         scond_signal(filt->thread_data[i].cond);
-         slock_unlock(filt->thread_data[i].lock);
-         sthread_join(filt->thread_data[i].thread);
-         slock_free(filt->thread_data[i].lock);
-         scond_free(filt->thread_data[i].cond);
-      }
-      free(filt->thread_data);
-   }
-#endif
-
    if (filt->conf)
       config_file_free(filt->conf);
 
@@ -560,30 +603,29 @@ void rarch_softfilter_process(rarch_softfilter_t *filt,
 #ifdef HAVE_THREADS
    if (filt->threads > 1)
    {
+      unsigned spin;
+
       /* Fire off workers */
-      for (i = 0; i < filt->threads; i++)
-      {
-#if 0
-         RARCH_LOG("Firing off filter thread %u ...\n", i);
-#endif
-         filt->thread_data[i].packet = &filt->packets[i];
-         slock_lock(filt->thread_data[i].lock);
-         filt->thread_data[i].done = false;
-         scond_signal(filt->thread_data[i].cond);
-         slock_unlock(filt->thread_data[i].lock);
-      }
+      slock_lock(filt->pool_lock);
+      filt->pool_pending = filt->threads - 1;
+      filt->pool_frame++;
+      scond_broadcast(filt->pool_cond);
+      slock_unlock(filt->pool_lock);
+
+      /* Work on the first slice while the
+       * others are being woken up */
+      if (filt->packets[0].work)
+         filt->packets[0].work(filt->impl_data,
+               filt->packets[0].thread_data);
 
       /* Wait for workers */
-      for (i = 0; i < filt->threads; i++)
-      {
-#if 0
-         RARCH_LOG("Waiting for filter thread %u ...\n", i);
-#endif
-         slock_lock(filt->thread_data[i].lock);
-         while (!filt->thread_data[i].done)
-            scond_wait(filt->thread_data[i].cond, filt->thread_data[i].lock);
-         slock_unlock(filt->thread_data[i].lock);
-      }
+      for (spin = filt->pool_spin; spin && filt->pool_pending; spin--)
+         FILTER_CPU_RELAX();
+
+      slock_lock(filt->pool_lock);
+      while (filt->pool_pending)
+         scond_wait(filt->pool_done_cond, filt->pool_lock);
+      slock_unlock(filt->pool_lock);
       return;
    }
 #endif
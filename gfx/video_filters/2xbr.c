@@ -56,6 +56,7 @@ struct softfilter_thread_data
    unsigned colfmt;
    unsigned width;
    unsigned height;
+   unsigned frame_height;
    int first;
    int last;
 };
@@ -233,7 +234,7 @@ static void *twoxbr_generic_create(const struct softfilter_config *config,
       return NULL;
    filt->workers = (struct softfilter_thread_data*)
       calloc(threads, sizeof(struct softfilter_thread_data));
-   filt->threads = 1;
+   filt->threads = threads;
    filt->in_fmt  = in_fmt;
    if (!filt->workers)
    {
@@ -531,15 +532,27 @@ int eq8(uint32_t A, uint32_t B,
          out[1] = E[1]; \
          out[dst_stride] = E[2]; \
          out[dst_stride + 1] = E[3]; \
-         ++in; \
          out += 2
 #endif
 
+/* Pixels outside the frame are replaced by the nearest edge
+ * pixel. Rows above and below the slice belong to other
+ * threads, but are only read. */
+#define twoxbr_rows(typename_t) \
+   const typename_t *r2  = src; \
+   const typename_t *r1  = (first + y > 0) ? r2 - src_stride : r2; \
+   const typename_t *r0  = (first + y > 1) ? r1 - src_stride : r1; \
+   const typename_t *r3  = (first + y + 1 < frame_height) \
+      ? r2 + src_stride : r2; \
+   const typename_t *r4  = (first + y + 2 < frame_height) \
+      ? r3 + src_stride : r3; \
+   typename_t *out       = dst
+
 static void twoxbr_generic_xrgb8888(void *data, unsigned width, unsigned height,
-      int first, int last, uint32_t *src,
+      unsigned first, unsigned frame_height, uint32_t *src,
       unsigned src_stride, uint32_t *dst, unsigned dst_stride)
 {
-   unsigned nextline, finish;
+   unsigned x, y;
    uint32_t pg_red_mask      = RED_MASK8888;
    uint32_t pg_green_mask    = GREEN_MASK8888;
    uint32_t pg_blue_mask     = BLUE_MASK8888;
@@ -549,38 +562,39 @@ static void twoxbr_generic_xrgb8888(void *data, unsigned width, unsigned height,
 
    (void)filt;
 
-   nextline = (last) ? 0 : src_stride;
-
-   for (; height; height--)
+   for (y = 0; y < height; y++)
    {
-      uint32_t *in  = (uint32_t*)src;
-      uint32_t *out = (uint32_t*)dst;
+      twoxbr_rows(uint32_t);
 
-      for (finish = width; finish; finish -= 1)
+      for (x = 0; x < width; x++)
       {
          uint32_t E[4];
          uint32_t ex, e, i, ke, ki, ex2, ex3, px;
-         uint32_t A1 = *(in - nextline - nextline - 1);
-         uint32_t B1 = *(in - nextline - nextline);
-         uint32_t C1 = *(in - nextline - nextline + 1);
-         uint32_t A0 = *(in - nextline - 2);
-         uint32_t PA = *(in - nextline - 1);
-         uint32_t PB = *(in - nextline);
-         uint32_t PC = *(in - nextline + 1);
-         uint32_t C4 = *(in - nextline + 2);
-         uint32_t D0 = *(in - 2);
-         uint32_t PD = *(in - 1);
-         uint32_t PE = *(in);
-         uint32_t PF = *(in + 1);
-         uint32_t F4 = *(in + 2);
-         uint32_t G0 = *(in + nextline - 2);
-         uint32_t PG = *(in + nextline - 1);
-         uint32_t PH = *(in + nextline);
-         uint32_t _PI = *(in + nextline + 1);
-         uint32_t I4 = *(in + nextline + 2);
-         uint32_t G5 = *(in + nextline + nextline - 1);
-         uint32_t H5 = *(in + nextline + nextline);
-         uint32_t I5 = *(in + nextline + nextline + 1);
+         unsigned x0 = (x > 0) ? x - 1 : x;
+         unsigned xm = (x > 1) ? x - 2 : x0;
+         unsigned x2 = (x + 1 < width) ? x + 1 : x;
+         unsigned x3 = (x + 2 < width) ? x + 2 : x2;
+         uint32_t A1 = r0[x0];
+         uint32_t B1 = r0[x];
+         uint32_t C1 = r0[x2];
+         uint32_t A0 = r1[xm];
+         uint32_t PA = r1[x0];
+         uint32_t PB = r1[x];
+         uint32_t PC = r1[x2];
+         uint32_t C4 = r1[x3];
+         uint32_t D0 = r2[xm];
+         uint32_t PD = r2[x0];
+         uint32_t PE = r2[x];
+         uint32_t PF = r2[x2];
+         uint32_t F4 = r2[x3];
+         uint32_t G0 = r3[xm];
+         uint32_t PG = r3[x0];
+         uint32_t PH = r3[x];
+         uint32_t _PI = r3[x2];
+         uint32_t I4 = r3[x3];
+         uint32_t G5 = r4[x0];
+         uint32_t H5 = r4[x];
+         uint32_t I5 = r4[x2];
 
          /*
           * Map of the pixels:          A1 B1 C1
@@ -599,47 +613,49 @@ static void twoxbr_generic_xrgb8888(void *data, unsigned width, unsigned height,
 }
 
 static void twoxbr_generic_rgb565(void *data, unsigned width, unsigned height,
-      int first, int last, uint16_t *src,
+      unsigned first, unsigned frame_height, uint16_t *src,
       unsigned src_stride, uint16_t *dst, unsigned dst_stride)
 {
-   unsigned finish;
+   unsigned x, y;
    struct filter_data *filt = (struct filter_data*)data;
    uint16_t pg_red_mask     = RED_MASK565;
    uint16_t pg_green_mask   = GREEN_MASK565;
    uint16_t pg_blue_mask    = BLUE_MASK565;
    uint16_t pg_lbmask       = PG_LBMASK565;
-   unsigned nextline        = (last) ? 0 : src_stride;
 
-   for (; height; height--)
+   for (y = 0; y < height; y++)
    {
-      uint16_t *in  = (uint16_t*)src;
-      uint16_t *out = (uint16_t*)dst;
+      twoxbr_rows(uint16_t);
 
-      for (finish = width; finish; finish -= 1)
+      for (x = 0; x < width; x++)
       {
          uint16_t E[4];
          uint16_t ex, e, i, ke, ki, ex2, ex3, px;
-         uint16_t A1 = *(in - nextline - nextline - 1);
-         uint16_t B1 = *(in - nextline - nextline);
-         uint16_t C1 = *(in - nextline - nextline + 1);
-         uint16_t A0 = *(in - nextline - 2);
-         uint16_t PA = *(in - nextline - 1);
-         uint16_t PB = *(in - nextline);
-         uint16_t PC = *(in - nextline + 1);
-         uint16_t C4 = *(in - nextline + 2);
-         uint16_t D0 = *(in - 2);
-         uint16_t PD = *(in - 1);
-         uint16_t PE = *(in);
-         uint16_t PF = *(in + 1);
-         uint16_t F4 = *(in + 2);
-         uint16_t G0 = *(in + nextline - 2);
-         uint16_t PG = *(in + nextline - 1);
-         uint16_t PH = *(in + nextline);
-         uint16_t _PI = *(in + nextline + 1);
-         uint16_t I4 = *(in + nextline + 2);
-         uint16_t G5 = *(in + nextline + nextline - 1);
-         uint16_t H5 = *(in + nextline + nextline);
-         uint16_t I5 = *(in + nextline + nextline + 1);
+         unsigned x0 = (x > 0) ? x - 1 : x;
+         unsigned xm = (x > 1) ? x - 2 : x0;
+         unsigned x2 = (x + 1 < width) ? x + 1 : x;
+         unsigned x3 = (x + 2 < width) ? x + 2 : x2;
+         uint16_t A1 = r0[x0];
+         uint16_t B1 = r0[x];
+         uint16_t C1 = r0[x2];
+         uint16_t A0 = r1[xm];
+         uint16_t PA = r1[x0];
+         uint16_t PB = r1[x];
+         uint16_t PC = r1[x2];
+         uint16_t C4 = r1[x3];
+         uint16_t D0 = r2[xm];
+         uint16_t PD = r2[x0];
+         uint16_t PE = r2[x];
+         uint16_t PF = r2[x2];
+         uint16_t F4 = r2[x3];
+         uint16_t G0 = r3[xm];
+         uint16_t PG = r3[x0];
+         uint16_t PH = r3[x];
+         uint16_t _PI = r3[x2];
+         uint16_t I4 = r3[x3];
+         uint16_t G5 = r4[x0];
+         uint16_t H5 = r4[x];
+         uint16_t I5 = r4[x2];
 
          /*
           * Map of the pixels:          A1 B1 C1
@@ -667,7 +683,7 @@ static void twoxbr_work_cb_rgb565(void *data, void *thread_data)
    unsigned height = thr->height;
 
    twoxbr_generic_rgb565(data, width, height,
-         thr->first, thr->last, input,
+         thr->first, thr->frame_height, input,
          (unsigned)(thr->in_pitch / SOFTFILTER_BPP_RGB565),
          output,
          (unsigned)(thr->out_pitch / SOFTFILTER_BPP_RGB565));
@@ -683,7 +699,7 @@ static void twoxbr_work_cb_xrgb8888(void *data, void *thread_data)
    unsigned height = thr->height;
 
    twoxbr_generic_xrgb8888(data, width, height,
-         thr->first, thr->last, input,
+         thr->first, thr->frame_height, input,
          (unsigned)(thr->in_pitch / SOFTFILTER_BPP_XRGB8888),
         output,
          (unsigned)(thr->out_pitch / SOFTFILTER_BPP_XRGB8888));
@@ -718,6 +734,7 @@ static void twoxbr_generic_packets(void *data,
        * pixels outside their given buffer. */
       thr->first = y_start;
       thr->last = y_end == height;
+      thr->frame_height = height;
 
       if (filt->in_fmt == SOFTFILTER_FMT_RGB565)
          packets[i].work = twoxbr_work_cb_rgb565;
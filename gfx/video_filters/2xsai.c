@@ -15,6 +15,7 @@
  */
 
 #include "softfilter.h"
+#include "softfilter_simd.h"
 #include <stdlib.h>
 #include <string.h>
 
@@ -35,6 +36,7 @@ struct softfilter_thread_data
    unsigned colfmt;
    unsigned width;
    unsigned height;
+   unsigned frame_height;
    int first;
    int last;
 };
@@ -44,6 +46,7 @@ struct filter_data
    unsigned threads;
    struct softfilter_thread_data *workers;
    unsigned in_fmt;
+   enum softfilter_isa isa;
 };
 
 static unsigned twoxsai_generic_input_fmts(void)
@@ -76,10 +79,9 @@ static void *twoxsai_generic_create(const struct softfilter_config *config,
       free(filt);
       return NULL;
    }
-   /* Apparently the code is not thread-safe,
-    * so force single threaded operation... */
-   filt->threads = 1;
+   filt->threads = threads;
    filt->in_fmt  = in_fmt;
+   filt->isa     = softfilter_simd_isa(simd);
    return filt;
 }
 
@@ -115,23 +117,23 @@ static void twoxsai_generic_destroy(void *data)
 
 #define twoxsai_result(A, B, C, D) (((A) != (C) || (A) != (D)) - ((B) != (C) || (B) != (D)));
 
-#define twoxsai_declare_variables(typename_t, in, nextline) \
+#define twoxsai_declare_variables(typename_t, r0, r1, r2, r3, x0, x1, x2, x3) \
          typename_t product, product1, product2; \
-         typename_t colorI = *(in - nextline - 1); \
-         typename_t colorE = *(in - nextline + 0); \
-         typename_t colorF = *(in - nextline + 1); \
-         typename_t colorJ = *(in - nextline + 2); \
-         typename_t colorG = *(in - 1); \
-         typename_t colorA = *(in + 0); \
-         typename_t colorB = *(in + 1); \
-         typename_t colorK = *(in + 2); \
-         typename_t colorH = *(in + nextline - 1); \
-         typename_t colorC = *(in + nextline + 0); \
-         typename_t colorD = *(in + nextline + 1); \
-         typename_t colorL = *(in + nextline + 2); \
-         typename_t colorM = *(in + nextline + nextline - 1); \
-         typename_t colorN = *(in + nextline + nextline + 0); \
-         typename_t colorO = *(in + nextline + nextline + 1);
+         typename_t colorI = r0[x0]; \
+         typename_t colorE = r0[x1]; \
+         typename_t colorF = r0[x2]; \
+         typename_t colorJ = r0[x3]; \
+         typename_t colorG = r1[x0]; \
+         typename_t colorA = r1[x1]; \
+         typename_t colorB = r1[x2]; \
+         typename_t colorK = r1[x3]; \
+         typename_t colorH = r2[x0]; \
+         typename_t colorC = r2[x1]; \
+         typename_t colorD = r2[x2]; \
+         typename_t colorL = r2[x3]; \
+         typename_t colorM = r3[x0]; \
+         typename_t colorN = r3[x1]; \
+         typename_t colorO = r3[x2];
 
 #ifndef twoxsai_function
 #define twoxsai_function(result_cb, interpolate_cb, interpolate2_cb) \
@@ -203,68 +205,217 @@ static void twoxsai_generic_destroy(void *data)
          out[1]              = product; \
          out[dst_stride]     = product1; \
          out[dst_stride + 1] = product2; \
-         ++in; \
          out += 2
 #endif
 
-static void twoxsai_generic_xrgb8888(unsigned width, unsigned height,
-      int first, int last, uint32_t *src,
+/* Vector form of twoxsai_function. Each 'result' term of the
+ * scalar code is +1, 0 or -1; with comparison masks being
+ * -1 for true, the same sum is (a == c && a == d) minus
+ * (b == c && b == d). Where the scalar code tests A == B in
+ * the A == D && B == C case, all four pixels are equal and
+ * the interpolations yield A anyway, so the test is dropped. */
+#define twoxsai_simd_result(isa, bits, a, b, c, d) \
+   sf_sub##bits##_##isa( \
+         sf_and_##isa(sf_eq##bits##_##isa(a, c), sf_eq##bits##_##isa(a, d)), \
+         sf_and_##isa(sf_eq##bits##_##isa(b, c), sf_eq##bits##_##isa(b, d)))
+
+#define twoxsai_simd_span(isa, fmt, bits, typename_t, hi, lo, hi2, lo2) \
+static SF_TARGET_##isa unsigned twoxsai_##fmt##_##isa( \
+      typename_t *out0, typename_t *out1, const typename_t *r0, \
+      const typename_t *r1, const typename_t *r2, const typename_t *r3, \
+      unsigned width) \
+{ \
+   unsigned x; \
+   const unsigned n  = SF_BYTES_##isa / sizeof(typename_t); \
+   const sf_v_##isa h  = sf_set##bits##_##isa(hi); \
+   const sf_v_##isa l  = sf_set##bits##_##isa(lo); \
+   const sf_v_##isa h2 = sf_set##bits##_##isa(hi2); \
+   const sf_v_##isa l2 = sf_set##bits##_##isa(lo2); \
+   for (x = 1; x + n + 1 < width; x += n) \
+   { \
+      sf_v_##isa I = sf_load_##isa(r0 + x - 1); \
+      sf_v_##isa E = sf_load_##isa(r0 + x); \
+      sf_v_##isa F = sf_load_##isa(r0 + x + 1); \
+      sf_v_##isa J = sf_load_##isa(r0 + x + 2); \
+      sf_v_##isa G = sf_load_##isa(r1 + x - 1); \
+      sf_v_##isa A = sf_load_##isa(r1 + x); \
+      sf_v_##isa B = sf_load_##isa(r1 + x + 1); \
+      sf_v_##isa K = sf_load_##isa(r1 + x + 2); \
+      sf_v_##isa H = sf_load_##isa(r2 + x - 1); \
+      sf_v_##isa C = sf_load_##isa(r2 + x); \
+      sf_v_##isa D = sf_load_##isa(r2 + x + 1); \
+      sf_v_##isa L = sf_load_##isa(r2 + x + 2); \
+      sf_v_##isa M = sf_load_##isa(r3 + x - 1); \
+      sf_v_##isa N = sf_load_##isa(r3 + x); \
+      sf_v_##isa O = sf_load_##isa(r3 + x + 1); \
+      sf_v_##isa eqAD = sf_eq##bits##_##isa(A, D); \
+      sf_v_##isa eqBC = sf_eq##bits##_##isa(B, C); \
+      sf_v_##isa c1   = sf_andn_##isa(eqAD, eqBC); \
+      sf_v_##isa c2   = sf_andn_##isa(eqBC, eqAD); \
+      sf_v_##isa c3   = sf_and_##isa(eqAD, eqBC); \
+      sf_v_##isa c4   = sf_andn_##isa(sf_andn_##isa( \
+               sf_eq##bits##_##isa(A, A), eqAD), eqBC); \
+      sf_v_##isa t1   = sf_and_##isa(sf_and_##isa( \
+               sf_eq##bits##_##isa(A, C), sf_eq##bits##_##isa(A, F)), \
+            sf_andn_##isa(sf_eq##bits##_##isa(B, J), \
+               sf_eq##bits##_##isa(B, E))); \
+      sf_v_##isa t2   = sf_and_##isa(sf_and_##isa( \
+               sf_eq##bits##_##isa(B, E), sf_eq##bits##_##isa(B, D)), \
+            sf_andn_##isa(sf_eq##bits##_##isa(A, I), \
+               sf_eq##bits##_##isa(A, F))); \
+      sf_v_##isa u1   = sf_and_##isa(sf_and_##isa( \
+               sf_eq##bits##_##isa(A, B), sf_eq##bits##_##isa(A, H)), \
+            sf_andn_##isa(sf_eq##bits##_##isa(C, M), \
+               sf_eq##bits##_##isa(G, C))); \
+      sf_v_##isa u2   = sf_and_##isa(sf_and_##isa( \
+               sf_eq##bits##_##isa(C, G), sf_eq##bits##_##isa(C, D)), \
+            sf_andn_##isa(sf_eq##bits##_##isa(A, I), \
+               sf_eq##bits##_##isa(A, H))); \
+      sf_v_##isa pa   = sf_or_##isa(sf_and_##isa(c1, sf_or_##isa(sf_and_##isa( \
+                     sf_eq##bits##_##isa(A, E), sf_eq##bits##_##isa(B, L)), t1)), \
+            sf_and_##isa(c4, t1)); \
+      sf_v_##isa pb   = sf_or_##isa(sf_and_##isa(c2, sf_or_##isa(sf_and_##isa( \
+                     sf_eq##bits##_##isa(B, F), sf_eq##bits##_##isa(A, H)), t2)), \
+            sf_and_##isa(c4, t2)); \
+      sf_v_##isa qa   = sf_or_##isa(sf_and_##isa(c1, sf_or_##isa(sf_and_##isa( \
+                     sf_eq##bits##_##isa(A, G), sf_eq##bits##_##isa(C, O)), u1)), \
+            sf_and_##isa(c4, u1)); \
+      sf_v_##isa qc   = sf_or_##isa(sf_and_##isa(c2, sf_or_##isa(sf_and_##isa( \
+                     sf_eq##bits##_##isa(C, H), sf_eq##bits##_##isa(A, F)), u2)), \
+            sf_and_##isa(c4, u2)); \
+      sf_v_##isa r    = sf_add##bits##_##isa(sf_add##bits##_##isa( \
+               twoxsai_simd_result(isa, bits, A, B, G, E), \
+               twoxsai_simd_result(isa, bits, B, A, K, F)), \
+            sf_add##bits##_##isa( \
+               twoxsai_simd_result(isa, bits, B, A, H, N), \
+               twoxsai_simd_result(isa, bits, A, B, L, O))); \
+      sf_v_##isa zero = sf_zero_##isa(); \
+      sf_v_##isa p2a  = sf_or_##isa(c1, \
+            sf_and_##isa(c3, sf_gt##bits##_##isa(r, zero))); \
+      sf_v_##isa p2b  = sf_or_##isa(c2, \
+            sf_and_##isa(c3, sf_gt##bits##_##isa(zero, r))); \
+      sf_v_##isa product  = sf_sel_##isa(pa, A, sf_sel_##isa(pb, B, \
+               SF_INTERPOLATE(isa, bits, A, B, h, l))); \
+      sf_v_##isa product1 = sf_sel_##isa(qa, A, sf_sel_##isa(qc, C, \
+               SF_INTERPOLATE(isa, bits, A, C, h, l))); \
+      sf_v_##isa product2 = sf_sel_##isa(p2a, A, sf_sel_##isa(p2b, B, \
+               SF_INTERPOLATE2(isa, bits, A, B, C, D, h2, l2))); \
+      sf_store_##isa(out0 + 2 * x,     sf_ziplo##bits##_##isa(A, product)); \
+      sf_store_##isa(out0 + 2 * x + n, sf_ziphi##bits##_##isa(A, product)); \
+      sf_store_##isa(out1 + 2 * x,     sf_ziplo##bits##_##isa(product1, product2)); \
+      sf_store_##isa(out1 + 2 * x + n, sf_ziphi##bits##_##isa(product1, product2)); \
+   } \
+   return x; \
+}
+
+/* Vector kernels process pixels [1, n) of a row, where n is
+ * the return value, leaving the edge pixels to the scalar code */
+typedef unsigned (*twoxsai_span_rgb565_t)(uint16_t *out0, uint16_t *out1,
+      const uint16_t *r0, const uint16_t *r1, const uint16_t *r2,
+      const uint16_t *r3, unsigned width);
+typedef unsigned (*twoxsai_span_xrgb8888_t)(uint32_t *out0, uint32_t *out1,
+      const uint32_t *r0, const uint32_t *r1, const uint32_t *r2,
+      const uint32_t *r3, unsigned width);
+
+#ifdef SOFTFILTER_HAVE_SSE2
+twoxsai_simd_span(sse2, rgb565, 16, uint16_t, 0xF7DE, 0x0821, 0xE79C, 0x1863)
+twoxsai_simd_span(sse2, xrgb8888, 32, uint32_t,
+      0xFEFEFEFE, 0x01010101, 0xFCFCFCFC, 0x03030303)
+#endif
+#ifdef SOFTFILTER_HAVE_AVX2
+twoxsai_simd_span(avx2, rgb565, 16, uint16_t, 0xF7DE, 0x0821, 0xE79C, 0x1863)
+twoxsai_simd_span(avx2, xrgb8888, 32, uint32_t,
+      0xFEFEFEFE, 0x01010101, 0xFCFCFCFC, 0x03030303)
+#endif
+#ifdef SOFTFILTER_HAVE_NEON
+twoxsai_simd_span(neon, rgb565, 16, uint16_t, 0xF7DE, 0x0821, 0xE79C, 0x1863)
+twoxsai_simd_span(neon, xrgb8888, 32, uint32_t,
+      0xFEFEFEFE, 0x01010101, 0xFCFCFCFC, 0x03030303)
+#endif
+
+/* Pixels outside the frame are replaced by the nearest edge
+ * pixel. Rows above and below the slice belong to other
+ * threads, but are only read. */
+#define twoxsai_span(typename_t, x, end, result_cb, interpolate_cb, interpolate2_cb) \
+   for (; x < end; x++) \
+   { \
+      unsigned x0 = (x > 0) ? x - 1 : x; \
+      unsigned x2 = (x + 1 < width) ? x + 1 : x; \
+      unsigned x3 = (x + 2 < width) ? x + 2 : x2; \
+      typename_t *out = out0 + 2 * x; \
+      twoxsai_declare_variables(typename_t, r0, r1, r2, r3, x0, x, x2, x3); \
+      twoxsai_function(result_cb, interpolate_cb, interpolate2_cb); \
+   }
+
+#define twoxsai_rows(typename_t) \
+   const typename_t *r1 = src; \
+   const typename_t *r0 = (first + y > 0) ? r1 - src_stride : r1; \
+   const typename_t *r2 = (first + y + 1 < frame_height) \
+      ? r1 + src_stride : r1; \
+   const typename_t *r3 = (first + y + 2 < frame_height) \
+      ? r2 + src_stride : r2; \
+   typename_t *out0     = dst; \
+   typename_t *out1     = dst + dst_stride
+
+static void twoxsai_generic_xrgb8888(enum softfilter_isa isa,
+      unsigned width, unsigned height,
+      unsigned first, unsigned frame_height, uint32_t *src,
       unsigned src_stride, uint32_t *dst, unsigned dst_stride)
 {
-   unsigned finish;
-   unsigned nextline = (last) ? 0 : src_stride;
+   unsigned x, y;
+   twoxsai_span_xrgb8888_t span;
 
-   for (; height; height--)
-   {
-      uint32_t *in  = (uint32_t*)src;
-      uint32_t *out = (uint32_t*)dst;
+   SOFTFILTER_SIMD_KERNEL(span, isa, twoxsai_xrgb8888);
 
-      for (finish = width; finish; finish -= 1)
-      {
-         twoxsai_declare_variables(uint32_t, in, nextline);
+   for (y = 0; y < height; y++)
+   {
+      twoxsai_rows(uint32_t);
 
-         /*
-          * Map of the pixels:           I|E F|J
-          *                              G|A B|K
-          *                              H|C D|L
-          *                              M|N O|P
-          */
+      /*
+       * Map of the pixels:           I|E F|J
+       *                              G|A B|K
+       *                              H|C D|L
+       *                              M|N O|P
+       */
 
-         twoxsai_function(twoxsai_result, twoxsai_interpolate_xrgb8888,
-               twoxsai_interpolate2_xrgb8888);
+      x = 0;
+      if (span && width > 1)
+      {
+         twoxsai_span(uint32_t, x, 1, twoxsai_result,
+               twoxsai_interpolate_xrgb8888, twoxsai_interpolate2_xrgb8888);
+         x = span(out0, out1, r0, r1, r2, r3, width);
       }
+      twoxsai_span(uint32_t, x, width, twoxsai_result,
+            twoxsai_interpolate_xrgb8888, twoxsai_interpolate2_xrgb8888);
 
       src += src_stride;
       dst += 2 * dst_stride;
    }
 }
 
-static void twoxsai_generic_rgb565(unsigned width, unsigned height,
-      int first, int last, uint16_t *src,
+static void twoxsai_generic_rgb565(enum softfilter_isa isa,
+      unsigned width, unsigned height,
+      unsigned first, unsigned frame_height, uint16_t *src,
       unsigned src_stride, uint16_t *dst, unsigned dst_stride)
 {
-   unsigned finish;
-   unsigned nextline = (last) ? 0 : src_stride;
+   unsigned x, y;
+   twoxsai_span_rgb565_t span;
+
+   SOFTFILTER_SIMD_KERNEL(span, isa, twoxsai_rgb565);
 
-   for (; height; height--)
+   for (y = 0; y < height; y++)
    {
-      uint16_t *in  = (uint16_t*)src;
-      uint16_t *out = (uint16_t*)dst;
+      twoxsai_rows(uint16_t);
 
-      for (finish = width; finish; finish -= 1)
+      x = 0;
+      if (span && width > 1)
       {
-         twoxsai_declare_variables(uint16_t, in, nextline);
-
-         /*
-          * Map of the pixels:           I|E F|J
-          *                              G|A B|K
-          *                              H|C D|L
-          *                              M|N O|P
-          */
-
-         twoxsai_function(twoxsai_result, twoxsai_interpolate_rgb565,
-               twoxsai_interpolate2_rgb565);
+         twoxsai_span(uint16_t, x, 1, twoxsai_result,
+               twoxsai_interpolate_rgb565, twoxsai_interpolate2_rgb565);
+         x = span(out0, out1, r0, r1, r2, r3, width);
       }
+      twoxsai_span(uint16_t, x, width, twoxsai_result,
+            twoxsai_interpolate_rgb565, twoxsai_interpolate2_rgb565);
 
       src += src_stride;
       dst += 2 * dst_stride;
@@ -273,14 +424,15 @@ static void twoxsai_generic_rgb565(unsigned width, unsigned height,
 
 static void twoxsai_work_cb_rgb565(void *data, void *thread_data)
 {
+   struct filter_data *filt           = (struct filter_data*)data;
    struct softfilter_thread_data *thr =
       (struct softfilter_thread_data*)thread_data;
    uint16_t *input                    = (uint16_t*)thr->in_data;
    uint16_t *output                   = (uint16_t*)thr->out_data;
    unsigned width                     = thr->width;
    unsigned height                    = thr->height;
-   twoxsai_generic_rgb565(width, height,
-         thr->first, thr->last, input,
+   twoxsai_generic_rgb565(filt->isa, width, height,
+         thr->first, thr->frame_height, input,
          (unsigned)(thr->in_pitch / SOFTFILTER_BPP_RGB565),
          output,
          (unsigned)(thr->out_pitch / SOFTFILTER_BPP_RGB565));
@@ -288,14 +440,15 @@ static void twoxsai_work_cb_rgb565(void *data, void *thread_data)
 
 static void twoxsai_work_cb_xrgb8888(void *data, void *thread_data)
 {
+   struct filter_data *filt           = (struct filter_data*)data;
    struct softfilter_thread_data *thr =
       (struct softfilter_thread_data*)thread_data;
    uint32_t *input                    = (uint32_t*)thr->in_data;
    uint32_t *output                   = (uint32_t*)thr->out_data;
    unsigned width                     = thr->width;
    unsigned height                    = thr->height;
-   twoxsai_generic_xrgb8888(width, height,
-         thr->first, thr->last, input,
+   twoxsai_generic_xrgb8888(filt->isa, width, height,
+         thr->first, thr->frame_height, input,
          (unsigned)(thr->in_pitch / SOFTFILTER_BPP_XRGB8888),
          output,
          (unsigned)(thr->out_pitch / SOFTFILTER_BPP_XRGB8888));
@@ -331,6 +484,7 @@ static void twoxsai_generic_packets(void *data,
        */
       thr->first             = y_start;
       thr->last              = y_end == height;
+      thr->frame_height      = height;
 
       if (filt->in_fmt == SOFTFILTER_FMT_RGB565)
          packets[i].work     = twoxsai_work_cb_rgb565;
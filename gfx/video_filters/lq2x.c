@@ -15,6 +15,7 @@
  */
 
 #include "softfilter.h"
+#include "softfilter_simd.h"
 #include <stdlib.h>
 
 #ifdef RARCH_INTERNAL
@@ -43,6 +44,7 @@ struct filter_data
    unsigned threads;
    struct softfilter_thread_data *workers;
    unsigned in_fmt;
+   enum softfilter_isa isa;
 };
 
 static unsigned lq2x_generic_input_fmts(void)
@@ -75,10 +77,9 @@ static void *lq2x_generic_create(const struct softfilter_config *config,
       free(filt);
       return NULL;
    }
-   /* Apparently the code is not thread-safe,
-    * so force single threaded operation... */
-   filt->threads = 1;
+   filt->threads = threads;
    filt->in_fmt  = in_fmt;
+   filt->isa     = softfilter_simd_isa(simd);
    return filt;
 }
 
@@ -101,103 +102,175 @@ static void lq2x_generic_destroy(void *data)
    free(filt);
 }
 
-static void lq2x_generic_rgb565(unsigned width, unsigned height,
+#define lq2x_blend_rgb565(C, A) (((C) + (A) - (((C) ^ (A)) & 0x0821)) >> 1)
+#define lq2x_blend_xrgb8888(C, A) (((C) + (A) - (((C) ^ (A)) & 0x0421)) >> 1)
+
+/* Vector forms of the blends above. The RGB565 one is
+ * rearranged so that it cannot overflow 16-bit lanes; the
+ * XRGB8888 one wraps around exactly like the scalar code. */
+#define lq2x_simd_blend_rgb565(isa, C, A) \
+   sf_add16_##isa(sf_and_##isa(C, A), sf_srl16_##isa( \
+         sf_and_##isa(sf_xor_##isa(C, A), sf_set16_##isa(0xF7DE)), 1))
+#define lq2x_simd_blend_xrgb8888(isa, C, A) \
+   sf_srl32_##isa(sf_sub32_##isa(sf_add32_##isa(C, A), \
+         sf_and_##isa(sf_xor_##isa(C, A), sf_set32_##isa(0x0421))), 1)
+
+/* Vector kernels process pixels [1, n) of a row, where n is
+ * the return value, leaving the edge pixels to the scalar code */
+typedef unsigned (*lq2x_span_rgb565_t)(uint16_t *out0, uint16_t *out1,
+      const uint16_t *prev, const uint16_t *cur, const uint16_t *next,
+      unsigned width);
+typedef unsigned (*lq2x_span_xrgb8888_t)(uint32_t *out0, uint32_t *out1,
+      const uint32_t *prev, const uint32_t *cur, const uint32_t *next,
+      unsigned width);
+
+#define lq2x_simd_span(isa, fmt, bits, typename_t) \
+static SF_TARGET_##isa unsigned lq2x_##fmt##_##isa( \
+      typename_t *out0, typename_t *out1, const typename_t *prev, \
+      const typename_t *cur, const typename_t *next, unsigned width) \
+{ \
+   unsigned x; \
+   const unsigned n = SF_BYTES_##isa / sizeof(typename_t); \
+   for (x = 1; x + n < width; x += n) \
+   { \
+      sf_v_##isa A    = sf_load_##isa(prev + x); \
+      sf_v_##isa B    = sf_load_##isa(cur + x - 1); \
+      sf_v_##isa C    = sf_load_##isa(cur + x); \
+      sf_v_##isa D    = sf_load_##isa(cur + x + 1); \
+      sf_v_##isa E    = sf_load_##isa(next + x); \
+      sf_v_##isa skip = sf_or_##isa(sf_eq##bits##_##isa(A, E), \
+            sf_eq##bits##_##isa(B, D)); \
+      sf_v_##isa CA   = lq2x_simd_blend_##fmt(isa, C, A); \
+      sf_v_##isa CE   = lq2x_simd_blend_##fmt(isa, C, E); \
+      sf_v_##isa p00  = sf_sel_##isa(sf_andn_##isa( \
+               sf_eq##bits##_##isa(A, B), skip), CA, C); \
+      sf_v_##isa p01  = sf_sel_##isa(sf_andn_##isa( \
+               sf_eq##bits##_##isa(A, D), skip), CA, C); \
+      sf_v_##isa p10  = sf_sel_##isa(sf_andn_##isa( \
+               sf_eq##bits##_##isa(E, B), skip), CE, C); \
+      sf_v_##isa p11  = sf_sel_##isa(sf_andn_##isa( \
+               sf_eq##bits##_##isa(E, D), skip), CE, C); \
+      sf_store_##isa(out0 + 2 * x,     sf_ziplo##bits##_##isa(p00, p01)); \
+      sf_store_##isa(out0 + 2 * x + n, sf_ziphi##bits##_##isa(p00, p01)); \
+      sf_store_##isa(out1 + 2 * x,     sf_ziplo##bits##_##isa(p10, p11)); \
+      sf_store_##isa(out1 + 2 * x + n, sf_ziphi##bits##_##isa(p10, p11)); \
+   } \
+   return x; \
+}
+
+#ifdef SOFTFILTER_HAVE_SSE2
+lq2x_simd_span(sse2, rgb565, 16, uint16_t)
+lq2x_simd_span(sse2, xrgb8888, 32, uint32_t)
+#endif
+#ifdef SOFTFILTER_HAVE_AVX2
+lq2x_simd_span(avx2, rgb565, 16, uint16_t)
+lq2x_simd_span(avx2, xrgb8888, 32, uint32_t)
+#endif
+#ifdef SOFTFILTER_HAVE_NEON
+lq2x_simd_span(neon, rgb565, 16, uint16_t)
+lq2x_simd_span(neon, xrgb8888, 32, uint32_t)
+#endif
+
+#define lq2x_span(typename_t, blend, x, end) \
+   for (; x < end; x++) \
+   { \
+      typename_t A = prev[x]; \
+      typename_t B = cur[(x > 0) ? x - 1 : x]; \
+      typename_t C = cur[x]; \
+      typename_t D = cur[(x < width - 1) ? x + 1 : x]; \
+      typename_t E = next[x]; \
+      if (A != E && B != D) \
+      { \
+         out0[2 * x]     = (A == B) ? blend(C, A) : C; \
+         out0[2 * x + 1] = (A == D) ? blend(C, A) : C; \
+         out1[2 * x]     = (E == B) ? blend(C, E) : C; \
+         out1[2 * x + 1] = (E == D) ? blend(C, E) : C; \
+      } \
+      else \
+      { \
+         out0[2 * x]     = C; \
+         out0[2 * x + 1] = C; \
+         out1[2 * x]     = C; \
+         out1[2 * x + 1] = C; \
+      } \
+   }
+
+/* Rows above and below the slice belong to other threads
+ * but are only read, so only the frame edges are clamped */
+static void lq2x_generic_rgb565(enum softfilter_isa isa,
+      unsigned width, unsigned height,
       int first, int last, uint16_t *src,
       unsigned src_stride, uint16_t *dst, unsigned dst_stride)
 {
    unsigned x, y;
-   uint16_t *out0 = (uint16_t*)dst;
-   uint16_t *out1 = (uint16_t*)(dst + dst_stride);
+   lq2x_span_rgb565_t span;
+
+   SOFTFILTER_SIMD_KERNEL(span, isa, lq2x_rgb565);
 
    for (y = 0; y < height; y++)
    {
-      int prevline = (y == 0 ? 0 : src_stride);
-      int nextline = (y == height - 1 || last) ? 0 : src_stride;
-
-      for (x = 0; x < width; x++)
+      const uint16_t *cur  = src;
+      const uint16_t *prev = (first + y > 0) ? cur - src_stride : cur;
+      const uint16_t *next = (y < height - 1 || !last)
+         ? cur + src_stride : cur;
+      uint16_t *out0       = dst;
+      uint16_t *out1       = dst + dst_stride;
+
+      x = 0;
+      if (span && width > 1)
       {
-         uint16_t A = *(src - prevline);
-         uint16_t B = (x > 0) ? *(src - 1) : *src;
-         uint16_t C = *src;
-         uint16_t D = (x < width - 1) ? *(src + 1) : *src;
-         uint16_t E = *(src++ + nextline);
-         uint16_t c = C;
-
-         if (A != E && B != D)
-         {
-            *out0++ = (A == B ? ((C + A - ((C ^ A) & 0x0821)) >> 1) : c);
-            *out0++ = (A == D ? ((C + A - ((C ^ A) & 0x0821)) >> 1) : c);
-            *out1++ = (E == B ? ((C + E - ((C ^ E) & 0x0821)) >> 1) : c);
-            *out1++ = (E == D ? ((C + E - ((C ^ E) & 0x0821)) >> 1) : c);
-         }
-         else
-         {
-            *out0++ = c;
-            *out0++ = c;
-            *out1++ = c;
-            *out1++ = c;
-         }
+         lq2x_span(uint16_t, lq2x_blend_rgb565, x, 1);
+         x = span(out0, out1, prev, cur, next, width);
       }
+      lq2x_span(uint16_t, lq2x_blend_rgb565, x, width);
 
-      src  += src_stride - width;
-      out0 += dst_stride + dst_stride - (width << 1);
-      out1 += dst_stride + dst_stride - (width << 1);
+      src += src_stride;
+      dst += dst_stride << 1;
    }
 }
 
-static void lq2x_generic_xrgb8888(unsigned width, unsigned height,
+static void lq2x_generic_xrgb8888(enum softfilter_isa isa,
+      unsigned width, unsigned height,
       int first, int last, uint32_t *src,
       unsigned src_stride, uint32_t *dst, unsigned dst_stride)
 {
    unsigned x, y;
-   uint32_t *out0 = (uint32_t*)dst;
-   uint32_t *out1 = (uint32_t*)(dst + dst_stride);
+   lq2x_span_xrgb8888_t span;
+
+   SOFTFILTER_SIMD_KERNEL(span, isa, lq2x_xrgb8888);
 
    for (y = 0; y < height; y++)
    {
-      int prevline = (y == 0 ? 0 : src_stride);
-      int nextline = (y == height - 1 || last) ? 0 : src_stride;
-
-      for (x = 0; x < width; x++)
+      const uint32_t *cur  = src;
+      const uint32_t *prev = (first + y > 0) ? cur - src_stride : cur;
+      const uint32_t *next = (y < height - 1 || !last)
+         ? cur + src_stride : cur;
+      uint32_t *out0       = dst;
+      uint32_t *out1       = dst + dst_stride;
+
+      x = 0;
+      if (span && width > 1)
       {
-         uint32_t A = *(src - prevline);
-         uint32_t B = (x > 0) ? *(src - 1) : *src;
-         uint32_t C = *src;
-         uint32_t D = (x < width - 1) ? *(src + 1) : *src;
-         uint32_t E = *(src++ + nextline);
-         uint32_t c = C;
-
-         if (A != E && B != D)
-         {
-            *out0++ = (A == B ? (C + A - ((C ^ A) & 0x0421)) >> 1 : c);
-            *out0++ = (A == D ? (C + A - ((C ^ A) & 0x0421)) >> 1 : c);
-            *out1++ = (E == B ? (C + E - ((C ^ E) & 0x0421)) >> 1 : c);
-            *out1++ = (E == D ? (C + E - ((C ^ E) & 0x0421)) >> 1 : c);
-         }
-         else
-         {
-            *out0++ = c;
-            *out0++ = c;
-            *out1++ = c;
-            *out1++ = c;
-         }
+         lq2x_span(uint32_t, lq2x_blend_xrgb8888, x, 1);
+         x = span(out0, out1, prev, cur, next, width);
       }
+      lq2x_span(uint32_t, lq2x_blend_xrgb8888, x, width);
 
-      src += src_stride - width;
-      out0 += dst_stride + dst_stride - (width << 1);
-      out1 += dst_stride + dst_stride - (width << 1);
+      src += src_stride;
+      dst += dst_stride << 1;
    }
 }
 
 static void lq2x_work_cb_rgb565(void *data, void *thread_data)
 {
+   struct filter_data *filt           = (struct filter_data*)data;
    struct softfilter_thread_data *thr =
       (struct softfilter_thread_data*)thread_data;
    uint16_t *input                    = (uint16_t*)thr->in_data;
    uint16_t *output                   = (uint16_t*)thr->out_data;
    unsigned width                     = thr->width;
    unsigned height                    = thr->height;
-   lq2x_generic_rgb565(width, height,
+   lq2x_generic_rgb565(filt->isa, width, height,
          thr->first, thr->last, input,
          (unsigned)(thr->in_pitch / SOFTFILTER_BPP_RGB565),
          output,
@@ -206,13 +279,14 @@ static void lq2x_work_cb_rgb565(void *data, void *thread_data)
 
 static void lq2x_work_cb_xrgb8888(void *data, void *thread_data)
 {
+   struct filter_data *filt           = (struct filter_data*)data;
    struct softfilter_thread_data *thr =
       (struct softfilter_thread_data*)thread_data;
    uint32_t *input                    = (uint32_t*)thr->in_data;
    uint32_t *output                   = (uint32_t*)thr->out_data;
    unsigned width                     = thr->width;
    unsigned height                    = thr->height;
-   lq2x_generic_xrgb8888(width, height,
+   lq2x_generic_xrgb8888(filt->isa, width, height,
          thr->first, thr->last, input,
          (unsigned)(thr->in_pitch / SOFTFILTER_BPP_XRGB8888),
          output,
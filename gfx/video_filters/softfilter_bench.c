@@ -0,0 +1,496 @@
+/*  RetroArch - A frontend for libretro.
+ *  Copyright (C) 2010-2020 - The RetroArch team
+ *
+ *  RetroArch is free software: you can redistribute it and/or modify it under the terms
+ *  of the GNU General Public License as published by the Free Software Found-
+ *  ation, either version 3 of the License, or (at your option) any later version.
+ *
+ *  RetroArch is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ *  without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ *  PURPOSE.  See the GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along with RetroArch.
+ *  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/* Runs softfilter plugins on synthetic frames with every
+ * combination of SIMD level and thread count, and reports
+ * the time taken per frame. Exits with an error if any
+ * combination produces different pixels than the plain C,
+ * single-threaded path.
+ *
+ * Each argument is either a plugin, which is run with its
+ * default settings, or a .filt preset, whose plugin is looked
+ * up next to it and configured the same way RetroArch does.
+ *
+ * Usage: softfilter_bench [-n frames] [-t max threads]
+ *        [-s width height] <plugin|preset>... */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+
+#include <boolean.h>
+#include <retro_miscellaneous.h>
+#include <compat/strl.h>
+#include <dynamic/dylib.h>
+#include <encodings/crc32.h>
+#include <features/features_cpu.h>
+#include <file/config_file.h>
+#include <file/config_file_userdata.h>
+#include <file/file_path.h>
+#include <lists/dir_list.h>
+#include <rthreads/tpool.h>
+#include <string/stdstring.h>
+
+#include "softfilter.h"
+
+#define SOFTFILTER_BENCH_MAX_THREADS 16
+
+#if defined(_WIN32)
+#define SOFTFILTER_BENCH_PLUG_EXT "dll"
+#elif defined(__APPLE__)
+#define SOFTFILTER_BENCH_PLUG_EXT "dylib"
+#else
+#define SOFTFILTER_BENCH_PLUG_EXT "so"
+#endif
+
+struct softfilter_bench_job
+{
+   const struct softfilter_work_packet *packet;
+   void *data;
+};
+
+static int softfilter_bench_get_float(void *userdata, const char *key,
+      float *value, float default_value)
+{
+   *value = default_value;
+   return 0;
+}
+
+static int softfilter_bench_get_int(void *userdata, const char *key,
+      int *value, int default_value)
+{
+   *value = default_value;
+   return 0;
+}
+
+static int softfilter_bench_get_hex(void *userdata, const char *key,
+      unsigned *value, unsigned default_value)
+{
+   *value = default_value;
+   return 0;
+}
+
+static int softfilter_bench_get_float_array(void *userdata, const char *key,
+      float **values, unsigned *out_num_values,
+      const float *default_values, unsigned num_default_values)
+{
+   *values         = (float*)malloc((num_default_values + 1) * sizeof(float));
+   *out_num_values = num_default_values;
+   if (num_default_values)
+      memcpy(*values, default_values, num_default_values * sizeof(float));
+   return 0;
+}
+
+static int softfilter_bench_get_int_array(void *userdata, const char *key,
+      int **values, unsigned *out_num_values,
+      const int *default_values, unsigned num_default_values)
+{
+   *values         = (int*)malloc((num_default_values + 1) * sizeof(int));
+   *out_num_values = num_default_values;
+   if (num_default_values)
+      memcpy(*values, default_values, num_default_values * sizeof(int));
+   return 0;
+}
+
+static int softfilter_bench_get_string(void *userdata, const char *key,
+      char **output, const char *default_output)
+{
+   size_t len = strlen(default_output) + 1;
+   *output    = (char*)malloc(len);
+   memcpy(*output, default_output, len);
+   return 0;
+}
+
+static void softfilter_bench_free(void *ptr)
+{
+   free(ptr);
+}
+
+/* Used for plugins given directly: every setting
+ * gets its default value */
+static const struct softfilter_config softfilter_bench_config = {
+   softfilter_bench_get_float,
+   softfilter_bench_get_int,
+   softfilter_bench_get_hex,
+   softfilter_bench_get_float_array,
+   softfilter_bench_get_int_array,
+   softfilter_bench_get_string,
+   softfilter_bench_free
+};
+
+/* Used for presets, reads the settings from the .filt file */
+static const struct softfilter_config softfilter_bench_preset_config = {
+   config_userdata_get_float,
+   config_userdata_get_int,
+   config_userdata_get_hex,
+   config_userdata_get_float_array,
+   config_userdata_get_int_array,
+   config_userdata_get_string,
+   config_userdata_free
+};
+
+/* Finds the plugin named by the 'filter' key of a preset
+ * among the plugins in the preset's directory, as
+ * rarch_softfilter_new() does. Returns NULL on failure. */
+static dylib_t softfilter_bench_load_preset(config_file_t *conf,
+      const char *path, softfilter_get_implementation_t *get_impl)
+{
+   size_t i;
+   char name[64];
+   char basedir[PATH_MAX_LENGTH];
+   struct string_list *plugs = NULL;
+   dylib_t lib               = NULL;
+
+   if (!config_get_array(conf, "filter", name, sizeof(name)))
+   {
+      fprintf(stderr, "%s has no 'filter' entry\n", path);
+      return NULL;
+   }
+
+   fill_pathname_basedir(basedir, path, sizeof(basedir));
+
+   if (!(plugs = dir_list_new(basedir, SOFTFILTER_BENCH_PLUG_EXT,
+               false, false, false, false)))
+      return NULL;
+
+   for (i = 0; i < plugs->size && !lib; i++)
+   {
+      const struct softfilter_implementation *impl = NULL;
+      softfilter_get_implementation_t cb;
+
+      if (!(lib = dylib_load(plugs->elems[i].data)))
+         continue;
+
+      cb = (softfilter_get_implementation_t)
+         dylib_proc(lib, "softfilter_get_implementation");
+
+      if (     cb
+            && (impl = cb(0))
+            && impl->api_version == SOFTFILTER_API_VERSION
+            && string_is_equal(impl->short_ident, name))
+         *get_impl = cb;
+      else
+      {
+         dylib_close(lib);
+         lib = NULL;
+      }
+   }
+
+   string_list_free(plugs);
+
+   if (!lib)
+      fprintf(stderr, "%s: could not find plugin '%s'\n", path, name);
+
+   return lib;
+}
+
+static void softfilter_bench_work(void *arg)
+{
+   struct softfilter_bench_job *job = (struct softfilter_bench_job*)arg;
+   job->packet->work(job->data, job->packet->thread_data);
+}
+
+/* Fills the frame with a few large flat areas, some
+ * diagonal edges and some noise, so that every branch
+ * of the pattern-matching filters is taken */
+static void softfilter_bench_fill(uint8_t *frame, unsigned fmt,
+      unsigned width, unsigned height, size_t pitch)
+{
+   unsigned x, y;
+   uint32_t seed = 1;
+
+   for (y = 0; y < height; y++)
+   {
+      for (x = 0; x < width; x++)
+      {
+         uint32_t color;
+
+         seed = seed * 1103515245 + 12345;
+
+         if (((seed >> 16) & 15) == 0)
+            color = seed ^ (seed >> 13);
+         else if (((x + y) / 8) & 1)
+            color = 0x00ffe0c0;
+         else if ((x / 16 + y / 16) & 1)
+            color = 0x00204080;
+         else
+            color = 0x00000000;
+
+         if (fmt == SOFTFILTER_FMT_RGB565)
+            ((uint16_t*)(frame + y * pitch))[x] = (uint16_t)(
+                    ((color >> 8) & 0xf800)
+                  | ((color >> 5) & 0x07e0)
+                  | ((color >> 3) & 0x001f));
+         else
+            ((uint32_t*)(frame + y * pitch))[x] = color;
+      }
+   }
+}
+
+/* Returns the time taken per frame in microseconds,
+ * or -1 if the filter could not be created */
+static double softfilter_bench_run(
+      softfilter_get_implementation_t get_impl,
+      const struct softfilter_config *config, void *userdata,
+      softfilter_simd_mask_t simd, unsigned fmt, unsigned threads,
+      const uint8_t *frame, unsigned width, unsigned height, size_t pitch,
+      unsigned frames, tpool_t *pool, uint32_t *crc)
+{
+   unsigned i, n, num_threads;
+   unsigned out_width, out_height;
+   size_t out_pitch;
+   retro_time_t start;
+   uint8_t *out                                 = NULL;
+   void *data                                   = NULL;
+   unsigned bpp                                 = (fmt == SOFTFILTER_FMT_RGB565)
+      ? SOFTFILTER_BPP_RGB565 : SOFTFILTER_BPP_XRGB8888;
+   const struct softfilter_implementation *impl = get_impl(simd);
+   struct softfilter_work_packet packets[SOFTFILTER_BENCH_MAX_THREADS];
+   struct softfilter_bench_job jobs[SOFTFILTER_BENCH_MAX_THREADS];
+
+   if (!impl || !(impl->query_input_formats() & fmt))
+      return -1.0;
+
+   if (!(data = impl->create(config, fmt, fmt,
+               width, height, threads, simd, userdata)))
+      return -1.0;
+
+   num_threads = impl->query_num_threads(data);
+   if (!num_threads || num_threads > SOFTFILTER_BENCH_MAX_THREADS)
+   {
+      impl->destroy(data);
+      return -1.0;
+   }
+
+   impl->query_output_size(data, &out_width, &out_height, width, height);
+   out_pitch = out_width * bpp;
+   out       = (uint8_t*)calloc(out_pitch, out_height);
+
+   for (i = 0; i < num_threads; i++)
+   {
+      jobs[i].packet = &packets[i];
+      jobs[i].data   = data;
+   }
+
+   start = cpu_features_get_time_usec();
+
+   for (n = 0; n < frames; n++)
+   {
+      impl->get_work_packets(data, packets, out, out_pitch,
+            frame, width, height, pitch);
+
+      if (num_threads == 1)
+         packets[0].work(data, packets[0].thread_data);
+      else
+      {
+         for (i = 1; i < num_threads; i++)
+            tpool_add_work(pool, softfilter_bench_work, &jobs[i]);
+         softfilter_bench_work(&jobs[0]);
+         tpool_wait(pool);
+      }
+   }
+
+   start = cpu_features_get_time_usec() - start;
+
+   *crc  = encoding_crc32(0, out, out_pitch * out_height);
+
+   free(out);
+   impl->destroy(data);
+
+   return (double)start / frames;
+}
+
+int main(int argc, char *argv[])
+{
+   int i;
+   unsigned f, s, t;
+   unsigned frames          = 200;
+   unsigned max_threads     = cpu_features_get_core_amount();
+   unsigned width           = 320;
+   unsigned height          = 240;
+   bool mismatch            = false;
+   tpool_t *pool            = NULL;
+   uint64_t cpu             = cpu_features_get();
+   static const unsigned fmts[2] = {
+      SOFTFILTER_FMT_RGB565, SOFTFILTER_FMT_XRGB8888 };
+   static const char *fmt_names[2] = { "rgb565", "xrgb8888" };
+   softfilter_simd_mask_t simds[3];
+   const char *simd_names[3];
+   unsigned num_simds       = 0;
+
+   /* Plain C, then each SIMD level available on this CPU */
+   simds[num_simds]         = 0;
+   simd_names[num_simds++]  = "c";
+   if (cpu & RETRO_SIMD_SSE2)
+   {
+      simds[num_simds]      = SOFTFILTER_SIMD_SSE2;
+      simd_names[num_simds++] = "sse2";
+      if (cpu & RETRO_SIMD_AVX2)
+      {
+         simds[num_simds]   = SOFTFILTER_SIMD_SSE2 | SOFTFILTER_SIMD_AVX2;
+         simd_names[num_simds++] = "avx2";
+      }
+   }
+   else if (cpu & RETRO_SIMD_NEON)
+   {
+      simds[num_simds]      = SOFTFILTER_SIMD_NEON;
+      simd_names[num_simds++] = "neon";
+   }
+
+   for (i = 1; i < argc; i++)
+   {
+      if (!strcmp(argv[i], "-n") && i + 1 < argc)
+         frames = (unsigned)strtoul(argv[++i], NULL, 10);
+      else if (!strcmp(argv[i], "-t") && i + 1 < argc)
+         max_threads = (unsigned)strtoul(argv[++i], NULL, 10);
+      else if (!strcmp(argv[i], "-s") && i + 2 < argc)
+      {
+         width  = (unsigned)strtoul(argv[++i], NULL, 10);
+         height = (unsigned)strtoul(argv[++i], NULL, 10);
+      }
+      else
+         break;
+   }
+
+   if (i >= argc || !frames || !width || !height)
+   {
+      fprintf(stderr, "Usage: %s [-n frames] [-t max threads] "
+            "[-s width height] <plugin|preset>...\n", argv[0]);
+      return 1;
+   }
+
+   if (max_threads < 1)
+      max_threads = 1;
+   else if (max_threads > SOFTFILTER_BENCH_MAX_THREADS)
+      max_threads = SOFTFILTER_BENCH_MAX_THREADS;
+
+   if (max_threads > 1 && !(pool = tpool_create(max_threads - 1)))
+      return 1;
+
+   printf("%ux%u, %u frames, up to %u threads\n",
+         width, height, frames, max_threads);
+
+   for (; i < argc; i++)
+   {
+      struct config_file_userdata userdata;
+      char label[64];
+      softfilter_get_implementation_t get_impl = NULL;
+      const struct softfilter_config *config   = &softfilter_bench_config;
+      config_file_t *conf                      = NULL;
+      dylib_t lib                              = NULL;
+
+      if (string_is_equal_noncase(path_get_extension(argv[i]), "filt"))
+      {
+         if (!(conf = config_file_new_from_path_to_string(argv[i])))
+         {
+            fprintf(stderr, "Could not read %s\n", argv[i]);
+            continue;
+         }
+
+         if (!(lib = softfilter_bench_load_preset(conf, argv[i], &get_impl)))
+         {
+            config_file_free(conf);
+            continue;
+         }
+
+         config             = &softfilter_bench_preset_config;
+         userdata.conf      = conf;
+         /* Index-specific configs take priority over ident-specific. */
+         userdata.prefix[0] = "filter";
+         userdata.prefix[1] = get_impl(0)->short_ident;
+
+         fill_pathname_base(label, argv[i], sizeof(label));
+         path_remove_extension(label);
+      }
+      else
+      {
+         if (!(lib = dylib_load(argv[i])))
+         {
+            fprintf(stderr, "Could not load %s\n", argv[i]);
+            continue;
+         }
+
+         get_impl = (softfilter_get_implementation_t)
+            dylib_proc(lib, "softfilter_get_implementation");
+
+         if (!get_impl)
+         {
+            fprintf(stderr, "%s is not a softfilter plugin\n", argv[i]);
+            dylib_close(lib);
+            continue;
+         }
+
+         strlcpy(label, get_impl(0)->short_ident, sizeof(label));
+      }
+
+      for (f = 0; f < 2; f++)
+      {
+         uint32_t ref_crc = 0;
+         unsigned bpp     = (fmts[f] == SOFTFILTER_FMT_RGB565)
+            ? SOFTFILTER_BPP_RGB565 : SOFTFILTER_BPP_XRGB8888;
+         size_t pitch     = width * bpp;
+         uint8_t *frame   = (uint8_t*)malloc(pitch * height);
+
+         if (!frame)
+            break;
+
+         softfilter_bench_fill(frame, fmts[f], width, height, pitch);
+
+         for (s = 0; s < num_simds; s++)
+         {
+            printf("%-24s %-8s %-4s", label, fmt_names[f], simd_names[s]);
+
+            for (t = 1; t <= max_threads; t++)
+            {
+               uint32_t crc = 0;
+               double   us  = softfilter_bench_run(get_impl,
+                     config, conf ? &userdata : NULL, simds[s],
+                     fmts[f], t, frame, width, height, pitch,
+                     frames, pool, &crc);
+
+               if (us < 0.0)
+               {
+                  printf("       n/a");
+                  continue;
+               }
+
+               if (s == 0 && t == 1)
+                  ref_crc = crc;
+               else if (crc != ref_crc)
+               {
+                  fprintf(stderr, "\n%s: %s output with %u threads differs\n",
+                        argv[i], simd_names[s], t);
+                  mismatch = true;
+               }
+
+               printf(" %6.3f ms", us / 1000.0);
+            }
+            printf("\n");
+         }
+
+         free(frame);
+      }
+
+      dylib_close(lib);
+      if (conf)
+         config_file_free(conf);
+   }
+
+   if (pool)
+      tpool_destroy(pool);
+
+   return mismatch ? 2 : 0;
+}
@@ -0,0 +1,266 @@
+/*  RetroArch - A frontend for libretro.
+ *  Copyright (C) 2010-2014 - Hans-Kristian Arntzen
+ *  Copyright (C) 2011-2017 - Daniel De Matteis
+ *
+ *  RetroArch is free software: you can redistribute it and/or modify it under the terms
+ *  of the GNU General Public License as published by the Free Software Found-
+ *  ation, either version 3 of the License, or (at your option) any later version.
+ *
+ *  RetroArch is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ *  without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ *  PURPOSE.  See the GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along with RetroArch.
+ *  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/* Minimal integer vector layer used by the pixel-art
+ * scalers (2xSaI, Super2xSaI, SuperEagle, LQ2x).
+ *
+ * Every operation exists once per instruction set, with
+ * the instruction set as a suffix (sf_and_sse2, sf_and_avx2,
+ * sf_and_neon, ...), so that a filter can write its vector
+ * kernel once as a macro taking the suffix as a parameter,
+ * and instantiate it for every instruction set the compiler
+ * can target. Which one actually runs is then decided from
+ * the softfilter_simd_mask_t given to create().
+ *
+ * AVX2 kernels are built with a function target attribute,
+ * so they do not require the whole filter to be compiled
+ * with -mavx2. */
+
+#ifndef SOFTFILTER_SIMD_H__
+#define SOFTFILTER_SIMD_H__
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include <retro_inline.h>
+
+#include "softfilter.h"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define SOFTFILTER_HAVE_SSE2
+#include <emmintrin.h>
+
+#if (defined(__GNUC__) && (__GNUC__ > 4 || (__GNUC__ == 4 && __GNUC_MINOR__ >= 9))) || defined(__clang__)
+#define SOFTFILTER_HAVE_AVX2
+#define SF_TARGET_avx2 __attribute__((target("avx2")))
+#elif defined(_MSC_VER) && _MSC_VER >= 1800
+#define SOFTFILTER_HAVE_AVX2
+#define SF_TARGET_avx2
+#endif
+
+#ifdef SOFTFILTER_HAVE_AVX2
+#include <immintrin.h>
+#endif
+#endif
+
+#if defined(__ARM_NEON__) || defined(__ARM_NEON) || defined(__aarch64__)
+#define SOFTFILTER_HAVE_NEON
+#include <arm_neon.h>
+#endif
+
+/* Size of a vector, in bytes */
+#define SF_BYTES_sse2 16
+#define SF_BYTES_avx2 32
+#define SF_BYTES_neon 16
+
+#define SF_TARGET_sse2
+#define SF_TARGET_neon
+
+#ifdef SOFTFILTER_HAVE_SSE2
+typedef __m128i sf_v_sse2;
+
+#define sf_load_sse2(p)       _mm_loadu_si128((const __m128i*)(const void*)(p))
+#define sf_store_sse2(p, v)   _mm_storeu_si128((__m128i*)(void*)(p), (v))
+#define sf_set32_sse2(x)      _mm_set1_epi32((int)(x))
+#define sf_set16_sse2(x)      _mm_set1_epi16((short)(x))
+#define sf_and_sse2(a, b)     _mm_and_si128((a), (b))
+#define sf_or_sse2(a, b)      _mm_or_si128((a), (b))
+#define sf_xor_sse2(a, b)     _mm_xor_si128((a), (b))
+/* a & ~b */
+#define sf_andn_sse2(a, b)    _mm_andnot_si128((b), (a))
+#define sf_eq32_sse2(a, b)    _mm_cmpeq_epi32((a), (b))
+#define sf_eq16_sse2(a, b)    _mm_cmpeq_epi16((a), (b))
+#define sf_gt32_sse2(a, b)    _mm_cmpgt_epi32((a), (b))
+#define sf_gt16_sse2(a, b)    _mm_cmpgt_epi16((a), (b))
+#define sf_add32_sse2(a, b)   _mm_add_epi32((a), (b))
+#define sf_add16_sse2(a, b)   _mm_add_epi16((a), (b))
+#define sf_sub32_sse2(a, b)   _mm_sub_epi32((a), (b))
+#define sf_sub16_sse2(a, b)   _mm_sub_epi16((a), (b))
+#define sf_srl32_sse2(v, n)   _mm_srli_epi32((v), (n))
+#define sf_srl16_sse2(v, n)   _mm_srli_epi16((v), (n))
+#define sf_zero_sse2()        _mm_setzero_si128()
+
+/* m ? a : b, where every lane of m is either all ones or zero */
+static INLINE __m128i sf_sel_sse2(__m128i m, __m128i a, __m128i b)
+{
+   return _mm_or_si128(_mm_and_si128(m, a), _mm_andnot_si128(m, b));
+}
+
+/* Interleaves a and b: a0 b0 a1 b1 ... */
+#define sf_ziplo32_sse2(a, b) _mm_unpacklo_epi32((a), (b))
+#define sf_ziphi32_sse2(a, b) _mm_unpackhi_epi32((a), (b))
+#define sf_ziplo16_sse2(a, b) _mm_unpacklo_epi16((a), (b))
+#define sf_ziphi16_sse2(a, b) _mm_unpackhi_epi16((a), (b))
+#endif
+
+#ifdef SOFTFILTER_HAVE_AVX2
+typedef __m256i sf_v_avx2;
+
+#define sf_load_avx2(p)       _mm256_loadu_si256((const __m256i*)(const void*)(p))
+#define sf_store_avx2(p, v)   _mm256_storeu_si256((__m256i*)(void*)(p), (v))
+#define sf_set32_avx2(x)      _mm256_set1_epi32((int)(x))
+#define sf_set16_avx2(x)      _mm256_set1_epi16((short)(x))
+#define sf_and_avx2(a, b)     _mm256_and_si256((a), (b))
+#define sf_or_avx2(a, b)      _mm256_or_si256((a), (b))
+#define sf_xor_avx2(a, b)     _mm256_xor_si256((a), (b))
+#define sf_andn_avx2(a, b)    _mm256_andnot_si256((b), (a))
+#define sf_eq32_avx2(a, b)    _mm256_cmpeq_epi32((a), (b))
+#define sf_eq16_avx2(a, b)    _mm256_cmpeq_epi16((a), (b))
+#define sf_gt32_avx2(a, b)    _mm256_cmpgt_epi32((a), (b))
+#define sf_gt16_avx2(a, b)    _mm256_cmpgt_epi16((a), (b))
+#define sf_add32_avx2(a, b)   _mm256_add_epi32((a), (b))
+#define sf_add16_avx2(a, b)   _mm256_add_epi16((a), (b))
+#define sf_sub32_avx2(a, b)   _mm256_sub_epi32((a), (b))
+#define sf_sub16_avx2(a, b)   _mm256_sub_epi16((a), (b))
+#define sf_srl32_avx2(v, n)   _mm256_srli_epi32((v), (n))
+#define sf_srl16_avx2(v, n)   _mm256_srli_epi16((v), (n))
+#define sf_zero_avx2()        _mm256_setzero_si256()
+#define sf_sel_avx2(m, a, b)  _mm256_blendv_epi8((b), (a), (m))
+
+/* The AVX2 unpack instructions work on each 128-bit half
+ * separately, so the halves have to be put back in order */
+#define sf_ziplo32_avx2(a, b) _mm256_permute2x128_si256( \
+      _mm256_unpacklo_epi32((a), (b)), _mm256_unpackhi_epi32((a), (b)), 0x20)
+#define sf_ziphi32_avx2(a, b) _mm256_permute2x128_si256( \
+      _mm256_unpacklo_epi32((a), (b)), _mm256_unpackhi_epi32((a), (b)), 0x31)
+#define sf_ziplo16_avx2(a, b) _mm256_permute2x128_si256( \
+      _mm256_unpacklo_epi16((a), (b)), _mm256_unpackhi_epi16((a), (b)), 0x20)
+#define sf_ziphi16_avx2(a, b) _mm256_permute2x128_si256( \
+      _mm256_unpacklo_epi16((a), (b)), _mm256_unpackhi_epi16((a), (b)), 0x31)
+#endif
+
+#ifdef SOFTFILTER_HAVE_NEON
+/* 16-bit operations reinterpret the same register type */
+typedef uint32x4_t sf_v_neon;
+
+#define SF_NEON_U16(v)        vreinterpretq_u16_u32(v)
+#define SF_NEON_U32(v)        vreinterpretq_u32_u16(v)
+
+#define sf_load_neon(p)       vreinterpretq_u32_u8(vld1q_u8((const uint8_t*)(const void*)(p)))
+#define sf_store_neon(p, v)   vst1q_u8((uint8_t*)(void*)(p), vreinterpretq_u8_u32(v))
+#define sf_set32_neon(x)      vdupq_n_u32((uint32_t)(x))
+#define sf_set16_neon(x)      SF_NEON_U32(vdupq_n_u16((uint16_t)(x)))
+#define sf_and_neon(a, b)     vandq_u32((a), (b))
+#define sf_or_neon(a, b)      vorrq_u32((a), (b))
+#define sf_xor_neon(a, b)     veorq_u32((a), (b))
+#define sf_andn_neon(a, b)    vbicq_u32((a), (b))
+#define sf_eq32_neon(a, b)    vceqq_u32((a), (b))
+#define sf_eq16_neon(a, b)    SF_NEON_U32(vceqq_u16(SF_NEON_U16(a), SF_NEON_U16(b)))
+#define sf_gt32_neon(a, b)    vcgtq_s32(vreinterpretq_s32_u32(a), vreinterpretq_s32_u32(b))
+#define sf_gt16_neon(a, b)    SF_NEON_U32(vcgtq_s16( \
+      vreinterpretq_s16_u32(a), vreinterpretq_s16_u32(b)))
+#define sf_add32_neon(a, b)   vaddq_u32((a), (b))
+#define sf_add16_neon(a, b)   SF_NEON_U32(vaddq_u16(SF_NEON_U16(a), SF_NEON_U16(b)))
+#define sf_sub32_neon(a, b)   vsubq_u32((a), (b))
+#define sf_sub16_neon(a, b)   SF_NEON_U32(vsubq_u16(SF_NEON_U16(a), SF_NEON_U16(b)))
+#define sf_srl32_neon(v, n)   vshrq_n_u32((v), (n))
+#define sf_srl16_neon(v, n)   SF_NEON_U32(vshrq_n_u16(SF_NEON_U16(v), (n)))
+#define sf_zero_neon()        vdupq_n_u32(0)
+#define sf_sel_neon(m, a, b)  vbslq_u32((m), (a), (b))
+
+#define sf_ziplo32_neon(a, b) (vzipq_u32((a), (b)).val[0])
+#define sf_ziphi32_neon(a, b) (vzipq_u32((a), (b)).val[1])
+#define sf_ziplo16_neon(a, b) SF_NEON_U32(vzipq_u16(SF_NEON_U16(a), SF_NEON_U16(b)).val[0])
+#define sf_ziphi16_neon(a, b) SF_NEON_U32(vzipq_u16(SF_NEON_U16(a), SF_NEON_U16(b)).val[1])
+#endif
+
+enum softfilter_isa
+{
+   SOFTFILTER_ISA_NONE = 0,
+   SOFTFILTER_ISA_SSE2,
+   SOFTFILTER_ISA_AVX2,
+   SOFTFILTER_ISA_NEON
+};
+
+/* Returns the widest instruction set that was compiled in
+ * and is also present in 'simd'. */
+static INLINE enum softfilter_isa softfilter_simd_isa(
+      softfilter_simd_mask_t simd)
+{
+#ifdef SOFTFILTER_HAVE_AVX2
+   if (simd & SOFTFILTER_SIMD_AVX2)
+      return SOFTFILTER_ISA_AVX2;
+#endif
+#ifdef SOFTFILTER_HAVE_SSE2
+   if (simd & SOFTFILTER_SIMD_SSE2)
+      return SOFTFILTER_ISA_SSE2;
+#endif
+#ifdef SOFTFILTER_HAVE_NEON
+   if (simd & SOFTFILTER_SIMD_NEON)
+      return SOFTFILTER_ISA_NEON;
+#endif
+   return SOFTFILTER_ISA_NONE;
+}
+
+#ifdef SOFTFILTER_HAVE_SSE2
+#define SF_KERNEL_sse2(name) name##_sse2
+#else
+#define SF_KERNEL_sse2(name) NULL
+#endif
+#ifdef SOFTFILTER_HAVE_AVX2
+#define SF_KERNEL_avx2(name) name##_avx2
+#else
+#define SF_KERNEL_avx2(name) NULL
+#endif
+#ifdef SOFTFILTER_HAVE_NEON
+#define SF_KERNEL_neon(name) name##_neon
+#else
+#define SF_KERNEL_neon(name) NULL
+#endif
+
+/* Sets 'ptr' to the instantiation of kernel 'name' for the
+ * given instruction set, or to NULL if there is none */
+#define SOFTFILTER_SIMD_KERNEL(ptr, isa, name) \
+   switch (isa) \
+   { \
+      case SOFTFILTER_ISA_AVX2: \
+         ptr = SF_KERNEL_avx2(name); \
+         break; \
+      case SOFTFILTER_ISA_SSE2: \
+         ptr = SF_KERNEL_sse2(name); \
+         break; \
+      case SOFTFILTER_ISA_NEON: \
+         ptr = SF_KERNEL_neon(name); \
+         break; \
+      default: \
+         ptr = NULL; \
+         break; \
+   }
+
+/* Vector versions of the per-channel averages shared by the
+ * SaI family of filters. 'hi' holds every channel without
+ * its low bit (or two low bits), 'lo' the remaining bits.
+ * Results are bit-exact with the scalar macros. */
+#define SF_INTERPOLATE(isa, bits, a, b, hi, lo) \
+   sf_add##bits##_##isa(sf_add##bits##_##isa( \
+         sf_srl##bits##_##isa(sf_and_##isa((a), (hi)), 1), \
+         sf_srl##bits##_##isa(sf_and_##isa((b), (hi)), 1)), \
+         sf_and_##isa(sf_and_##isa((a), (b)), (lo)))
+
+#define SF_INTERPOLATE2(isa, bits, a, b, c, d, hi, lo) \
+   sf_add##bits##_##isa(sf_add##bits##_##isa(sf_add##bits##_##isa( \
+         sf_srl##bits##_##isa(sf_and_##isa((a), (hi)), 2), \
+         sf_srl##bits##_##isa(sf_and_##isa((b), (hi)), 2)), \
+         sf_add##bits##_##isa( \
+         sf_srl##bits##_##isa(sf_and_##isa((c), (hi)), 2), \
+         sf_srl##bits##_##isa(sf_and_##isa((d), (hi)), 2))), \
+         sf_and_##isa(sf_srl##bits##_##isa( \
+         sf_add##bits##_##isa(sf_add##bits##_##isa( \
+         sf_and_##isa((a), (lo)), sf_and_##isa((b), (lo))), \
+         sf_add##bits##_##isa( \
+         sf_and_##isa((c), (lo)), sf_and_##isa((d), (lo)))), 2), (lo)))
+
+#endif
@@ -17,6 +17,7 @@
 /* Compile: gcc -o supertwoxsai.so -shared supertwoxsai.c -std=c99 -O3 -Wall -pedantic -fPIC */
 
 #include "softfilter.h"
+#include "softfilter_simd.h"
 #include <stdlib.h>
 
 #ifdef RARCH_INTERNAL
@@ -36,6 +37,7 @@ struct softfilter_thread_data
    unsigned colfmt;
    unsigned width;
    unsigned height;
+   unsigned frame_height;
    int first;
    int last;
 };
@@ -45,6 +47,7 @@ struct filter_data
    unsigned threads;
    struct softfilter_thread_data *workers;
    unsigned in_fmt;
+   enum softfilter_isa isa;
 };
 
 static unsigned supertwoxsai_generic_input_fmts(void)
@@ -77,10 +80,9 @@ static void *supertwoxsai_generic_create(const struct softfilter_config *config,
       free(filt);
       return NULL;
    }
-   /* Apparently the code is not thread-safe,
-    * so force single threaded operation... */
-   filt->threads = 1;
+   filt->threads = threads;
    filt->in_fmt  = in_fmt;
+   filt->isa     = softfilter_simd_isa(simd);
 
    return filt;
 }
@@ -114,24 +116,24 @@ static void supertwoxsai_generic_destroy(void *data)
 #define supertwoxsai_result(A, B, C, D) (((A) != (C) || (A) != (D)) - ((B) != (C) || (B) != (D)))
 
 #ifndef supertwoxsai_declare_variables
-#define supertwoxsai_declare_variables(typename_t, in, nextline) \
+#define supertwoxsai_declare_variables(typename_t, r0, r1, r2, r3, x0, x1, x2, x3) \
          typename_t product1a, product1b, product2a, product2b; \
-         const typename_t colorB0 = *(in - nextline - 1); \
-         const typename_t colorB1 = *(in - nextline + 0); \
-         const typename_t colorB2 = *(in - nextline + 1); \
-         const typename_t colorB3 = *(in - nextline + 2); \
-         const typename_t color4  = *(in - 1); \
-         const typename_t color5  = *(in + 0); \
-         const typename_t color6  = *(in + 1); \
-         const typename_t colorS2 = *(in + 2); \
-         const typename_t color1  = *(in + nextline - 1); \
-         const typename_t color2  = *(in + nextline + 0); \
-         const typename_t color3  = *(in + nextline + 1); \
-         const typename_t colorS1 = *(in + nextline + 2); \
-         const typename_t colorA0 = *(in + nextline + nextline - 1); \
-         const typename_t colorA1 = *(in + nextline + nextline + 0); \
-         const typename_t colorA2 = *(in + nextline + nextline + 1); \
-         const typename_t colorA3 = *(in + nextline + nextline + 2)
+         const typename_t colorB0 = r0[x0]; \
+         const typename_t colorB1 = r0[x1]; \
+         const typename_t colorB2 = r0[x2]; \
+         const typename_t colorB3 = r0[x3]; \
+         const typename_t color4  = r1[x0]; \
+         const typename_t color5  = r1[x1]; \
+         const typename_t color6  = r1[x2]; \
+         const typename_t colorS2 = r1[x3]; \
+         const typename_t color1  = r2[x0]; \
+         const typename_t color2  = r2[x1]; \
+         const typename_t color3  = r2[x2]; \
+         const typename_t colorS1 = r2[x3]; \
+         const typename_t colorA0 = r3[x0]; \
+         const typename_t colorA1 = r3[x1]; \
+         const typename_t colorA2 = r3[x2]; \
+         const typename_t colorA3 = r3[x3]
 #endif
 
 #ifndef supertwoxsai_function
@@ -193,66 +195,213 @@ static void supertwoxsai_generic_destroy(void *data)
          out[1] = product1b; \
          out[dst_stride] = product2a; \
          out[dst_stride + 1] = product2b; \
-         ++in; \
          out += 2
 #endif
 
-static void supertwoxsai_generic_xrgb8888(unsigned width, unsigned height,
-      int first, int last, uint32_t *src,
+/* Vector form of supertwoxsai_function, see 2xsai.c for how
+ * the 'result' sum is computed from comparison masks */
+#define supertwoxsai_simd_result(isa, bits, a, b, c, d) \
+   sf_sub##bits##_##isa( \
+         sf_and_##isa(sf_eq##bits##_##isa(a, c), sf_eq##bits##_##isa(a, d)), \
+         sf_and_##isa(sf_eq##bits##_##isa(b, c), sf_eq##bits##_##isa(b, d)))
+
+/* a == b && c == d && e != f && g != h */
+#define supertwoxsai_simd_test(isa, bits, a, b, c, d, e, f, g, h) \
+   sf_andn_##isa(sf_andn_##isa( \
+         sf_and_##isa(sf_eq##bits##_##isa(a, b), sf_eq##bits##_##isa(c, d)), \
+         sf_eq##bits##_##isa(e, f)), sf_eq##bits##_##isa(g, h))
+
+#define supertwoxsai_simd_span(isa, fmt, bits, typename_t, hi, lo, hi2, lo2) \
+static SF_TARGET_##isa unsigned supertwoxsai_##fmt##_##isa( \
+      typename_t *out0, typename_t *out1, const typename_t *r0, \
+      const typename_t *r1, const typename_t *r2, const typename_t *r3, \
+      unsigned width) \
+{ \
+   unsigned x; \
+   const unsigned n  = SF_BYTES_##isa / sizeof(typename_t); \
+   const sf_v_##isa h  = sf_set##bits##_##isa(hi); \
+   const sf_v_##isa l  = sf_set##bits##_##isa(lo); \
+   const sf_v_##isa h2 = sf_set##bits##_##isa(hi2); \
+   const sf_v_##isa l2 = sf_set##bits##_##isa(lo2); \
+   for (x = 1; x + n + 1 < width; x += n) \
+   { \
+      sf_v_##isa cB0 = sf_load_##isa(r0 + x - 1); \
+      sf_v_##isa cB1 = sf_load_##isa(r0 + x); \
+      sf_v_##isa cB2 = sf_load_##isa(r0 + x + 1); \
+      sf_v_##isa cB3 = sf_load_##isa(r0 + x + 2); \
+      sf_v_##isa c4  = sf_load_##isa(r1 + x - 1); \
+      sf_v_##isa c5  = sf_load_##isa(r1 + x); \
+      sf_v_##isa c6  = sf_load_##isa(r1 + x + 1); \
+      sf_v_##isa cS2 = sf_load_##isa(r1 + x + 2); \
+      sf_v_##isa c1  = sf_load_##isa(r2 + x - 1); \
+      sf_v_##isa c2  = sf_load_##isa(r2 + x); \
+      sf_v_##isa c3  = sf_load_##isa(r2 + x + 1); \
+      sf_v_##isa cS1 = sf_load_##isa(r2 + x + 2); \
+      sf_v_##isa cA0 = sf_load_##isa(r3 + x - 1); \
+      sf_v_##isa cA1 = sf_load_##isa(r3 + x); \
+      sf_v_##isa cA2 = sf_load_##isa(r3 + x + 1); \
+      sf_v_##isa cA3 = sf_load_##isa(r3 + x + 2); \
+      sf_v_##isa e26 = sf_eq##bits##_##isa(c2, c6); \
+      sf_v_##isa e53 = sf_eq##bits##_##isa(c5, c3); \
+      sf_v_##isa k1  = sf_andn_##isa(e26, e53); \
+      sf_v_##isa k2  = sf_andn_##isa(e53, e26); \
+      sf_v_##isa k3  = sf_and_##isa(e26, e53); \
+      sf_v_##isa I25 = SF_INTERPOLATE(isa, bits, c2, c5, h, l); \
+      sf_v_##isa I23 = SF_INTERPOLATE(isa, bits, c2, c3, h, l); \
+      sf_v_##isa I56 = SF_INTERPOLATE(isa, bits, c5, c6, h, l); \
+      sf_v_##isa r   = sf_add##bits##_##isa(sf_add##bits##_##isa( \
+               supertwoxsai_simd_result(isa, bits, c6, c5, c1, cA1), \
+               supertwoxsai_simd_result(isa, bits, c6, c5, c4, cB1)), \
+            sf_add##bits##_##isa( \
+               supertwoxsai_simd_result(isa, bits, c6, c5, cA2, cS1), \
+               supertwoxsai_simd_result(isa, bits, c6, c5, cB2, cS2))); \
+      sf_v_##isa b3  = sf_sel_##isa(sf_gt##bits##_##isa(r, sf_zero_##isa()), \
+            c6, sf_sel_##isa(sf_gt##bits##_##isa(sf_zero_##isa(), r), \
+               c5, I56)); \
+      sf_v_##isa p2b = sf_sel_##isa(k1, c2, sf_sel_##isa(k2, c5, \
+               sf_sel_##isa(k3, b3, sf_sel_##isa( \
+                  supertwoxsai_simd_test(isa, bits, \
+                     c6, c3, c3, cA1, c2, cA2, c3, cA0), \
+                  SF_INTERPOLATE2(isa, bits, c3, c3, c3, c2, h2, l2), \
+                  sf_sel_##isa(supertwoxsai_simd_test(isa, bits, \
+                        c5, c2, c2, cA2, cA1, c3, c2, cA3), \
+                     SF_INTERPOLATE2(isa, bits, c2, c2, c2, c3, h2, l2), \
+                     I23))))); \
+      sf_v_##isa p1b = sf_sel_##isa(k1, c2, sf_sel_##isa(k2, c5, \
+               sf_sel_##isa(k3, b3, sf_sel_##isa( \
+                  supertwoxsai_simd_test(isa, bits, \
+                     c6, c3, c6, cB1, c5, cB2, c6, cB0), \
+                  SF_INTERPOLATE2(isa, bits, c6, c6, c6, c5, h2, l2), \
+                  sf_sel_##isa(supertwoxsai_simd_test(isa, bits, \
+                        c5, c2, c5, cB2, cB1, c6, c5, cB3), \
+                     SF_INTERPOLATE2(isa, bits, c6, c5, c5, c5, h2, l2), \
+                     I56))))); \
+      sf_v_##isa p2a = sf_sel_##isa(sf_or_##isa( \
+               sf_andn_##isa(sf_and_##isa(k2, sf_eq##bits##_##isa(c4, c5)), \
+                  sf_eq##bits##_##isa(c5, cA2)), \
+               supertwoxsai_simd_test(isa, bits, \
+                  c5, c1, c6, c5, c4, c2, c5, cA0)), I25, c2); \
+      sf_v_##isa p1a = sf_sel_##isa(sf_or_##isa( \
+               sf_andn_##isa(sf_and_##isa(k1, sf_eq##bits##_##isa(c1, c2)), \
+                  sf_eq##bits##_##isa(c2, cB2)), \
+               supertwoxsai_simd_test(isa, bits, \
+                  c4, c2, c3, c2, c1, c5, c2, cB0)), I25, c5); \
+      sf_store_##isa(out0 + 2 * x,     sf_ziplo##bits##_##isa(p1a, p1b)); \
+      sf_store_##isa(out0 + 2 * x + n, sf_ziphi##bits##_##isa(p1a, p1b)); \
+      sf_store_##isa(out1 + 2 * x,     sf_ziplo##bits##_##isa(p2a, p2b)); \
+      sf_store_##isa(out1 + 2 * x + n, sf_ziphi##bits##_##isa(p2a, p2b)); \
+   } \
+   return x; \
+}
+
+/* Vector kernels process pixels [1, n) of a row, where n is
+ * the return value, leaving the edge pixels to the scalar code */
+typedef unsigned (*supertwoxsai_span_rgb565_t)(uint16_t *out0, uint16_t *out1,
+      const uint16_t *r0, const uint16_t *r1, const uint16_t *r2,
+      const uint16_t *r3, unsigned width);
+typedef unsigned (*supertwoxsai_span_xrgb8888_t)(uint32_t *out0, uint32_t *out1,
+      const uint32_t *r0, const uint32_t *r1, const uint32_t *r2,
+      const uint32_t *r3, unsigned width);
+
+#ifdef SOFTFILTER_HAVE_SSE2
+supertwoxsai_simd_span(sse2, rgb565, 16, uint16_t, 0xF7DE, 0x0821, 0xE79C, 0x1863)
+supertwoxsai_simd_span(sse2, xrgb8888, 32, uint32_t,
+      0xFEFEFEFE, 0x01010101, 0xFCFCFCFC, 0x03030303)
+#endif
+#ifdef SOFTFILTER_HAVE_AVX2
+supertwoxsai_simd_span(avx2, rgb565, 16, uint16_t, 0xF7DE, 0x0821, 0xE79C, 0x1863)
+supertwoxsai_simd_span(avx2, xrgb8888, 32, uint32_t,
+      0xFEFEFEFE, 0x01010101, 0xFCFCFCFC, 0x03030303)
+#endif
+#ifdef SOFTFILTER_HAVE_NEON
+supertwoxsai_simd_span(neon, rgb565, 16, uint16_t, 0xF7DE, 0x0821, 0xE79C, 0x1863)
+supertwoxsai_simd_span(neon, xrgb8888, 32, uint32_t,
+      0xFEFEFEFE, 0x01010101, 0xFCFCFCFC, 0x03030303)
+#endif
+
+/* Pixels outside the frame are replaced by the nearest edge
+ * pixel. Rows above and below the slice belong to other
+ * threads, but are only read. */
+#define supertwoxsai_span(typename_t, x, end, interpolate_cb, interpolate2_cb) \
+   for (; x < end; x++) \
+   { \
+      unsigned x0 = (x > 0) ? x - 1 : x; \
+      unsigned x2 = (x + 1 < width) ? x + 1 : x; \
+      unsigned x3 = (x + 2 < width) ? x + 2 : x2; \
+      typename_t *out = out0 + 2 * x; \
+      supertwoxsai_declare_variables(typename_t, r0, r1, r2, r3, x0, x, x2, x3); \
+      supertwoxsai_function(supertwoxsai_result, interpolate_cb, interpolate2_cb); \
+   }
+
+#define supertwoxsai_rows(typename_t) \
+   const typename_t *r1 = src; \
+   const typename_t *r0 = (first + y > 0) ? r1 - src_stride : r1; \
+   const typename_t *r2 = (first + y + 1 < frame_height) \
+      ? r1 + src_stride : r1; \
+   const typename_t *r3 = (first + y + 2 < frame_height) \
+      ? r2 + src_stride : r2; \
+   typename_t *out0     = dst; \
+   typename_t *out1     = dst + dst_stride
+
+static void supertwoxsai_generic_xrgb8888(enum softfilter_isa isa,
+      unsigned width, unsigned height,
+      unsigned first, unsigned frame_height, uint32_t *src,
       unsigned src_stride, uint32_t *dst, unsigned dst_stride)
 {
-   unsigned finish;
-   unsigned nextline = (last) ? 0 : src_stride;
+   unsigned x, y;
+   supertwoxsai_span_xrgb8888_t span;
 
-   for (; height; height--)
-   {
-      uint32_t *in  = (uint32_t*)src;
-      uint32_t *out = (uint32_t*)dst;
+   SOFTFILTER_SIMD_KERNEL(span, isa, supertwoxsai_xrgb8888);
 
-      for (finish = width; finish; finish -= 1)
-      {
-         supertwoxsai_declare_variables(uint32_t, in, nextline);
+   for (y = 0; y < height; y++)
+   {
+      supertwoxsai_rows(uint32_t);
 
-         /*---------------------------    B1 B2
-          *                             4  5  6 S2
-          *                             1  2  3 S1
-          *                               A1 A2
-          *--------------------------------------
-          */
+      /*---------------------------    B1 B2
+       *                             4  5  6 S2
+       *                             1  2  3 S1
+       *                               A1 A2
+       *--------------------------------------
+       */
 
-         supertwoxsai_function(supertwoxsai_result, supertwoxsai_interpolate_xrgb8888, supertwoxsai_interpolate2_xrgb8888);
+      x = 0;
+      if (span && width > 1)
+      {
+         supertwoxsai_span(uint32_t, x, 1, supertwoxsai_interpolate_xrgb8888,
+               supertwoxsai_interpolate2_xrgb8888);
+         x = span(out0, out1, r0, r1, r2, r3, width);
       }
+      supertwoxsai_span(uint32_t, x, width, supertwoxsai_interpolate_xrgb8888,
+            supertwoxsai_interpolate2_xrgb8888);
 
       src += src_stride;
       dst += 2 * dst_stride;
    }
 }
 
-static void supertwoxsai_generic_rgb565(unsigned width, unsigned height,
-      int first, int last, uint16_t *src,
+static void supertwoxsai_generic_rgb565(enum softfilter_isa isa,
+      unsigned width, unsigned height,
+      unsigned first, unsigned frame_height, uint16_t *src,
       unsigned src_stride, uint16_t *dst, unsigned dst_stride)
 {
-   unsigned finish;
-   unsigned nextline = (last) ? 0 : src_stride;
+   unsigned x, y;
+   supertwoxsai_span_rgb565_t span;
 
-   for (; height; height--)
+   SOFTFILTER_SIMD_KERNEL(span, isa, supertwoxsai_rgb565);
+
+   for (y = 0; y < height; y++)
    {
-      uint16_t *in  = (uint16_t*)src;
-      uint16_t *out = (uint16_t*)dst;
+      supertwoxsai_rows(uint16_t);
 
-      for (finish = width; finish; finish -= 1)
+      x = 0;
+      if (span && width > 1)
       {
-         supertwoxsai_declare_variables(uint16_t, in, nextline);
-
-         /*---------------------------    B1 B2
-          *                             4  5  6 S2
-          *                             1  2  3 S1
-          *                               A1 A2
-          *--------------------------------------
-          */
-
-         supertwoxsai_function(supertwoxsai_result, supertwoxsai_interpolate_rgb565, supertwoxsai_interpolate2_rgb565);
+         supertwoxsai_span(uint16_t, x, 1, supertwoxsai_interpolate_rgb565,
+               supertwoxsai_interpolate2_rgb565);
+         x = span(out0, out1, r0, r1, r2, r3, width);
       }
+      supertwoxsai_span(uint16_t, x, width, supertwoxsai_interpolate_rgb565,
+            supertwoxsai_interpolate2_rgb565);
 
       src += src_stride;
       dst += 2 * dst_stride;
@@ -261,13 +410,14 @@ static void supertwoxsai_generic_rgb565(unsigned width, unsigned height,
 
 static void supertwoxsai_work_cb_rgb565(void *data, void *thread_data)
 {
+   struct filter_data *filt           = (struct filter_data*)data;
    struct softfilter_thread_data *thr = (struct softfilter_thread_data*)thread_data;
    uint16_t *input                    = (uint16_t*)thr->in_data;
    uint16_t *output                   = (uint16_t*)thr->out_data;
    unsigned width                     = thr->width;
    unsigned height                    = thr->height;
-   supertwoxsai_generic_rgb565(width, height,
-         thr->first, thr->last, input,
+   supertwoxsai_generic_rgb565(filt->isa, width, height,
+         thr->first, thr->frame_height, input,
         (unsigned)(thr->in_pitch / SOFTFILTER_BPP_RGB565),
         output,
         (unsigned)(thr->out_pitch / SOFTFILTER_BPP_RGB565));
@@ -275,13 +425,14 @@ static void supertwoxsai_work_cb_rgb565(void *data, void *thread_data)
 
 static void supertwoxsai_work_cb_xrgb8888(void *data, void *thread_data)
 {
+   struct filter_data *filt           = (struct filter_data*)data;
    struct softfilter_thread_data *thr = (struct softfilter_thread_data*)thread_data;
    uint32_t *input                    = (uint32_t*)thr->in_data;
    uint32_t *output                   = (uint32_t*)thr->out_data;
    unsigned width                     = thr->width;
    unsigned height                    = thr->height;
-   supertwoxsai_generic_xrgb8888(width, height,
-         thr->first, thr->last, input,
+   supertwoxsai_generic_xrgb8888(filt->isa, width, height,
+         thr->first, thr->frame_height, input,
 	 (unsigned)(thr->in_pitch / SOFTFILTER_BPP_XRGB8888),
 	 output,
 	 (unsigned)(thr->out_pitch / SOFTFILTER_BPP_XRGB8888));
@@ -312,6 +463,7 @@ static void supertwoxsai_generic_packets(void *data,
        * outside their given buffer. */
       thr->first             = y_start;
       thr->last              = y_end == height;
+      thr->frame_height      = height;
 
       if (filt->in_fmt == SOFTFILTER_FMT_RGB565)
          packets[i].work     = supertwoxsai_work_cb_rgb565;
@@ -17,6 +17,7 @@
 /* Compile: gcc -o supereagle.so -shared supereagle.c -std=c99 -O3 -Wall -pedantic -fPIC */
 
 #include "softfilter.h"
+#include "softfilter_simd.h"
 #include <stdlib.h>
 
 #ifdef RARCH_INTERNAL
@@ -36,6 +37,7 @@ struct softfilter_thread_data
    unsigned colfmt;
    unsigned width;
    unsigned height;
+   unsigned frame_height;
    int first;
    int last;
 };
@@ -45,6 +47,7 @@ struct filter_data
    unsigned threads;
    struct softfilter_thread_data *workers;
    unsigned in_fmt;
+   enum softfilter_isa isa;
 };
 
 static unsigned supereagle_generic_input_fmts(void)
@@ -76,8 +79,9 @@ static void *supereagle_generic_create(const struct softfilter_config *config,
       free(filt);
       return NULL;
    }
-   filt->threads = 1;
+   filt->threads = threads;
    filt->in_fmt  = in_fmt;
+   filt->isa     = softfilter_simd_isa(simd);
    return filt;
 }
 
@@ -109,20 +113,20 @@ static void supereagle_generic_destroy(void *data)
 
 #define supereagle_result(A, B, C, D) (((A) != (C) || (A) != (D)) - ((B) != (C) || (B) != (D)));
 
-#define supereagle_declare_variables(typename_t, in, nextline) \
+#define supereagle_declare_variables(typename_t, r0, r1, r2, r3, x0, x1, x2, x3) \
          typename_t product1a, product1b, product2a, product2b; \
-         const typename_t colorB1 = *(in - nextline + 0); \
-         const typename_t colorB2 = *(in - nextline + 1); \
-         const typename_t color4  = *(in - 1); \
-         const typename_t color5  = *(in + 0); \
-         const typename_t color6  = *(in + 1); \
-         const typename_t colorS2 = *(in + 2); \
-         const typename_t color1  = *(in + nextline - 1); \
-         const typename_t color2  = *(in + nextline + 0); \
-         const typename_t color3  = *(in + nextline + 1); \
-         const typename_t colorS1 = *(in + nextline + 2); \
-         const typename_t colorA1 = *(in + nextline + nextline + 0); \
-         const typename_t colorA2 = *(in + nextline + nextline + 1)
+         const typename_t colorB1 = r0[x1]; \
+         const typename_t colorB2 = r0[x2]; \
+         const typename_t color4  = r1[x0]; \
+         const typename_t color5  = r1[x1]; \
+         const typename_t color6  = r1[x2]; \
+         const typename_t colorS2 = r1[x3]; \
+         const typename_t color1  = r2[x0]; \
+         const typename_t color2  = r2[x1]; \
+         const typename_t color3  = r2[x2]; \
+         const typename_t colorS1 = r2[x3]; \
+         const typename_t colorA1 = r3[x1]; \
+         const typename_t colorA2 = r3[x2]
 
 #ifndef supereagle_function
 #define supereagle_function(result_cb, interpolate_cb, interpolate2_cb) \
@@ -206,50 +210,195 @@ static void supereagle_generic_destroy(void *data)
          out[1] = product1b; \
          out[dst_stride] = product2a; \
          out[dst_stride + 1] = product2b; \
-         ++in; \
          out += 2
 #endif
 
-static void supereagle_generic_xrgb8888(unsigned width, unsigned height,
-      int first, int last, uint32_t *src,
+/* Vector form of supereagle_function, see 2xsai.c for how
+ * the 'result' sum is computed from comparison masks */
+#define supereagle_simd_result(isa, bits, a, b, c, d) \
+   sf_sub##bits##_##isa( \
+         sf_and_##isa(sf_eq##bits##_##isa(a, c), sf_eq##bits##_##isa(a, d)), \
+         sf_and_##isa(sf_eq##bits##_##isa(b, c), sf_eq##bits##_##isa(b, d)))
+
+#define supereagle_simd_span(isa, fmt, bits, typename_t, hi, lo, hi2, lo2) \
+static SF_TARGET_##isa unsigned supereagle_##fmt##_##isa( \
+      typename_t *out0, typename_t *out1, const typename_t *r0, \
+      const typename_t *r1, const typename_t *r2, const typename_t *r3, \
+      unsigned width) \
+{ \
+   unsigned x; \
+   const unsigned n  = SF_BYTES_##isa / sizeof(typename_t); \
+   const sf_v_##isa h  = sf_set##bits##_##isa(hi); \
+   const sf_v_##isa l  = sf_set##bits##_##isa(lo); \
+   const sf_v_##isa h2 = sf_set##bits##_##isa(hi2); \
+   const sf_v_##isa l2 = sf_set##bits##_##isa(lo2); \
+   for (x = 1; x + n + 1 < width; x += n) \
+   { \
+      sf_v_##isa cB1 = sf_load_##isa(r0 + x); \
+      sf_v_##isa cB2 = sf_load_##isa(r0 + x + 1); \
+      sf_v_##isa c4  = sf_load_##isa(r1 + x - 1); \
+      sf_v_##isa c5  = sf_load_##isa(r1 + x); \
+      sf_v_##isa c6  = sf_load_##isa(r1 + x + 1); \
+      sf_v_##isa cS2 = sf_load_##isa(r1 + x + 2); \
+      sf_v_##isa c1  = sf_load_##isa(r2 + x - 1); \
+      sf_v_##isa c2  = sf_load_##isa(r2 + x); \
+      sf_v_##isa c3  = sf_load_##isa(r2 + x + 1); \
+      sf_v_##isa cS1 = sf_load_##isa(r2 + x + 2); \
+      sf_v_##isa cA1 = sf_load_##isa(r3 + x); \
+      sf_v_##isa cA2 = sf_load_##isa(r3 + x + 1); \
+      sf_v_##isa e26 = sf_eq##bits##_##isa(c2, c6); \
+      sf_v_##isa e53 = sf_eq##bits##_##isa(c5, c3); \
+      sf_v_##isa k1  = sf_andn_##isa(e26, e53); \
+      sf_v_##isa k2  = sf_andn_##isa(e53, e26); \
+      sf_v_##isa k3  = sf_and_##isa(e26, e53); \
+      sf_v_##isa I25 = SF_INTERPOLATE(isa, bits, c2, c5, h, l); \
+      sf_v_##isa I23 = SF_INTERPOLATE(isa, bits, c2, c3, h, l); \
+      sf_v_##isa I56 = SF_INTERPOLATE(isa, bits, c5, c6, h, l); \
+      sf_v_##isa I26 = SF_INTERPOLATE(isa, bits, c2, c6, h, l); \
+      sf_v_##isa I53 = SF_INTERPOLATE(isa, bits, c5, c3, h, l); \
+      sf_v_##isa r   = sf_add##bits##_##isa(sf_add##bits##_##isa( \
+               supereagle_simd_result(isa, bits, c6, c5, c1, cA1), \
+               supereagle_simd_result(isa, bits, c6, c5, c4, cB1)), \
+            sf_add##bits##_##isa( \
+               supereagle_simd_result(isa, bits, c6, c5, cA2, cS1), \
+               supereagle_simd_result(isa, bits, c6, c5, cB2, cS2))); \
+      sf_v_##isa rp  = sf_gt##bits##_##isa(r, sf_zero_##isa()); \
+      sf_v_##isa rn  = sf_gt##bits##_##isa(sf_zero_##isa(), r); \
+      sf_v_##isa p1a = sf_sel_##isa(k1, sf_sel_##isa( \
+               sf_or_##isa(sf_eq##bits##_##isa(c1, c2), \
+                  sf_eq##bits##_##isa(c6, cB2)), \
+               SF_INTERPOLATE(isa, bits, c2, I25, h, l), I56), \
+            sf_sel_##isa(k2, c5, sf_sel_##isa(k3, \
+               sf_sel_##isa(rp, I56, c5), \
+               SF_INTERPOLATE2(isa, bits, c5, c5, c5, I26, h2, l2)))); \
+      sf_v_##isa p1b = sf_sel_##isa(k1, c2, sf_sel_##isa(k2, sf_sel_##isa( \
+               sf_or_##isa(sf_eq##bits##_##isa(cB1, c5), \
+                  sf_eq##bits##_##isa(c3, cS1)), \
+               SF_INTERPOLATE(isa, bits, c5, I56, h, l), I56), \
+            sf_sel_##isa(k3, sf_sel_##isa(rn, I56, c2), \
+               SF_INTERPOLATE2(isa, bits, c6, c6, c6, I53, h2, l2)))); \
+      sf_v_##isa p2a = sf_sel_##isa(k1, c2, sf_sel_##isa(k2, sf_sel_##isa( \
+               sf_or_##isa(sf_eq##bits##_##isa(c3, cA2), \
+                  sf_eq##bits##_##isa(c4, c5)), \
+               SF_INTERPOLATE(isa, bits, c5, I25, h, l), I23), \
+            sf_sel_##isa(k3, sf_sel_##isa(rn, I56, c2), \
+               SF_INTERPOLATE2(isa, bits, c2, c2, c2, I53, h2, l2)))); \
+      sf_v_##isa p2b = sf_sel_##isa(k1, sf_sel_##isa( \
+               sf_or_##isa(sf_eq##bits##_##isa(c6, cS2), \
+                  sf_eq##bits##_##isa(c2, cA1)), \
+               SF_INTERPOLATE(isa, bits, c2, I23, h, l), I23), \
+            sf_sel_##isa(k2, c5, sf_sel_##isa(k3, \
+               sf_sel_##isa(rp, I56, c5), \
+               SF_INTERPOLATE2(isa, bits, c3, c3, c3, I26, h2, l2)))); \
+      sf_store_##isa(out0 + 2 * x,     sf_ziplo##bits##_##isa(p1a, p1b)); \
+      sf_store_##isa(out0 + 2 * x + n, sf_ziphi##bits##_##isa(p1a, p1b)); \
+      sf_store_##isa(out1 + 2 * x,     sf_ziplo##bits##_##isa(p2a, p2b)); \
+      sf_store_##isa(out1 + 2 * x + n, sf_ziphi##bits##_##isa(p2a, p2b)); \
+   } \
+   return x; \
+}
+
+/* Vector kernels process pixels [1, n) of a row, where n is
+ * the return value, leaving the edge pixels to the scalar code */
+typedef unsigned (*supereagle_span_rgb565_t)(uint16_t *out0, uint16_t *out1,
+      const uint16_t *r0, const uint16_t *r1, const uint16_t *r2,
+      const uint16_t *r3, unsigned width);
+typedef unsigned (*supereagle_span_xrgb8888_t)(uint32_t *out0, uint32_t *out1,
+      const uint32_t *r0, const uint32_t *r1, const uint32_t *r2,
+      const uint32_t *r3, unsigned width);
+
+#ifdef SOFTFILTER_HAVE_SSE2
+supereagle_simd_span(sse2, rgb565, 16, uint16_t, 0xF7DE, 0x0821, 0xE79C, 0x1863)
+supereagle_simd_span(sse2, xrgb8888, 32, uint32_t,
+      0xFEFEFEFE, 0x01010101, 0xFCFCFCFC, 0x03030303)
+#endif
+#ifdef SOFTFILTER_HAVE_AVX2
+supereagle_simd_span(avx2, rgb565, 16, uint16_t, 0xF7DE, 0x0821, 0xE79C, 0x1863)
+supereagle_simd_span(avx2, xrgb8888, 32, uint32_t,
+      0xFEFEFEFE, 0x01010101, 0xFCFCFCFC, 0x03030303)
+#endif
+#ifdef SOFTFILTER_HAVE_NEON
+supereagle_simd_span(neon, rgb565, 16, uint16_t, 0xF7DE, 0x0821, 0xE79C, 0x1863)
+supereagle_simd_span(neon, xrgb8888, 32, uint32_t,
+      0xFEFEFEFE, 0x01010101, 0xFCFCFCFC, 0x03030303)
+#endif
+
+/* Pixels outside the frame are replaced by the nearest edge
+ * pixel. Rows above and below the slice belong to other
+ * threads, but are only read. */
+#define supereagle_span(typename_t, x, end, interpolate_cb, interpolate2_cb) \
+   for (; x < end; x++) \
+   { \
+      unsigned x0 = (x > 0) ? x - 1 : x; \
+      unsigned x2 = (x + 1 < width) ? x + 1 : x; \
+      unsigned x3 = (x + 2 < width) ? x + 2 : x2; \
+      typename_t *out = out0 + 2 * x; \
+      supereagle_declare_variables(typename_t, r0, r1, r2, r3, x0, x, x2, x3); \
+      supereagle_function(supereagle_result, interpolate_cb, interpolate2_cb); \
+   }
+
+#define supereagle_rows(typename_t) \
+   const typename_t *r1 = src; \
+   const typename_t *r0 = (first + y > 0) ? r1 - src_stride : r1; \
+   const typename_t *r2 = (first + y + 1 < frame_height) \
+      ? r1 + src_stride : r1; \
+   const typename_t *r3 = (first + y + 2 < frame_height) \
+      ? r2 + src_stride : r2; \
+   typename_t *out0     = dst; \
+   typename_t *out1     = dst + dst_stride
+
+static void supereagle_generic_xrgb8888(enum softfilter_isa isa,
+      unsigned width, unsigned height,
+      unsigned first, unsigned frame_height, uint32_t *src,
       unsigned src_stride, uint32_t *dst, unsigned dst_stride)
 {
-   unsigned finish;
-   unsigned nextline = (last) ? 0 : src_stride;
+   unsigned x, y;
+   supereagle_span_xrgb8888_t span;
 
-   for (; height; height--)
+   SOFTFILTER_SIMD_KERNEL(span, isa, supereagle_xrgb8888);
+
+   for (y = 0; y < height; y++)
    {
-      uint32_t *in  = (uint32_t*)src;
-      uint32_t *out = (uint32_t*)dst;
+      supereagle_rows(uint32_t);
 
-      for (finish = width; finish; finish -= 1)
+      x = 0;
+      if (span && width > 1)
       {
-         supereagle_declare_variables(uint32_t, in, nextline);
-         supereagle_function(supereagle_result, supereagle_interpolate_xrgb8888, supereagle_interpolate2_xrgb8888);
+         supereagle_span(uint32_t, x, 1, supereagle_interpolate_xrgb8888,
+               supereagle_interpolate2_xrgb8888);
+         x = span(out0, out1, r0, r1, r2, r3, width);
       }
+      supereagle_span(uint32_t, x, width, supereagle_interpolate_xrgb8888,
+            supereagle_interpolate2_xrgb8888);
 
       src += src_stride;
       dst += 2 * dst_stride;
    }
 }
 
-static void supereagle_generic_rgb565(unsigned width, unsigned height,
-      int first, int last, uint16_t *src,
+static void supereagle_generic_rgb565(enum softfilter_isa isa,
+      unsigned width, unsigned height,
+      unsigned first, unsigned frame_height, uint16_t *src,
       unsigned src_stride, uint16_t *dst, unsigned dst_stride)
 {
-   unsigned finish;
-   unsigned nextline = (last) ? 0 : src_stride;
+   unsigned x, y;
+   supereagle_span_rgb565_t span;
+
+   SOFTFILTER_SIMD_KERNEL(span, isa, supereagle_rgb565);
 
-   for (; height; height--)
+   for (y = 0; y < height; y++)
    {
-      uint16_t *in  = (uint16_t*)src;
-      uint16_t *out = (uint16_t*)dst;
+      supereagle_rows(uint16_t);
 
-      for (finish = width; finish; finish -= 1)
+      x = 0;
+      if (span && width > 1)
       {
-         supereagle_declare_variables(uint16_t, in, nextline);
-         supereagle_function(supereagle_result, supereagle_interpolate_rgb565, supereagle_interpolate2_rgb565);
+         supereagle_span(uint16_t, x, 1, supereagle_interpolate_rgb565,
+               supereagle_interpolate2_rgb565);
+         x = span(out0, out1, r0, r1, r2, r3, width);
       }
+      supereagle_span(uint16_t, x, width, supereagle_interpolate_rgb565,
+            supereagle_interpolate2_rgb565);
 
       src += src_stride;
       dst += 2 * dst_stride;
@@ -258,14 +407,15 @@ static void supereagle_generic_rgb565(unsigned width, unsigned height,
 
 static void supereagle_work_cb_rgb565(void *data, void *thread_data)
 {
+   struct filter_data *filt           = (struct filter_data*)data;
    struct softfilter_thread_data *thr = (struct softfilter_thread_data*)thread_data;
    uint16_t *input  = (uint16_t*)thr->in_data;
    uint16_t *output = (uint16_t*)thr->out_data;
    unsigned width   = thr->width;
    unsigned height  = thr->height;
 
-   supereagle_generic_rgb565(width, height,
-         thr->first, thr->last, input,
+   supereagle_generic_rgb565(filt->isa, width, height,
+         thr->first, thr->frame_height, input,
          (unsigned)(thr->in_pitch / SOFTFILTER_BPP_RGB565),
          output,
          (unsigned)(thr->out_pitch / SOFTFILTER_BPP_RGB565));
@@ -273,14 +423,15 @@ static void supereagle_work_cb_rgb565(void *data, void *thread_data)
 
 static void supereagle_work_cb_xrgb8888(void *data, void *thread_data)
 {
+   struct filter_data *filt           = (struct filter_data*)data;
    struct softfilter_thread_data *thr = (struct softfilter_thread_data*)thread_data;
    uint32_t *input  = (uint32_t*)thr->in_data;
    uint32_t *output = (uint32_t*)thr->out_data;
    unsigned width   = thr->width;
    unsigned height  = thr->height;
 
-   supereagle_generic_xrgb8888(width, height,
-         thr->first, thr->last, input,
+   supereagle_generic_xrgb8888(filt->isa, width, height,
+         thr->first, thr->frame_height, input,
          (unsigned)(thr->in_pitch / SOFTFILTER_BPP_XRGB8888),
          output,
          (unsigned)(thr->out_pitch / SOFTFILTER_BPP_XRGB8888));
@@ -310,6 +461,7 @@ static void supereagle_generic_packets(void *data,
       /* Workers need to know if they can access pixels outside their given buffer. */
       thr->first             = y_start;
       thr->last              = y_end == height;
+      thr->frame_height      = height;
 
       if (filt->in_fmt == SOFTFILTER_FMT_RGB565)
          packets[i].work     = supereagle_work_cb_rgb565;
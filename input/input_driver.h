@@ -296,6 +296,7 @@ typedef struct input_remote_state
 typedef struct input_list_element_t
 {
    int16_t *state;
+   uint8_t *requested;
    unsigned port;
    unsigned device;
    unsigned index;
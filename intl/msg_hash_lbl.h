@@ -3430,6 +3430,18 @@ MSG_HASH(
    MENU_ENUM_LABEL_REWIND_BUFFER_SIZE_STEP,
    "rewind_buffer_size_step"
    )
+MSG_HASH(
+   MENU_ENUM_LABEL_REWIND_THREADS,
+   "rewind_threads"
+   )
+MSG_HASH(
+   MENU_ENUM_LABEL_REWIND_COMPRESS,
+   "rewind_compress"
+   )
+MSG_HASH(
+   MENU_ENUM_LABEL_REWIND_DIRTY_PAGES,
+   "rewind_dirty_pages"
+   )
 MSG_HASH(
    MENU_ENUM_LABEL_REWIND_SETTINGS,
    "rewind_settings"
@@ -3760,6 +3772,14 @@ MSG_HASH(
    MENU_ENUM_LABEL_RUN_AHEAD_SECONDARY_INSTANCE,
    "run_ahead_secondary_instance"
    )
+MSG_HASH(
+   MENU_ENUM_LABEL_RUN_AHEAD_SPECULATIONS,
+   "run_ahead_speculations"
+   )
+MSG_HASH(
+   MENU_ENUM_LABEL_RUN_AHEAD_KEEP_TIMELINE,
+   "run_ahead_keep_timeline"
+   )
 MSG_HASH(
    MENU_ENUM_LABEL_RUN_AHEAD_HIDE_WARNINGS,
    "run_ahead_hide_warnings"
@@ -3780,6 +3800,10 @@ MSG_HASH(
    MENU_ENUM_LABEL_PREEMPT_HIDE_WARNINGS,
    "preemptive_frames_hide_warnings"
    )
+MSG_HASH(
+   MENU_ENUM_LABEL_PREEMPT_ADAPTIVE,
+   "preemptive_frames_adaptive"
+   )
 MSG_HASH(
    MENU_ENUM_LABEL_PREEMPT_FRAMES,
    "preemptive_frames"
@@ -3937,6 +3961,10 @@ MSG_HASH(
    MENU_ENUM_LABEL_MENU_THUMBNAIL_UPSCALE_THRESHOLD,
    "menu_thumbnail_upscale_threshold"
    )
+MSG_HASH(
+   MENU_ENUM_LABEL_MENU_THUMBNAIL_CACHE_SIZE,
+   "menu_thumbnail_cache_size"
+   )
 MSG_HASH(
    MENU_ENUM_LABEL_MENU_RGUI_THUMBNAIL_DOWNSCALER,
    "rgui_thumbnail_downscaler"
@@ -6084,6 +6112,10 @@ MSG_HASH(
    MENU_ENUM_LABEL_PLAYLIST_COMPRESSION,
    "playlist_compression"
    )
+MSG_HASH(
+   MENU_ENUM_LABEL_PLAYLIST_BINARY_FORMAT,
+   "playlist_binary_format"
+   )
 MSG_HASH(
    MENU_ENUM_LABEL_MENU_SOUND_OK,
    "menu_sound_ok"
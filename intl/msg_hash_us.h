@@ -4438,6 +4438,22 @@ MSG_HASH(
    MENU_ENUM_SUBLABEL_RUN_AHEAD_SECONDARY_INSTANCE,
    "Use a second instance of the RetroArch core to run-ahead. Prevents audio problems due to loading state."
    )
+MSG_HASH(
+   MENU_ENUM_LABEL_VALUE_RUN_AHEAD_SPECULATIONS,
+   "Speculative Run-Ahead Instances"
+   )
+MSG_HASH(
+   MENU_ENUM_SUBLABEL_RUN_AHEAD_SPECULATIONS,
+   "Extra instances of the core that run ahead on other CPU cores, guessing the next input (all buttons released, or an earlier input). A correct guess skips loading state into the second instance. Software rendered cores only. Uses more memory and CPU."
+   )
+MSG_HASH(
+   MENU_ENUM_LABEL_VALUE_RUN_AHEAD_KEEP_TIMELINE,
+   "Keep Run-Ahead Frames Until Input Changes"
+   )
+MSG_HASH(
+   MENU_ENUM_SUBLABEL_RUN_AHEAD_KEEP_TIMELINE,
+   "Without a second instance, continue from the previous run-ahead frame instead of loading state and running all frames again. Only rolls back when input changes. Uses one save state per run-ahead frame."
+   )
 MSG_HASH(
    MENU_ENUM_LABEL_VALUE_RUN_AHEAD_HIDE_WARNINGS,
    "Hide Run-Ahead Warnings"
@@ -4470,6 +4486,14 @@ MSG_HASH(
    MENU_ENUM_SUBLABEL_PREEMPT_FRAMES,
    "The number of frames to rerun. Causes gameplay issues such as jitter if the number of lag frames internal to the game is exceeded."
    )
+MSG_HASH(
+   MENU_ENUM_LABEL_VALUE_PREEMPT_ADAPTIVE,
+   "Adaptive Preemptive Frames"
+   )
+MSG_HASH(
+   MENU_ENUM_SUBLABEL_PREEMPT_ADAPTIVE,
+   "Measure save state and core run times, and lower the number of preemptive frames when rerunning them would not fit in the frame time. The number of preemptive frames setting becomes the maximum."
+   )
 MSG_HASH(
    MENU_ENUM_LABEL_VALUE_PREEMPT_HIDE_WARNINGS,
    "Hide Preemptive Frames Warnings"
@@ -5077,6 +5101,30 @@ MSG_HASH(
    MENU_ENUM_SUBLABEL_REWIND_BUFFER_SIZE_STEP,
    "Each time the rewind buffer size value is increased or decreased, it will change by this amount."
    )
+MSG_HASH(
+   MENU_ENUM_LABEL_VALUE_REWIND_THREADS,
+   "Rewind Threads"
+   )
+MSG_HASH(
+   MENU_ENUM_SUBLABEL_REWIND_THREADS,
+   "Number of threads used to compare savestates for the rewind buffer. Speeds up rewind for cores with large savestates. Takes effect when rewind is next enabled."
+   )
+MSG_HASH(
+   MENU_ENUM_LABEL_VALUE_REWIND_COMPRESS,
+   "Compress Rewind History"
+   )
+MSG_HASH(
+   MENU_ENUM_SUBLABEL_REWIND_COMPRESS,
+   "Keep only recent rewind history uncompressed and compress older history. Allows rewinding much further back with the same buffer size. Takes effect when rewind is next enabled."
+   )
+MSG_HASH(
+   MENU_ENUM_LABEL_VALUE_REWIND_DIRTY_PAGES,
+   "Only Compare Changed Savestate Pages"
+   )
+MSG_HASH(
+   MENU_ENUM_SUBLABEL_REWIND_DIRTY_PAGES,
+   "Fingerprint savestates in 4 KB pages and only compare the pages that changed since the last rewind step. Speeds up rewind for cores with large savestates that change little per frame. Takes effect when rewind is next enabled."
+   )
 
 /* Settings > Frame Throttle > Frame Time Counter */
 
@@ -7035,6 +7083,14 @@ MSG_HASH(
    MENU_ENUM_SUBLABEL_MENU_THUMBNAIL_UPSCALE_THRESHOLD,
    "Automatically upscale thumbnail images with a width/height smaller than the specified value. Improves picture quality. Has a moderate performance impact."
    )
+MSG_HASH(
+   MENU_ENUM_LABEL_VALUE_MENU_THUMBNAIL_CACHE_SIZE,
+   "Thumbnail Cache Size"
+   )
+MSG_HASH(
+   MENU_ENUM_SUBLABEL_MENU_THUMBNAIL_CACHE_SIZE,
+   "Keep decoded thumbnails, reduced to the size the menu shows them at, in the cache directory so they can be shown again without decoding. Sets the maximum disk space used, in MB. 0 disables the cache. Requires a cache directory to be set."
+   )
 MSG_HASH(
    MENU_ENUM_LABEL_VALUE_MENU_TICKER_TYPE,
    "Ticker Text Animation"
@@ -7777,6 +7833,14 @@ MSG_HASH(
    MENU_ENUM_SUBLABEL_PLAYLIST_COMPRESSION,
    "Archive playlist data when writing to disk. Reduces file size and loading times at the expense of (negligibly) increased CPU usage. May be used with either old or new format playlists."
    )
+MSG_HASH(
+   MENU_ENUM_LABEL_VALUE_PLAYLIST_BINARY_FORMAT,
+   "Binary Playlist Format"
+   )
+MSG_HASH(
+   MENU_ENUM_SUBLABEL_PLAYLIST_BINARY_FORMAT,
+   "Save playlists in an indexed binary format. Playlists open without parsing, and small changes (adding, removing or renaming entries) are appended instead of rewriting the whole file. Disabling converts playlists back to JSON. Ignored when 'Save Playlists Using Old Format' is enabled."
+   )
 MSG_HASH(
    MENU_ENUM_LABEL_VALUE_PLAYLIST_SHOW_INLINE_CORE_NAME,
    "Show Associated Cores in Playlists"
@@ -98,6 +98,21 @@ int32_t path_get_size(const char *path)
    return -1;
 }
 
+/**
+ * path_get_mtime:
+ * @path               : path
+ *
+ * @return last modification time of @path in seconds,
+ * or 0 if it could not be determined.
+ */
+int64_t path_get_mtime(const char *path)
+{
+   struct stat buf;
+   if (!path || !*path || stat(path, &buf) != 0)
+      return 0;
+   return (int64_t)buf.st_mtime;
+}
+
 /**
  * path_mkdir:
  * @dir                : directory
@@ -196,7 +196,8 @@ static bool image_texture_load_internal(
       size_t len,
       struct texture_image *out_img,
       unsigned a_shift, unsigned r_shift,
-      unsigned g_shift, unsigned b_shift)
+      unsigned g_shift, unsigned b_shift,
+      unsigned max_width, unsigned max_height)
 {
    int ret;
    bool success = false;
@@ -206,6 +207,7 @@ static bool image_texture_load_internal(
       goto end;
 
    image_transfer_set_buffer_ptr(img, type, (uint8_t*)ptr, len);
+   image_transfer_set_target_size(img, type, max_width, max_height);
 
    if (!image_transfer_start(img, type))
       goto end;
@@ -268,7 +270,7 @@ bool image_texture_load_buffer(struct texture_image *out_img,
    {
       if (image_texture_load_internal(
          type, buffer, buffer_len, out_img,
-         a_shift, r_shift, g_shift, b_shift))
+         a_shift, r_shift, g_shift, b_shift, 0, 0))
       {
          return true;
       }
@@ -284,6 +286,12 @@ bool image_texture_load_buffer(struct texture_image *out_img,
 
 bool image_texture_load(struct texture_image *out_img,
       const char *path)
+{
+   return image_texture_load_scaled(out_img, path, 0, 0);
+}
+
+bool image_texture_load_scaled(struct texture_image *out_img,
+      const char *path, unsigned max_width, unsigned max_height)
 {
    unsigned r_shift, g_shift, b_shift, a_shift;
    size_t file_len             = 0;
@@ -311,7 +319,8 @@ bool image_texture_load(struct texture_image *out_img,
       if (image_texture_load_internal(
                type,
                ptr, file_len, out_img,
-               a_shift, r_shift, g_shift, b_shift))
+               a_shift, r_shift, g_shift, b_shift,
+               max_width, max_height))
          goto success;
    }
 
@@ -73,13 +73,37 @@ void image_transfer_free(void *data, enum image_type_enum type)
    }
 }
 
+void image_transfer_set_target_size(
+      void *data,
+      enum image_type_enum type,
+      unsigned width,
+      unsigned height)
+{
+   switch (type)
+   {
+      case IMAGE_TYPE_JPEG:
+#ifdef HAVE_RJPEG
+         rjpeg_set_target_size((rjpeg_t*)data, width, height);
+#endif
+         break;
+      default:
+         /* Other formats are always decoded at full size */
+         break;
+   }
+}
+
 void *image_transfer_new(enum image_type_enum type)
 {
    switch (type)
    {
       case IMAGE_TYPE_PNG:
 #ifdef HAVE_RPNG
-         return rpng_alloc();
+         {
+            rpng_t *rpng = rpng_alloc();
+            /* Decode large images on two threads */
+            rpng_set_threaded(rpng, true);
+            return rpng;
+         }
 #else
          break;
 #endif
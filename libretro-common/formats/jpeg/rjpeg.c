@@ -67,6 +67,8 @@ typedef struct
 struct rjpeg
 {
    uint8_t *buff_data;
+   unsigned target_width;
+   unsigned target_height;
 };
 
 #ifdef _MSC_VER
@@ -220,6 +222,8 @@ typedef struct
    int            eob_run;
    int scan_n, order[4];
    int restart_interval, todo;
+   int scale;                    /* log2 of the IDCT downscale factor (0-3) */
+   unsigned target_w, target_h;  /* smallest acceptable size, 0 if none */
    uint32_t       code_buffer;   /* jpeg entropy-coded buffer */
    rjpeg_huffman huff_dc[4];     /* unsigned int alignment */
    rjpeg_huffman huff_ac[4];     /* unsigned int alignment */
@@ -771,7 +775,7 @@ static INLINE uint8_t rjpeg_clamp(int x)
 {
    /* trick to use a single test to catch both cases */
    if ((unsigned int) x > 255)
-      return 255;
+      return (x < 0) ? 0 : 255;
    return (uint8_t) x;
 }
 
@@ -890,6 +894,75 @@ static void rjpeg_idct_block(uint8_t *out, int out_stride, short data[64])
    }
 }
 
+/* Reduced-size IDCTs, used when decoding at 1/2, 1/4 or
+ * 1/8 of the original size. Each output pixel is the
+ * value of the continuous 8x8 reconstruction at the centre
+ * of the 2x2/4x4 area it replaces, which only depends on
+ * the lowest NxN coefficients (cf. IJG jidctred.c) */
+#define RJPEG_IDCT_A RJPEG_F2F(0.353553391f) /* cos(4pi/16) / 2 */
+#define RJPEG_IDCT_B RJPEG_F2F(0.461939766f) /* cos(2pi/16) / 2 */
+#define RJPEG_IDCT_C RJPEG_F2F(0.191341716f) /* cos(6pi/16) / 2 */
+
+static void rjpeg_idct_block_4x4(uint8_t *out, int out_stride, short data[64])
+{
+   int i, val[16], *v = val;
+   const short *d     = data;
+
+   /* columns; as with the full IDCT, keep 2 extra bits of precision */
+   for (i = 0; i < 4; ++i, ++d, ++v)
+   {
+      if (d[8] == 0 && d[16] == 0 && d[24] == 0)
+      {
+         v[0] = v[4] = v[8] = v[12] = (d[0] * RJPEG_IDCT_A + 512) >> 10;
+      }
+      else
+      {
+         int e0 = (d[0] + d[16]) * RJPEG_IDCT_A + 512;
+         int e1 = (d[0] - d[16]) * RJPEG_IDCT_A + 512;
+         int o0 = d[8] * RJPEG_IDCT_B + d[24] * RJPEG_IDCT_C;
+         int o1 = d[8] * RJPEG_IDCT_C - d[24] * RJPEG_IDCT_B;
+         v[ 0]  = (e0 + o0) >> 10;
+         v[12]  = (e0 - o0) >> 10;
+         v[ 4]  = (e1 + o1) >> 10;
+         v[ 8]  = (e1 - o1) >> 10;
+      }
+   }
+
+   /* rows; remove the remaining 1<<14 and re-center on 128 */
+   for (i = 0, v = val; i < 4; ++i, v += 4, out += out_stride)
+   {
+      int e0 = (v[0] + v[2]) * RJPEG_IDCT_A + (1 << 13) + (128 << 14);
+      int e1 = (v[0] - v[2]) * RJPEG_IDCT_A + (1 << 13) + (128 << 14);
+      int o0 = v[1] * RJPEG_IDCT_B + v[3] * RJPEG_IDCT_C;
+      int o1 = v[1] * RJPEG_IDCT_C - v[3] * RJPEG_IDCT_B;
+      out[0] = rjpeg_clamp((e0 + o0) >> 14);
+      out[3] = rjpeg_clamp((e0 - o0) >> 14);
+      out[1] = rjpeg_clamp((e1 + o1) >> 14);
+      out[2] = rjpeg_clamp((e1 - o1) >> 14);
+   }
+}
+
+/* For 2x2 all weights are +/-cos(4pi/16) / 2, so both passes
+ * reduce to sums of the four lowest coefficients, scaled by 1/8 */
+static void rjpeg_idct_block_2x2(uint8_t *out, int out_stride, short data[64])
+{
+   int s0 = data[0] + data[8];
+   int s1 = data[0] - data[8];
+   int t0 = data[1] + data[9];
+   int t1 = data[1] - data[9];
+
+   out[0]              = rjpeg_clamp((s0 + t0 + 4 + (128 << 3)) >> 3);
+   out[1]              = rjpeg_clamp((s0 - t0 + 4 + (128 << 3)) >> 3);
+   out[out_stride]     = rjpeg_clamp((s1 + t1 + 4 + (128 << 3)) >> 3);
+   out[out_stride + 1] = rjpeg_clamp((s1 - t1 + 4 + (128 << 3)) >> 3);
+}
+
+/* 1x1 is just the (scaled) DC term */
+static void rjpeg_idct_block_1x1(uint8_t *out, int out_stride, short data[64])
+{
+   out[0] = rjpeg_clamp((data[0] + 4 + (128 << 3)) >> 3);
+}
+
 #if defined(__SSE2__)
 /* sse2 integer IDCT. not the fastest possible implementation but it
  * produces bit-identical results to the generic C version so it's
@@ -1388,7 +1461,8 @@ static int rjpeg_parse_entropy_coded_data(rjpeg_jpeg *z)
                         z->huff_ac+ha, z->fast_ac[ha], n, z->dequant[z->img_comp[n].tq]))
                   return 0;
 
-               z->idct_block_kernel(z->img_comp[n].data+z->img_comp[n].w2*j*8+i*8,
+               z->idct_block_kernel(z->img_comp[n].data
+                     + ((z->img_comp[n].w2 * j + i) << (3 - z->scale)),
                      z->img_comp[n].w2, data);
 
                /* every data block is an MCU, so countdown the restart interval */
@@ -1468,8 +1542,8 @@ static int rjpeg_parse_entropy_coded_data(rjpeg_jpeg *z)
                   {
                      for (x = 0; x < z->img_comp[n].h; ++x)
                      {
-                        int x2 = (i*z->img_comp[n].h + x)*8;
-                        int y2 = (j*z->img_comp[n].v + y)*8;
+                        int x2 = (i*z->img_comp[n].h + x) << (3 - z->scale);
+                        int y2 = (j*z->img_comp[n].v + y) << (3 - z->scale);
                         int ha = z->img_comp[n].ha;
 
                         if (!rjpeg_jpeg_decode_block(z, data,
@@ -1527,7 +1601,8 @@ static void rjpeg_jpeg_finish(rjpeg_jpeg *z)
          {
             short *data = z->img_comp[n].coeff + 64 * (i + j * z->img_comp[n].coeff_w);
             rjpeg_jpeg_dequantize(data, z->dequant[z->img_comp[n].tq]);
-            z->idct_block_kernel(z->img_comp[n].data+z->img_comp[n].w2*j*8+i*8,
+            z->idct_block_kernel(z->img_comp[n].data
+                  + ((z->img_comp[n].w2 * j + i) << (3 - z->scale)),
                   z->img_comp[n].w2, data);
          }
       }
@@ -1805,6 +1880,32 @@ static int rjpeg_process_frame_header(rjpeg_jpeg *z, int scan)
    z->img_mcu_x = (s->img_x + z->img_mcu_w-1) / z->img_mcu_w;
    z->img_mcu_y = (s->img_y + z->img_mcu_h-1) / z->img_mcu_h;
 
+   /* pick the smallest IDCT size that still yields an image
+    * at least as large as the target in one dimension */
+   z->scale     = 0;
+   if (z->target_w || z->target_h)
+   {
+      while (z->scale < 3
+            && (  (z->target_w && (z->target_w << (z->scale + 1)) <= s->img_x)
+               || (z->target_h && (z->target_h << (z->scale + 1)) <= s->img_y)))
+         z->scale++;
+   }
+
+   switch (z->scale)
+   {
+      case 1:
+         z->idct_block_kernel = rjpeg_idct_block_4x4;
+         break;
+      case 2:
+         z->idct_block_kernel = rjpeg_idct_block_2x2;
+         break;
+      case 3:
+         z->idct_block_kernel = rjpeg_idct_block_1x1;
+         break;
+      default:
+         break;
+   }
+
    if (z->progressive)
    {
       for (i = 0; i < s->img_n; ++i)
@@ -1817,8 +1918,10 @@ static int rjpeg_process_frame_header(rjpeg_jpeg *z, int scan)
           * the bogus oversized data from using interleaved MCUs and their
           * big blocks (e.g. a 16x16 iMCU on an image of width 33); we won't
           * discard the extra data until colorspace conversion */
-         z->img_comp[i].w2       = z->img_mcu_x * z->img_comp[i].h * 8;
-         z->img_comp[i].h2       = z->img_mcu_y * z->img_comp[i].v * 8;
+         z->img_comp[i].coeff_w  = z->img_mcu_x * z->img_comp[i].h;
+         z->img_comp[i].coeff_h  = z->img_mcu_y * z->img_comp[i].v;
+         z->img_comp[i].w2       = z->img_comp[i].coeff_w << (3 - z->scale);
+         z->img_comp[i].h2       = z->img_comp[i].coeff_h << (3 - z->scale);
          z->img_comp[i].raw_data = malloc(z->img_comp[i].w2 * z->img_comp[i].h2+15);
 
          /* Out of memory? */
@@ -1836,8 +1939,6 @@ static int rjpeg_process_frame_header(rjpeg_jpeg *z, int scan)
          /* align blocks for IDCT using MMX/SSE */
          z->img_comp[i].data      = (uint8_t*) (((size_t) z->img_comp[i].raw_data + 15) & ~15);
          z->img_comp[i].linebuf   = NULL;
-         z->img_comp[i].coeff_w   = (z->img_comp[i].w2 + 7) >> 3;
-         z->img_comp[i].coeff_h   = (z->img_comp[i].h2 + 7) >> 3;
          z->img_comp[i].raw_coeff = malloc(z->img_comp[i].coeff_w *
                                     z->img_comp[i].coeff_h * 64 * sizeof(short) + 15);
          z->img_comp[i].coeff     = (short*) (((size_t) z->img_comp[i].raw_coeff + 15) & ~15);
@@ -1855,8 +1956,8 @@ static int rjpeg_process_frame_header(rjpeg_jpeg *z, int scan)
           * the bogus oversized data from using interleaved MCUs and their
           * big blocks (e.g. a 16x16 iMCU on an image of width 33); we won't
           * discard the extra data until colorspace conversion */
-         z->img_comp[i].w2       = z->img_mcu_x * z->img_comp[i].h * 8;
-         z->img_comp[i].h2       = z->img_mcu_y * z->img_comp[i].v * 8;
+         z->img_comp[i].w2       = (z->img_mcu_x * z->img_comp[i].h) << (3 - z->scale);
+         z->img_comp[i].h2       = (z->img_mcu_y * z->img_comp[i].v) << (3 - z->scale);
          z->img_comp[i].raw_data = malloc(z->img_comp[i].w2 * z->img_comp[i].h2+15);
 
          /* Out of memory? */
@@ -2214,11 +2315,11 @@ static void rjpeg_YCbCr_to_RGB_row(uint8_t *out, const uint8_t *y,
       g >>= 20;
       b >>= 20;
       if ((unsigned) r > 255)
-         r = 255;
+         r = (r < 0) ? 0 : 255;
       if ((unsigned) g > 255)
-         g = 255;
+         g = (g < 0) ? 0 : 255;
       if ((unsigned) b > 255)
-         b = 255;
+         b = (b < 0) ? 0 : 255;
       out[0] = (uint8_t)r;
       out[1] = (uint8_t)g;
       out[2] = (uint8_t)b;
@@ -2358,11 +2459,11 @@ static void rjpeg_YCbCr_to_RGB_simd(uint8_t *out, const uint8_t *y,
       g >>= 20;
       b >>= 20;
       if ((unsigned) r > 255)
-         r = 255;
+         r = (r < 0) ? 0 : 255;
       if ((unsigned) g > 255)
-         g = 255;
+         g = (g < 0) ? 0 : 255;
       if ((unsigned) b > 255)
-         b = 255;
+         b = (b < 0) ? 0 : 255;
       out[0] = (uint8_t)r;
       out[1] = (uint8_t)g;
       out[2] = (uint8_t)b;
@@ -2433,6 +2534,7 @@ static uint8_t *rjpeg_load_jpeg_image(rjpeg_jpeg *z,
    int n, decode_n;
    int k;
    unsigned int i,j;
+   unsigned out_w, out_h;
    rjpeg_resample res_comp[4];
    uint8_t *coutput[4] = {0};
    uint8_t *output     = NULL;
@@ -2442,6 +2544,10 @@ static uint8_t *rjpeg_load_jpeg_image(rjpeg_jpeg *z,
    if (!rjpeg_decode_jpeg_image(z))
       goto error;
 
+   /* size of the (possibly downscaled) output image */
+   out_w = (z->s->img_x + (1 << z->scale) - 1) >> z->scale;
+   out_h = (z->s->img_y + (1 << z->scale) - 1) >> z->scale;
+
    /* determine actual number of components to generate */
    n = req_comp ? req_comp : z->s->img_n;
 
@@ -2457,14 +2563,14 @@ static uint8_t *rjpeg_load_jpeg_image(rjpeg_jpeg *z,
 
       /* allocate line buffer big enough for upsampling off the edges
        * with upsample factor of 4 */
-      z->img_comp[k].linebuf = (uint8_t *) malloc(z->s->img_x + 3);
+      z->img_comp[k].linebuf = (uint8_t *) malloc(out_w + 3);
       if (!z->img_comp[k].linebuf)
          goto error;
 
       r->hs       = z->img_h_max / z->img_comp[k].h;
       r->vs       = z->img_v_max / z->img_comp[k].v;
       r->ystep    = r->vs >> 1;
-      r->w_lores  = (z->s->img_x + r->hs-1) / r->hs;
+      r->w_lores  = (out_w + r->hs-1) / r->hs;
       r->ypos     = 0;
       r->line0    = r->line1 = z->img_comp[k].data;
       r->resample = rjpeg_resample_row_generic;
@@ -2480,15 +2586,15 @@ static uint8_t *rjpeg_load_jpeg_image(rjpeg_jpeg *z,
    }
 
    /* can't error after this so, this is safe */
-   output = (uint8_t *) malloc(n * z->s->img_x * z->s->img_y + 1);
+   output = (uint8_t *) malloc(n * out_w * out_h + 1);
 
    if (!output)
       goto error;
 
    /* now go ahead and resample */
-   for (j = 0; j < z->s->img_y; ++j)
+   for (j = 0; j < out_h; ++j)
    {
-      uint8_t *out = output + n * z->s->img_x * j;
+      uint8_t *out = output + n * out_w * j;
       for (k = 0; k < decode_n; ++k)
       {
          rjpeg_resample *r = &res_comp[k];
@@ -2503,7 +2609,8 @@ static uint8_t *rjpeg_load_jpeg_image(rjpeg_jpeg *z,
          {
             r->ystep = 0;
             r->line0 = r->line1;
-            if (++r->ypos < z->img_comp[k].y)
+            if (++r->ypos < ((z->img_comp[k].y
+                        + (1 << z->scale) - 1) >> z->scale))
                r->line1 += z->img_comp[k].w2;
          }
       }
@@ -2514,9 +2621,9 @@ static uint8_t *rjpeg_load_jpeg_image(rjpeg_jpeg *z,
          if (y)
          {
             if (z->s->img_n == 3)
-               z->YCbCr_to_RGB_kernel(out, y, coutput[1], coutput[2], z->s->img_x, n);
+               z->YCbCr_to_RGB_kernel(out, y, coutput[1], coutput[2], out_w, n);
             else
-               for (i = 0; i < z->s->img_x; ++i)
+               for (i = 0; i < out_w; ++i)
                {
                   out[0]  = out[1] = out[2] = y[i];
                   out[3]  = 255; /* not used if n==3 */
@@ -2528,10 +2635,10 @@ static uint8_t *rjpeg_load_jpeg_image(rjpeg_jpeg *z,
       {
          uint8_t *y = coutput[0];
          if (n == 1)
-            for (i = 0; i < z->s->img_x; ++i)
+            for (i = 0; i < out_w; ++i)
                out[i] = y[i];
          else
-            for (i = 0; i < z->s->img_x; ++i)
+            for (i = 0; i < out_w; ++i)
             {
                *out++ = y[i];
                *out++ = 255;
@@ -2540,8 +2647,8 @@ static uint8_t *rjpeg_load_jpeg_image(rjpeg_jpeg *z,
    }
 
    rjpeg_cleanup_jpeg(z);
-   *out_x = z->s->img_x;
-   *out_y = z->s->img_y;
+   *out_x = out_w;
+   *out_y = out_h;
 
    if (comp)
       *comp  = z->s->img_n; /* report original components, not output */
@@ -2552,6 +2659,36 @@ error:
    return NULL;
 }
 
+/* Converts RGBA to ARGB, in place */
+static void rjpeg_rgba_to_argb(uint32_t *pixels, size_t count)
+{
+   size_t i = 0;
+#if defined(__SSE2__)
+   const __m128i mask_ag = _mm_set1_epi32((int)0xFF00FF00);
+   const __m128i mask_lo = _mm_set1_epi32(0x000000FF);
+
+   for (; i + 4 <= count; i += 4)
+   {
+      __m128i texel = _mm_loadu_si128((const __m128i*)(pixels + i));
+      __m128i ag    = _mm_and_si128(texel, mask_ag);
+      __m128i r     = _mm_slli_epi32(_mm_and_si128(texel, mask_lo), 16);
+      __m128i b     = _mm_and_si128(_mm_srli_epi32(texel, 16), mask_lo);
+      _mm_storeu_si128((__m128i*)(pixels + i),
+            _mm_or_si128(ag, _mm_or_si128(r, b)));
+   }
+#endif
+
+   for (; i < count; i++)
+   {
+      uint32_t texel = pixels[i];
+      uint32_t A     = texel & 0xFF000000;
+      uint32_t B     = texel & 0x00FF0000;
+      uint32_t G     = texel & 0x0000FF00;
+      uint32_t R     = texel & 0x000000FF;
+      pixels[i]      = A | (R << 16) | G | (B >> 16);
+   }
+}
+
 int rjpeg_process_image(rjpeg_t *rjpeg, void **buf_data,
       size_t size, unsigned *width, unsigned *height)
 {
@@ -2559,8 +2696,6 @@ int rjpeg_process_image(rjpeg_t *rjpeg, void **buf_data,
    rjpeg_context s;
    int comp;
    uint32_t *img         = NULL;
-   uint32_t *pixels      = NULL;
-   unsigned size_tex     = 0;
 
    if (!rjpeg)
       return IMAGE_PROCESS_ERROR;
@@ -2570,6 +2705,9 @@ int rjpeg_process_image(rjpeg_t *rjpeg, void **buf_data,
    s.img_buffer_end      = (uint8_t*)rjpeg->buff_data + (int)size;
 
    j.s                   = &s;
+   j.scale               = 0;
+   j.target_w            = rjpeg->target_width;
+   j.target_h            = rjpeg->target_height;
 
    rjpeg_setup_jpeg(&j);
 
@@ -2578,31 +2716,21 @@ int rjpeg_process_image(rjpeg_t *rjpeg, void **buf_data,
    if (!img)
       return IMAGE_PROCESS_ERROR;
 
-   size_tex = (*width) * (*height);
-   pixels   = (uint32_t*)malloc(size_tex * sizeof(uint32_t));
+   rjpeg_rgba_to_argb(img, (size_t)(*width) * (*height));
 
-   if (!pixels)
-   {
-      free(img);
-      return IMAGE_PROCESS_ERROR;
-   }
+   *buf_data = img;
 
-   *buf_data = pixels;
-
-   /* Convert RGBA to ARGB */
-   while (size_tex--)
-   {
-      unsigned int texel = img[size_tex];
-      unsigned int A     = texel & 0xFF000000;
-      unsigned int B     = texel & 0x00FF0000;
-      unsigned int G     = texel & 0x0000FF00;
-      unsigned int R     = texel & 0x000000FF;
-      ((unsigned int*)pixels)[size_tex] = A | (R << 16) | G | (B >> 16);
-   }
+   return IMAGE_PROCESS_END;
+}
 
-   free(img);
+void rjpeg_set_target_size(rjpeg_t *rjpeg,
+      unsigned width, unsigned height)
+{
+   if (!rjpeg)
+      return;
 
-   return IMAGE_PROCESS_END;
+   rjpeg->target_width  = width;
+   rjpeg->target_height = height;
 }
 
 bool rjpeg_set_buf_ptr(rjpeg_t *rjpeg, void *data)
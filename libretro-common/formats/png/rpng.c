@@ -31,11 +31,18 @@
 #include <malloc.h>
 #endif
 
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
 #include <boolean.h>
 #include <formats/image.h>
 #include <formats/rpng.h>
 #include <streams/trans_stream.h>
 #include <string/stdstring.h>
+#ifdef HAVE_THREADS
+#include <rthreads/rthreads.h>
+#endif
 
 #include "rpng_internal.h"
 
@@ -96,7 +103,6 @@ struct rpng_process
    void *stream;
    const struct trans_stream_backend *stream_backend;
    uint8_t *prev_scanline;
-   uint8_t *decoded_scanline;
    uint8_t *inflate_buf;
    size_t restore_buf_size;
    size_t adam7_restore_buf_size;
@@ -122,7 +128,8 @@ enum rpng_flags
    RPNG_FLAG_HAS_IDAT = (1 << 1),
    RPNG_FLAG_HAS_IEND = (1 << 2),
    RPNG_FLAG_HAS_PLTE = (1 << 3),
-   RPNG_FLAG_HAS_TRNS = (1 << 4)
+   RPNG_FLAG_HAS_TRNS = (1 << 4),
+   RPNG_FLAG_THREADED = (1 << 5)
 };
 
 struct rpng
@@ -254,11 +261,29 @@ static void rpng_reverse_filter_copy_line_rgb(uint32_t *data,
 static void rpng_reverse_filter_copy_line_rgba(uint32_t *data,
       const uint8_t *decoded, unsigned width, unsigned bpp)
 {
-   int i;
+   int i = 0;
 
    bpp /= 8;
 
-   for (i = 0; i < (int)width; i++)
+#if defined(__SSE2__)
+   /* RGBA -> ARGB: swap the R and B bytes of each pixel */
+   if (bpp == 1)
+   {
+      const __m128i mask_ag = _mm_set1_epi32((int)0xff00ff00);
+      const __m128i mask_rb = _mm_set1_epi32(0x00ff00ff);
+      for (; i + 4 <= (int)width; i += 4, decoded += 16)
+      {
+         __m128i v  = _mm_loadu_si128((const __m128i*)decoded);
+         __m128i rb = _mm_and_si128(v, mask_rb);
+         rb         = _mm_or_si128(_mm_slli_epi32(rb, 16),
+               _mm_srli_epi32(rb, 16));
+         _mm_storeu_si128((__m128i*)(data + i),
+               _mm_or_si128(_mm_and_si128(v, mask_ag), rb));
+      }
+   }
+#endif
+
+   for (; i < (int)width; i++)
    {
       uint32_t r, g, b, a;
       r        = *decoded;
@@ -484,9 +509,6 @@ static void rpng_reverse_filter_deinit(struct rpng_process *pngp)
 {
    if (!pngp)
       return;
-   if (pngp->decoded_scanline)
-      free(pngp->decoded_scanline);
-   pngp->decoded_scanline = NULL;
    if (pngp->prev_scanline)
       free(pngp->prev_scanline);
    pngp->prev_scanline    = NULL;
@@ -546,10 +568,12 @@ static int rpng_reverse_filter_init(const struct png_ihdr *ihdr,
 
    pngp->restore_buf_size      = 0;
    pngp->data_restore_buf_size = 0;
+   /* Scanlines are reconstructed in place, so the
+    * previous scanline is only needed (as a line of
+    * zeroes) for the first one */
    pngp->prev_scanline         = (uint8_t*)calloc(1, pngp->pitch);
-   pngp->decoded_scanline      = (uint8_t*)calloc(1, pngp->pitch);
 
-   if (!pngp->prev_scanline || !pngp->decoded_scanline)
+   if (!pngp->prev_scanline)
       goto error;
 
    pngp->h                    = 0;
@@ -562,75 +586,194 @@ error:
    return -1;
 }
 
-static int rpng_reverse_filter_copy_line(uint32_t *data,
-      const struct png_ihdr *ihdr,
-      struct rpng_process *pngp, unsigned filter)
+/* Scanline filters
+ * > Each function reverses the filter of @line in place,
+ *   @prev being the previous reconstructed scanline
+ * > Sub and Average are left to the compiler: their
+ *   serial dependency makes SIMD slower than scalar
+ *   code, whereas Paeth is dominated by the predictor
+ *   and gains from SSE2 for 8 bit RGB and RGBA */
+static void rpng_reverse_filter_sub(uint8_t *line,
+      unsigned pitch, unsigned bpp)
+{
+   unsigned i;
+   for (i = bpp; i < pitch; i++)
+      line[i] += line[i - bpp];
+}
+
+static void rpng_reverse_filter_up(uint8_t *line,
+      const uint8_t *prev, unsigned pitch)
+{
+   unsigned i = 0;
+#if defined(__SSE2__)
+   for (; i + 16 <= pitch; i += 16)
+      _mm_storeu_si128((__m128i*)(line + i), _mm_add_epi8(
+               _mm_loadu_si128((const __m128i*)(line + i)),
+               _mm_loadu_si128((const __m128i*)(prev + i))));
+#endif
+   for (; i < pitch; i++)
+      line[i] += prev[i];
+}
+
+static void rpng_reverse_filter_avg(uint8_t *line,
+      const uint8_t *prev, unsigned pitch, unsigned bpp)
 {
    unsigned i;
+   for (i = 0; i < bpp; i++)
+      line[i] += prev[i] >> 1;
+   for (i = bpp; i < pitch; i++)
+      line[i] += (line[i - bpp] + prev[i]) >> 1;
+}
+
+static void rpng_reverse_filter_paeth(uint8_t *line,
+      const uint8_t *prev, unsigned pitch, unsigned bpp)
+{
+   unsigned i;
+   for (i = 0; i < bpp; i++)
+      line[i] += prev[i];
+   for (i = bpp; i < pitch; i++)
+      line[i] += paeth(line[i - bpp], prev[i], prev[i - bpp]);
+}
+
+#if defined(__SSE2__)
+static INLINE __m128i rpng_sse2_abs_epi16(__m128i x)
+{
+   return _mm_max_epi16(x, _mm_sub_epi16(_mm_setzero_si128(), x));
+}
+
+/* Pixels depend on their left neighbour, so they are
+ * processed one at a time with all of their channels
+ * in one register
+ * > With 3 bytes per pixel, 4 bytes are loaded and
+ *   stored while that stays within the scanline;
+ *   the predictor of the 4th byte is masked out, so
+ *   the byte is written back unchanged */
+static void rpng_reverse_filter_paeth_sse2(uint8_t *line,
+      const uint8_t *prev, unsigned pitch, unsigned bpp)
+{
+   unsigned i         = 0;
+   const __m128i zero = _mm_setzero_si128();
+   const __m128i mask = _mm_cvtsi32_si128(
+         (bpp == 3) ? 0x00ffffff : (int)0xffffffff);
+   __m128i a          = zero; /* left */
+   __m128i c          = zero; /* upper left */
+
+   while (i + bpp <= pitch)
+   {
+      uint32_t v;
+      __m128i x, b, pa, pb, pc, smallest, nearest, sel;
+      bool wide = (i + 4 <= pitch);
+
+      v         = 0;
+      memcpy(&v, prev + i, wide ? 4 : bpp);
+      b         = _mm_unpacklo_epi8(_mm_cvtsi32_si128((int)v), zero);
+      v         = 0;
+      memcpy(&v, line + i, wide ? 4 : bpp);
+      x         = _mm_cvtsi32_si128((int)v);
+
+      /* p = a + b - c, pa = |p - a|, pb = |p - b|, pc = |p - c| */
+      pa        = rpng_sse2_abs_epi16(_mm_sub_epi16(b, c));
+      pb        = rpng_sse2_abs_epi16(_mm_sub_epi16(a, c));
+      pc        = rpng_sse2_abs_epi16(_mm_sub_epi16(
+               _mm_add_epi16(a, b), _mm_add_epi16(c, c)));
+      smallest  = _mm_min_epi16(pc, _mm_min_epi16(pa, pb));
+
+      /* Ties are resolved in the order a, b, c */
+      sel       = _mm_cmpeq_epi16(pb, smallest);
+      nearest   = _mm_or_si128(_mm_and_si128(sel, b),
+            _mm_andnot_si128(sel, c));
+      sel       = _mm_cmpeq_epi16(pa, smallest);
+      nearest   = _mm_or_si128(_mm_and_si128(sel, a),
+            _mm_andnot_si128(sel, nearest));
+
+      x         = _mm_add_epi8(x, _mm_and_si128(mask,
+               _mm_packus_epi16(nearest, nearest)));
+      v         = (uint32_t)_mm_cvtsi128_si32(x);
+      memcpy(line + i, &v, wide ? 4 : bpp);
+
+      c         = b;
+      a         = _mm_unpacklo_epi8(x, zero);
+      i        += bpp;
+   }
+}
+#endif
 
+static bool rpng_reverse_filter_line(uint8_t *line, const uint8_t *prev,
+      unsigned pitch, unsigned bpp, unsigned filter)
+{
    switch (filter)
    {
       case PNG_FILTER_NONE:
-         memcpy(pngp->decoded_scanline, pngp->inflate_buf, pngp->pitch);
          break;
       case PNG_FILTER_SUB:
-         memcpy(pngp->decoded_scanline, pngp->inflate_buf, pngp->pitch);
-         for (i = pngp->bpp; i < pngp->pitch; i++)
-            pngp->decoded_scanline[i] += pngp->decoded_scanline[i - pngp->bpp];
+         rpng_reverse_filter_sub(line, pitch, bpp);
          break;
       case PNG_FILTER_UP:
-         memcpy(pngp->decoded_scanline, pngp->inflate_buf, pngp->pitch);
-         for (i = 0; i < pngp->pitch; i++)
-            pngp->decoded_scanline[i] += pngp->prev_scanline[i];
+         rpng_reverse_filter_up(line, prev, pitch);
          break;
       case PNG_FILTER_AVERAGE:
-         memcpy(pngp->decoded_scanline, pngp->inflate_buf, pngp->pitch);
-         for (i = 0; i < pngp->bpp; i++)
-         {
-            uint8_t avg = pngp->prev_scanline[i] >> 1;
-            pngp->decoded_scanline[i] += avg;
-         }
-         for (i = pngp->bpp; i < pngp->pitch; i++)
-         {
-            uint8_t avg = (pngp->decoded_scanline[i - pngp->bpp] + pngp->prev_scanline[i]) >> 1;
-            pngp->decoded_scanline[i] += avg;
-         }
+         rpng_reverse_filter_avg(line, prev, pitch, bpp);
          break;
       case PNG_FILTER_PAETH:
-         memcpy(pngp->decoded_scanline, pngp->inflate_buf, pngp->pitch);
-         for (i = 0; i < pngp->bpp; i++)
-            pngp->decoded_scanline[i] += pngp->prev_scanline[i];
-         for (i = pngp->bpp; i < pngp->pitch; i++)
-            pngp->decoded_scanline[i] += paeth(pngp->decoded_scanline[i - pngp->bpp],
-                  pngp->prev_scanline[i], pngp->prev_scanline[i - pngp->bpp]);
+#if defined(__SSE2__)
+         if (bpp == 3 || bpp == 4)
+         {
+            rpng_reverse_filter_paeth_sse2(line, prev, pitch, bpp);
+            break;
+         }
+#endif
+         rpng_reverse_filter_paeth(line, prev, pitch, bpp);
          break;
       default:
-         return IMAGE_PROCESS_ERROR_END;
+         return false;
    }
 
+   return true;
+}
+
+static void rpng_reverse_filter_convert_line(uint32_t *data,
+      const uint8_t *line, const struct png_ihdr *ihdr,
+      const uint32_t *palette)
+{
    switch (ihdr->color_type)
    {
       case PNG_IHDR_COLOR_GRAY:
-         rpng_reverse_filter_copy_line_bw(data, pngp->decoded_scanline, ihdr->width, ihdr->depth);
+         rpng_reverse_filter_copy_line_bw(data, line, ihdr->width, ihdr->depth);
          break;
       case PNG_IHDR_COLOR_RGB:
-         rpng_reverse_filter_copy_line_rgb(data, pngp->decoded_scanline, ihdr->width, ihdr->depth);
+         rpng_reverse_filter_copy_line_rgb(data, line, ihdr->width, ihdr->depth);
          break;
       case PNG_IHDR_COLOR_PLT:
          rpng_reverse_filter_copy_line_plt(
-               data, pngp->decoded_scanline, ihdr->width,
-               ihdr->depth, pngp->palette);
+               data, line, ihdr->width,
+               ihdr->depth, palette);
          break;
       case PNG_IHDR_COLOR_GRAY_ALPHA:
-         rpng_reverse_filter_copy_line_gray_alpha(data, pngp->decoded_scanline, ihdr->width,
+         rpng_reverse_filter_copy_line_gray_alpha(data, line, ihdr->width,
                ihdr->depth);
          break;
       case PNG_IHDR_COLOR_RGBA:
-         rpng_reverse_filter_copy_line_rgba(data, pngp->decoded_scanline, ihdr->width, ihdr->depth);
+         rpng_reverse_filter_copy_line_rgba(data, line, ihdr->width, ihdr->depth);
          break;
    }
+}
+
+static int rpng_reverse_filter_copy_line(uint32_t *data,
+      const struct png_ihdr *ihdr,
+      struct rpng_process *pngp, unsigned filter)
+{
+   /* The previous scanline precedes the current one
+    * (and its filter type byte) in the inflate buffer */
+   const uint8_t *prev = pngp->h
+      ? pngp->inflate_buf - (pngp->pitch + 1)
+      : pngp->prev_scanline;
+
+   if (!rpng_reverse_filter_line(pngp->inflate_buf, prev,
+            pngp->pitch, pngp->bpp, filter))
+      return IMAGE_PROCESS_ERROR_END;
 
-   memcpy(pngp->prev_scanline, pngp->decoded_scanline, pngp->pitch);
+   rpng_reverse_filter_convert_line(data, pngp->inflate_buf,
+         ihdr, pngp->palette);
 
    return IMAGE_PROCESS_NEXT;
 }
@@ -749,6 +892,201 @@ static int rpng_reverse_filter_adam7(uint32_t **data_,
    return ret;
 }
 
+static uint32_t *rpng_alloc_image_data(rpng_t *rpng)
+{
+#ifdef GEKKO
+   /* we often use these in textures, make sure they're 32-byte aligned */
+   return (uint32_t*)memalign(32, rpng->ihdr.width *
+         rpng->ihdr.height * sizeof(uint32_t));
+#else
+   return (uint32_t*)malloc(rpng->ihdr.width *
+         rpng->ihdr.height * sizeof(uint32_t));
+#endif
+}
+
+#ifdef HAVE_THREADS
+/* Threaded decoding
+ *
+ * Scanlines of non-interlaced images are reconstructed
+ * on a worker thread as soon as they have been inflated,
+ * while the calling thread keeps inflating the rest of
+ * the image in chunks of RPNG_PIPELINE_CHUNK_SIZE bytes.
+ * Images smaller than RPNG_PIPELINE_MIN_SIZE (inflated)
+ * are not worth the thread start-up cost. */
+#define RPNG_PIPELINE_MIN_SIZE   (256 * 1024)
+#define RPNG_PIPELINE_CHUNK_SIZE (64 * 1024)
+
+struct rpng_pipeline
+{
+   const struct png_ihdr *ihdr;
+   struct rpng_process *process;
+   uint32_t *data;
+   slock_t *lock;
+   scond_t *cond;
+   size_t avail;  /* Inflated bytes, guarded by lock */
+   bool done;     /* Inflate finished, guarded by lock */
+   bool failed;   /* Guarded by lock */
+};
+
+static void rpng_pipeline_thread(void *userdata)
+{
+   unsigned h;
+   struct rpng_pipeline *pipe   = (struct rpng_pipeline*)userdata;
+   const struct png_ihdr *ihdr  = pipe->ihdr;
+   struct rpng_process *process = pipe->process;
+   size_t stride                = process->pitch + 1;
+   size_t avail                 = 0;
+   bool failed                  = false;
+
+   for (h = 0; h < ihdr->height; h++)
+   {
+      uint8_t *line = process->inflate_buf + h * stride;
+
+      /* Wait for the scanline to be inflated */
+      if (avail < (h + 1) * stride)
+      {
+         slock_lock(pipe->lock);
+         while (pipe->avail < (h + 1) * stride && !pipe->done)
+            scond_wait(pipe->cond, pipe->lock);
+         avail = pipe->avail;
+         slock_unlock(pipe->lock);
+
+         /* Truncated image data */
+         if (avail < (h + 1) * stride)
+         {
+            failed = true;
+            break;
+         }
+      }
+
+      if (!rpng_reverse_filter_line(line + 1,
+               h ? line + 1 - stride : process->prev_scanline,
+               process->pitch, process->bpp, line[0]))
+      {
+         failed = true;
+         break;
+      }
+
+      rpng_reverse_filter_convert_line(pipe->data + h * ihdr->width,
+            line + 1, ihdr, process->palette);
+   }
+
+   if (failed)
+   {
+      slock_lock(pipe->lock);
+      pipe->failed = true;
+      slock_unlock(pipe->lock);
+   }
+}
+
+/* Inflates and reconstructs the whole image
+ * @return 1 on success, -1 on error, or 0 if the
+ * worker thread could not be started (in which case
+ * nothing has been inflated yet) */
+static int rpng_process_pipelined(rpng_t *rpng, uint32_t **data)
+{
+   struct rpng_pipeline pipe;
+   sthread_t *thread            = NULL;
+   struct rpng_process *process = rpng->process;
+   bool failed                  = false;
+
+   rpng_pass_geom(&rpng->ihdr, rpng->ihdr.width, rpng->ihdr.height,
+         &process->bpp, &process->pitch, NULL);
+
+   process->palette       = rpng->palette;
+   process->prev_scanline = (uint8_t*)calloc(1, process->pitch);
+   *data                  = rpng_alloc_image_data(rpng);
+
+   pipe.ihdr              = &rpng->ihdr;
+   pipe.process           = process;
+   pipe.data              = *data;
+   pipe.lock              = slock_new();
+   pipe.cond              = scond_new();
+   pipe.avail             = 0;
+   pipe.done              = false;
+   pipe.failed            = false;
+
+   if (     !process->prev_scanline
+         || !*data
+         || !pipe.lock
+         || !pipe.cond
+         || !(thread = sthread_create(rpng_pipeline_thread, &pipe)))
+   {
+      if (pipe.lock)
+         slock_free(pipe.lock);
+      if (pipe.cond)
+         scond_free(pipe.cond);
+      if (*data)
+         free(*data);
+      *data = NULL;
+      rpng_reverse_filter_deinit(process);
+      return 0;
+   }
+
+   while (process->avail_in > 0 && process->avail_out > 0)
+   {
+      bool zstatus;
+      enum trans_stream_error terror;
+      uint32_t rd, wn;
+      size_t chunk = process->avail_out;
+
+      if (chunk > RPNG_PIPELINE_CHUNK_SIZE)
+         chunk = RPNG_PIPELINE_CHUNK_SIZE;
+
+      process->stream_backend->set_out(process->stream,
+            process->inflate_buf + process->total_out, (uint32_t)chunk);
+
+      zstatus = process->stream_backend->trans(process->stream,
+            false, &rd, &wn, &terror);
+
+      if (!zstatus && terror != TRANS_STREAM_ERROR_BUFFER_FULL)
+      {
+         failed = true;
+         break;
+      }
+
+      process->avail_in  -= rd;
+      process->avail_out -= wn;
+      process->total_out += wn;
+
+      slock_lock(pipe.lock);
+      pipe.avail = process->total_out;
+      failed     = pipe.failed;
+      scond_signal(pipe.cond);
+      slock_unlock(pipe.lock);
+
+      if (!terror || failed)
+         break;
+   }
+
+   slock_lock(pipe.lock);
+   pipe.done = true;
+   scond_signal(pipe.cond);
+   slock_unlock(pipe.lock);
+
+   sthread_join(thread);
+   slock_free(pipe.lock);
+   scond_free(pipe.cond);
+
+   process->stream_backend->stream_free(process->stream);
+   process->stream = NULL;
+
+   if (failed || pipe.failed)
+   {
+      free(*data);
+      *data = NULL;
+      rpng_reverse_filter_deinit(process);
+      return -1;
+   }
+
+   /* All scanlines are done; the next call of
+    * rpng_reverse_filter_regular_iterate() ends */
+   process->h      = rpng->ihdr.height;
+   process->flags |= RPNG_PROCESS_FLAG_PASS_INITIALIZED;
+   return 1;
+}
+#endif
+
 static int rpng_load_image_argb_process_inflate_init(
       rpng_t *rpng, uint32_t **data)
 {
@@ -762,6 +1100,25 @@ static int rpng_load_image_argb_process_inflate_init(
    if (!to_continue)
       goto end;
 
+#ifdef HAVE_THREADS
+   if (     (rpng->flags & RPNG_FLAG_THREADED)
+         && (rpng->ihdr.interlace != 1)
+         && (process->total_out == 0)
+         && (process->inflate_buf_size >= RPNG_PIPELINE_MIN_SIZE))
+   {
+      switch (rpng_process_pipelined(rpng, data))
+      {
+         case 1:
+            process->flags |=  RPNG_PROCESS_FLAG_INFLATE_INITIALIZED;
+            return 1;
+         case -1:
+            goto error;
+         default:
+            break;
+      }
+   }
+#endif
+
    zstatus = process->stream_backend->trans(process->stream, false, &rd, &wn, &terror);
 
    if (!zstatus && terror != TRANS_STREAM_ERROR_BUFFER_FULL)
@@ -778,15 +1135,7 @@ end:
    process->stream_backend->stream_free(process->stream);
    process->stream = NULL;
 
-#ifdef GEKKO
-   /* we often use these in textures, make sure they're 32-byte aligned */
-   *data = (uint32_t*)memalign(32, rpng->ihdr.width *
-         rpng->ihdr.height * sizeof(uint32_t));
-#else
-   *data = (uint32_t*)malloc(rpng->ihdr.width *
-         rpng->ihdr.height * sizeof(uint32_t));
-#endif
-   if (!*data)
+   if (!(*data = rpng_alloc_image_data(rpng)))
       goto false_end;
 
    process->adam7_restore_buf_size = 0;
@@ -827,7 +1176,6 @@ static struct rpng_process *rpng_process_init(rpng_t *rpng)
 
    process->flags                  = 0;
    process->prev_scanline          = NULL;
-   process->decoded_scanline       = NULL;
    process->inflate_buf            = NULL;
 
    process->ihdr.width             = 0;
@@ -1231,6 +1579,24 @@ bool rpng_is_valid(rpng_t *rpng)
 RPNG_FLAG_HAS_IEND)) > 0));
 }
 
+/**
+ * rpng_set_threaded:
+ *
+ * Allows large, non-interlaced images to be reconstructed
+ * on a separate thread while they are being inflated.
+ * Has no effect unless built with HAVE_THREADS.
+ * Must be called before rpng_process_image().
+ **/
+void rpng_set_threaded(rpng_t *rpng, bool threaded)
+{
+   if (!rpng)
+      return;
+   if (threaded)
+      rpng->flags |=  RPNG_FLAG_THREADED;
+   else
+      rpng->flags &= ~RPNG_FLAG_THREADED;
+}
+
 bool rpng_set_buf_ptr(rpng_t *rpng, void *data, size_t len)
 {
    if (!rpng || (len < 1))
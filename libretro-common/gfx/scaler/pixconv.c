@@ -26,6 +26,7 @@
 #include <string.h>
 
 #include <retro_inline.h>
+#include <features/features_cpu.h>
 
 #include <gfx/scaler/pixconv.h>
 
@@ -37,6 +38,8 @@
 #undef __SSE2__
 #endif
 
+#include <gfx/scaler/scaler_int.h>
+
 #if defined(__SSE2__)
 #include <emmintrin.h>
 #elif defined(__MMX__)
@@ -45,6 +48,11 @@
 #include <arm_neon.h>
 #endif
 
+#ifdef SCALER_HAVE_AVX2
+#include <immintrin.h>
+#define PIXCONV_AVX2 __attribute__((target("avx2")))
+#endif
+
 void conv_rgb565_0rgb1555(void *output_, const void *input_,
       int width, int height,
       int out_stride, int in_stride)
@@ -67,7 +75,7 @@ void conv_rgb565_0rgb1555(void *output_, const void *input_,
       for (; w < max_width; w += 8)
       {
          const __m128i in = _mm_loadu_si128((const __m128i*)(input + w));
-         __m128i hi = _mm_and_si128(_mm_slli_epi16(in, 1), hi_mask);
+         __m128i hi = _mm_and_si128(_mm_srli_epi16(in, 1), hi_mask);
          __m128i lo = _mm_and_si128(in, lo_mask);
          _mm_storeu_si128((__m128i*)(output + w), _mm_or_si128(hi, lo));
       }
@@ -355,10 +363,10 @@ void conv_rgb565_abgr8888(void *output_, const void *input_,
          r                = _mm_mulhi_epi16(r, mul16_r);
          g                = _mm_mulhi_epi16(g, mul16_g);
          b                = _mm_mulhi_epi16(b, mul16_b);
-         res_lo_bg        = _mm_unpacklo_epi8(b, g);
-         res_hi_bg        = _mm_unpackhi_epi8(b, g);
-         res_lo_ra        = _mm_unpacklo_epi8(r, a);
-         res_hi_ra        = _mm_unpackhi_epi8(r, a);
+         res_lo_bg        = _mm_unpacklo_epi8(r, g);
+         res_hi_bg        = _mm_unpackhi_epi8(r, g);
+         res_lo_ra        = _mm_unpacklo_epi8(b, a);
+         res_hi_ra        = _mm_unpackhi_epi8(b, a);
          res_lo           = _mm_or_si128(res_lo_bg,
                _mm_slli_si128(res_lo_ra, 2));
          res_hi           = _mm_or_si128(res_hi_bg,
@@ -398,28 +406,66 @@ void conv_rgb565_abgr8888(void *output_, const void *input_,
    }
 }
 
+#if defined(__SSE2__)
+/* Packs the low 16 bits of each 32-bit element of 'a'
+ * and 'b' into one vector. Sign-extends them first, so
+ * that _mm_packs_epi32() does not saturate. */
+static INLINE __m128i conv_pack_u16_epi32(__m128i a, __m128i b)
+{
+   a = _mm_srai_epi32(_mm_slli_epi32(a, 16), 16);
+   b = _mm_srai_epi32(_mm_slli_epi32(b, 16), 16);
+   return _mm_packs_epi32(a, b);
+}
+#endif
+
 void conv_argb8888_rgba4444(void *output_, const void *input_,
       int width, int height,
       int out_stride, int in_stride)
 {
-   int h, w;
+   int h;
    const uint32_t *input = (const uint32_t*)input_;
    uint16_t *output      = (uint16_t*)output_;
 
+#if defined(__SSE2__)
+   const __m128i mask_r  = _mm_set1_epi32(0xf000);
+   const __m128i mask_g  = _mm_set1_epi32(0x0f00);
+   const __m128i mask_b  = _mm_set1_epi32(0x00f0);
+
+   int max_width         = width - 7;
+#endif
+
    for (h = 0; h < height;
-         h++, output += out_stride >> 2, input += in_stride >> 1)
+         h++, output += out_stride >> 1, input += in_stride >> 2)
    {
-      for (w = 0; w < width; w++)
+      int w = 0;
+#if defined(__SSE2__)
+      for (; w < max_width; w += 8)
+      {
+         __m128i in0  = _mm_loadu_si128((const __m128i*)(input + w + 0));
+         __m128i in1  = _mm_loadu_si128((const __m128i*)(input + w + 4));
+         __m128i res0 = _mm_or_si128(
+               _mm_or_si128(_mm_and_si128(_mm_srli_epi32(in0, 8), mask_r),
+                  _mm_and_si128(_mm_srli_epi32(in0, 4), mask_g)),
+               _mm_or_si128(_mm_and_si128(in0, mask_b),
+                  _mm_srli_epi32(in0, 28)));
+         __m128i res1 = _mm_or_si128(
+               _mm_or_si128(_mm_and_si128(_mm_srli_epi32(in1, 8), mask_r),
+                  _mm_and_si128(_mm_srli_epi32(in1, 4), mask_g)),
+               _mm_or_si128(_mm_and_si128(in1, mask_b),
+                  _mm_srli_epi32(in1, 28)));
+
+         _mm_storeu_si128((__m128i*)(output + w),
+               conv_pack_u16_epi32(res0, res1));
+      }
+#endif
+
+      for (; w < width; w++)
       {
          uint32_t col = input[w];
-         uint32_t r   = (col >> 16) & 0xf;
-         uint32_t g   = (col >>  8) & 0xf;
-         uint32_t b   = (col) & 0xf;
-         uint32_t a   = (col >>  24) & 0xf;
-         r            = (r >> 4) | r;
-         g            = (g >> 4) | g;
-         b            = (b >> 4) | b;
-         a            = (a >> 4) | a;
+         uint32_t r   = (col >> 20) & 0xf;
+         uint32_t g   = (col >> 12) & 0xf;
+         uint32_t b   = (col >>  4) & 0xf;
+         uint32_t a   = (col >> 28) & 0xf;
 
          output[w]    = (r << 12) | (g << 8) | (b << 4) | a;
       }
@@ -434,51 +480,52 @@ void conv_rgba4444_argb8888(void *output_, const void *input_,
    const uint16_t *input = (const uint16_t*)input_;
    uint32_t *output      = (uint32_t*)output_;
 
-#if defined(__MMX__)
-   const __m64 pix_mask_r = _mm_set1_pi16(0xf << 10);
-   const __m64 pix_mask_g = _mm_set1_pi16(0xf << 8);
-   const __m64 pix_mask_b = _mm_set1_pi16(0xf << 8);
-   const __m64 mul16_r    = _mm_set1_pi16(0x0440);
-   const __m64 mul16_g    = _mm_set1_pi16(0x1100);
-   const __m64 mul16_b    = _mm_set1_pi16(0x1100);
-   const __m64 a          = _mm_set1_pi16(0x00ff);
+#if defined(__SSE2__)
+   const __m128i mask_hi = _mm_set1_epi16((int16_t)0xf0f0);
+   const __m128i mask_lo = _mm_set1_epi16(0x0f0f);
 
-   int max_width            = width - 3;
+   int max_width         = width - 7;
+#elif (defined(__ARM_NEON__) || defined(__ARM_NEON))
+   int max_width         = width - 7;
 #endif
 
    for (h = 0; h < height;
          h++, output += out_stride >> 2, input += in_stride >> 1)
    {
       int w = 0;
-#if defined(__MMX__)
-      for (; w < max_width; w += 4)
+#if defined(__SSE2__)
+      for (; w < max_width; w += 8)
       {
-         __m64 res_lo, res_hi;
-         __m64 res_lo_bg, res_hi_bg, res_lo_ra, res_hi_ra;
-         const __m64 in = *((__m64*)(input + w));
-         __m64          r = _mm_and_si64(_mm_srli_pi16(in, 2), pix_mask_r);
-         __m64          g = _mm_and_si64(in, pix_mask_g);
-         __m64          b = _mm_and_si64(_mm_slli_pi16(in, 4), pix_mask_b);
-
-         r                = _mm_mulhi_pi16(r, mul16_r);
-         g                = _mm_mulhi_pi16(g, mul16_g);
-         b                = _mm_mulhi_pi16(b, mul16_b);
-
-         res_lo_bg        = _mm_unpacklo_pi8(b, g);
-         res_hi_bg        = _mm_unpackhi_pi8(b, g);
-         res_lo_ra        = _mm_unpacklo_pi8(r, a);
-         res_hi_ra        = _mm_unpackhi_pi8(r, a);
+         const __m128i in = _mm_loadu_si128((const __m128i*)(input + w));
+         /* [B, R] and [A, G] nibbles, widened to 8 bits */
+         __m128i br       = _mm_and_si128(in, mask_hi);
+         __m128i ag       = _mm_and_si128(in, mask_lo);
+         br               = _mm_or_si128(br, _mm_srli_epi16(br, 4));
+         ag               = _mm_or_si128(ag, _mm_slli_epi16(ag, 4));
+         ag               = _mm_or_si128(_mm_srli_epi16(ag, 8),
+               _mm_slli_epi16(ag, 8));
+
+         _mm_storeu_si128((__m128i*)(output + w + 0),
+               _mm_unpacklo_epi8(br, ag));
+         _mm_storeu_si128((__m128i*)(output + w + 4),
+               _mm_unpackhi_epi8(br, ag));
+      }
+#elif (defined(__ARM_NEON__) || defined(__ARM_NEON))
+      for (; w < max_width; w += 8)
+      {
+         uint16x8_t in = vld1q_u16(input + w);
+         uint16x8_t br = vandq_u16(in, vdupq_n_u16(0xf0f0));
+         uint16x8_t ag = vandq_u16(in, vdupq_n_u16(0x0f0f));
+         uint8x16x2_t res;
 
-         res_lo           = _mm_or_si64(res_lo_bg,
-               _mm_slli_si64(res_lo_ra, 16));
-         res_hi           = _mm_or_si64(res_hi_bg,
-               _mm_slli_si64(res_hi_ra, 16));
+         br            = vorrq_u16(br, vshrq_n_u16(br, 4));
+         ag            = vorrq_u16(ag, vshlq_n_u16(ag, 4));
+         res           = vzipq_u8(vreinterpretq_u8_u16(br),
+               vrev16q_u8(vreinterpretq_u8_u16(ag)));
 
-         *((__m64*)(output + w + 0)) = res_lo;
-         *((__m64*)(output + w + 2)) = res_hi;
+         vst1q_u8((uint8_t*)(output + w + 0), res.val[0]);
+         vst1q_u8((uint8_t*)(output + w + 4), res.val[1]);
       }
-
-      _mm_empty();
 #endif
 
       for (; w < width; w++)
@@ -502,21 +549,54 @@ void conv_rgba4444_rgb565(void *output_, const void *input_,
       int width, int height,
       int out_stride, int in_stride)
 {
-   int h, w;
-   const uint16_t *input = (const uint16_t*)input_;
-   uint16_t *output      = (uint16_t*)output_;
+   int h;
+   const uint16_t *input  = (const uint16_t*)input_;
+   uint16_t *output       = (uint16_t*)output_;
+
+#if defined(__SSE2__)
+   const __m128i mask_r   = _mm_set1_epi16((int16_t)0xf000);
+   const __m128i mask_rlo = _mm_set1_epi16(0x0800);
+   const __m128i mask_g   = _mm_set1_epi16(0x0780);
+   const __m128i mask_glo = _mm_set1_epi16(0x0060);
+   const __m128i mask_b   = _mm_set1_epi16(0x001e);
+   const __m128i mask_blo = _mm_set1_epi16(0x0001);
+
+   int max_width          = width - 7;
+#endif
 
    for (h = 0; h < height;
          h++, output += out_stride >> 1, input += in_stride >> 1)
    {
-      for (w = 0; w < width; w++)
+      int w = 0;
+#if defined(__SSE2__)
+      for (; w < max_width; w += 8)
+      {
+         const __m128i in = _mm_loadu_si128((const __m128i*)(input + w));
+         __m128i r        = _mm_or_si128(_mm_and_si128(in, mask_r),
+               _mm_and_si128(_mm_srli_epi16(in, 4), mask_rlo));
+         __m128i g        = _mm_or_si128(
+               _mm_and_si128(_mm_srli_epi16(in, 1), mask_g),
+               _mm_and_si128(_mm_srli_epi16(in, 5), mask_glo));
+         __m128i b        = _mm_or_si128(
+               _mm_and_si128(_mm_srli_epi16(in, 3), mask_b),
+               _mm_and_si128(_mm_srli_epi16(in, 7), mask_blo));
+
+         _mm_storeu_si128((__m128i*)(output + w),
+               _mm_or_si128(r, _mm_or_si128(g, b)));
+      }
+#endif
+
+      for (; w < width; w++)
       {
          uint32_t col = input[w];
          uint32_t r   = (col >> 12) & 0xf;
          uint32_t g   = (col >>  8) & 0xf;
          uint32_t b   = (col >>  4) & 0xf;
+         r            = (r << 1) | (r >> 3);
+         g            = (g << 2) | (g >> 2);
+         b            = (b << 1) | (b >> 3);
 
-         output[w]    = (r << 12) | (g << 7) | (b << 1);
+         output[w]    = (r << 11) | (g << 5) | b;
       }
    }
 }
@@ -743,15 +823,34 @@ void conv_bgr24_argb8888(void *output_, const void *input_,
       int width, int height,
       int out_stride, int in_stride)
 {
-   int h, w;
+   int h;
    const uint8_t *input = (const uint8_t*)input_;
    uint32_t *output     = (uint32_t*)output_;
 
+#if (defined(__ARM_NEON__) || defined(__ARM_NEON))
+   int max_width        = width - 15;
+#endif
+
    for (h = 0; h < height;
          h++, output += out_stride >> 2, input += in_stride)
    {
       const uint8_t *inp = input;
-      for (w = 0; w < width; w++)
+      int              w = 0;
+#if (defined(__ARM_NEON__) || defined(__ARM_NEON))
+      for (; w < max_width; w += 16, inp += 48)
+      {
+         uint8x16x3_t in = vld3q_u8(inp);
+         uint8x16x4_t res;
+         res.val[0]      = in.val[0];
+         res.val[1]      = in.val[1];
+         res.val[2]      = in.val[2];
+         res.val[3]      = vdupq_n_u8(0xffu);
+
+         vst4q_u8((uint8_t*)(output + w), res);
+      }
+#endif
+
+      for (; w < width; w++)
       {
          uint32_t b = *inp++;
          uint32_t g = *inp++;
@@ -769,7 +868,7 @@ void conv_bgr24_rgb565(void *output_, const void *input_,
    const uint8_t *input = (const uint8_t*)input_;
    uint16_t *output     = (uint16_t*)output_;
    for (h = 0; h < height;
-         h++, output += out_stride, input += in_stride)
+         h++, output += out_stride >> 1, input += in_stride)
    {
       const uint8_t *inp = input;
       for (w = 0; w < width; w++)
@@ -777,9 +876,9 @@ void conv_bgr24_rgb565(void *output_, const void *input_,
          uint16_t b = *inp++;
          uint16_t g = *inp++;
          uint16_t r = *inp++;
-    
+
          output[w] = ((r & 0x00F8) << 8) | ((g&0x00FC) << 3) | ((b&0x00F8) >> 3);
-      }  
+      }
    }
 }
 
@@ -787,14 +886,42 @@ void conv_argb8888_0rgb1555(void *output_, const void *input_,
       int width, int height,
       int out_stride, int in_stride)
 {
-   int h, w;
+   int h;
    const uint32_t *input = (const uint32_t*)input_;
    uint16_t *output      = (uint16_t*)output_;
 
+#if defined(__SSE2__)
+   const __m128i mask_r  = _mm_set1_epi32(0x7c00);
+   const __m128i mask_g  = _mm_set1_epi32(0x03e0);
+   const __m128i mask_b  = _mm_set1_epi32(0x001f);
+
+   int max_width         = width - 7;
+#endif
+
    for (h = 0; h < height;
          h++, output += out_stride >> 1, input += in_stride >> 2)
    {
-      for (w = 0; w < width; w++)
+      int w = 0;
+#if defined(__SSE2__)
+      for (; w < max_width; w += 8)
+      {
+         __m128i in0  = _mm_loadu_si128((const __m128i*)(input + w + 0));
+         __m128i in1  = _mm_loadu_si128((const __m128i*)(input + w + 4));
+         __m128i res0 = _mm_or_si128(
+               _mm_and_si128(_mm_srli_epi32(in0, 9), mask_r),
+               _mm_or_si128(_mm_and_si128(_mm_srli_epi32(in0, 6), mask_g),
+                  _mm_and_si128(_mm_srli_epi32(in0, 3), mask_b)));
+         __m128i res1 = _mm_or_si128(
+               _mm_and_si128(_mm_srli_epi32(in1, 9), mask_r),
+               _mm_or_si128(_mm_and_si128(_mm_srli_epi32(in1, 6), mask_g),
+                  _mm_and_si128(_mm_srli_epi32(in1, 3), mask_b)));
+
+         _mm_storeu_si128((__m128i*)(output + w),
+               conv_pack_u16_epi32(res0, res1));
+      }
+#endif
+
+      for (; w < width; w++)
       {
          uint32_t col = input[w];
          uint16_t r   = (col >> 19) & 0x1f;
@@ -805,6 +932,56 @@ void conv_argb8888_0rgb1555(void *output_, const void *input_,
    }
 }
 
+void conv_argb8888_rgb565(void *output_, const void *input_,
+      int width, int height,
+      int out_stride, int in_stride)
+{
+   int h;
+   const uint32_t *input = (const uint32_t*)input_;
+   uint16_t *output      = (uint16_t*)output_;
+
+#if defined(__SSE2__)
+   const __m128i mask_r  = _mm_set1_epi32(0xf800);
+   const __m128i mask_g  = _mm_set1_epi32(0x07e0);
+   const __m128i mask_b  = _mm_set1_epi32(0x001f);
+
+   int max_width         = width - 7;
+#endif
+
+   for (h = 0; h < height;
+         h++, output += out_stride >> 1, input += in_stride >> 2)
+   {
+      int w = 0;
+#if defined(__SSE2__)
+      for (; w < max_width; w += 8)
+      {
+         __m128i in0  = _mm_loadu_si128((const __m128i*)(input + w + 0));
+         __m128i in1  = _mm_loadu_si128((const __m128i*)(input + w + 4));
+         __m128i res0 = _mm_or_si128(
+               _mm_and_si128(_mm_srli_epi32(in0, 8), mask_r),
+               _mm_or_si128(_mm_and_si128(_mm_srli_epi32(in0, 5), mask_g),
+                  _mm_and_si128(_mm_srli_epi32(in0, 3), mask_b)));
+         __m128i res1 = _mm_or_si128(
+               _mm_and_si128(_mm_srli_epi32(in1, 8), mask_r),
+               _mm_or_si128(_mm_and_si128(_mm_srli_epi32(in1, 5), mask_g),
+                  _mm_and_si128(_mm_srli_epi32(in1, 3), mask_b)));
+
+         _mm_storeu_si128((__m128i*)(output + w),
+               conv_pack_u16_epi32(res0, res1));
+      }
+#endif
+
+      for (; w < width; w++)
+      {
+         uint32_t col = input[w];
+         uint16_t r   = (col >> 19) & 0x1f;
+         uint16_t g   = (col >> 10) & 0x3f;
+         uint16_t b   = (col >>  3) & 0x1f;
+         output[w]    = (r << 11) | (g << 5) | (b << 0);
+      }
+   }
+}
+
 void conv_argb8888_bgr24(void *output_, const void *input_,
       int width, int height,
       int out_stride, int in_stride)
@@ -813,7 +990,7 @@ void conv_argb8888_bgr24(void *output_, const void *input_,
    const uint32_t *input = (const uint32_t*)input_;
    uint8_t *output       = (uint8_t*)output_;
 
-#if defined(__SSE2__)
+#if defined(__SSE2__) || (defined(__ARM_NEON__) || defined(__ARM_NEON))
    int max_width = width - 15;
 #endif
 
@@ -831,6 +1008,17 @@ void conv_argb8888_bgr24(void *output_, const void *input_,
          __m128i l3 = _mm_loadu_si128((const __m128i*)(input + w + 12));
          store_bgr24_sse2(out, l0, l1, l2, l3);
       }
+#elif (defined(__ARM_NEON__) || defined(__ARM_NEON))
+      for (; w < max_width; w += 16, out += 48)
+      {
+         uint8x16x4_t in = vld4q_u8((const uint8_t*)(input + w));
+         uint8x16x3_t res;
+         res.val[0]      = in.val[0];
+         res.val[1]      = in.val[1];
+         res.val[2]      = in.val[2];
+
+         vst3q_u8(out, res);
+      }
 #endif
 
       for (; w < width; w++)
@@ -856,6 +1044,16 @@ static INLINE __m128i conv_shuffle_rb_epi32(__m128i c)
    __m128i rb = _mm_or_si128(sl, sr);
    return _mm_or_si128(g, rb);
 }
+
+/* As conv_shuffle_rb_epi32(), but keeps alpha */
+static INLINE __m128i conv_swap_rb_epi32(__m128i c)
+{
+   const __m128i rb_mask = _mm_set1_epi32(0x00ff00ff);
+   const __m128i ag_mask = _mm_set1_epi32((int)0xff00ff00);
+   __m128i rb = _mm_or_si128(_mm_slli_epi32(c, 16), _mm_srli_epi32(c, 16));
+   return _mm_or_si128(_mm_and_si128(rb, rb_mask),
+         _mm_and_si128(c, ag_mask));
+}
 #endif
 
 void conv_abgr8888_bgr24(void *output_, const void *input_,
@@ -866,7 +1064,7 @@ void conv_abgr8888_bgr24(void *output_, const void *input_,
    const uint32_t *input = (const uint32_t*)input_;
    uint8_t *output       = (uint8_t*)output_;
 
-#if defined(__SSE2__)
+#if defined(__SSE2__) || (defined(__ARM_NEON__) || defined(__ARM_NEON))
    int max_width = width - 15;
 #endif
 
@@ -878,16 +1076,27 @@ void conv_abgr8888_bgr24(void *output_, const void *input_,
 #if defined(__SSE2__)
       for (; w < max_width; w += 16, out += 48)
       {
-		 __m128i a = _mm_loadu_si128((const __m128i*)(input + w +  0));
-		 __m128i b = _mm_loadu_si128((const __m128i*)(input + w +  4));
-		 __m128i c = _mm_loadu_si128((const __m128i*)(input + w +  8));
-		 __m128i d = _mm_loadu_si128((const __m128i*)(input + w + 12));
+         __m128i a = _mm_loadu_si128((const __m128i*)(input + w +  0));
+         __m128i b = _mm_loadu_si128((const __m128i*)(input + w +  4));
+         __m128i c = _mm_loadu_si128((const __m128i*)(input + w +  8));
+         __m128i d = _mm_loadu_si128((const __m128i*)(input + w + 12));
          a = conv_shuffle_rb_epi32(a);
          b = conv_shuffle_rb_epi32(b);
          c = conv_shuffle_rb_epi32(c);
          d = conv_shuffle_rb_epi32(d);
          store_bgr24_sse2(out, a, b, c, d);
       }
+#elif (defined(__ARM_NEON__) || defined(__ARM_NEON))
+      for (; w < max_width; w += 16, out += 48)
+      {
+         uint8x16x4_t in = vld4q_u8((const uint8_t*)(input + w));
+         uint8x16x3_t res;
+         res.val[0]      = in.val[2];
+         res.val[1]      = in.val[1];
+         res.val[2]      = in.val[0];
+
+         vst3q_u8(out, res);
+      }
 #endif
 
       for (; w < width; w++)
@@ -904,14 +1113,43 @@ void conv_argb8888_abgr8888(void *output_, const void *input_,
       int width, int height,
       int out_stride, int in_stride)
 {
-   int h, w;
+   int h;
    const uint32_t *input = (const uint32_t*)input_;
    uint32_t *output      = (uint32_t*)output_;
 
+#if defined(__SSE2__) || (defined(__ARM_NEON__) || defined(__ARM_NEON))
+   int max_width         = width - 15;
+#endif
+
    for (h = 0; h < height;
          h++, output += out_stride >> 2, input += in_stride >> 2)
    {
-      for (w = 0; w < width; w++)
+      int w = 0;
+#if defined(__SSE2__)
+      for (; w < max_width; w += 16)
+      {
+         __m128i a = _mm_loadu_si128((const __m128i*)(input + w +  0));
+         __m128i b = _mm_loadu_si128((const __m128i*)(input + w +  4));
+         __m128i c = _mm_loadu_si128((const __m128i*)(input + w +  8));
+         __m128i d = _mm_loadu_si128((const __m128i*)(input + w + 12));
+         _mm_storeu_si128((__m128i*)(output + w +  0), conv_swap_rb_epi32(a));
+         _mm_storeu_si128((__m128i*)(output + w +  4), conv_swap_rb_epi32(b));
+         _mm_storeu_si128((__m128i*)(output + w +  8), conv_swap_rb_epi32(c));
+         _mm_storeu_si128((__m128i*)(output + w + 12), conv_swap_rb_epi32(d));
+      }
+#elif (defined(__ARM_NEON__) || defined(__ARM_NEON))
+      for (; w < max_width; w += 16)
+      {
+         uint8x16x4_t px = vld4q_u8((const uint8_t*)(input + w));
+         uint8x16_t   rb = px.val[0];
+         px.val[0]       = px.val[2];
+         px.val[2]       = rb;
+
+         vst4q_u8((uint8_t*)(output + w), px);
+      }
+#endif
+
+      for (; w < width; w++)
       {
          uint32_t col = input[w];
          output[w]    = ((col << 16) & 0xff0000) |
@@ -1081,3 +1319,739 @@ void conv_copy(void *output_, const void *input_,
          h++, output += out_stride, input += in_stride)
       memcpy(output, input, copy_len);
 }
+
+#ifdef SCALER_HAVE_AVX2
+/* AVX2 versions of the converters above, picked at
+ * runtime by pixconv_get(). They only convert whole
+ * blocks of pixels, and leave the rightmost columns
+ * of the image to the function they replace. */
+#define PIXCONV_AVX2_TAIL(func, x, out_bpp, in_bpp) \
+   if ((x) < width) \
+      func((uint8_t*)output_ + (x) * (out_bpp), \
+            (const uint8_t*)input_ + (x) * (in_bpp), \
+            width - (x), height, out_stride, in_stride)
+
+/* Interleaves 16 pixels of 16-bit R, G and B values
+ * (0 - 255) with an opaque alpha channel. The first 8
+ * pixels are returned in 'lo', the next 8 in 'hi'. */
+static INLINE PIXCONV_AVX2 void conv_interleave_argb8888_avx2(
+      __m256i *lo, __m256i *hi, __m256i r, __m256i g, __m256i b)
+{
+   const __m256i a = _mm256_set1_epi16(0x00ff);
+   __m256i res_lo  = _mm256_or_si256(_mm256_unpacklo_epi8(b, g),
+         _mm256_slli_si256(_mm256_unpacklo_epi8(r, a), 2));
+   __m256i res_hi  = _mm256_or_si256(_mm256_unpackhi_epi8(b, g),
+         _mm256_slli_si256(_mm256_unpackhi_epi8(r, a), 2));
+
+   /* Unpacking works within 128-bit lanes,
+    * put the pixels back in order */
+   *lo             = _mm256_permute2x128_si256(res_lo, res_hi, 0x20);
+   *hi             = _mm256_permute2x128_si256(res_lo, res_hi, 0x31);
+}
+
+/* Picks three bytes out of each of 8 32-bit pixels with
+ * 'shuf', and stores them packed. Writes 32 bytes, of
+ * which only the first 24 are meaningful. */
+static INLINE PIXCONV_AVX2 void conv_store_bgr24_avx2(uint8_t *out,
+      __m256i c, __m256i shuf)
+{
+   const __m256i perm = _mm256_setr_epi32(0, 1, 2, 4, 5, 6, 3, 7);
+   _mm256_storeu_si256((__m256i*)out,
+         _mm256_permutevar8x32_epi32(_mm256_shuffle_epi8(c, shuf), perm));
+}
+
+/* AVX2 counterpart of conv_pack_u16_epi32() */
+static INLINE PIXCONV_AVX2 __m256i conv_pack_u16_epi32_avx2(
+      __m256i a, __m256i b)
+{
+   a = _mm256_srai_epi32(_mm256_slli_epi32(a, 16), 16);
+   b = _mm256_srai_epi32(_mm256_slli_epi32(b, 16), 16);
+   return _mm256_permute4x64_epi64(_mm256_packs_epi32(a, b), 0xd8);
+}
+
+static INLINE PIXCONV_AVX2 void conv_unpack_0rgb1555_avx2(__m256i in,
+      __m256i *r, __m256i *g, __m256i *b)
+{
+   const __m256i pix_mask_r  = _mm256_set1_epi16(0x1f << 10);
+   const __m256i pix_mask_gb = _mm256_set1_epi16(0x1f <<  5);
+   const __m256i mul15_mid   = _mm256_set1_epi16(0x4200);
+   const __m256i mul15_hi    = _mm256_set1_epi16(0x0210);
+
+   *r = _mm256_mulhi_epi16(_mm256_and_si256(in, pix_mask_r), mul15_hi);
+   *g = _mm256_mulhi_epi16(_mm256_and_si256(in, pix_mask_gb), mul15_mid);
+   *b = _mm256_mulhi_epi16(_mm256_and_si256(
+            _mm256_slli_epi16(in, 5), pix_mask_gb), mul15_mid);
+}
+
+static INLINE PIXCONV_AVX2 void conv_unpack_rgb565_avx2(__m256i in,
+      __m256i *r, __m256i *g, __m256i *b)
+{
+   const __m256i pix_mask_r = _mm256_set1_epi16(0x1f << 10);
+   const __m256i pix_mask_g = _mm256_set1_epi16(0x3f <<  5);
+   const __m256i pix_mask_b = _mm256_set1_epi16(0x1f <<  5);
+   const __m256i mul16_r    = _mm256_set1_epi16(0x0210);
+   const __m256i mul16_g    = _mm256_set1_epi16(0x2080);
+   const __m256i mul16_b    = _mm256_set1_epi16(0x4200);
+
+   *r = _mm256_mulhi_epi16(_mm256_and_si256(
+            _mm256_srli_epi16(in, 1), pix_mask_r), mul16_r);
+   *g = _mm256_mulhi_epi16(_mm256_and_si256(in, pix_mask_g), mul16_g);
+   *b = _mm256_mulhi_epi16(_mm256_and_si256(
+            _mm256_slli_epi16(in, 5), pix_mask_b), mul16_b);
+}
+
+static PIXCONV_AVX2 void conv_rgb565_0rgb1555_avx2(void *output_,
+      const void *input_, int width, int height,
+      int out_stride, int in_stride)
+{
+   int h;
+   const uint16_t *input = (const uint16_t*)input_;
+   uint16_t *output      = (uint16_t*)output_;
+   const __m256i hi_mask = _mm256_set1_epi16(0x7fe0);
+   const __m256i lo_mask = _mm256_set1_epi16(0x1f);
+   int vec_width         = width & ~15;
+
+   for (h = 0; h < height;
+         h++, output += out_stride >> 1, input += in_stride >> 1)
+   {
+      int w;
+      for (w = 0; w < vec_width; w += 16)
+      {
+         const __m256i in = _mm256_loadu_si256((const __m256i*)(input + w));
+         __m256i hi       = _mm256_and_si256(_mm256_srli_epi16(in, 1), hi_mask);
+         __m256i lo       = _mm256_and_si256(in, lo_mask);
+         _mm256_storeu_si256((__m256i*)(output + w), _mm256_or_si256(hi, lo));
+      }
+   }
+
+   PIXCONV_AVX2_TAIL(conv_rgb565_0rgb1555, vec_width, 2, 2);
+}
+
+static PIXCONV_AVX2 void conv_0rgb1555_rgb565_avx2(void *output_,
+      const void *input_, int width, int height,
+      int out_stride, int in_stride)
+{
+   int h;
+   const uint16_t *input   = (const uint16_t*)input_;
+   uint16_t *output        = (uint16_t*)output_;
+   const __m256i hi_mask   = _mm256_set1_epi16(
+         (int16_t)((0x1f << 11) | (0x1f << 6)));
+   const __m256i lo_mask   = _mm256_set1_epi16(0x1f);
+   const __m256i glow_mask = _mm256_set1_epi16(1 << 5);
+   int vec_width           = width & ~15;
+
+   for (h = 0; h < height;
+         h++, output += out_stride >> 1, input += in_stride >> 1)
+   {
+      int w;
+      for (w = 0; w < vec_width; w += 16)
+      {
+         const __m256i in = _mm256_loadu_si256((const __m256i*)(input + w));
+         __m256i rg       = _mm256_and_si256(_mm256_slli_epi16(in, 1), hi_mask);
+         __m256i b        = _mm256_and_si256(in, lo_mask);
+         __m256i glow     = _mm256_and_si256(_mm256_srli_epi16(in, 4), glow_mask);
+         _mm256_storeu_si256((__m256i*)(output + w),
+               _mm256_or_si256(rg, _mm256_or_si256(b, glow)));
+      }
+   }
+
+   PIXCONV_AVX2_TAIL(conv_0rgb1555_rgb565, vec_width, 2, 2);
+}
+
+static PIXCONV_AVX2 void conv_0rgb1555_argb8888_avx2(void *output_,
+      const void *input_, int width, int height,
+      int out_stride, int in_stride)
+{
+   int h;
+   const uint16_t *input = (const uint16_t*)input_;
+   uint32_t *output      = (uint32_t*)output_;
+   int vec_width         = width & ~15;
+
+   for (h = 0; h < height;
+         h++, output += out_stride >> 2, input += in_stride >> 1)
+   {
+      int w;
+      for (w = 0; w < vec_width; w += 16)
+      {
+         __m256i r, g, b, lo, hi;
+         conv_unpack_0rgb1555_avx2(
+               _mm256_loadu_si256((const __m256i*)(input + w)), &r, &g, &b);
+         conv_interleave_argb8888_avx2(&lo, &hi, r, g, b);
+         _mm256_storeu_si256((__m256i*)(output + w + 0), lo);
+         _mm256_storeu_si256((__m256i*)(output + w + 8), hi);
+      }
+   }
+
+   PIXCONV_AVX2_TAIL(conv_0rgb1555_argb8888, vec_width, 4, 2);
+}
+
+static PIXCONV_AVX2 void conv_rgb565_argb8888_avx2(void *output_,
+      const void *input_, int width, int height,
+      int out_stride, int in_stride)
+{
+   int h;
+   const uint16_t *input = (const uint16_t*)input_;
+   uint32_t *output      = (uint32_t*)output_;
+   int vec_width         = width & ~15;
+
+   for (h = 0; h < height;
+         h++, output += out_stride >> 2, input += in_stride >> 1)
+   {
+      int w;
+      for (w = 0; w < vec_width; w += 16)
+      {
+         __m256i r, g, b, lo, hi;
+         conv_unpack_rgb565_avx2(
+               _mm256_loadu_si256((const __m256i*)(input + w)), &r, &g, &b);
+         conv_interleave_argb8888_avx2(&lo, &hi, r, g, b);
+         _mm256_storeu_si256((__m256i*)(output + w + 0), lo);
+         _mm256_storeu_si256((__m256i*)(output + w + 8), hi);
+      }
+   }
+
+   PIXCONV_AVX2_TAIL(conv_rgb565_argb8888, vec_width, 4, 2);
+}
+
+static PIXCONV_AVX2 void conv_rgb565_abgr8888_avx2(void *output_,
+      const void *input_, int width, int height,
+      int out_stride, int in_stride)
+{
+   int h;
+   const uint16_t *input = (const uint16_t*)input_;
+   uint32_t *output      = (uint32_t*)output_;
+   int vec_width         = width & ~15;
+
+   for (h = 0; h < height;
+         h++, output += out_stride >> 2, input += in_stride >> 1)
+   {
+      int w;
+      for (w = 0; w < vec_width; w += 16)
+      {
+         __m256i r, g, b, lo, hi;
+         conv_unpack_rgb565_avx2(
+               _mm256_loadu_si256((const __m256i*)(input + w)), &r, &g, &b);
+         conv_interleave_argb8888_avx2(&lo, &hi, b, g, r);
+         _mm256_storeu_si256((__m256i*)(output + w + 0), lo);
+         _mm256_storeu_si256((__m256i*)(output + w + 8), hi);
+      }
+   }
+
+   PIXCONV_AVX2_TAIL(conv_rgb565_abgr8888, vec_width, 4, 2);
+}
+
+static PIXCONV_AVX2 void conv_0rgb1555_bgr24_avx2(void *output_,
+      const void *input_, int width, int height,
+      int out_stride, int in_stride)
+{
+   int h;
+   const uint16_t *input = (const uint16_t*)input_;
+   uint8_t *output       = (uint8_t*)output_;
+   const __m256i shuf    = _mm256_setr_epi8(
+          0,  1,  2,  4,  5,  6,  8,  9, 10, 12, 13, 14, -1, -1, -1, -1,
+          0,  1,  2,  4,  5,  6,  8,  9, 10, 12, 13, 14, -1, -1, -1, -1);
+   /* The last store spills 8 bytes, which must still
+    * land within this line */
+   int vec_width         = width > 3 ? (width - 3) & ~15 : 0;
+
+   for (h = 0; h < height;
+         h++, output += out_stride, input += in_stride >> 1)
+   {
+      int w;
+      uint8_t *out = output;
+      for (w = 0; w < vec_width; w += 16, out += 48)
+      {
+         __m256i r, g, b, lo, hi;
+         conv_unpack_0rgb1555_avx2(
+               _mm256_loadu_si256((const __m256i*)(input + w)), &r, &g, &b);
+         conv_interleave_argb8888_avx2(&lo, &hi, r, g, b);
+         conv_store_bgr24_avx2(out +  0, lo, shuf);
+         conv_store_bgr24_avx2(out + 24, hi, shuf);
+      }
+   }
+
+   PIXCONV_AVX2_TAIL(conv_0rgb1555_bgr24, vec_width, 3, 2);
+}
+
+static PIXCONV_AVX2 void conv_rgb565_bgr24_avx2(void *output_,
+      const void *input_, int width, int height,
+      int out_stride, int in_stride)
+{
+   int h;
+   const uint16_t *input = (const uint16_t*)input_;
+   uint8_t *output       = (uint8_t*)output_;
+   const __m256i shuf    = _mm256_setr_epi8(
+          0,  1,  2,  4,  5,  6,  8,  9, 10, 12, 13, 14, -1, -1, -1, -1,
+          0,  1,  2,  4,  5,  6,  8,  9, 10, 12, 13, 14, -1, -1, -1, -1);
+   int vec_width         = width > 3 ? (width - 3) & ~15 : 0;
+
+   for (h = 0; h < height;
+         h++, output += out_stride, input += in_stride >> 1)
+   {
+      int w;
+      uint8_t *out = output;
+      for (w = 0; w < vec_width; w += 16, out += 48)
+      {
+         __m256i r, g, b, lo, hi;
+         conv_unpack_rgb565_avx2(
+               _mm256_loadu_si256((const __m256i*)(input + w)), &r, &g, &b);
+         conv_interleave_argb8888_avx2(&lo, &hi, r, g, b);
+         conv_store_bgr24_avx2(out +  0, lo, shuf);
+         conv_store_bgr24_avx2(out + 24, hi, shuf);
+      }
+   }
+
+   PIXCONV_AVX2_TAIL(conv_rgb565_bgr24, vec_width, 3, 2);
+}
+
+static PIXCONV_AVX2 void conv_rgba4444_argb8888_avx2(void *output_,
+      const void *input_, int width, int height,
+      int out_stride, int in_stride)
+{
+   int h;
+   const uint16_t *input = (const uint16_t*)input_;
+   uint32_t *output      = (uint32_t*)output_;
+   const __m256i mask_hi = _mm256_set1_epi16((int16_t)0xf0f0);
+   const __m256i mask_lo = _mm256_set1_epi16(0x0f0f);
+   int vec_width         = width & ~15;
+
+   for (h = 0; h < height;
+         h++, output += out_stride >> 2, input += in_stride >> 1)
+   {
+      int w;
+      for (w = 0; w < vec_width; w += 16)
+      {
+         __m256i lo, hi;
+         const __m256i in = _mm256_loadu_si256((const __m256i*)(input + w));
+         __m256i br       = _mm256_and_si256(in, mask_hi);
+         __m256i ag       = _mm256_and_si256(in, mask_lo);
+         br               = _mm256_or_si256(br, _mm256_srli_epi16(br, 4));
+         ag               = _mm256_or_si256(ag, _mm256_slli_epi16(ag, 4));
+         ag               = _mm256_or_si256(_mm256_srli_epi16(ag, 8),
+               _mm256_slli_epi16(ag, 8));
+         lo               = _mm256_unpacklo_epi8(br, ag);
+         hi               = _mm256_unpackhi_epi8(br, ag);
+
+         _mm256_storeu_si256((__m256i*)(output + w + 0),
+               _mm256_permute2x128_si256(lo, hi, 0x20));
+         _mm256_storeu_si256((__m256i*)(output + w + 8),
+               _mm256_permute2x128_si256(lo, hi, 0x31));
+      }
+   }
+
+   PIXCONV_AVX2_TAIL(conv_rgba4444_argb8888, vec_width, 4, 2);
+}
+
+static PIXCONV_AVX2 void conv_bgr24_argb8888_avx2(void *output_,
+      const void *input_, int width, int height,
+      int out_stride, int in_stride)
+{
+   int h;
+   const uint8_t *input  = (const uint8_t*)input_;
+   uint32_t *output      = (uint32_t*)output_;
+   /* Moves pixels 4 - 7 into the upper lane */
+   const __m256i perm    = _mm256_setr_epi32(0, 1, 2, 3, 3, 4, 5, 6);
+   const __m256i shuf    = _mm256_setr_epi8(
+          0,  1,  2, -1,  3,  4,  5, -1,  6,  7,  8, -1,  9, 10, 11, -1,
+          0,  1,  2, -1,  3,  4,  5, -1,  6,  7,  8, -1,  9, 10, 11, -1);
+   const __m256i a       = _mm256_set1_epi32((int)0xff000000);
+   /* Each load reads 8 bytes past the pixels it converts,
+    * which must still be part of this line */
+   int vec_width         = width > 3 ? (width - 3) & ~7 : 0;
+
+   for (h = 0; h < height;
+         h++, output += out_stride >> 2, input += in_stride)
+   {
+      int w;
+      const uint8_t *inp = input;
+      for (w = 0; w < vec_width; w += 8, inp += 24)
+      {
+         __m256i in = _mm256_loadu_si256((const __m256i*)inp);
+         in         = _mm256_shuffle_epi8(
+               _mm256_permutevar8x32_epi32(in, perm), shuf);
+         _mm256_storeu_si256((__m256i*)(output + w), _mm256_or_si256(in, a));
+      }
+   }
+
+   PIXCONV_AVX2_TAIL(conv_bgr24_argb8888, vec_width, 4, 3);
+}
+
+static PIXCONV_AVX2 void conv_argb8888_0rgb1555_avx2(void *output_,
+      const void *input_, int width, int height,
+      int out_stride, int in_stride)
+{
+   int h;
+   const uint32_t *input = (const uint32_t*)input_;
+   uint16_t *output      = (uint16_t*)output_;
+   const __m256i mask_r  = _mm256_set1_epi32(0x7c00);
+   const __m256i mask_g  = _mm256_set1_epi32(0x03e0);
+   const __m256i mask_b  = _mm256_set1_epi32(0x001f);
+   int vec_width         = width & ~15;
+
+   for (h = 0; h < height;
+         h++, output += out_stride >> 1, input += in_stride >> 2)
+   {
+      int w;
+      for (w = 0; w < vec_width; w += 16)
+      {
+         __m256i in0  = _mm256_loadu_si256((const __m256i*)(input + w + 0));
+         __m256i in1  = _mm256_loadu_si256((const __m256i*)(input + w + 8));
+         __m256i res0 = _mm256_or_si256(
+               _mm256_and_si256(_mm256_srli_epi32(in0, 9), mask_r),
+               _mm256_or_si256(_mm256_and_si256(_mm256_srli_epi32(in0, 6), mask_g),
+                  _mm256_and_si256(_mm256_srli_epi32(in0, 3), mask_b)));
+         __m256i res1 = _mm256_or_si256(
+               _mm256_and_si256(_mm256_srli_epi32(in1, 9), mask_r),
+               _mm256_or_si256(_mm256_and_si256(_mm256_srli_epi32(in1, 6), mask_g),
+                  _mm256_and_si256(_mm256_srli_epi32(in1, 3), mask_b)));
+
+         _mm256_storeu_si256((__m256i*)(output + w),
+               conv_pack_u16_epi32_avx2(res0, res1));
+      }
+   }
+
+   PIXCONV_AVX2_TAIL(conv_argb8888_0rgb1555, vec_width, 2, 4);
+}
+
+static PIXCONV_AVX2 void conv_argb8888_rgb565_avx2(void *output_,
+      const void *input_, int width, int height,
+      int out_stride, int in_stride)
+{
+   int h;
+   const uint32_t *input = (const uint32_t*)input_;
+   uint16_t *output      = (uint16_t*)output_;
+   const __m256i mask_r  = _mm256_set1_epi32(0xf800);
+   const __m256i mask_g  = _mm256_set1_epi32(0x07e0);
+   const __m256i mask_b  = _mm256_set1_epi32(0x001f);
+   int vec_width         = width & ~15;
+
+   for (h = 0; h < height;
+         h++, output += out_stride >> 1, input += in_stride >> 2)
+   {
+      int w;
+      for (w = 0; w < vec_width; w += 16)
+      {
+         __m256i in0  = _mm256_loadu_si256((const __m256i*)(input + w + 0));
+         __m256i in1  = _mm256_loadu_si256((const __m256i*)(input + w + 8));
+         __m256i res0 = _mm256_or_si256(
+               _mm256_and_si256(_mm256_srli_epi32(in0, 8), mask_r),
+               _mm256_or_si256(_mm256_and_si256(_mm256_srli_epi32(in0, 5), mask_g),
+                  _mm256_and_si256(_mm256_srli_epi32(in0, 3), mask_b)));
+         __m256i res1 = _mm256_or_si256(
+               _mm256_and_si256(_mm256_srli_epi32(in1, 8), mask_r),
+               _mm256_or_si256(_mm256_and_si256(_mm256_srli_epi32(in1, 5), mask_g),
+                  _mm256_and_si256(_mm256_srli_epi32(in1, 3), mask_b)));
+
+         _mm256_storeu_si256((__m256i*)(output + w),
+               conv_pack_u16_epi32_avx2(res0, res1));
+      }
+   }
+
+   PIXCONV_AVX2_TAIL(conv_argb8888_rgb565, vec_width, 2, 4);
+}
+
+static PIXCONV_AVX2 void conv_argb8888_rgba4444_avx2(void *output_,
+      const void *input_, int width, int height,
+      int out_stride, int in_stride)
+{
+   int h;
+   const uint32_t *input = (const uint32_t*)input_;
+   uint16_t *output      = (uint16_t*)output_;
+   const __m256i mask_r  = _mm256_set1_epi32(0xf000);
+   const __m256i mask_g  = _mm256_set1_epi32(0x0f00);
+   const __m256i mask_b  = _mm256_set1_epi32(0x00f0);
+   int vec_width         = width & ~15;
+
+   for (h = 0; h < height;
+         h++, output += out_stride >> 1, input += in_stride >> 2)
+   {
+      int w;
+      for (w = 0; w < vec_width; w += 16)
+      {
+         __m256i in0  = _mm256_loadu_si256((const __m256i*)(input + w + 0));
+         __m256i in1  = _mm256_loadu_si256((const __m256i*)(input + w + 8));
+         __m256i res0 = _mm256_or_si256(
+               _mm256_or_si256(_mm256_and_si256(_mm256_srli_epi32(in0, 8), mask_r),
+                  _mm256_and_si256(_mm256_srli_epi32(in0, 4), mask_g)),
+               _mm256_or_si256(_mm256_and_si256(in0, mask_b),
+                  _mm256_srli_epi32(in0, 28)));
+         __m256i res1 = _mm256_or_si256(
+               _mm256_or_si256(_mm256_and_si256(_mm256_srli_epi32(in1, 8), mask_r),
+                  _mm256_and_si256(_mm256_srli_epi32(in1, 4), mask_g)),
+               _mm256_or_si256(_mm256_and_si256(in1, mask_b),
+                  _mm256_srli_epi32(in1, 28)));
+
+         _mm256_storeu_si256((__m256i*)(output + w),
+               conv_pack_u16_epi32_avx2(res0, res1));
+      }
+   }
+
+   PIXCONV_AVX2_TAIL(conv_argb8888_rgba4444, vec_width, 2, 4);
+}
+
+static PIXCONV_AVX2 void conv_argb8888_bgr24_avx2(void *output_,
+      const void *input_, int width, int height,
+      int out_stride, int in_stride)
+{
+   int h;
+   const uint32_t *input = (const uint32_t*)input_;
+   uint8_t *output       = (uint8_t*)output_;
+   const __m256i shuf    = _mm256_setr_epi8(
+          0,  1,  2,  4,  5,  6,  8,  9, 10, 12, 13, 14, -1, -1, -1, -1,
+          0,  1,  2,  4,  5,  6,  8,  9, 10, 12, 13, 14, -1, -1, -1, -1);
+   int vec_width         = width > 3 ? (width - 3) & ~7 : 0;
+
+   for (h = 0; h < height;
+         h++, output += out_stride, input += in_stride >> 2)
+   {
+      int w;
+      uint8_t *out = output;
+      for (w = 0; w < vec_width; w += 8, out += 24)
+         conv_store_bgr24_avx2(out,
+               _mm256_loadu_si256((const __m256i*)(input + w)), shuf);
+   }
+
+   PIXCONV_AVX2_TAIL(conv_argb8888_bgr24, vec_width, 3, 4);
+}
+
+static PIXCONV_AVX2 void conv_abgr8888_bgr24_avx2(void *output_,
+      const void *input_, int width, int height,
+      int out_stride, int in_stride)
+{
+   int h;
+   const uint32_t *input = (const uint32_t*)input_;
+   uint8_t *output       = (uint8_t*)output_;
+   const __m256i shuf    = _mm256_setr_epi8(
+          2,  1,  0,  6,  5,  4, 10,  9,  8, 14, 13, 12, -1, -1, -1, -1,
+          2,  1,  0,  6,  5,  4, 10,  9,  8, 14, 13, 12, -1, -1, -1, -1);
+   int vec_width         = width > 3 ? (width - 3) & ~7 : 0;
+
+   for (h = 0; h < height;
+         h++, output += out_stride, input += in_stride >> 2)
+   {
+      int w;
+      uint8_t *out = output;
+      for (w = 0; w < vec_width; w += 8, out += 24)
+         conv_store_bgr24_avx2(out,
+               _mm256_loadu_si256((const __m256i*)(input + w)), shuf);
+   }
+
+   PIXCONV_AVX2_TAIL(conv_abgr8888_bgr24, vec_width, 3, 4);
+}
+
+static PIXCONV_AVX2 void conv_argb8888_abgr8888_avx2(void *output_,
+      const void *input_, int width, int height,
+      int out_stride, int in_stride)
+{
+   int h;
+   const uint32_t *input = (const uint32_t*)input_;
+   uint32_t *output      = (uint32_t*)output_;
+   const __m256i shuf    = _mm256_setr_epi8(
+          2,  1,  0,  3,  6,  5,  4,  7, 10,  9,  8, 11, 14, 13, 12, 15,
+          2,  1,  0,  3,  6,  5,  4,  7, 10,  9,  8, 11, 14, 13, 12, 15);
+   int vec_width         = width & ~15;
+
+   for (h = 0; h < height;
+         h++, output += out_stride >> 2, input += in_stride >> 2)
+   {
+      int w;
+      for (w = 0; w < vec_width; w += 16)
+      {
+         __m256i a = _mm256_loadu_si256((const __m256i*)(input + w + 0));
+         __m256i b = _mm256_loadu_si256((const __m256i*)(input + w + 8));
+         _mm256_storeu_si256((__m256i*)(output + w + 0),
+               _mm256_shuffle_epi8(a, shuf));
+         _mm256_storeu_si256((__m256i*)(output + w + 8),
+               _mm256_shuffle_epi8(b, shuf));
+      }
+   }
+
+   PIXCONV_AVX2_TAIL(conv_argb8888_abgr8888, vec_width, 4, 4);
+}
+
+static PIXCONV_AVX2 void conv_yuyv_argb8888_avx2(void *output_,
+      const void *input_, int width, int height,
+      int out_stride, int in_stride)
+{
+   int h;
+   const uint8_t *input        = (const uint8_t*)input_;
+   uint32_t *output            = (uint32_t*)output_;
+   const __m256i mask_y        = _mm256_set1_epi16(0xffu);
+   const __m256i mask_u        = _mm256_set1_epi32(0xffu << 8);
+   const __m256i mask_v        = _mm256_set1_epi32(0xffu << 24);
+   const __m256i chroma_offset = _mm256_set1_epi16(128);
+   const __m256i round_offset  = _mm256_set1_epi16(YUV_OFFSET);
+   const __m256i yuv_mul       = _mm256_set1_epi16(YUV_MAT_Y);
+   const __m256i u_g_mul       = _mm256_set1_epi16(YUV_MAT_U_G);
+   const __m256i u_b_mul       = _mm256_set1_epi16(YUV_MAT_U_B);
+   const __m256i v_r_mul       = _mm256_set1_epi16(YUV_MAT_V_R);
+   const __m256i v_g_mul       = _mm256_set1_epi16(YUV_MAT_V_G);
+   const __m256i a             = _mm256_set1_epi16(-1);
+   int vec_width               = width & ~31;
+
+   for (h = 0; h < height; h++, output += out_stride >> 2, input += in_stride)
+   {
+      int w;
+      const uint8_t *src = input;
+      uint32_t      *dst = output;
+
+      /* Same as the SSE2 version, but with 32 pixels per
+       * loop. Since packing and unpacking stay within each
+       * 128-bit lane, '_y0' and 'u0'/'v0' hold pixels 0 - 7
+       * and 8 - 15, and '_y1', 'u1' and 'v1' pixels 16 - 23
+       * and 24 - 31. */
+      for (w = 0; w < vec_width; w += 32, src += 64, dst += 32)
+      {
+         __m256i u, v, u0_g, u1_g, u0_b, u1_b, v0_r, v1_r, v0_g, v1_g,
+                 r0, g0, b0, r1, g1, b1;
+         __m256i res_lo_bg, res_hi_bg, res_lo_ra, res_hi_ra;
+         __m256i res0, res1, res2, res3;
+         __m256i yuv0 = _mm256_loadu_si256((const __m256i*)(src +  0));
+         __m256i yuv1 = _mm256_loadu_si256((const __m256i*)(src + 32));
+         __m256i _y0  = _mm256_and_si256(yuv0, mask_y);
+         __m256i u0   = _mm256_and_si256(yuv0, mask_u);
+         __m256i v0   = _mm256_and_si256(yuv0, mask_v);
+         __m256i _y1  = _mm256_and_si256(yuv1, mask_y);
+         __m256i u1   = _mm256_and_si256(yuv1, mask_u);
+         __m256i v1   = _mm256_and_si256(yuv1, mask_v);
+
+         u0   = _mm256_srli_si256(u0, 1);
+         v0   = _mm256_srli_si256(v0, 3);
+         u1   = _mm256_srli_si256(u1, 1);
+         v1   = _mm256_srli_si256(v1, 3);
+         u    = _mm256_packs_epi32(u0, u1);
+         v    = _mm256_packs_epi32(v0, v1);
+
+         u    = _mm256_sub_epi16(u, chroma_offset);
+         v    = _mm256_sub_epi16(v, chroma_offset);
+
+         u0   = _mm256_unpacklo_epi16(u, u);
+         u1   = _mm256_unpackhi_epi16(u, u);
+         v0   = _mm256_unpacklo_epi16(v, v);
+         v1   = _mm256_unpackhi_epi16(v, v);
+
+         _y0  = _mm256_mullo_epi16(_y0, yuv_mul);
+         _y1  = _mm256_mullo_epi16(_y1, yuv_mul);
+         u0_g = _mm256_mullo_epi16(u0, u_g_mul);
+         u1_g = _mm256_mullo_epi16(u1, u_g_mul);
+         u0_b = _mm256_mullo_epi16(u0, u_b_mul);
+         u1_b = _mm256_mullo_epi16(u1, u_b_mul);
+         v0_r = _mm256_mullo_epi16(v0, v_r_mul);
+         v1_r = _mm256_mullo_epi16(v1, v_r_mul);
+         v0_g = _mm256_mullo_epi16(v0, v_g_mul);
+         v1_g = _mm256_mullo_epi16(v1, v_g_mul);
+
+         r0   = _mm256_srai_epi16(_mm256_adds_epi16(
+                  _mm256_adds_epi16(_y0, v0_r), round_offset), YUV_SHIFT);
+         g0   = _mm256_srai_epi16(_mm256_adds_epi16(_mm256_adds_epi16(
+                  _mm256_adds_epi16(_y0, v0_g), u0_g), round_offset), YUV_SHIFT);
+         b0   = _mm256_srai_epi16(_mm256_adds_epi16(
+                  _mm256_adds_epi16(_y0, u0_b), round_offset), YUV_SHIFT);
+         r1   = _mm256_srai_epi16(_mm256_adds_epi16(
+                  _mm256_adds_epi16(_y1, v1_r), round_offset), YUV_SHIFT);
+         g1   = _mm256_srai_epi16(_mm256_adds_epi16(_mm256_adds_epi16(
+                  _mm256_adds_epi16(_y1, v1_g), u1_g), round_offset), YUV_SHIFT);
+         b1   = _mm256_srai_epi16(_mm256_adds_epi16(
+                  _mm256_adds_epi16(_y1, u1_b), round_offset), YUV_SHIFT);
+
+         /* Lane 0 now holds pixels 0 - 7 and 16 - 23,
+          * lane 1 pixels 8 - 15 and 24 - 31 */
+         r0   = _mm256_packus_epi16(r0, r1);
+         g0   = _mm256_packus_epi16(g0, g1);
+         b0   = _mm256_packus_epi16(b0, b1);
+
+         res_lo_bg = _mm256_unpacklo_epi8(b0, g0);
+         res_hi_bg = _mm256_unpackhi_epi8(b0, g0);
+         res_lo_ra = _mm256_unpacklo_epi8(r0, a);
+         res_hi_ra = _mm256_unpackhi_epi8(r0, a);
+         res0      = _mm256_unpacklo_epi16(res_lo_bg, res_lo_ra);
+         res1      = _mm256_unpackhi_epi16(res_lo_bg, res_lo_ra);
+         res2      = _mm256_unpacklo_epi16(res_hi_bg, res_hi_ra);
+         res3      = _mm256_unpackhi_epi16(res_hi_bg, res_hi_ra);
+
+         _mm256_storeu_si256((__m256i*)(dst +  0),
+               _mm256_permute2x128_si256(res0, res1, 0x20));
+         _mm256_storeu_si256((__m256i*)(dst +  8),
+               _mm256_permute2x128_si256(res0, res1, 0x31));
+         _mm256_storeu_si256((__m256i*)(dst + 16),
+               _mm256_permute2x128_si256(res2, res3, 0x20));
+         _mm256_storeu_si256((__m256i*)(dst + 24),
+               _mm256_permute2x128_si256(res2, res3, 0x31));
+      }
+   }
+
+   PIXCONV_AVX2_TAIL(conv_yuyv_argb8888, vec_width, 4, 2);
+}
+
+#define PIXCONV_ENTRY(in_fmt, out_fmt, func) \
+   { func, func##_avx2, in_fmt, out_fmt }
+#else
+#define PIXCONV_ENTRY(in_fmt, out_fmt, func) \
+   { func, NULL, in_fmt, out_fmt }
+#endif
+
+struct pixconv_entry
+{
+   pixconv_func_t func;
+   pixconv_func_t func_avx2;
+   enum scaler_pix_fmt in_fmt;
+   enum scaler_pix_fmt out_fmt;
+};
+
+static const struct pixconv_entry pixconv_entries[] = {
+   PIXCONV_ENTRY(SCALER_FMT_0RGB1555, SCALER_FMT_ARGB8888, conv_0rgb1555_argb8888),
+   PIXCONV_ENTRY(SCALER_FMT_0RGB1555, SCALER_FMT_RGB565,   conv_0rgb1555_rgb565),
+   PIXCONV_ENTRY(SCALER_FMT_0RGB1555, SCALER_FMT_BGR24,    conv_0rgb1555_bgr24),
+   PIXCONV_ENTRY(SCALER_FMT_RGB565,   SCALER_FMT_ARGB8888, conv_rgb565_argb8888),
+   PIXCONV_ENTRY(SCALER_FMT_RGB565,   SCALER_FMT_ABGR8888, conv_rgb565_abgr8888),
+   PIXCONV_ENTRY(SCALER_FMT_RGB565,   SCALER_FMT_BGR24,    conv_rgb565_bgr24),
+   PIXCONV_ENTRY(SCALER_FMT_RGB565,   SCALER_FMT_0RGB1555, conv_rgb565_0rgb1555),
+   PIXCONV_ENTRY(SCALER_FMT_BGR24,    SCALER_FMT_ARGB8888, conv_bgr24_argb8888),
+   { conv_bgr24_rgb565, NULL, SCALER_FMT_BGR24, SCALER_FMT_RGB565 },
+   PIXCONV_ENTRY(SCALER_FMT_ARGB8888, SCALER_FMT_0RGB1555, conv_argb8888_0rgb1555),
+   PIXCONV_ENTRY(SCALER_FMT_ARGB8888, SCALER_FMT_RGB565,   conv_argb8888_rgb565),
+   PIXCONV_ENTRY(SCALER_FMT_ARGB8888, SCALER_FMT_RGBA4444, conv_argb8888_rgba4444),
+   PIXCONV_ENTRY(SCALER_FMT_ARGB8888, SCALER_FMT_BGR24,    conv_argb8888_bgr24),
+   PIXCONV_ENTRY(SCALER_FMT_ARGB8888, SCALER_FMT_ABGR8888, conv_argb8888_abgr8888),
+   /* Swapping R and B works both ways */
+   PIXCONV_ENTRY(SCALER_FMT_ABGR8888, SCALER_FMT_ARGB8888, conv_argb8888_abgr8888),
+   PIXCONV_ENTRY(SCALER_FMT_ABGR8888, SCALER_FMT_BGR24,    conv_abgr8888_bgr24),
+   PIXCONV_ENTRY(SCALER_FMT_YUYV,     SCALER_FMT_ARGB8888, conv_yuyv_argb8888),
+   PIXCONV_ENTRY(SCALER_FMT_RGBA4444, SCALER_FMT_ARGB8888, conv_rgba4444_argb8888),
+   { conv_rgba4444_rgb565, NULL, SCALER_FMT_RGBA4444, SCALER_FMT_RGB565 }
+};
+
+pixconv_func_t pixconv_get_simd(enum scaler_pix_fmt in_fmt,
+      enum scaler_pix_fmt out_fmt, uint64_t simd)
+{
+   size_t i;
+
+   if (in_fmt == out_fmt)
+      return conv_copy;
+
+   for (i = 0; i < sizeof(pixconv_entries) / sizeof(pixconv_entries[0]); i++)
+   {
+      const struct pixconv_entry *entry = &pixconv_entries[i];
+
+      if (entry->in_fmt != in_fmt || entry->out_fmt != out_fmt)
+         continue;
+
+      if ((simd & RETRO_SIMD_AVX2) && entry->func_avx2)
+         return entry->func_avx2;
+      return entry->func;
+   }
+
+   return NULL;
+}
+
+pixconv_func_t pixconv_get(enum scaler_pix_fmt in_fmt,
+      enum scaler_pix_fmt out_fmt)
+{
+   /* cpu_features_get() is too slow to call every frame */
+   static int have_avx2 = -1;
+
+   if (have_avx2 < 0)
+      have_avx2 = (cpu_features_get() & RETRO_SIMD_AVX2) ? 1 : 0;
+
+   return pixconv_get_simd(in_fmt, out_fmt,
+         have_avx2 ? RETRO_SIMD_AVX2 : 0);
+}
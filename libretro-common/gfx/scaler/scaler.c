@@ -29,6 +29,39 @@
 #include <gfx/scaler/scaler_int.h>
 #include <gfx/scaler/filter.h>
 #include <gfx/scaler/pixconv.h>
+#include <features/features_cpu.h>
+#include <retro_math.h>
+
+#ifdef HAVE_THREADS
+#include <rthreads/tpool.h>
+#endif
+
+/* Upper bound for scaler_ctx::threads */
+#define SCALER_MAX_THREADS   8
+/* Don't split frames into bands smaller than this,
+ * the dispatch overhead would outweigh the gain */
+#define SCALER_MIN_BAND_ROWS 16
+
+static void scaler_ctx_free_frames(struct scaler_ctx *ctx)
+{
+   if (ctx->scaled.frame)
+      free(ctx->scaled.frame);
+   if (ctx->input.frame)
+      free(ctx->input.frame);
+   if (ctx->output.frame)
+      free(ctx->output.frame);
+
+   ctx->scaled.frame        = NULL;
+   ctx->scaled.width        = 0;
+   ctx->scaled.height       = 0;
+   ctx->scaled.stride       = 0;
+
+   ctx->input.frame         = NULL;
+   ctx->input.stride        = 0;
+
+   ctx->output.frame        = NULL;
+   ctx->output.stride       = 0;
+}
 
 static bool allocate_frames(struct scaler_ctx *ctx)
 {
@@ -76,7 +109,11 @@ static bool allocate_frames(struct scaler_ctx *ctx)
 
 bool scaler_ctx_gen_filter(struct scaler_ctx *ctx)
 {
-   scaler_ctx_gen_reset(ctx);
+   /* Keep the filter cache and worker threads around,
+    * they are what makes a resolution change cheap */
+   scaler_ctx_free_frames(ctx);
+   memset(&ctx->horiz, 0, sizeof(ctx->horiz));
+   memset(&ctx->vert,  0, sizeof(ctx->vert));
 
    ctx->scaler_special = NULL;
    ctx->unscaled       = false;
@@ -89,173 +126,33 @@ bool scaler_ctx_gen_filter(struct scaler_ctx *ctx)
    {
       ctx->unscaled     = true; /* Only pixel format conversion ... */
 
-      if (ctx->in_fmt == ctx->out_fmt)
-         ctx->direct_pixconv = conv_copy;
-      else
-      {
-         /* Bind a pixel converter callback function to the
-          * 'direct_pixconv' function pointer of the scaler context object. */
-         switch (ctx->in_fmt)
-         {
-            case SCALER_FMT_0RGB1555:
-               switch (ctx->out_fmt)
-               {
-                  case SCALER_FMT_ARGB8888:
-                     ctx->direct_pixconv = conv_0rgb1555_argb8888;
-                     break;
-                  case SCALER_FMT_RGB565:
-                     ctx->direct_pixconv = conv_0rgb1555_rgb565;
-                     break;
-                  case SCALER_FMT_BGR24:
-                     ctx->direct_pixconv = conv_0rgb1555_bgr24;
-                     break;
-                  default:
-                     break;
-               }
-               break;
-            case SCALER_FMT_RGB565:
-               switch (ctx->out_fmt)
-               {
-                  case SCALER_FMT_ARGB8888:
-                     ctx->direct_pixconv = conv_rgb565_argb8888;
-                     break;
-                  case SCALER_FMT_ABGR8888:
-                     ctx->direct_pixconv = conv_rgb565_abgr8888;
-                     break;
-                  case SCALER_FMT_BGR24:
-                     ctx->direct_pixconv = conv_rgb565_bgr24;
-                     break;
-                  case SCALER_FMT_0RGB1555:
-                     ctx->direct_pixconv = conv_rgb565_0rgb1555;
-                     break;
-                  default:
-                     break;
-               }
-               break;
-            case SCALER_FMT_BGR24:
-               switch (ctx->out_fmt)
-               {
-                  case SCALER_FMT_ARGB8888:
-                     ctx->direct_pixconv = conv_bgr24_argb8888;
-                     break;
-                  case SCALER_FMT_RGB565:
-                     ctx->direct_pixconv = conv_bgr24_rgb565;
-                  default:
-                     break;
-               }
-               break;
-            case SCALER_FMT_ARGB8888:
-               switch (ctx->out_fmt)
-               {
-                  case SCALER_FMT_0RGB1555:
-                     ctx->direct_pixconv = conv_argb8888_0rgb1555;
-                     break;
-                  case SCALER_FMT_BGR24:
-                     ctx->direct_pixconv = conv_argb8888_bgr24;
-                     break;
-                  case SCALER_FMT_ABGR8888:
-                     ctx->direct_pixconv = conv_argb8888_abgr8888;
-                     break;
-                  case SCALER_FMT_RGBA4444:
-                     ctx->direct_pixconv = conv_argb8888_rgba4444;
-                     break;
-                  default:
-                     break;
-               }
-               break;
-            case SCALER_FMT_YUYV:
-               switch (ctx->out_fmt)
-               {
-                  case SCALER_FMT_ARGB8888:
-                     ctx->direct_pixconv = conv_yuyv_argb8888;
-                     break;
-                  default:
-                     break;
-               }
-               break;
-            case SCALER_FMT_RGBA4444:
-               switch (ctx->out_fmt)
-               {
-                  case SCALER_FMT_ARGB8888:
-                     ctx->direct_pixconv = conv_rgba4444_argb8888;
-                     break;
-                  case SCALER_FMT_RGB565:
-                     ctx->direct_pixconv = conv_rgba4444_rgb565;
-                     break;
-                  default:
-                     break;
-               }
-               break;
-            case SCALER_FMT_ABGR8888:
-               switch (ctx->out_fmt)
-               {
-                  case SCALER_FMT_BGR24:
-                     ctx->direct_pixconv = conv_abgr8888_bgr24;
-                     break;
-                  default:
-                     break;
-               }
-               break;
-         }
-
-         if (!ctx->direct_pixconv)
-            return false;
-      }
+      if (!(ctx->direct_pixconv = pixconv_get(ctx->in_fmt, ctx->out_fmt)))
+         return false;
    }
    else
    {
       ctx->scaler_horiz = scaler_argb8888_horiz;
       ctx->scaler_vert  = scaler_argb8888_vert;
-
-      switch (ctx->in_fmt)
+#ifdef SCALER_HAVE_AVX2
+      if (cpu_features_get() & RETRO_SIMD_AVX2)
       {
-         case SCALER_FMT_ARGB8888:
-            /* No need to convert :D */
-            break;
-
-         case SCALER_FMT_0RGB1555:
-            ctx->in_pixconv = conv_0rgb1555_argb8888;
-            break;
-
-         case SCALER_FMT_RGB565:
-            ctx->in_pixconv = conv_rgb565_argb8888;
-            break;
-
-         case SCALER_FMT_BGR24:
-            ctx->in_pixconv = conv_bgr24_argb8888;
-            break;
-
-         case SCALER_FMT_RGBA4444:
-            ctx->in_pixconv = conv_rgba4444_argb8888;
-            break;
+         ctx->scaler_horiz = scaler_argb8888_horiz_avx2;
+         ctx->scaler_vert  = scaler_argb8888_vert_avx2;
+      }
+#endif
 
-         default:
+      /* The scalers work on ARGB8888 */
+      if (ctx->in_fmt != SCALER_FMT_ARGB8888)
+      {
+         if (!(ctx->in_pixconv = pixconv_get(ctx->in_fmt,
+                     SCALER_FMT_ARGB8888)))
             return false;
       }
 
-      switch (ctx->out_fmt)
+      if (ctx->out_fmt != SCALER_FMT_ARGB8888)
       {
-         case SCALER_FMT_ARGB8888:
-            /* No need to convert :D */
-            break;
-
-         case SCALER_FMT_RGBA4444:
-            ctx->out_pixconv = conv_argb8888_rgba4444;
-            break;
-
-         case SCALER_FMT_0RGB1555:
-            ctx->out_pixconv = conv_argb8888_0rgb1555;
-            break;
-
-         case SCALER_FMT_BGR24:
-            ctx->out_pixconv = conv_argb8888_bgr24;
-            break;
-
-         case SCALER_FMT_ABGR8888:
-            ctx->out_pixconv = conv_argb8888_abgr8888;
-            break;
-
-         default:
+         if (!(ctx->out_pixconv = pixconv_get(SCALER_FMT_ARGB8888,
+                     ctx->out_fmt)))
             return false;
       }
 
@@ -268,20 +165,11 @@ bool scaler_ctx_gen_filter(struct scaler_ctx *ctx)
 
 void scaler_ctx_gen_reset(struct scaler_ctx *ctx)
 {
-   if (ctx->horiz.filter)
-      free(ctx->horiz.filter);
-   if (ctx->horiz.filter_pos)
-      free(ctx->horiz.filter_pos);
-   if (ctx->vert.filter)
-      free(ctx->vert.filter);
-   if (ctx->vert.filter_pos)
-      free(ctx->vert.filter_pos);
-   if (ctx->scaled.frame)
-      free(ctx->scaled.frame);
-   if (ctx->input.frame)
-      free(ctx->input.frame);
-   if (ctx->output.frame)
-      free(ctx->output.frame);
+   scaler_ctx_free_frames(ctx);
+
+   /* 'horiz' and 'vert' point into the cache */
+   scaler_filter_cache_free(ctx->filter_cache);
+   ctx->filter_cache        = NULL;
 
    ctx->horiz.filter        = NULL;
    ctx->horiz.filter_len    = 0;
@@ -293,18 +181,150 @@ void scaler_ctx_gen_reset(struct scaler_ctx *ctx)
    ctx->vert.filter_stride  = 0;
    ctx->vert.filter_pos     = NULL;
 
-   ctx->scaled.frame        = NULL;
-   ctx->scaled.width        = 0;
-   ctx->scaled.height       = 0;
-   ctx->scaled.stride       = 0;
+#ifdef HAVE_THREADS
+   if (ctx->thread_pool)
+      tpool_destroy((tpool_t*)ctx->thread_pool);
+#endif
+   ctx->thread_pool         = NULL;
+}
 
-   ctx->input.frame         = NULL;
-   ctx->input.stride        = 0;
+#ifdef HAVE_THREADS
+struct scaler_band
+{
+   const struct scaler_ctx *ctx;
+   const void *input;
+   void *output;
+   int first;
+   int last;
+};
+
+/* First pass: input rows [first, last) are converted
+ * to ARGB8888 if needed and scaled horizontally. Each
+ * output row of this pass only depends on the input
+ * row of the same index. */
+static void scaler_band_horiz(void *data)
+{
+   struct scaler_band *band   = (struct scaler_band*)data;
+   const struct scaler_ctx *c = band->ctx;
+   struct scaler_ctx ctx      = *c;
+   const uint8_t *input       = (const uint8_t*)band->input
+      + band->first * c->in_stride;
+   int input_stride           = c->in_stride;
+
+   if (c->in_fmt != SCALER_FMT_ARGB8888)
+   {
+      uint8_t *conv = (uint8_t*)c->input.frame
+         + band->first * c->input.stride;
 
-   ctx->output.frame        = NULL;
-   ctx->output.stride       = 0;
+      c->in_pixconv(conv, input,
+            c->in_width, band->last - band->first,
+            c->input.stride, c->in_stride);
+
+      input        = conv;
+      input_stride = c->input.stride;
+   }
+
+   ctx.scaled.frame  = c->scaled.frame
+      + band->first * (c->scaled.stride >> 3);
+   ctx.scaled.height = band->last - band->first;
+
+   c->scaler_horiz(&ctx, input, input_stride);
 }
 
+/* Second pass: output rows [first, last) are scaled
+ * vertically and converted to the output format */
+static void scaler_band_vert(void *data)
+{
+   struct scaler_band *band   = (struct scaler_band*)data;
+   const struct scaler_ctx *c = band->ctx;
+   struct scaler_ctx ctx      = *c;
+
+   ctx.vert.filter     = c->vert.filter
+      + band->first * c->vert.filter_stride;
+   ctx.vert.filter_pos = c->vert.filter_pos + band->first;
+   ctx.out_height      = band->last - band->first;
+
+   if (c->out_fmt != SCALER_FMT_ARGB8888)
+   {
+      uint8_t *conv = (uint8_t*)c->output.frame
+         + band->first * c->output.stride;
+
+      c->scaler_vert(&ctx, conv, c->output.stride);
+      c->out_pixconv((uint8_t*)band->output
+            + band->first * c->out_stride, conv,
+            c->out_width, ctx.out_height,
+            c->out_stride, c->output.stride);
+   }
+   else
+      c->scaler_vert(&ctx, (uint8_t*)band->output
+            + band->first * c->out_stride, c->out_stride);
+}
+
+static void scaler_run_bands(tpool_t *pool, thread_func_t func,
+      struct scaler_band *bands, int num_bands, int height)
+{
+   int i;
+
+   for (i = 0; i < num_bands; i++)
+   {
+      bands[i].first = height *  i      / num_bands;
+      bands[i].last  = height * (i + 1) / num_bands;
+   }
+
+   /* The calling thread takes the first band */
+   for (i = 1; i < num_bands; i++)
+      tpool_add_work(pool, func, &bands[i]);
+   func(&bands[0]);
+   tpool_wait(pool);
+}
+
+/**
+ * scaler_ctx_scale_threaded:
+ * @ctx          : pointer to scaler context object.
+ * @output       : pointer to output image.
+ * @input        : pointer to input image.
+ *
+ * Generic filter path of scaler_ctx_scale(), with both
+ * passes split into bands of rows that are processed
+ * in parallel.
+ *
+ * Returns: false if the frame is too small to be
+ * worth splitting, in which case nothing was done.
+ **/
+static bool scaler_ctx_scale_threaded(struct scaler_ctx *ctx,
+      void *output, const void *input)
+{
+   int i;
+   struct scaler_band bands[SCALER_MAX_THREADS];
+   int num_bands = (int)MIN(ctx->threads, SCALER_MAX_THREADS);
+
+   num_bands     = MIN(num_bands, ctx->in_height  / SCALER_MIN_BAND_ROWS);
+   num_bands     = MIN(num_bands, ctx->out_height / SCALER_MIN_BAND_ROWS);
+
+   if (num_bands < 2)
+      return false;
+
+   if (!ctx->thread_pool)
+      if (!(ctx->thread_pool = tpool_create(
+                  MIN(ctx->threads, SCALER_MAX_THREADS) - 1)))
+         return false;
+
+   for (i = 0; i < num_bands; i++)
+   {
+      bands[i].ctx    = ctx;
+      bands[i].input  = input;
+      bands[i].output = output;
+   }
+
+   scaler_run_bands((tpool_t*)ctx->thread_pool, scaler_band_horiz,
+         bands, num_bands, ctx->in_height);
+   scaler_run_bands((tpool_t*)ctx->thread_pool, scaler_band_vert,
+         bands, num_bands, ctx->out_height);
+
+   return true;
+}
+#endif
+
 /**
  * scaler_ctx_scale:
  * @ctx          : pointer to scaler context object.
@@ -321,6 +341,14 @@ void scaler_ctx_scale(struct scaler_ctx *ctx,
    int input_stride        = ctx->in_stride;
    int output_stride       = ctx->out_stride;
 
+#ifdef HAVE_THREADS
+   if (     ctx->threads > 1
+         && !ctx->unscaled
+         && !ctx->scaler_special
+         && scaler_ctx_scale_threaded(ctx, output, input))
+      return;
+#endif
+
    if (ctx->in_fmt != SCALER_FMT_ARGB8888)
    {
       ctx->in_pixconv(ctx->input.frame, input,
@@ -349,7 +377,7 @@ void scaler_ctx_scale(struct scaler_ctx *ctx,
       if (ctx->scaler_horiz)
          ctx->scaler_horiz(ctx, input_frame, input_stride);
       if (ctx->scaler_vert)
-         ctx->scaler_vert (ctx, output, output_stride);
+         ctx->scaler_vert (ctx, output_frame, output_stride);
    }
 
    if (ctx->out_fmt != SCALER_FMT_ARGB8888)
@@ -21,6 +21,7 @@
  */
 
 #include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
 
 #include <gfx/scaler/filter.h>
@@ -31,6 +32,24 @@
 
 #define FILTER_UNITY (1 << 14)
 
+/* Number of single-axis filters kept per scaler context */
+#define SCALER_FILTER_CACHE_SIZE 8
+
+struct scaler_filter_cache_entry
+{
+   struct scaler_filter filter;
+   unsigned last_used;
+   int in_len;
+   int out_len;
+   enum scaler_type type;
+};
+
+struct scaler_filter_cache
+{
+   struct scaler_filter_cache_entry entries[SCALER_FILTER_CACHE_SIZE];
+   unsigned clock;
+};
+
 static INLINE void gen_filter_point_sub(struct scaler_filter *filter,
       int len, int pos, int step)
 {
@@ -157,90 +176,171 @@ static void fixup_filter_sub(struct scaler_filter *filter,
    }
 }
 
-bool scaler_gen_filter(struct scaler_ctx *ctx)
+static void scaler_gen_filter_sub(struct scaler_filter *filter,
+      enum scaler_type type, int in_len, int out_len)
 {
-   int x_pos, x_step, y_pos, y_step;
-   int sinc_size = 0;
+   int step = (1 << 16) * in_len / out_len;
+   int pos  = (1 << 15) * in_len / out_len - (1 << 15);
 
-   switch (ctx->scaler_type)
+   switch (type)
    {
       case SCALER_TYPE_POINT:
-         ctx->horiz.filter_len    = 1;
-         ctx->horiz.filter_stride = 1;
-         ctx->vert.filter_len     = 1;
-         ctx->vert.filter_stride  = 1;
+         gen_filter_point_sub(filter, out_len, pos, step);
          break;
       case SCALER_TYPE_BILINEAR:
-         ctx->horiz.filter_len    = 2;
-         ctx->horiz.filter_stride = 2;
-         ctx->vert.filter_len     = 2;
-         ctx->vert.filter_stride  = 2;
+         gen_filter_bilinear_sub(filter, out_len, pos, step);
          break;
       case SCALER_TYPE_SINC:
-         sinc_size                = 8 * ((ctx->in_width > ctx->out_width)
-               ? next_pow2(ctx->in_width / ctx->out_width) : 1);
-         ctx->horiz.filter_len    = sinc_size;
-         ctx->horiz.filter_stride = sinc_size;
-         ctx->vert.filter_len     = sinc_size;
-         ctx->vert.filter_stride  = sinc_size;
+         /* Need to expand the filter when downsampling
+          * to get a proper low-pass effect. */
+         gen_filter_sinc_sub(filter, out_len,
+               pos - (filter->filter_len << 15), step,
+               in_len > out_len ? (double)out_len / in_len : 1.0);
          break;
       case SCALER_TYPE_UNKNOWN:
-      default:
-         return false;
+         break;
    }
 
-   ctx->horiz.filter     = (int16_t*)calloc(sizeof(int16_t), ctx->horiz.filter_stride * ctx->out_width);
-   ctx->horiz.filter_pos = (int*)calloc(sizeof(int), ctx->out_width);
+   /* Makes sure that we never sample outside our rectangle. */
+   fixup_filter_sub(filter, out_len, in_len);
+}
+
+/**
+ * scaler_filter_cache_get:
+ * @cache        : filter cache of a scaler context.
+ * @type         : scaler type.
+ * @filter_len   : number of taps.
+ * @in_len       : input width or height.
+ * @out_len      : output width or height.
+ *
+ * Looks up the filter for one axis, generating it
+ * in place of the least recently used entry if it
+ * is not in the cache yet. A filter only depends on
+ * its own axis, so a width or height that did not
+ * change is never regenerated, and switching back
+ * and forth between a handful of resolutions never
+ * evaluates a sinc twice.
+ *
+ * Returns: filter owned by @cache, or NULL on
+ * allocation failure.
+ **/
+static const struct scaler_filter *scaler_filter_cache_get(
+      struct scaler_filter_cache *cache, enum scaler_type type,
+      int filter_len, int in_len, int out_len)
+{
+   int i;
+   struct scaler_filter_cache_entry *entry = NULL;
+
+   for (i = 0; i < SCALER_FILTER_CACHE_SIZE; i++)
+   {
+      struct scaler_filter_cache_entry *cur = &cache->entries[i];
 
-   ctx->vert.filter      = (int16_t*)calloc(sizeof(int16_t), ctx->vert.filter_stride * ctx->out_height);
-   ctx->vert.filter_pos  = (int*)calloc(sizeof(int), ctx->out_height);
+      if (     cur->filter.filter
+            && cur->type              == type
+            && cur->filter.filter_len == filter_len
+            && cur->in_len            == in_len
+            && cur->out_len           == out_len)
+      {
+         cur->last_used = ++cache->clock;
+         return &cur->filter;
+      }
 
-   if (!ctx->horiz.filter || !ctx->vert.filter)
-      return false;
+      /* Prefer empty slots, then the oldest one */
+      if (     !entry
+            || (entry->filter.filter
+               && (!cur->filter.filter
+                  || cur->last_used < entry->last_used)))
+         entry = cur;
+   }
 
-   x_step = (1 << 16) * ctx->in_width / ctx->out_width;
-   y_step = (1 << 16) * ctx->in_height / ctx->out_height;
+   free(entry->filter.filter);
+   free(entry->filter.filter_pos);
 
-   switch (ctx->scaler_type)
+   entry->filter.filter        = (int16_t*)calloc(sizeof(int16_t),
+         filter_len * out_len);
+   entry->filter.filter_pos    = (int*)calloc(sizeof(int), out_len);
+   entry->filter.filter_len    = filter_len;
+   entry->filter.filter_stride = filter_len;
+
+   if (!entry->filter.filter || !entry->filter.filter_pos)
    {
-      case SCALER_TYPE_POINT:
-         x_pos  = (1 << 15) * ctx->in_width / ctx->out_width   - (1 << 15);
-         y_pos  = (1 << 15) * ctx->in_height / ctx->out_height - (1 << 15);
+      free(entry->filter.filter);
+      free(entry->filter.filter_pos);
+      entry->filter.filter     = NULL;
+      entry->filter.filter_pos = NULL;
+      return NULL;
+   }
 
-         gen_filter_point_sub(&ctx->horiz, ctx->out_width,  x_pos, x_step);
-         gen_filter_point_sub(&ctx->vert,  ctx->out_height, y_pos, y_step);
+   scaler_gen_filter_sub(&entry->filter, type, in_len, out_len);
 
-         ctx->scaler_special = scaler_argb8888_point_special;
-         break;
+   entry->type      = type;
+   entry->in_len    = in_len;
+   entry->out_len   = out_len;
+   entry->last_used = ++cache->clock;
 
-      case SCALER_TYPE_BILINEAR:
-         x_pos  = (1 << 15) * ctx->in_width / ctx->out_width   - (1 << 15);
-         y_pos  = (1 << 15) * ctx->in_height / ctx->out_height - (1 << 15);
+   return &entry->filter;
+}
 
-         gen_filter_bilinear_sub(&ctx->horiz, ctx->out_width,  x_pos, x_step);
-         gen_filter_bilinear_sub(&ctx->vert,  ctx->out_height, y_pos, y_step);
-         break;
+void scaler_filter_cache_free(struct scaler_filter_cache *cache)
+{
+   int i;
 
-      case SCALER_TYPE_SINC:
-         /* Need to expand the filter when downsampling
-          * to get a proper low-pass effect. */
+   if (!cache)
+      return;
+
+   for (i = 0; i < SCALER_FILTER_CACHE_SIZE; i++)
+   {
+      free(cache->entries[i].filter.filter);
+      free(cache->entries[i].filter.filter_pos);
+   }
+
+   free(cache);
+}
 
-         x_pos  = (1 << 15) * ctx->in_width  / ctx->out_width  - (1 << 15) - (sinc_size << 15);
-         y_pos  = (1 << 15) * ctx->in_height / ctx->out_height - (1 << 15) - (sinc_size << 15);
+bool scaler_gen_filter(struct scaler_ctx *ctx)
+{
+   const struct scaler_filter *horiz = NULL;
+   const struct scaler_filter *vert  = NULL;
+   int filter_len                    = 0;
 
-         gen_filter_sinc_sub(&ctx->horiz, ctx->out_width, x_pos, x_step,
-               ctx->in_width  > ctx->out_width  ? (double)ctx->out_width  / ctx->in_width  : 1.0);
-         gen_filter_sinc_sub(&ctx->vert, ctx->out_height, y_pos, y_step,
-               ctx->in_height > ctx->out_height ? (double)ctx->out_height / ctx->in_height : 1.0
-               );
+   switch (ctx->scaler_type)
+   {
+      case SCALER_TYPE_POINT:
+         filter_len = 1;
          break;
-      case SCALER_TYPE_UNKNOWN:
+      case SCALER_TYPE_BILINEAR:
+         filter_len = 2;
+         break;
+      case SCALER_TYPE_SINC:
+         filter_len = 8 * ((ctx->in_width > ctx->out_width)
+               ? next_pow2(ctx->in_width / ctx->out_width) : 1);
          break;
+      case SCALER_TYPE_UNKNOWN:
+      default:
+         return false;
    }
 
-   /* Makes sure that we never sample outside our rectangle. */
-   fixup_filter_sub(&ctx->horiz, ctx->out_width, ctx->in_width);
-   fixup_filter_sub(&ctx->vert,  ctx->out_height, ctx->in_height);
+   if (!ctx->filter_cache)
+      if (!(ctx->filter_cache = (struct scaler_filter_cache*)
+               calloc(1, sizeof(*ctx->filter_cache))))
+         return false;
+
+   /* The horizontal filter is the most recently used entry
+    * once looked up, so the vertical lookup cannot evict it */
+   if (!(horiz = scaler_filter_cache_get(ctx->filter_cache,
+               ctx->scaler_type, filter_len,
+               ctx->in_width, ctx->out_width)))
+      return false;
+   if (!(vert  = scaler_filter_cache_get(ctx->filter_cache,
+               ctx->scaler_type, filter_len,
+               ctx->in_height, ctx->out_height)))
+      return false;
+
+   ctx->horiz = *horiz;
+   ctx->vert  = *vert;
+
+   if (ctx->scaler_type == SCALER_TYPE_POINT)
+      ctx->scaler_special = scaler_argb8888_point_special;
 
    return validate_filter(ctx);
 }
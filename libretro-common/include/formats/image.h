@@ -71,6 +71,13 @@ bool image_texture_load_buffer(struct texture_image *img,
    enum image_type_enum type, void *buffer, size_t buffer_len);
 
 bool image_texture_load(struct texture_image *img, const char *path);
+
+/* Same as image_texture_load(), but allows the decoder
+ * to skip detail that would be lost when the image is
+ * scaled down to fit within 'max_width' x 'max_height'.
+ * The resulting image may still be larger than that */
+bool image_texture_load_scaled(struct texture_image *img, const char *path,
+      unsigned max_width, unsigned max_height);
 void image_texture_free(struct texture_image *img);
 
 /* Image transfer */
@@ -87,6 +94,13 @@ void image_transfer_set_buffer_ptr(
       void *ptr,
       size_t len);
 
+/* See image_texture_load_scaled() */
+void image_transfer_set_target_size(
+      void *data,
+      enum image_type_enum type,
+      unsigned width,
+      unsigned height);
+
 int image_transfer_process(
       void *data,
       enum image_type_enum type,
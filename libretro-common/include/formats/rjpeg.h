@@ -39,6 +39,13 @@ int rjpeg_process_image(rjpeg_t *rjpeg, void **buf,
 
 bool rjpeg_set_buf_ptr(rjpeg_t *rjpeg, void *data);
 
+/* Lets rjpeg_process_image() decode the image at 1/2,
+ * 1/4 or 1/8 of its size (in the DCT domain), as long
+ * as the result still covers 'width' x 'height' when
+ * scaled to fit. 0 x 0 (the default) decodes at full size */
+void rjpeg_set_target_size(rjpeg_t *rjpeg,
+      unsigned width, unsigned height);
+
 void rjpeg_free(rjpeg_t *rjpeg);
 
 rjpeg_t *rjpeg_alloc(void);
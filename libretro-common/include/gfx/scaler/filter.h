@@ -32,6 +32,8 @@ RETRO_BEGIN_DECLS
 
 bool scaler_gen_filter(struct scaler_ctx *ctx);
 
+void scaler_filter_cache_free(struct scaler_filter_cache *cache);
+
 RETRO_END_DECLS
 
 #endif
@@ -23,12 +23,37 @@
 #ifndef __LIBRETRO_SDK_SCALER_PIXCONV_H__
 #define __LIBRETRO_SDK_SCALER_PIXCONV_H__
 
+#include <stdint.h>
+
 #include <clamping.h>
 
 #include <retro_common_api.h>
 
+#include <gfx/scaler/scaler.h>
+
 RETRO_BEGIN_DECLS
 
+typedef void (*pixconv_func_t)(void *output, const void *input,
+      int width, int height,
+      int out_stride, int in_stride);
+
+/* The conv_* functions below only use the SIMD
+ * instructions the library was compiled for.
+ * pixconv_get() returns the fastest converter from
+ * 'in_fmt' to 'out_fmt' for the CPU we are running on
+ * (e.g. AVX2 kernels on an SSE2 build), or NULL if
+ * the conversion is not supported.
+ * If 'in_fmt' and 'out_fmt' are equal, conv_copy() is
+ * returned. */
+pixconv_func_t pixconv_get(enum scaler_pix_fmt in_fmt,
+      enum scaler_pix_fmt out_fmt);
+
+/* As pixconv_get(), but only considers the SIMD
+ * extensions in 'simd' (RETRO_SIMD_* flags) instead of
+ * asking the CPU. Mostly useful to test each kernel. */
+pixconv_func_t pixconv_get_simd(enum scaler_pix_fmt in_fmt,
+      enum scaler_pix_fmt out_fmt, uint64_t simd);
+
 void conv_0rgb1555_argb8888(void *output, const void *input,
       int width, int height,
       int out_stride, int in_stride);
@@ -59,6 +59,8 @@ struct scaler_filter
    int      filter_stride;
 };
 
+struct scaler_filter_cache;
+
 struct scaler_ctx
 {
    void (*scaler_horiz)(const struct scaler_ctx*,
@@ -73,6 +75,14 @@ struct scaler_ctx
    void (*direct_pixconv)(void*, const void*, int, int, int, int);
    struct scaler_filter horiz, vert;   /* ptr alignment */
 
+   /* Filters generated by earlier scaler_ctx_gen_filter()
+    * calls, reused when the same sizes come up again.
+    * Owns the memory 'horiz' and 'vert' point to. */
+   struct scaler_filter_cache *filter_cache;
+   /* Worker threads used by scaler_ctx_scale() when
+    * 'threads' is larger than 1 */
+   void *thread_pool;
+
    struct
    {
       uint32_t *frame;
@@ -105,6 +115,11 @@ struct scaler_ctx
    enum scaler_pix_fmt out_fmt;
    enum scaler_type scaler_type;
 
+   /* Maximum number of threads scaler_ctx_scale() may
+    * split a frame across. 0 or 1 scales on the calling
+    * thread only. Requires HAVE_THREADS. */
+   unsigned threads;
+
    bool unscaled;
 };
 
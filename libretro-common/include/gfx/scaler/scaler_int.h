@@ -29,6 +29,16 @@
 
 RETRO_BEGIN_DECLS
 
+/* AVX2 versions of the ARGB8888 scalers are built whenever
+ * the compiler can target AVX2 for individual functions,
+ * and are picked at runtime if the CPU supports them. */
+#if !defined(SCALER_NO_SIMD) && defined(__SSE2__) \
+   && (defined(__x86_64__) || defined(__i386__)) \
+   && (defined(__clang__) || (defined(__GNUC__) \
+   && (__GNUC__ > 4 || (__GNUC__ == 4 && __GNUC_MINOR__ >= 9))))
+#define SCALER_HAVE_AVX2
+#endif
+
 void scaler_argb8888_vert(const struct scaler_ctx *ctx,
       void *output, int stride);
 
@@ -41,6 +51,14 @@ void scaler_argb8888_point_special(const struct scaler_ctx *ctx,
       int in_width, int in_height,
       int out_stride, int in_stride);
 
+#ifdef SCALER_HAVE_AVX2
+void scaler_argb8888_vert_avx2(const struct scaler_ctx *ctx,
+      void *output, int stride);
+
+void scaler_argb8888_horiz_avx2(const struct scaler_ctx *ctx,
+      const void *input, int stride);
+#endif
+
 RETRO_END_DECLS
 
 #endif
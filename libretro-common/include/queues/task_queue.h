@@ -46,6 +46,27 @@ enum task_type
    TASK_TYPE_BLOCKING
 };
 
+/**
+ * Scheduling class of a task.
+ * Threaded workers always pick a task of the most urgent
+ * class available, while making sure lower classes still
+ * get an occasional turn.
+ */
+enum task_priority
+{
+   /** Work the user is waiting on, e.g. loading a state
+    * or the thumbnail of the selected entry. */
+   TASK_PRIORITY_INTERACTIVE = 0,
+
+   /** The default for tasks created with \c task_init. */
+   TASK_PRIORITY_NORMAL,
+
+   /** Bulk work that may take minutes, e.g. content scans. */
+   TASK_PRIORITY_BACKGROUND,
+
+   TASK_PRIORITY_COUNT
+};
+
 enum task_style
 {
    TASK_STYLE_NONE,
@@ -113,6 +134,17 @@ struct retro_task
     */
    retro_time_t when;
 
+   /**
+    * The time (in microseconds) by which the task would like
+    * to have finished, or 0 if it has no deadline.
+    * Among tasks of the same \c priority,
+    * the one with the earliest deadline runs first.
+    * Set by the caller.
+    * @note This is a point in time, not a duration.
+    * @see cpu_features_get_time_usec
+    */
+   retro_time_t deadline;
+
    /**
     * The main body of work for a task.
     * Should be as fast as possible,
@@ -220,6 +252,19 @@ struct retro_task
     */
    retro_task_t *next;
 
+   /**
+    * @private Pointer to the next task waiting for a worker thread.
+    * Do not touch this; it is managed by the task system.
+    */
+   retro_task_t *pool_next;
+
+   /**
+    * @private Order in which this task was pushed
+    * among \c sequential tasks.
+    * Do not touch this; it is managed by the task system.
+    */
+   uint32_t sequence;
+
    /**
     * Indicates the current progress of the task.
     *
@@ -245,6 +290,13 @@ struct retro_task
    enum task_type type;
    enum task_style style;
 
+   /**
+    * The scheduling class of this task.
+    * Defaults to \c TASK_PRIORITY_NORMAL.
+    * Set by the caller.
+    */
+   enum task_priority priority;
+
    /**
     * If \c true, the frontend should use some alternative means
     * of displaying this task's progress or messages.
@@ -274,6 +326,16 @@ struct retro_task
     * and will not display any messages from this task.
     */
    bool mute;
+
+   /**
+    * If set, this task does not start until every other
+    * \c sequential task pushed before it has finished,
+    * regardless of \c priority, \c deadline or threading.
+    * Use it for tasks that share a resource (e.g. a file)
+    * which must not be used by two of them at once.
+    * Set by the caller.
+    */
+   bool sequential;
 };
 
 /**
@@ -649,7 +711,11 @@ void task_queue_check(void);
  * If \c task::when is 0, it will start as soon as possible.
  *
  * Tasks with the same \c task::when value
- * will be executed in the order they were scheduled.
+ * will be executed in the order they were scheduled,
+ * unless they differ in \c task::priority or \c task::deadline.
+ * If the task queue is threaded, tasks that were started
+ * may run at the same time; set \c task::sequential
+ * on tasks that must not.
  *
  * @param task The task to schedule.
  * @return \c true unless \c task's type is \c TASK_TYPE_BLOCKING
@@ -715,9 +781,13 @@ void task_queue_deinit(void);
  * Must be called before any other task_queue_* function,
  * and must only be called from the main thread.
  *
- * @param threaded \c true if tasks should run on a separate thread,
+ * @param threaded \c true if tasks should run on a pool of worker threads,
  * \c false if they should remain on the calling thread.
- * All tasks run in sequence on a single thread.
+ * Workers share one first-in first-out queue per priority class,
+ * so tasks start in the order they were pushed,
+ * but separate tasks may run concurrently
+ * (see \c retro_task::sequential).
+ * A single task's \c handler is never called from two threads at once.
  * If you want to scale a task to multiple threads,
  * you must do so within the task itself.
  * @param msg_push The task system will call this function to output messages.
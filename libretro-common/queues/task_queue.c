@@ -23,7 +23,9 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <stdarg.h>
+#include <string.h>
 
+#include <retro_inline.h>
 #include <queues/task_queue.h>
 
 #include <features/features_cpu.h>
@@ -61,17 +63,47 @@ static struct retro_task_impl *impl_current = NULL;
 static bool task_threaded_enable            = false;
 
 #ifdef HAVE_THREADS
+/* Upper limit of the threaded worker pool size */
+#define TASK_QUEUE_MAX_WORKERS 4
+/* Number of times a less urgent priority class may be
+ * passed over before it gets a turn anyway */
+#define TASK_QUEUE_AGING       16
+
+/* Tasks of one priority class waiting for a worker, linked
+ * through 'pool_next' in the order they were pushed or last
+ * ran a slice */
+typedef struct
+{
+   retro_task_t *front;
+   retro_task_t *back;
+   unsigned count;
+} task_pool_queue_t;
+
 static uintptr_t main_thread_id             = 0;
 static slock_t *running_lock                = NULL;
 static slock_t *finished_lock               = NULL;
 static slock_t *property_lock               = NULL;
 static slock_t *queue_lock                  = NULL;
+/* use pool_lock when touching the pool queues, the delayed
+ * tasks, task_sequence_next, worker_cond or worker_continue */
+static slock_t *pool_lock                   = NULL;
 static scond_t *worker_cond                 = NULL;
-static sthread_t *worker_thread             = NULL;
+static sthread_t *workers[TASK_QUEUE_MAX_WORKERS];
+static unsigned worker_count                = 0;
+static task_pool_queue_t tasks_ready[TASK_PRIORITY_COUNT];
+static unsigned tasks_passed_over[TASK_PRIORITY_COUNT];
+/* Tasks whose 'when' is in the future, sorted by 'when' */
+static retro_task_t **tasks_delayed         = NULL;
+static size_t tasks_delayed_count           = 0;
+static size_t tasks_delayed_capacity        = 0;
 static bool worker_continue                 = true;
-/* use running_lock when touching it */
 #endif
 
+/* Number of sequential tasks pushed so far, and the
+ * 'sequence' of the only one that may run right now */
+static uint32_t task_sequence_pushed        = 0;
+static uint32_t task_sequence_next          = 0;
+
 static void task_queue_msg_push(retro_task_t *task,
       unsigned prio, unsigned duration,
       bool flush, const char *fmt, ...)
@@ -126,6 +158,19 @@ static void task_queue_push_progress(retro_task_t *task)
 #endif
 }
 
+static INLINE unsigned task_queue_priority(retro_task_t *task)
+{
+   if ((unsigned)task->priority >= TASK_PRIORITY_COUNT)
+      return TASK_PRIORITY_BACKGROUND;
+   return (unsigned)task->priority;
+}
+
+/* Whether it is this task's turn among sequential tasks */
+static INLINE bool task_queue_may_start(retro_task_t *task)
+{
+   return !task->sequential || task->sequence == task_sequence_next;
+}
+
 static void task_queue_put(task_queue_t *queue, retro_task_t *task)
 {
    task->next                   = NULL;
@@ -210,26 +255,47 @@ static void retro_task_regular_cancel(void *task)
 
 static void retro_task_regular_gather(void)
 {
+   unsigned priority;
    retro_task_t *task  = NULL;
    retro_task_t *queue = NULL;
+   retro_task_t *back  = NULL;
    retro_task_t *next  = NULL;
 
+   /* Keep the order they were pushed in */
    while ((task = task_queue_get(&tasks_running)))
    {
-      task->next = queue;
-      queue = task;
+      if (back)
+         back->next = task;
+      else
+         queue      = task;
+      back          = task;
    }
 
-   for (task = queue; task; task = next)
+   /* Every due task runs once per pass,
+    * the most urgent priority class first */
+   for (priority = 0; priority < TASK_PRIORITY_COUNT; priority++)
    {
-      next = task->next;
-
-      if (!task->when || task->when < cpu_features_get_time_usec())
+      for (task = queue; task; task = task->next)
       {
-         task->handler(task);
+         if (task_queue_priority(task) != priority)
+            continue;
+
+         if (     (!task->when || task->when < cpu_features_get_time_usec())
+               && task_queue_may_start(task))
+         {
+            task->handler(task);
+
+            task_queue_push_progress(task);
 
-         task_queue_push_progress(task);
+            if (task->finished && task->sequential)
+               task_sequence_next++;
+         }
       }
+   }
+
+   for (task = queue; task; task = next)
+   {
+      next = task->next;
 
       if (task->finished)
          task_queue_put(&tasks_finished, task);
@@ -371,14 +437,186 @@ static void task_queue_remove(task_queue_t *queue, retro_task_t *task)
    }
 }
 
+/* 'pool_lock' must be held for the duration of this function */
+static void task_pool_queue_put(retro_task_t *task)
+{
+   task_pool_queue_t *queue = &tasks_ready[task_queue_priority(task)];
+
+   task->pool_next          = NULL;
+
+   if (queue->back)
+      queue->back->pool_next = task;
+   else
+      queue->front           = task;
+
+   queue->back              = task;
+   queue->count++;
+}
+
+/* 'pool_lock' must be held for the duration of this function.
+ * Takes the first task of a priority class that may start,
+ * unless one that may start has an earlier deadline. */
+static retro_task_t *task_pool_queue_take(unsigned priority)
+{
+   task_pool_queue_t *queue = &tasks_ready[priority];
+   retro_task_t *best       = NULL;
+   retro_task_t *best_prev  = NULL;
+   retro_task_t *prev       = NULL;
+   retro_task_t *task       = NULL;
+
+   for (task = queue->front; task; prev = task, task = task->pool_next)
+   {
+      if (!task_queue_may_start(task))
+         continue;
+
+      if (     !best
+            || (task->deadline
+               && (!best->deadline || task->deadline < best->deadline)))
+      {
+         best      = task;
+         best_prev = prev;
+      }
+   }
+
+   if (!best)
+      return NULL;
+
+   if (best_prev)
+      best_prev->pool_next = best->pool_next;
+   else
+      queue->front         = best->pool_next;
+
+   if (queue->back == best)
+      queue->back          = best_prev;
+
+   best->pool_next         = NULL;
+   queue->count--;
+
+   return best;
+}
+
+/* 'pool_lock' must be held for the duration of this function.
+ * Returns false if the task could not be added, in which case
+ * the caller has to run it right away instead. */
+static bool task_pool_delay(retro_task_t *task)
+{
+   size_t i;
+
+   if (tasks_delayed_count == tasks_delayed_capacity)
+   {
+      size_t capacity      = tasks_delayed_capacity
+         ? tasks_delayed_capacity * 2 : 8;
+      retro_task_t **tasks = (retro_task_t**)realloc(tasks_delayed,
+            capacity * sizeof(*tasks));
+
+      if (!tasks)
+         return false;
+
+      tasks_delayed          = tasks;
+      tasks_delayed_capacity = capacity;
+   }
+
+   /* Tasks with the same 'when' stay in the order
+    * they were scheduled */
+   for (i = tasks_delayed_count;
+         i > 0 && tasks_delayed[i - 1]->when > task->when; i--)
+      tasks_delayed[i] = tasks_delayed[i - 1];
+
+   tasks_delayed[i] = task;
+   tasks_delayed_count++;
+   return true;
+}
+
+/* 'pool_lock' must be held for the duration of this function.
+ * Tasks join the back of their class, both when pushed and
+ * after each slice, so they start in the order they were
+ * pushed and take turns once running. */
+static void task_pool_schedule(retro_task_t *task)
+{
+   /* allow half a millisecond for context switching */
+   bool delayed = task->when
+      && task->when - cpu_features_get_time_usec() > 500;
+
+   /* Out of memory for the delayed list - run it early
+    * rather than never */
+   if (!delayed || !task_pool_delay(task))
+      task_pool_queue_put(task);
+
+   scond_signal(worker_cond);
+}
+
+/* 'pool_lock' must be held for the duration of this function.
+ * Moves delayed tasks that are due onto their queues and
+ * returns the delay until the next one, or 0 if none are left. */
+static retro_time_t task_pool_promote(void)
+{
+   size_t i         = 0;
+   retro_time_t now = cpu_features_get_time_usec();
+
+   while (     i < tasks_delayed_count
+         && tasks_delayed[i]->when - now - 500 <= 0)
+      task_pool_queue_put(tasks_delayed[i++]);
+
+   if (i)
+   {
+      tasks_delayed_count -= i;
+      memmove(tasks_delayed, tasks_delayed + i,
+            tasks_delayed_count * sizeof(*tasks_delayed));
+   }
+
+   if (tasks_delayed_count)
+   {
+      retro_time_t delay = tasks_delayed[0]->when - now - 500;
+      return (delay < 1) ? 1 : delay;
+   }
+
+   return 0;
+}
+
+/* 'pool_lock' must be held for the duration of this function.
+ * Takes a task of the most urgent class available, unless a
+ * less urgent class has been passed over too often. */
+static retro_task_t *task_pool_take(void)
+{
+   unsigned i, j;
+   retro_task_t *task = NULL;
+
+   for (i = TASK_PRIORITY_COUNT - 1; i > 0; i--)
+   {
+      if (tasks_passed_over[i] < TASK_QUEUE_AGING)
+         continue;
+
+      tasks_passed_over[i] = 0;
+      if ((task = task_pool_queue_take(i)))
+         return task;
+   }
+
+   for (i = 0; i < TASK_PRIORITY_COUNT; i++)
+   {
+      if (!(task = task_pool_queue_take(i)))
+         continue;
+
+      for (j = i + 1; j < TASK_PRIORITY_COUNT; j++)
+         if (tasks_ready[j].count)
+            tasks_passed_over[j]++;
+
+      return task;
+   }
+
+   return NULL;
+}
+
 static void retro_task_threaded_push_running(retro_task_t *task)
 {
    slock_lock(running_lock);
    slock_lock(queue_lock);
    task_queue_put(&tasks_running, task);
-   scond_signal(worker_cond);
    slock_unlock(queue_lock);
    slock_unlock(running_lock);
+
+   slock_lock(pool_lock);
+   task_pool_schedule(task);
+   slock_unlock(pool_lock);
 }
 
 static void retro_task_threaded_cancel(void *task)
@@ -481,32 +719,38 @@ static void threaded_worker(void *userdata)
       retro_task_t *task  = NULL;
       bool       finished = false;
 
-      if (!worker_continue)
-         break; /* should we keep running until all tasks finished? */
-
-      slock_lock(running_lock);
+      slock_lock(pool_lock);
 
-      /* Get first task to run */
-      if (!(task = tasks_running.front))
+      if (!worker_continue)
       {
-         scond_wait(worker_cond, running_lock);
-         slock_unlock(running_lock);
-         continue;
+         /* should we keep running until all tasks finished? */
+         slock_unlock(pool_lock);
+         break;
       }
 
-      if (task->when)
+      /* Get next task to run */
+      if (!(task = task_pool_take()))
       {
-         retro_time_t now   = cpu_features_get_time_usec();
-         retro_time_t delay = task->when - now - 500; /* allow half a millisecond for context switching */
-         if (delay > 0)
+         retro_time_t delay = task_pool_promote();
+
+         if (!(task = task_pool_take()))
          {
-            scond_wait_timeout(worker_cond, running_lock, delay);
-            slock_unlock(running_lock);
+            if (delay > 0)
+               scond_wait_timeout(worker_cond, pool_lock, delay);
+            else
+               scond_wait(worker_cond, pool_lock);
+            slock_unlock(pool_lock);
             continue;
          }
       }
 
-      slock_unlock(running_lock);
+      /* Let an idle worker pick up what is left */
+      if (     tasks_ready[TASK_PRIORITY_INTERACTIVE].count
+            || tasks_ready[TASK_PRIORITY_NORMAL].count
+            || tasks_ready[TASK_PRIORITY_BACKGROUND].count)
+         scond_signal(worker_cond);
+
+      slock_unlock(pool_lock);
 
       task->handler(task);
 
@@ -517,24 +761,22 @@ static void threaded_worker(void *userdata)
       /* Update queue */
       if (!finished)
       {
-         /* Move the task to the back of the queue */
-         /* mimics retro_task_threaded_push_running,
-          * but also includes a task_queue_remove */
-         slock_lock(running_lock);
-         slock_lock(queue_lock);
-
-         /* do nothing if only item in queue */
-         if (task->next)
-         {
-            task_queue_remove(&tasks_running, task);
-            task_queue_put(&tasks_running, task);
-            scond_signal(worker_cond);
-         }
-         slock_unlock(queue_lock);
-         slock_unlock(running_lock);
+         /* Move the task to the back of its queue */
+         slock_lock(pool_lock);
+         task_pool_schedule(task);
+         slock_unlock(pool_lock);
       }
       else
       {
+         if (task->sequential)
+         {
+            /* Next sequential task may start now */
+            slock_lock(pool_lock);
+            task_sequence_next++;
+            scond_signal(worker_cond);
+            slock_unlock(pool_lock);
+         }
+
          /* Remove task from running queue */
          slock_lock(running_lock);
          slock_lock(queue_lock);
@@ -552,40 +794,77 @@ static void threaded_worker(void *userdata)
 
 static void retro_task_threaded_init(void)
 {
+   unsigned i;
+   retro_task_t *task = NULL;
+   unsigned count     = cpu_features_get_core_amount();
+
+   /* Keep a second worker even on single core machines,
+    * so I/O bound tasks do not wait behind CPU bound ones */
+   if (count < 2)
+      count = 2;
+   else if (count > TASK_QUEUE_MAX_WORKERS)
+      count = TASK_QUEUE_MAX_WORKERS;
+
    running_lock    = slock_new();
    finished_lock   = slock_new();
    property_lock   = slock_new();
    queue_lock      = slock_new();
+   pool_lock       = slock_new();
    worker_cond     = scond_new();
+   worker_count    = 0;
+   worker_continue = true;
 
+   /* Schedule tasks left over from a previous implementation */
    slock_lock(running_lock);
-   worker_continue = true;
+   slock_lock(pool_lock);
+   for (task = tasks_running.front; task; task = task->next)
+      task_pool_schedule(task);
+   slock_unlock(pool_lock);
    slock_unlock(running_lock);
 
-   worker_thread   = sthread_create(threaded_worker, NULL);
+   for (i = 0; i < count; i++)
+      if ((workers[worker_count] = sthread_create(threaded_worker, NULL)))
+         worker_count++;
 }
 
 static void retro_task_threaded_deinit(void)
 {
-   slock_lock(running_lock);
+   unsigned i;
+
+   slock_lock(pool_lock);
    worker_continue = false;
-   scond_signal(worker_cond);
-   slock_unlock(running_lock);
+   scond_broadcast(worker_cond);
+   slock_unlock(pool_lock);
 
-   sthread_join(worker_thread);
+   for (i = 0; i < worker_count; i++)
+   {
+      sthread_join(workers[i]);
+      workers[i] = NULL;
+   }
+
+   free(tasks_delayed);
 
    scond_free(worker_cond);
    slock_free(running_lock);
    slock_free(finished_lock);
    slock_free(property_lock);
    slock_free(queue_lock);
-
-   worker_thread   = NULL;
-   worker_cond     = NULL;
-   running_lock    = NULL;
-   finished_lock   = NULL;
-   property_lock   = NULL;
-   queue_lock      = NULL;
+   slock_free(pool_lock);
+
+   /* Tasks that are left stay in tasks_running
+    * for the next implementation to pick up */
+   worker_count           = 0;
+   memset(tasks_ready, 0, sizeof(tasks_ready));
+   memset(tasks_passed_over, 0, sizeof(tasks_passed_over));
+   tasks_delayed          = NULL;
+   tasks_delayed_count    = 0;
+   tasks_delayed_capacity = 0;
+   worker_cond            = NULL;
+   running_lock           = NULL;
+   finished_lock          = NULL;
+   property_lock          = NULL;
+   queue_lock             = NULL;
+   pool_lock              = NULL;
 }
 
 static struct retro_task_impl impl_threaded = {
@@ -703,6 +982,17 @@ bool task_queue_push(retro_task_t *task)
          return false;
    }
 
+   if (task->sequential)
+   {
+#ifdef HAVE_THREADS
+      slock_lock(queue_lock);
+#endif
+      task->sequence = task_sequence_pushed++;
+#ifdef HAVE_THREADS
+      slock_unlock(queue_lock);
+#endif
+   }
+
    /* The lack of NULL checks in the following functions
     * is proposital to ensure correct control flow by the users. */
    impl_current->push_running(task);
@@ -985,7 +1275,12 @@ retro_task_t *task_init(void)
    task->frontend_userdata = NULL;
    task->alternative_look  = false;
    task->next              = NULL;
+   task->pool_next         = NULL;
+   task->sequence          = 0;
+   task->sequential        = false;
    task->when              = 0;
+   task->deadline          = 0;
+   task->priority          = TASK_PRIORITY_NORMAL;
 
    return task;
 }
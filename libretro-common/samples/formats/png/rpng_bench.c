@@ -0,0 +1,186 @@
+/* Copyright  (C) 2010-2020 The RetroArch team
+ *
+ * ---------------------------------------------------------------------------------------
+ * The following license statement only applies to this file (rpng_bench.c).
+ * ---------------------------------------------------------------------------------------
+ *
+ * Permission is hereby granted, free of charge,
+ * to any person obtaining a copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/* Decodes a set of PNG files (e.g. a thumbnail directory)
+ * repeatedly, single-threaded and threaded, and reports
+ * the time taken by each mode. Exits with an error if
+ * the two modes do not produce identical pixels.
+ *
+ * Usage: rpng_bench [-n iterations] [-v] <png file>... */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+
+#include <boolean.h>
+#include <encodings/crc32.h>
+#include <features/features_cpu.h>
+#include <formats/rpng.h>
+#include <formats/image.h>
+#include <streams/file_stream.h>
+
+static bool rpng_bench_decode(uint8_t *buf, size_t len, bool threaded,
+      uint32_t **data, unsigned *width, unsigned *height)
+{
+   int retval;
+   bool ret   = false;
+   rpng_t *rpng = rpng_alloc();
+
+   *data = NULL;
+
+   if (!rpng)
+      return false;
+
+   rpng_set_threaded(rpng, threaded);
+
+   if (     !rpng_set_buf_ptr(rpng, buf, len)
+         || !rpng_start(rpng))
+      goto end;
+
+   while (rpng_iterate_image(rpng));
+
+   if (!rpng_is_valid(rpng))
+      goto end;
+
+   do
+   {
+      retval = rpng_process_image(rpng,
+            (void**)data, len, width, height);
+   } while (retval == IMAGE_PROCESS_NEXT);
+
+   ret = (retval == IMAGE_PROCESS_END);
+
+end:
+   rpng_free(rpng);
+   if (!ret)
+   {
+      free(*data);
+      *data = NULL;
+   }
+   return ret;
+}
+
+int main(int argc, char *argv[])
+{
+   int i;
+   unsigned mode;
+   unsigned iterations     = 10;
+   bool verbose            = false;
+   bool mismatch           = false;
+   unsigned num_files      = 0;
+   uint64_t num_pixels     = 0;
+   retro_time_t total[2]   = { 0, 0 };
+   static const char *mode_names[2] = { "single", "threaded" };
+
+   for (i = 1; i < argc; i++)
+   {
+      if (!strcmp(argv[i], "-n") && i + 1 < argc)
+         iterations = (unsigned)strtoul(argv[++i], NULL, 10);
+      else if (!strcmp(argv[i], "-v"))
+         verbose = true;
+      else
+         break;
+   }
+
+   if (i >= argc || !iterations)
+   {
+      fprintf(stderr, "Usage: %s [-n iterations] [-v] <png file>...\n", argv[0]);
+      return 1;
+   }
+
+   for (; i < argc; i++)
+   {
+      void *buf        = NULL;
+      int64_t len      = 0;
+      uint32_t crc[2]  = { 0, 0 };
+      retro_time_t t[2];
+      unsigned width   = 0;
+      unsigned height  = 0;
+
+      if (!filestream_read_file(argv[i], &buf, &len))
+      {
+         fprintf(stderr, "Could not read %s\n", argv[i]);
+         continue;
+      }
+
+      for (mode = 0; mode < 2; mode++)
+      {
+         unsigned n;
+         retro_time_t start = cpu_features_get_time_usec();
+
+         for (n = 0; n < iterations; n++)
+         {
+            uint32_t *data = NULL;
+
+            if (!rpng_bench_decode((uint8_t*)buf, (size_t)len,
+                     mode == 1, &data, &width, &height))
+               break;
+
+            if (n == 0)
+               crc[mode] = encoding_crc32(0, (const uint8_t*)data,
+                     (size_t)width * height * sizeof(uint32_t));
+            free(data);
+         }
+
+         t[mode] = cpu_features_get_time_usec() - start;
+
+         if (n < iterations)
+         {
+            fprintf(stderr, "Could not decode %s\n", argv[i]);
+            t[mode] = -1;
+         }
+      }
+
+      free(buf);
+
+      if (t[0] < 0 || t[1] < 0)
+         continue;
+
+      if (crc[0] != crc[1])
+      {
+         fprintf(stderr, "%s: threaded decode differs\n", argv[i]);
+         mismatch = true;
+      }
+
+      if (verbose)
+         printf("%-40s %5ux%-5u %08x %8.3f ms %8.3f ms\n", argv[i],
+               width, height, (unsigned)crc[0],
+               t[0] / 1000.0 / iterations, t[1] / 1000.0 / iterations);
+
+      total[0]   += t[0];
+      total[1]   += t[1];
+      num_pixels += (uint64_t)width * height * iterations;
+      num_files++;
+   }
+
+   if (!num_files)
+      return 1;
+
+   for (mode = 0; mode < 2; mode++)
+      printf("%-8s: %u files, %8.3f ms/iteration, %7.1f Mpixels/s\n",
+            mode_names[mode], num_files,
+            total[mode] / 1000.0 / iterations,
+            total[mode] ? (double)num_pixels / total[mode] : 0.0);
+
+   return mismatch ? 2 : 0;
+}
@@ -0,0 +1,378 @@
+/* Copyright  (C) 2010-2020 The RetroArch team
+ *
+ * ---------------------------------------------------------------------------------------
+ * The following license statement only applies to this file (pixconv_test.c).
+ * ---------------------------------------------------------------------------------------
+ *
+ * Permission is hereby granted, free of charge,
+ * to any person obtaining a copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/* Checks every conversion pixconv_get() knows about
+ * against a plain per-pixel reference, for both the
+ * baseline and the AVX2 kernels (if supported), with
+ * odd widths and padded strides, and makes sure nothing
+ * is written outside of each line. Then reports the
+ * throughput of each kernel on 1920x1080 frames.
+ * Exits with an error on any mismatch.
+ *
+ * Usage: pixconv_test [-n iterations] */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+
+#include <boolean.h>
+#include <clamping.h>
+#include <features/features_cpu.h>
+#include <gfx/scaler/pixconv.h>
+
+#define PIXCONV_TEST_CANARY 0xa5
+
+static const char *pixconv_test_fmt_names[] = {
+   "argb8888", "abgr8888", "0rgb1555", "rgb565", "bgr24", "yuyv", "rgba4444"
+};
+
+static int pixconv_test_bpp(enum scaler_pix_fmt fmt)
+{
+   switch (fmt)
+   {
+      case SCALER_FMT_ARGB8888:
+      case SCALER_FMT_ABGR8888:
+         return 4;
+      case SCALER_FMT_BGR24:
+         return 3;
+      default:
+         break;
+   }
+   return 2;
+}
+
+static uint32_t pixconv_test_swap_rb(uint32_t col)
+{
+   return (col & 0xff00ff00) | ((col >> 16) & 0xff) | ((col & 0xff) << 16);
+}
+
+/* Returns pixel 'x' of a line as ARGB8888 */
+static uint32_t pixconv_test_read(enum scaler_pix_fmt fmt,
+      const uint8_t *line, int x)
+{
+   uint32_t col, r, g, b, a;
+
+   switch (fmt)
+   {
+      case SCALER_FMT_ARGB8888:
+         return ((const uint32_t*)line)[x];
+      case SCALER_FMT_ABGR8888:
+         return pixconv_test_swap_rb(((const uint32_t*)line)[x]);
+      case SCALER_FMT_BGR24:
+         return 0xff000000u | (line[x * 3 + 2] << 16)
+            | (line[x * 3 + 1] << 8) | line[x * 3];
+      case SCALER_FMT_YUYV:
+      {
+         const uint8_t *p = line + (x & ~1) * 2;
+         int y            = p[(x & 1) * 2] * 64;
+         int u            = p[1] - 128;
+         int v            = p[3] - 128;
+         r = clamp_8bit((y +            90 * v + 32) >> 6);
+         g = clamp_8bit((y + -22 * u + -46 * v + 32) >> 6);
+         b = clamp_8bit((y + 113 * u            + 32) >> 6);
+         return 0xff000000u | (r << 16) | (g << 8) | b;
+      }
+      default:
+         break;
+   }
+
+   col = ((const uint16_t*)line)[x];
+
+   switch (fmt)
+   {
+      case SCALER_FMT_0RGB1555:
+         r = (col >> 10) & 0x1f;
+         g = (col >>  5) & 0x1f;
+         b = col & 0x1f;
+         r = (r << 3) | (r >> 2);
+         g = (g << 3) | (g >> 2);
+         b = (b << 3) | (b >> 2);
+         a = 0xff;
+         break;
+      case SCALER_FMT_RGB565:
+         r = (col >> 11) & 0x1f;
+         g = (col >>  5) & 0x3f;
+         b = col & 0x1f;
+         r = (r << 3) | (r >> 2);
+         g = (g << 2) | (g >> 4);
+         b = (b << 3) | (b >> 2);
+         a = 0xff;
+         break;
+      default: /* RGBA4444 */
+         r = ((col >> 12) & 0xf) * 0x11;
+         g = ((col >>  8) & 0xf) * 0x11;
+         b = ((col >>  4) & 0xf) * 0x11;
+         a = (col & 0xf) * 0x11;
+         break;
+   }
+
+   return (a << 24) | (r << 16) | (g << 8) | b;
+}
+
+static void pixconv_test_write(enum scaler_pix_fmt fmt,
+      uint8_t *line, int x, uint32_t col)
+{
+   uint32_t a = col >> 24;
+   uint32_t r = (col >> 16) & 0xff;
+   uint32_t g = (col >>  8) & 0xff;
+   uint32_t b = col & 0xff;
+
+   switch (fmt)
+   {
+      case SCALER_FMT_ARGB8888:
+         ((uint32_t*)line)[x] = col;
+         break;
+      case SCALER_FMT_ABGR8888:
+         ((uint32_t*)line)[x] = pixconv_test_swap_rb(col);
+         break;
+      case SCALER_FMT_BGR24:
+         line[x * 3 + 0] = b;
+         line[x * 3 + 1] = g;
+         line[x * 3 + 2] = r;
+         break;
+      case SCALER_FMT_0RGB1555:
+         ((uint16_t*)line)[x] = ((r >> 3) << 10) | ((g >> 3) << 5) | (b >> 3);
+         break;
+      case SCALER_FMT_RGB565:
+         ((uint16_t*)line)[x] = ((r >> 3) << 11) | ((g >> 2) << 5) | (b >> 3);
+         break;
+      case SCALER_FMT_RGBA4444:
+         ((uint16_t*)line)[x] = ((r >> 4) << 12) | ((g >> 4) << 8)
+            | ((b >> 4) << 4) | (a >> 4);
+         break;
+      default:
+         break;
+   }
+}
+
+static void pixconv_test_fill(uint8_t *data, size_t len, uint32_t seed)
+{
+   size_t i;
+   for (i = 0; i < len; i++)
+   {
+      seed    = seed * 1103515245 + 12345;
+      data[i] = (uint8_t)(seed >> 16);
+   }
+}
+
+/* Converts a width x 3 image with padded strides, and
+ * compares it to the reference. Returns false on any
+ * difference, including bytes written past a line. */
+static bool pixconv_test_check(pixconv_func_t func,
+      enum scaler_pix_fmt in_fmt, enum scaler_pix_fmt out_fmt,
+      int width, uint32_t seed)
+{
+   int x, y;
+   bool ok          = true;
+   int height       = 3;
+   int in_bpp       = pixconv_test_bpp(in_fmt);
+   int out_bpp      = pixconv_test_bpp(out_fmt);
+   int in_stride    = width * in_bpp  + 4 * (seed % 5);
+   int out_stride   = width * out_bpp + 4 * ((seed >> 3) % 5);
+   size_t out_len   = (size_t)out_stride * height + 64;
+   uint8_t *input   = (uint8_t*)malloc((size_t)in_stride * height);
+   uint8_t *output  = (uint8_t*)malloc(out_len);
+   uint8_t *ref     = (uint8_t*)malloc((size_t)out_stride * height);
+
+   if (!input || !output || !ref)
+   {
+      free(input);
+      free(output);
+      free(ref);
+      return false;
+   }
+
+   pixconv_test_fill(input, (size_t)in_stride * height, seed);
+   memset(output, PIXCONV_TEST_CANARY, out_len);
+
+   for (y = 0; y < height; y++)
+      for (x = 0; x < width; x++)
+         pixconv_test_write(out_fmt, ref + y * out_stride, x,
+               pixconv_test_read(in_fmt, input + y * in_stride, x));
+
+   func(output, input, width, height, out_stride, in_stride);
+
+   for (y = 0; y < height && ok; y++)
+   {
+      const uint8_t *line = output + y * out_stride;
+      int line_len        = width * out_bpp;
+      int end             = (y == height - 1)
+         ? (int)(out_len - (size_t)y * out_stride) : out_stride;
+
+      if (memcmp(line, ref + y * out_stride, line_len))
+      {
+         for (x = 0; x < line_len; x++)
+            if (line[x] != ref[y * out_stride + x])
+               break;
+         fprintf(stderr, "  width %d, line %d: pixel %d differs\n",
+               width, y, x / out_bpp);
+         ok = false;
+      }
+
+      for (x = line_len; x < end && ok; x++)
+      {
+         if (line[x] != PIXCONV_TEST_CANARY)
+         {
+            fprintf(stderr, "  width %d, line %d: wrote %d bytes past the end\n",
+                  width, y, x - line_len + 1);
+            ok = false;
+         }
+      }
+   }
+
+   free(input);
+   free(output);
+   free(ref);
+   return ok;
+}
+
+/* Returns megapixels per second */
+static double pixconv_test_speed(pixconv_func_t func,
+      enum scaler_pix_fmt in_fmt, enum scaler_pix_fmt out_fmt,
+      unsigned iterations)
+{
+   unsigned n;
+   retro_time_t start;
+   int width       = 1920;
+   int height      = 1080;
+   int in_stride   = width * pixconv_test_bpp(in_fmt);
+   int out_stride  = width * pixconv_test_bpp(out_fmt);
+   uint8_t *input  = (uint8_t*)malloc((size_t)in_stride * height);
+   uint8_t *output = (uint8_t*)malloc((size_t)out_stride * height);
+
+   if (!input || !output)
+   {
+      free(input);
+      free(output);
+      return 0.0;
+   }
+
+   pixconv_test_fill(input, (size_t)in_stride * height, 1);
+   /* Warm up */
+   func(output, input, width, height, out_stride, in_stride);
+
+   start = cpu_features_get_time_usec();
+   for (n = 0; n < iterations; n++)
+      func(output, input, width, height, out_stride, in_stride);
+   start = cpu_features_get_time_usec() - start;
+
+   free(input);
+   free(output);
+
+   if (start <= 0)
+      start = 1;
+   return (double)width * height * iterations / (double)start;
+}
+
+int main(int argc, char *argv[])
+{
+   int i, in_fmt, out_fmt;
+   unsigned iterations = 50;
+   unsigned pairs      = 0;
+   bool failed         = false;
+   bool have_avx2      = (cpu_features_get() & RETRO_SIMD_AVX2) != 0;
+
+   for (i = 1; i < argc; i++)
+   {
+      if (!strcmp(argv[i], "-n") && i + 1 < argc)
+         iterations = (unsigned)strtoul(argv[++i], NULL, 10);
+      else
+      {
+         fprintf(stderr, "Usage: %s [-n iterations]\n", argv[0]);
+         return 1;
+      }
+   }
+
+   if (!iterations)
+      iterations = 1;
+
+   printf("%-20s %12s %12s (MPix/s, 1920x1080)\n", "", "baseline",
+         have_avx2 ? "avx2" : "avx2 n/a");
+
+   for (in_fmt = SCALER_FMT_ARGB8888; in_fmt <= SCALER_FMT_RGBA4444; in_fmt++)
+   {
+      for (out_fmt = SCALER_FMT_ARGB8888; out_fmt <= SCALER_FMT_RGBA4444; out_fmt++)
+      {
+         unsigned v;
+         pixconv_func_t funcs[2];
+         const char *names[2] = { "baseline", "avx2" };
+
+         if (in_fmt == out_fmt || out_fmt == SCALER_FMT_YUYV)
+            continue;
+
+         funcs[0] = pixconv_get_simd((enum scaler_pix_fmt)in_fmt,
+               (enum scaler_pix_fmt)out_fmt, 0);
+         funcs[1] = pixconv_get_simd((enum scaler_pix_fmt)in_fmt,
+               (enum scaler_pix_fmt)out_fmt, RETRO_SIMD_AVX2);
+
+         if (!funcs[0])
+            continue;
+
+         pairs++;
+         if (!have_avx2 || funcs[1] == funcs[0])
+            funcs[1] = NULL;
+
+         printf("%8s -> %-8s", pixconv_test_fmt_names[in_fmt],
+               pixconv_test_fmt_names[out_fmt]);
+
+         for (v = 0; v < 2; v++)
+         {
+            int width;
+
+            if (!funcs[v])
+            {
+               printf(" %12s", "-");
+               continue;
+            }
+
+            for (width = 1; width <= 300; width++)
+            {
+               /* YUYV comes in pairs of pixels */
+               if (in_fmt == SCALER_FMT_YUYV && (width & 1))
+                  continue;
+
+               if (!pixconv_test_check(funcs[v],
+                        (enum scaler_pix_fmt)in_fmt,
+                        (enum scaler_pix_fmt)out_fmt,
+                        width, (uint32_t)width * 2654435761u))
+               {
+                  fprintf(stderr, "%s -> %s (%s) failed\n",
+                        pixconv_test_fmt_names[in_fmt],
+                        pixconv_test_fmt_names[out_fmt], names[v]);
+                  failed = true;
+                  break;
+               }
+            }
+
+            printf(" %12.1f", pixconv_test_speed(funcs[v],
+                     (enum scaler_pix_fmt)in_fmt,
+                     (enum scaler_pix_fmt)out_fmt, iterations));
+         }
+         printf("\n");
+      }
+   }
+
+   printf("%u conversions, %s\n", pairs, failed ? "FAILED" : "all correct");
+
+   return failed ? 2 : 0;
+}
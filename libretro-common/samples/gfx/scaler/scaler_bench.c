@@ -0,0 +1,268 @@
+/* Copyright  (C) 2010-2020 The RetroArch team
+ *
+ * ---------------------------------------------------------------------------------------
+ * The following license statement only applies to this file (scaler_bench.c).
+ * ---------------------------------------------------------------------------------------
+ *
+ * Permission is hereby granted, free of charge,
+ * to any person obtaining a copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/* Scales synthetic frames with the SSE2 scaler, the AVX2
+ * scaler (if supported), and the AVX2 scaler split across
+ * threads, and reports the time taken by each. Exits with
+ * an error if any of them produces different pixels than
+ * the SSE2 scaler. Also times scaler_ctx_gen_filter() when
+ * switching back and forth between two resolutions, with
+ * and without the filter cache.
+ *
+ * Usage: scaler_bench [-n iterations] [-t max threads] */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+
+#include <boolean.h>
+#include <encodings/crc32.h>
+#include <features/features_cpu.h>
+#include <gfx/scaler/scaler.h>
+#include <gfx/scaler/scaler_int.h>
+
+struct scaler_bench_case
+{
+   enum scaler_pix_fmt in_fmt;
+   enum scaler_pix_fmt out_fmt;
+   enum scaler_type type;
+   int in_width;
+   int in_height;
+   int out_width;
+   int out_height;
+};
+
+static const struct scaler_bench_case scaler_bench_cases[] = {
+   { SCALER_FMT_RGB565,   SCALER_FMT_ARGB8888, SCALER_TYPE_BILINEAR,  320,  240, 1280,  960 },
+   { SCALER_FMT_ARGB8888, SCALER_FMT_ARGB8888, SCALER_TYPE_BILINEAR,  256,  224, 1173,  883 },
+   { SCALER_FMT_ARGB8888, SCALER_FMT_BGR24,    SCALER_TYPE_BILINEAR, 1920, 1080,  640,  360 },
+   { SCALER_FMT_ARGB8888, SCALER_FMT_ARGB8888, SCALER_TYPE_SINC,      640,  480,  321,  241 },
+   { SCALER_FMT_ARGB8888, SCALER_FMT_ARGB8888, SCALER_TYPE_SINC,     1920, 1080,  320,  180 },
+   { SCALER_FMT_BGR24,    SCALER_FMT_ARGB8888, SCALER_TYPE_SINC,      256,  240,  767,  719 },
+   { SCALER_FMT_ARGB8888, SCALER_FMT_ARGB8888, SCALER_TYPE_POINT,     320,  240, 1280,  960 }
+};
+
+static const char *scaler_bench_type_names[] = {
+   "unknown", "point", "bilinear", "sinc"
+};
+
+static int scaler_bench_bpp(enum scaler_pix_fmt fmt)
+{
+   switch (fmt)
+   {
+      case SCALER_FMT_ARGB8888:
+      case SCALER_FMT_ABGR8888:
+         return 4;
+      case SCALER_FMT_BGR24:
+         return 3;
+      default:
+         break;
+   }
+   return 2;
+}
+
+static void scaler_bench_fill(uint8_t *frame, size_t len)
+{
+   size_t i;
+   uint32_t seed = 1;
+
+   /* Smooth gradients with some noise on top, so that
+    * both small and large filter sums show up */
+   for (i = 0; i < len; i++)
+   {
+      seed     = seed * 1103515245 + 12345;
+      frame[i] = (uint8_t)((i * 7 / 5) ^ ((seed >> 16) & 0x1f));
+   }
+}
+
+/* mode 0: SSE2, mode 1: AVX2 (or SSE2 if unsupported),
+ * mode 2 and up: as mode 1, split across 'mode' threads.
+ * Returns time per frame in microseconds, or -1 */
+static double scaler_bench_run(const struct scaler_bench_case *c,
+      unsigned mode, unsigned iterations,
+      const uint8_t *input, uint32_t *crc)
+{
+   unsigned n;
+   retro_time_t start;
+   uint8_t *output;
+   struct scaler_ctx ctx;
+   int out_bpp = scaler_bench_bpp(c->out_fmt);
+
+   memset(&ctx, 0, sizeof(ctx));
+   ctx.in_fmt      = c->in_fmt;
+   ctx.out_fmt     = c->out_fmt;
+   ctx.scaler_type = c->type;
+   ctx.in_width    = c->in_width;
+   ctx.in_height   = c->in_height;
+   ctx.in_stride   = c->in_width * scaler_bench_bpp(c->in_fmt);
+   ctx.out_width   = c->out_width;
+   ctx.out_height  = c->out_height;
+   ctx.out_stride  = c->out_width * out_bpp;
+   ctx.threads     = mode > 1 ? mode : 0;
+
+   if (!scaler_ctx_gen_filter(&ctx))
+   {
+      scaler_ctx_gen_reset(&ctx);
+      return -1.0;
+   }
+
+   if (mode == 0 && !ctx.scaler_special)
+   {
+      ctx.scaler_horiz = scaler_argb8888_horiz;
+      ctx.scaler_vert  = scaler_argb8888_vert;
+   }
+
+   output = (uint8_t*)calloc(ctx.out_stride, ctx.out_height);
+
+   start  = cpu_features_get_time_usec();
+   for (n = 0; n < iterations; n++)
+      scaler_ctx_scale(&ctx, output, input);
+   start  = cpu_features_get_time_usec() - start;
+
+   *crc   = encoding_crc32(0, output, (size_t)ctx.out_stride * ctx.out_height);
+
+   free(output);
+   scaler_ctx_gen_reset(&ctx);
+
+   return (double)start / iterations;
+}
+
+static void scaler_bench_gen_filter(unsigned iterations)
+{
+   unsigned cached, n;
+   static const int sizes[2][2] = { { 256, 224 }, { 512, 448 } };
+
+   for (cached = 0; cached < 2; cached++)
+   {
+      retro_time_t start;
+      struct scaler_ctx ctx;
+
+      memset(&ctx, 0, sizeof(ctx));
+      ctx.in_fmt      = SCALER_FMT_ARGB8888;
+      ctx.out_fmt     = SCALER_FMT_ARGB8888;
+      ctx.scaler_type = SCALER_TYPE_SINC;
+      ctx.out_width   = 1920;
+      ctx.out_height  = 1080;
+      ctx.out_stride  = 1920 * 4;
+
+      start = cpu_features_get_time_usec();
+      for (n = 0; n < iterations; n++)
+      {
+         ctx.in_width  = sizes[n & 1][0];
+         ctx.in_height = sizes[n & 1][1];
+         ctx.in_stride = ctx.in_width * 4;
+
+         if (!cached)
+            scaler_ctx_gen_reset(&ctx);
+         scaler_ctx_gen_filter(&ctx);
+      }
+      start = cpu_features_get_time_usec() - start;
+
+      scaler_ctx_gen_reset(&ctx);
+
+      printf("gen_filter %-8s: %8.3f ms\n", cached ? "cached" : "uncached",
+            (double)start / 1000.0 / iterations);
+   }
+}
+
+int main(int argc, char *argv[])
+{
+   int i;
+   unsigned c, mode;
+   unsigned iterations  = 20;
+   unsigned max_threads = cpu_features_get_core_amount();
+   bool mismatch        = false;
+
+   for (i = 1; i < argc; i++)
+   {
+      if (!strcmp(argv[i], "-n") && i + 1 < argc)
+         iterations = (unsigned)strtoul(argv[++i], NULL, 10);
+      else if (!strcmp(argv[i], "-t") && i + 1 < argc)
+         max_threads = (unsigned)strtoul(argv[++i], NULL, 10);
+      else
+      {
+         fprintf(stderr, "Usage: %s [-n iterations] [-t max threads]\n",
+               argv[0]);
+         return 1;
+      }
+   }
+
+   if (!iterations)
+      iterations = 1;
+   if (max_threads < 2)
+      max_threads = 2;
+
+#ifdef SCALER_HAVE_AVX2
+   printf("AVX2 scaler: %s\n",
+         (cpu_features_get() & RETRO_SIMD_AVX2) ? "yes" : "not supported");
+#else
+   printf("AVX2 scaler: not built\n");
+#endif
+
+   for (c = 0; c < sizeof(scaler_bench_cases) / sizeof(scaler_bench_cases[0]); c++)
+   {
+      const struct scaler_bench_case *cur = &scaler_bench_cases[c];
+      size_t len       = (size_t)cur->in_width * cur->in_height
+         * scaler_bench_bpp(cur->in_fmt);
+      uint8_t *input   = (uint8_t*)malloc(len);
+      uint32_t ref_crc = 0;
+
+      if (!input)
+         return 1;
+
+      scaler_bench_fill(input, len);
+
+      printf("%-8s %4dx%-4d -> %4dx%-4d", scaler_bench_type_names[cur->type],
+            cur->in_width, cur->in_height, cur->out_width, cur->out_height);
+
+      for (mode = 0; mode <= max_threads; mode++)
+      {
+         uint32_t crc = 0;
+         double us    = scaler_bench_run(cur, mode, iterations, input, &crc);
+
+         if (us < 0.0)
+         {
+            printf("     n/a");
+            mismatch = true;
+            continue;
+         }
+
+         if (mode == 0)
+            ref_crc = crc;
+         else if (crc != ref_crc)
+         {
+            fprintf(stderr, "\ncase %u: mode %u output differs\n", c, mode);
+            mismatch = true;
+         }
+
+         printf(" %7.3f", us / 1000.0);
+      }
+      printf(" ms (sse2, avx2, 2..%u threads)\n", max_threads);
+
+      free(input);
+   }
+
+   scaler_bench_gen_filter(iterations);
+
+   return mismatch ? 2 : 0;
+}
@@ -851,6 +851,21 @@ int main(int argc, char** argv)
 
    filestream_close(rdb_file);
 
+   /* Index the fields RetroArch looks entries up by */
+   {
+      libretrodb_t *db = libretrodb_new();
+
+      if (!db || libretrodb_open(rdb_path, db, true) != 0
+            || libretrodb_create_default_indexes(db) < 0)
+         printf("Could not create indexes for '%s'\n", rdb_path);
+
+      if (db)
+      {
+         libretrodb_close(db);
+         libretrodb_free(db);
+      }
+   }
+
    dat_converter_list_free(dat_parser_list);
 
    while (dat_count--)
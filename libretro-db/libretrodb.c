@@ -35,21 +35,54 @@
 #include <string/stdstring.h>
 #include <compat/strl.h>
 
+#ifdef HAVE_MMAP
+#include <fcntl.h>
+#include <memmap.h>
+#endif
+
 #include "libretrodb.h"
 #include "rmsgpack_dom.h"
 #include "rmsgpack.h"
-#include "bintree.h"
 #include "query.h"
 #include "libretrodb.h"
 
 #define MAGIC_NUMBER "RARCHDB"
 
-struct node_iter_ctx
-{
-   libretrodb_t *db;
-   libretrodb_index_t *idx;
+/* Read-only cursors map the database for
+ * libretrodb_cursor_read_view() */
+#if defined(HAVE_MMAP) && defined(HAVE_MMAN)
+#define LIBRETRODB_MAP
+#endif
+
+/* Index format written by libretrodb_create_index():
+ * records are sorted by (key, offset) and may repeat keys,
+ * and item offsets are stored big-endian. Version 0 indexes
+ * hold unique keys and native-endian offsets. */
+#define LIBRETRODB_INDEX_VERSION 1
+
+/* Longer string/binary values are indexed by their prefix;
+ * the query filter still checks every candidate in full. */
+#define LIBRETRODB_INDEX_KEY_MAX 32
+
+/* Largest key size of an index the planner will read */
+#define LIBRETRODB_INDEX_KEY_LIMIT 256
+
+/* Largest number of values in a planned equality/or() */
+#define LIBRETRODB_PLAN_MAX_KEYS 50
+
+static const char *libretrodb_default_indexes[] = {
+   "crc",
+   "serial",
+   "name",
+   NULL
 };
 
+typedef struct libretrodb_index_record
+{
+   uint8_t key[LIBRETRODB_INDEX_KEY_MAX];
+   uint64_t offset;
+} libretrodb_index_record_t;
+
 struct libretrodb
 {
    RFILE *fd;
@@ -66,6 +99,7 @@ struct libretrodb_index
    uint64_t key_size;
    uint64_t next;
    uint64_t count;
+   uint64_t version;
 };
 
 typedef struct libretrodb_metadata
@@ -84,6 +118,24 @@ struct libretrodb_cursor
    RFILE *fd;
    libretrodb_query_t *query;
    libretrodb_t *db;
+   /* Item offsets to visit, when the query was planned
+    * from an index */
+   uint64_t *offsets;
+   size_t offsets_count;
+   size_t offsets_ptr;
+#ifdef LIBRETRODB_MAP
+   const uint8_t *map;
+   size_t map_size;
+   /* Next item, while the file is mapped */
+   uint64_t pos;
+#endif
+   /* Encoded item, when the file isn't mapped */
+   uint8_t *buff;
+   size_t buff_len;
+   size_t buff_capacity;
+   /* Scratch for libretrodb_view_string() */
+   char *strings;
+   size_t strings_capacity;
    int is_valid;
    int eof;
 };
@@ -222,100 +274,242 @@ error:
    return -1;
 }
 
-static int libretrodb_find_index(libretrodb_t *db, const char *index_name,
+static struct rmsgpack_dom_value *libretrodb_map_value(
+      const struct rmsgpack_dom_value *map, const char *name,
+      enum rmsgpack_dom_type type)
+{
+   struct rmsgpack_dom_value key;
+   struct rmsgpack_dom_value *value;
+
+   key.type            = RDT_STRING;
+   key.val.string.len  = (uint32_t)strlen(name);
+   key.val.string.buff = (char*)name;
+
+   if (     (value = rmsgpack_dom_value_map_value(map, &key))
+         && value->type == type)
+      return value;
+   return NULL;
+}
+
+static int libretrodb_read_index_header(RFILE *fd,
       libretrodb_index_t *idx)
 {
-   filestream_seek(db->fd,
-                   (ssize_t)db->first_index_offset,
-                   RETRO_VFS_SEEK_POSITION_START);
+   struct rmsgpack_dom_value header;
+   struct rmsgpack_dom_value *name, *key_size, *next, *count, *version;
+   int rv = -1;
+
+   if (rmsgpack_dom_read(fd, &header) < 0)
+      return -1;
+
+   if (header.type != RDT_MAP)
+      goto clean;
+
+   name     = libretrodb_map_value(&header, "name",     RDT_STRING);
+   key_size = libretrodb_map_value(&header, "key_size", RDT_UINT);
+   next     = libretrodb_map_value(&header, "next",     RDT_UINT);
+   count    = libretrodb_map_value(&header, "count",    RDT_UINT);
+   /* Absent from indexes written before the format was versioned */
+   version  = libretrodb_map_value(&header, "version",  RDT_UINT);
+
+   if (!name || !key_size || !next || !count)
+      goto clean;
+
+   strlcpy(idx->name, name->val.string.buff, sizeof(idx->name));
+   idx->key_size = key_size->val.uint_;
+   idx->next     = next->val.uint_;
+   idx->count    = count->val.uint_;
+   idx->version  = version ? version->val.uint_ : 0;
+   rv            = 0;
+
+clean:
+   rmsgpack_dom_value_free(&header);
+   return rv;
+}
+
+/* Calls @cb for each index in the file, with @fd positioned
+ * at the index records. Stops when @cb returns non-zero. */
+static int libretrodb_foreach_index(libretrodb_t *db, RFILE *fd,
+      int (*cb)(RFILE *fd, libretrodb_index_t *idx, void *ctx), void *ctx)
+{
+   libretrodb_index_t idx;
+   int64_t size    = filestream_get_size(fd);
+   uint64_t offset = db->first_index_offset;
 
-   while (!filestream_eof(db->fd))
+   while ((int64_t)offset < size)
    {
-      uint64_t name_len = 50;
-      /* Read index header */
-      if (rmsgpack_dom_read_into(db->fd,
-            "name",     idx->name, &name_len,
-            "key_size", &idx->key_size,
-            "next",     &idx->next,
-            "count",    &idx->count,
-                                 NULL) < 0) {
-        printf("Invalid index header\n");
-        break;
+      int rv;
+
+      if (filestream_seek(fd, (int64_t)offset,
+               RETRO_VFS_SEEK_POSITION_START) < 0)
+         break;
+
+      if (libretrodb_read_index_header(fd, &idx) < 0)
+      {
+         printf("Invalid index header\n");
+         break;
       }
 
-      if (strncmp(index_name, idx->name, strlen(idx->name)) == 0)
-         return 0;
+      offset = (uint64_t)filestream_tell(fd);
 
-      filestream_seek(db->fd, (ssize_t)idx->next,
-            RETRO_VFS_SEEK_POSITION_CURRENT);
+      if ((rv = cb(fd, &idx, ctx)) != 0)
+         return rv;
+
+      offset += idx.next;
    }
 
-   return -1;
+   return 0;
 }
 
-static int binsearch(const void *buff, const void *item,
-      uint64_t count, uint8_t field_size, uint64_t *offset)
+static int libretrodb_find_index_cb(RFILE *fd,
+      libretrodb_index_t *idx, void *ctx)
 {
-   int mid            = (int)(count / 2);
-   int item_size      = field_size + sizeof(uint64_t);
-   uint8_t *current   = ((uint8_t *)buff + (mid * item_size));
-   int rv             = memcmp(current, item, field_size);
+   libretrodb_index_t *out = (libretrodb_index_t*)ctx;
 
-   if (rv == 0)
-   {
-      *offset         = *(uint64_t *)(current + field_size);
+   if (!string_is_equal(out->name, idx->name))
       return 0;
-   }
 
-   if (count == 0)
-      return -1;
+   memcpy(out, idx, sizeof(*out));
+   return 1;
+}
+
+/* On success, db->fd is positioned at the index records */
+static int libretrodb_find_index(libretrodb_t *db, const char *index_name,
+      libretrodb_index_t *idx)
+{
+   strlcpy(idx->name, index_name, sizeof(idx->name));
+   if (libretrodb_foreach_index(db, db->fd, libretrodb_find_index_cb,
+            idx) == 1)
+      return 0;
+   return -1;
+}
+
+static void libretrodb_index_key(const struct rmsgpack_dom_value *value,
+      uint8_t *key, size_t key_size)
+{
+   size_t len = 0;
 
-   if (rv > 0)
-      return binsearch(buff, item, mid, field_size, offset);
+   memset(key, 0, key_size);
 
-   return binsearch(current + item_size, item,
-         count - mid, field_size, offset);
+   if (value->type == RDT_STRING)
+      len = value->val.string.len;
+   else if (value->type == RDT_BINARY)
+      len = value->val.binary.len;
+
+   if (len > key_size)
+      len = key_size;
+   if (len)
+      memcpy(key, value->type == RDT_STRING
+            ? (const void*)value->val.string.buff
+            : (const void*)value->val.binary.buff, len);
 }
 
-int libretrodb_find_entry(libretrodb_t *db, const char *index_name,
-      const void *key, struct rmsgpack_dom_value *out)
+static int libretrodb_index_read_record(RFILE *fd, uint64_t base,
+      const libretrodb_index_t *idx, uint64_t i,
+      uint8_t *key, uint64_t *offset)
 {
-   libretrodb_index_t idx;
-   int rv;
-   uint8_t *buff;
-   uint64_t offset;
-   ssize_t bufflen, nread = 0;
+   uint64_t item_offset;
 
-   if (libretrodb_find_index(db, index_name, &idx) < 0)
+   if (filestream_seek(fd,
+            (int64_t)(base + i * (idx->key_size + sizeof(uint64_t))),
+            RETRO_VFS_SEEK_POSITION_START) < 0)
+      return -1;
+   if (filestream_read(fd, key, (int64_t)idx->key_size)
+         != (int64_t)idx->key_size)
       return -1;
+   if (filestream_read(fd, &item_offset, sizeof(item_offset))
+         != sizeof(item_offset))
+      return -1;
+
+   if (idx->version >= 1)
+      item_offset = swap_if_little64(item_offset);
+   *offset        = item_offset;
+   return 0;
+}
+
+/**
+ * libretrodb_index_lookup:
+ *
+ * Binary search of the index records starting at @base for
+ * @key, appending the offset of every matching item to
+ * @offsets (grown as needed).
+ *
+ * Returns: 0 if successful, otherwise negative.
+ **/
+static int libretrodb_index_lookup(RFILE *fd, uint64_t base,
+      const libretrodb_index_t *idx, const uint8_t *key,
+      uint64_t **offsets, size_t *count, size_t *capacity)
+{
+   uint8_t current[LIBRETRODB_INDEX_KEY_LIMIT];
+   uint64_t offset;
+   uint64_t lo = 0;
+   uint64_t hi = idx->count;
 
-   bufflen        = idx.next;
-   if (!(buff = (uint8_t*)malloc(bufflen)))
+   if (idx->key_size == 0 || idx->key_size > sizeof(current))
       return -1;
 
-   while (nread < bufflen)
+   /* Lower bound */
+   while (lo < hi)
    {
-      void *buff_ = (buff + nread);
-      rv          = (int)filestream_read(db->fd, buff_, bufflen - nread);
+      uint64_t mid = lo + (hi - lo) / 2;
+      if (libretrodb_index_read_record(fd, base, idx, mid,
+               current, &offset) < 0)
+         return -1;
+      if (memcmp(current, key, (size_t)idx->key_size) < 0)
+         lo = mid + 1;
+      else
+         hi = mid;
+   }
 
-      if (rv <= 0)
-      {
-         free(buff);
+   for (; lo < idx->count; lo++)
+   {
+      if (libretrodb_index_read_record(fd, base, idx, lo,
+               current, &offset) < 0)
          return -1;
+      if (memcmp(current, key, (size_t)idx->key_size) != 0)
+         break;
+
+      if (*count == *capacity)
+      {
+         size_t new_capacity = *capacity ? *capacity * 2 : 16;
+         uint64_t *new_offsets = (uint64_t*)realloc(*offsets,
+               new_capacity * sizeof(uint64_t));
+         if (!new_offsets)
+            return -1;
+         *offsets  = new_offsets;
+         *capacity = new_capacity;
       }
-      nread += rv;
+
+      (*offsets)[(*count)++] = offset;
    }
 
-   rv = binsearch(buff, key, idx.count, (ssize_t)idx.key_size, &offset);
-   free(buff);
+   return 0;
+}
 
-   if (rv == 0) {
-      filestream_seek(db->fd, (ssize_t)offset, RETRO_VFS_SEEK_POSITION_START);
-      rmsgpack_dom_read(db->fd, out);
-      return 0;
-   } else {
-     return -1;
-   }
+int libretrodb_find_entry(libretrodb_t *db, const char *index_name,
+      const void *key, struct rmsgpack_dom_value *out)
+{
+   libretrodb_index_t idx;
+   uint64_t base;
+   uint64_t *offsets = NULL;
+   size_t count      = 0;
+   size_t capacity   = 0;
+   int rv            = -1;
+
+   if (libretrodb_find_index(db, index_name, &idx) < 0)
+      return -1;
+
+   base = (uint64_t)filestream_tell(db->fd);
+
+   if (     libretrodb_index_lookup(db->fd, base, &idx,
+               (const uint8_t*)key, &offsets, &count, &capacity) == 0
+         && count > 0
+         && filestream_seek(db->fd, (int64_t)offsets[0],
+               RETRO_VFS_SEEK_POSITION_START) >= 0
+         && rmsgpack_dom_read(db->fd, out) >= 0)
+      rv = 0;
+
+   free(offsets);
+   return rv;
 }
 
 /**
@@ -328,7 +522,11 @@ int libretrodb_find_entry(libretrodb_t *db, const char *index_name,
  **/
 int libretrodb_cursor_reset(libretrodb_cursor_t *cursor)
 {
-   cursor->eof = 0;
+   cursor->eof         = 0;
+   cursor->offsets_ptr = 0;
+#ifdef LIBRETRODB_MAP
+   cursor->pos         = cursor->db->root + sizeof(libretrodb_header_t);
+#endif
    return (int)filestream_seek(cursor->fd,
          (ssize_t)(cursor->db->root + sizeof(libretrodb_header_t)),
          RETRO_VFS_SEEK_POSITION_START);
@@ -343,9 +541,32 @@ int libretrodb_cursor_read_item(libretrodb_cursor_t *cursor,
       return EOF;
 
 retry:
+   if (cursor->offsets)
+   {
+      if (cursor->offsets_ptr >= cursor->offsets_count)
+      {
+         cursor->eof = 1;
+         return EOF;
+      }
+      if (filestream_seek(cursor->fd,
+               (int64_t)cursor->offsets[cursor->offsets_ptr++],
+               RETRO_VFS_SEEK_POSITION_START) < 0)
+         return -1;
+   }
+#ifdef LIBRETRODB_MAP
+   else if (cursor->map && filestream_seek(cursor->fd,
+            (int64_t)cursor->pos, RETRO_VFS_SEEK_POSITION_START) < 0)
+      return -1;
+#endif
+
    if ((rv = rmsgpack_dom_read(cursor->fd, out)) < 0)
       return rv;
 
+#ifdef LIBRETRODB_MAP
+   if (cursor->map)
+      cursor->pos = (uint64_t)filestream_tell(cursor->fd);
+#endif
+
    if (out->type == RDT_NULL)
    {
       cursor->eof = 1;
@@ -364,6 +585,175 @@ retry:
    return 0;
 }
 
+int libretrodb_cursor_read_view(libretrodb_cursor_t *cursor,
+      libretrodb_view_t *out)
+{
+   struct rmsgpack_view_value item;
+   const uint8_t *data = NULL;
+   const uint8_t *next = NULL;
+   uint64_t start      = 0;
+   size_t size;
+
+   if (cursor->eof)
+      return EOF;
+
+retry:
+   if (cursor->offsets)
+   {
+      if (cursor->offsets_ptr >= cursor->offsets_count)
+      {
+         cursor->eof = 1;
+         return EOF;
+      }
+      start = cursor->offsets[cursor->offsets_ptr++];
+   }
+#ifdef LIBRETRODB_MAP
+   else if (cursor->map)
+      start = cursor->pos;
+#endif
+   else
+      start = (uint64_t)filestream_tell(cursor->fd);
+
+#ifdef LIBRETRODB_MAP
+   if (cursor->map)
+   {
+      if (start >= cursor->map_size)
+         return -1;
+      data = cursor->map + start;
+      if (!(next = rmsgpack_view_read(data,
+                  cursor->map + cursor->map_size, &item)))
+         return -1;
+      cursor->pos = (uint64_t)(next - cursor->map);
+   }
+   else
+#endif
+   {
+      cursor->buff_len = 0;
+      if (     (cursor->offsets && filestream_seek(cursor->fd,
+                  (int64_t)start, RETRO_VFS_SEEK_POSITION_START) < 0)
+            || rmsgpack_read_raw(cursor->fd, &cursor->buff,
+                  &cursor->buff_len, &cursor->buff_capacity) < 0)
+         return -1;
+      data = cursor->buff;
+      if (!(next = rmsgpack_view_read(data,
+                  cursor->buff + cursor->buff_len, &item)))
+         return -1;
+   }
+
+   if (item.type == RDT_NULL)
+   {
+      cursor->eof = 1;
+      return EOF;
+   }
+
+   if (item.type != RDT_MAP)
+      goto retry;
+
+   /* The query filter works on decoded items; with a
+    * planned query this only decodes the candidates */
+   if (cursor->query)
+   {
+      int match;
+      struct rmsgpack_dom_value value;
+
+      if (filestream_seek(cursor->fd, (int64_t)start,
+               RETRO_VFS_SEEK_POSITION_START) < 0)
+         return -1;
+      if (rmsgpack_dom_read(cursor->fd, &value) < 0)
+         return -1;
+      match = libretrodb_query_filter(cursor->query, &value);
+      rmsgpack_dom_value_free(&value);
+      if (!match)
+         goto retry;
+   }
+
+   /* Each string is at least one byte shorter than its
+    * encoding, so this fits all of them NUL-terminated */
+   size = (size_t)(next - data) + 1;
+   if (size > cursor->strings_capacity)
+   {
+      char *strings = (char*)realloc(cursor->strings, size);
+      if (!strings)
+         return -1;
+      cursor->strings          = strings;
+      cursor->strings_capacity = size;
+   }
+
+   out->pos              = item.val.map.items;
+   out->end              = next;
+   out->remaining        = item.val.map.len;
+   out->strings          = cursor->strings;
+   out->strings_len      = 0;
+   out->strings_capacity = cursor->strings_capacity;
+   return 0;
+}
+
+bool libretrodb_view_next(libretrodb_view_t *view,
+      struct rmsgpack_view_value *key, struct rmsgpack_view_value *value)
+{
+   const uint8_t *next;
+
+   if (!view->remaining)
+      return false;
+
+   if (     !(next = rmsgpack_view_read(view->pos, view->end, key))
+         || !(next = rmsgpack_view_read(next, view->end, value)))
+   {
+      view->remaining = 0;
+      return false;
+   }
+
+   view->pos = next;
+   view->remaining--;
+   return true;
+}
+
+const char *libretrodb_view_string(libretrodb_view_t *view,
+      const struct rmsgpack_view_value *value)
+{
+   char *s;
+   uint32_t len;
+
+   if (value->type != RDT_STRING && value->type != RDT_BINARY)
+      return NULL;
+
+   len = value->val.string.len;
+   if (view->strings_len + len + 1 > view->strings_capacity)
+      return NULL;
+
+   s = view->strings + view->strings_len;
+   memcpy(s, value->val.string.buff, len);
+   s[len]             = '\0';
+   view->strings_len += len + 1;
+   return s;
+}
+
+uint64_t libretrodb_cursor_tell(libretrodb_cursor_t *cursor)
+{
+#ifdef LIBRETRODB_MAP
+   if (cursor->map)
+      return cursor->pos;
+#endif
+   return (uint64_t)filestream_tell(cursor->fd);
+}
+
+int libretrodb_cursor_seek(libretrodb_cursor_t *cursor, uint64_t offset)
+{
+   /* Continue sequentially from @offset */
+   free(cursor->offsets);
+   cursor->offsets       = NULL;
+   cursor->offsets_count = 0;
+   cursor->offsets_ptr   = 0;
+   cursor->eof           = 0;
+#ifdef LIBRETRODB_MAP
+   cursor->pos           = offset;
+#endif
+   if (filestream_seek(cursor->fd, (int64_t)offset,
+         RETRO_VFS_SEEK_POSITION_START) < 0)
+      return -1;
+   return 0;
+}
+
 /**
  * libretrodb_cursor_close:
  * @cursor              : Handle to database cursor.
@@ -381,11 +771,165 @@ void libretrodb_cursor_close(libretrodb_cursor_t *cursor)
    if (cursor->query)
       libretrodb_query_free(cursor->query);
 
-   cursor->is_valid = 0;
-   cursor->eof      = 1;
-   cursor->fd       = NULL;
-   cursor->db       = NULL;
-   cursor->query    = NULL;
+#ifdef LIBRETRODB_MAP
+   if (cursor->map)
+      munmap((void*)cursor->map, cursor->map_size);
+   cursor->map              = NULL;
+   cursor->map_size         = 0;
+#endif
+
+   free(cursor->offsets);
+   free(cursor->buff);
+   free(cursor->strings);
+
+   cursor->is_valid         = 0;
+   cursor->eof              = 1;
+   cursor->fd               = NULL;
+   cursor->db               = NULL;
+   cursor->query            = NULL;
+   cursor->offsets          = NULL;
+   cursor->offsets_count    = 0;
+   cursor->offsets_ptr      = 0;
+   cursor->buff             = NULL;
+   cursor->buff_len         = 0;
+   cursor->buff_capacity    = 0;
+   cursor->strings          = NULL;
+   cursor->strings_capacity = 0;
+}
+
+#ifdef LIBRETRODB_MAP
+static void libretrodb_cursor_map(libretrodb_cursor_t *cursor)
+{
+   struct stat st;
+   void *map;
+   int fd = open(cursor->db->path, O_RDONLY);
+
+   if (fd < 0)
+      return;
+
+   if (     fstat(fd, &st) == 0
+         && st.st_size > 0
+         && (map = mmap(NULL, (size_t)st.st_size, PROT_READ,
+               MAP_SHARED, fd, 0)) != MAP_FAILED)
+   {
+      cursor->map      = (const uint8_t*)map;
+      cursor->map_size = (size_t)st.st_size;
+   }
+
+   /* The mapping outlives the descriptor */
+   close(fd);
+}
+#endif
+
+struct libretrodb_plan
+{
+   libretrodb_query_t *query;
+   uint64_t *offsets;
+   size_t count;
+   bool planned;
+};
+
+static int libretrodb_plan_index_cb(RFILE *fd,
+      libretrodb_index_t *idx, void *ctx)
+{
+   unsigned i;
+   uint8_t key[LIBRETRODB_INDEX_KEY_LIMIT];
+   const struct rmsgpack_dom_value *keys[LIBRETRODB_PLAN_MAX_KEYS];
+   struct libretrodb_plan *plan = (struct libretrodb_plan*)ctx;
+   uint64_t base                = (uint64_t)filestream_tell(fd);
+   uint64_t *offsets            = NULL;
+   size_t count                 = 0;
+   size_t capacity              = 0;
+   int nkeys                    = libretrodb_query_get_keys(plan->query,
+         idx->name, keys, LIBRETRODB_PLAN_MAX_KEYS);
+
+   /* Version 0 indexes were written with a wrong offset for
+    * the first record, so planning from one could return a
+    * different result than the full scan. Leave those to it. */
+   if (idx->version < 1)
+      return 0;
+
+   /* Index names are the names of the fields they cover */
+   if (nkeys < 0 || idx->key_size == 0 || idx->key_size > sizeof(key))
+      return 0;
+
+   for (i = 0; i < (unsigned)nkeys; i++)
+   {
+      libretrodb_index_key(keys[i], key, (size_t)idx->key_size);
+      if (libretrodb_index_lookup(fd, base, idx, key,
+               &offsets, &count, &capacity) < 0)
+      {
+         free(offsets);
+         return 0;
+      }
+   }
+
+   /* Keep the most selective index */
+   if (!plan->planned || count < plan->count)
+   {
+      free(plan->offsets);
+      plan->offsets = offsets;
+      plan->count   = count;
+      plan->planned = true;
+   }
+   else
+      free(offsets);
+
+   return 0;
+}
+
+static int libretrodb_offset_compare(const void *left, const void *right)
+{
+   uint64_t l = *(const uint64_t*)left;
+   uint64_t r = *(const uint64_t*)right;
+   return (l > r) - (l < r);
+}
+
+/**
+ * libretrodb_cursor_plan:
+ * @cursor              : Handle to database cursor.
+ *
+ * If the query pins an indexed field to one or more values,
+ * restricts the cursor to the items found in that index,
+ * visited in file order. The query still filters every item
+ * read, so results match a full scan.
+ **/
+static void libretrodb_cursor_plan(libretrodb_cursor_t *cursor)
+{
+   size_t i, j;
+   struct libretrodb_plan plan;
+
+   plan.query   = cursor->query;
+   plan.offsets = NULL;
+   plan.count   = 0;
+   plan.planned = false;
+
+   libretrodb_foreach_index(cursor->db, cursor->fd,
+         libretrodb_plan_index_cb, &plan);
+
+   if (plan.planned)
+   {
+      if (plan.count > 1)
+         qsort(plan.offsets, plan.count, sizeof(uint64_t),
+               libretrodb_offset_compare);
+
+      /* Remove items found by more than one value */
+      for (i = j = 0; i < plan.count; i++)
+         if (j == 0 || plan.offsets[i] != plan.offsets[j - 1])
+            plan.offsets[j++] = plan.offsets[i];
+
+      /* An empty plan still needs a (non-NULL) offset list */
+      if (!plan.offsets)
+         plan.offsets = (uint64_t*)malloc(sizeof(uint64_t));
+
+      if (plan.offsets)
+      {
+         cursor->offsets       = plan.offsets;
+         cursor->offsets_count = j;
+      }
+   }
+
+   libretrodb_cursor_reset(cursor);
 }
 
 /**
@@ -411,122 +955,143 @@ int libretrodb_cursor_open(libretrodb_t *db,
          RETRO_VFS_FILE_ACCESS_HINT_NONE)))
       return -1;
 
-   cursor->fd       = fd;
-   cursor->db       = db;
-   cursor->is_valid = 1;
-   libretrodb_cursor_reset(cursor);
-   cursor->query    = q;
+   cursor->fd               = fd;
+   cursor->db               = db;
+   cursor->is_valid         = 1;
+   cursor->offsets          = NULL;
+   cursor->offsets_count    = 0;
+   cursor->offsets_ptr      = 0;
+   cursor->buff             = NULL;
+   cursor->buff_len         = 0;
+   cursor->buff_capacity    = 0;
+   cursor->strings          = NULL;
+   cursor->strings_capacity = 0;
+   cursor->query            = q;
+#ifdef LIBRETRODB_MAP
+   cursor->map              = NULL;
+   cursor->map_size         = 0;
+   if (!db->can_write)
+      libretrodb_cursor_map(cursor);
+#endif
 
    if (q)
+   {
       libretrodb_query_inc_ref(q);
+      libretrodb_cursor_plan(cursor);
+   }
+   else
+      libretrodb_cursor_reset(cursor);
 
    return 0;
 }
 
-static int node_iter(void *value, void *ctx)
+static int libretrodb_index_record_compare(const void *left,
+      const void *right)
 {
-   struct node_iter_ctx *nictx = (struct node_iter_ctx*)ctx;
-
-   if (filestream_write(nictx->db->fd, value,
-            (ssize_t)(nictx->idx->key_size + sizeof(uint64_t))) > 0)
-      return 0;
-
-   return -1;
-}
+   const libretrodb_index_record_t *l =
+      (const libretrodb_index_record_t*)left;
+   const libretrodb_index_record_t *r =
+      (const libretrodb_index_record_t*)right;
+   int rv = memcmp(l->key, r->key, sizeof(l->key));
 
-static int node_compare(const void *a, const void *b, void *ctx)
-{
-   return memcmp(a, b, *(uint8_t *)ctx);
+   if (rv != 0)
+      return rv;
+   return (l->offset > r->offset) - (l->offset < r->offset);
 }
 
 int libretrodb_create_index(libretrodb_t *db,
       const char *name, const char *field_name)
 {
-   struct node_iter_ctx nictx;
-   struct rmsgpack_dom_value key;
+   size_t i;
    libretrodb_index_t idx;
+   struct rmsgpack_dom_value key;
    struct rmsgpack_dom_value item;
-   libretrodb_cursor_t cur          = {0};
-   struct rmsgpack_dom_value *field = NULL;
-   void *buff                       = NULL;
-   uint64_t *buff_u64               = NULL;
-   uint8_t field_size               = 0;
-   uint64_t item_loc                = filestream_tell(db->fd);
-   bintree_t *tree;
-   uint64_t item_count              = 0;
-   int rval                         = -1;
+   libretrodb_cursor_t cur             = {0};
+   libretrodb_index_record_t *records  = NULL;
+   size_t count                        = 0;
+   size_t capacity                     = 0;
+   uint64_t key_size                   = 0;
+   int rval                            = -1;
 
    if (libretrodb_find_index(db, name, &idx) >= 0)
      return 1;
    if (!db->can_write)
      return -1;
 
-   tree = bintree_new(node_compare, &field_size);
+   item.type                           = RDT_NULL;
 
-   item.type                        = RDT_NULL;
-
-   if (!tree || (libretrodb_cursor_open(db, &cur, NULL) != 0))
+   if (libretrodb_cursor_open(db, &cur, NULL) != 0)
       goto clean;
 
-   key.type                         = RDT_STRING;
-   key.val.string.len               = (uint32_t)strlen(field_name);
-   key.val.string.buff              = (char *)field_name;   /* We know we aren't going to change it */
+   key.type                            = RDT_STRING;
+   key.val.string.len                  = (uint32_t)strlen(field_name);
+   key.val.string.buff                 = (char *)field_name;   /* We know we aren't going to change it */
 
-   while (libretrodb_cursor_read_item(&cur, &item) == 0)
+   for (;;)
    {
-      /* Only map keys are supported */
-      if (item.type != RDT_MAP)
-         goto clean;
-
-      /* Field not found in item? */
-      if (!(field = rmsgpack_dom_value_map_value(&item, &key)))
-        continue;
-
-      /* Field is not binary? */
-      if (field->type != RDT_BINARY)
-         goto clean;
-
-      /* Field is empty? */
-      if (field->val.binary.len == 0)
-         goto clean;
-
-      if (field_size == 0)
-         field_size = field->val.binary.len;
-      /* Field is not of correct size */
-      else if (field->val.binary.len != field_size)
-         goto clean;
-
-      if (!(buff = malloc(field_size + sizeof(uint64_t))))
-         goto clean;
+      struct rmsgpack_dom_value *field = NULL;
+      uint64_t item_loc                = (uint64_t)filestream_tell(cur.fd);
+      size_t len;
+
+      if (libretrodb_cursor_read_item(&cur, &item) != 0)
+         break;
+
+      /* Only string and binary fields are indexed; a query
+       * for such a value can never match other types */
+      if (     item.type != RDT_MAP
+            || !(field = rmsgpack_dom_value_map_value(&item, &key))
+            || (field->type != RDT_STRING && field->type != RDT_BINARY))
+      {
+         rmsgpack_dom_value_free(&item);
+         continue;
+      }
 
-      memcpy(buff, field->val.binary.buff, field_size);
+      if (count == capacity)
+      {
+         size_t new_capacity = capacity ? capacity * 2 : 1024;
+         libretrodb_index_record_t *new_records =
+            (libretrodb_index_record_t*)realloc(records,
+                  new_capacity * sizeof(*records));
+         if (!new_records)
+            goto clean;
+         records  = new_records;
+         capacity = new_capacity;
+      }
 
-      buff_u64 = (uint64_t *)((uint8_t *)buff + field_size);
+      len = (field->type == RDT_STRING)
+         ? field->val.string.len
+         : field->val.binary.len;
+      if (len > key_size)
+         key_size = (len > LIBRETRODB_INDEX_KEY_MAX)
+            ? LIBRETRODB_INDEX_KEY_MAX
+            : len;
 
-      memcpy(buff_u64, &item_loc, sizeof(uint64_t));
+      libretrodb_index_key(field, records[count].key,
+            LIBRETRODB_INDEX_KEY_MAX);
+      records[count].offset = item_loc;
+      count++;
 
-      /* Value is not unique? */
-      if (bintree_insert(tree, tree->root, buff) != 0)
-      {
-         rmsgpack_dom_value_print(field);
-         goto clean;
-      }
-      item_count++;
-      buff     = NULL;
       rmsgpack_dom_value_free(&item);
-      item_loc = filestream_tell(cur.fd);
    }
-   rval = 0;
+
+   /* Bytes past key_size are zero in every record,
+    * so this is also (key, offset) order at key_size */
+   qsort(records, count, sizeof(*records),
+         libretrodb_index_record_compare);
+
+   if (key_size == 0)
+      key_size = 1;
 
    filestream_seek(db->fd, 0, RETRO_VFS_SEEK_POSITION_END);
 
    strlcpy(idx.name, name, sizeof(idx.name));
 
-   idx.key_size = field_size;
-   idx.next     = item_count * (field_size + sizeof(uint64_t));
-   idx.count    = item_count;
+   idx.key_size = key_size;
+   idx.next     = count * (key_size + sizeof(uint64_t));
+   idx.count    = count;
+   idx.version  = LIBRETRODB_INDEX_VERSION;
    /* Write index header */
-   rmsgpack_write_map_header(db->fd, 4);
+   rmsgpack_write_map_header(db->fd, 5);
    rmsgpack_write_string(db->fd, "name", STRLEN_CONST("name"));
    rmsgpack_write_string(db->fd, idx.name, (uint32_t)strlen(idx.name));
    rmsgpack_write_string(db->fd, "key_size", (uint32_t)STRLEN_CONST("key_size"));
@@ -535,24 +1100,49 @@ int libretrodb_create_index(libretrodb_t *db,
    rmsgpack_write_uint  (db->fd, idx.next);
    rmsgpack_write_string(db->fd, "count", STRLEN_CONST("count"));
    rmsgpack_write_uint  (db->fd, idx.count);
+   rmsgpack_write_string(db->fd, "version", STRLEN_CONST("version"));
+   rmsgpack_write_uint  (db->fd, idx.version);
 
-   nictx.db     = db;
-   nictx.idx    = &idx;
-   bintree_iterate(tree->root, node_iter, &nictx);
+   for (i = 0; i < count; i++)
+   {
+      uint64_t offset = swap_if_little64(records[i].offset);
+      if (     filestream_write(db->fd, records[i].key,
+                  (int64_t)key_size) != (int64_t)key_size
+            || filestream_write(db->fd, &offset,
+                  sizeof(offset)) != sizeof(offset))
+         goto clean;
+   }
 
    filestream_flush(db->fd);
+   rval = 0;
 clean:
    rmsgpack_dom_value_free(&item);
-   if (buff)
-      free(buff);
+   free(records);
    if (cur.is_valid)
       libretrodb_cursor_close(&cur);
-   if (tree && tree->root)
-      bintree_free(tree->root);
-   free(tree);
    return rval;
 }
 
+/**
+ * libretrodb_create_default_indexes:
+ * @db                  : Handle to database, opened for writing.
+ *
+ * Creates the indexes the query planner uses for RetroArch's
+ * own lookups, on the crc, serial and name fields.
+ *
+ * Returns: 0 if successful, otherwise negative.
+ **/
+int libretrodb_create_default_indexes(libretrodb_t *db)
+{
+   const char **field;
+
+   for (field = libretrodb_default_indexes; *field; field++)
+      if (libretrodb_create_index(db, *field, *field) < 0)
+         return -1;
+
+   return 0;
+}
+
 libretrodb_cursor_t *libretrodb_cursor_new(void)
 {
    libretrodb_cursor_t *dbc = (libretrodb_cursor_t*)
@@ -566,6 +1156,19 @@ libretrodb_cursor_t *libretrodb_cursor_new(void)
    dbc->eof                 = 0;
    dbc->query               = NULL;
    dbc->db                  = NULL;
+   dbc->offsets             = NULL;
+   dbc->offsets_count       = 0;
+   dbc->offsets_ptr         = 0;
+   dbc->buff                = NULL;
+   dbc->buff_len            = 0;
+   dbc->buff_capacity       = 0;
+   dbc->strings             = NULL;
+   dbc->strings_capacity    = 0;
+#ifdef LIBRETRODB_MAP
+   dbc->map                 = NULL;
+   dbc->map_size            = 0;
+   dbc->pos                 = 0;
+#endif
 
    return dbc;
 }
@@ -33,6 +33,7 @@
 #include <retro_common_api.h>
 
 #include "query.h"
+#include "rmsgpack.h"
 #include "rmsgpack_dom.h"
 
 RETRO_BEGIN_DECLS
@@ -43,6 +44,17 @@ typedef struct libretrodb_cursor libretrodb_cursor_t;
 
 typedef struct libretrodb_index libretrodb_index_t;
 
+/* An undecoded item, see libretrodb_cursor_read_view() */
+typedef struct libretrodb_view
+{
+   const uint8_t *pos;
+   const uint8_t *end;
+   char *strings;
+   size_t strings_len;
+   size_t strings_capacity;
+   uint32_t remaining;
+} libretrodb_view_t;
+
 typedef int (*libretrodb_value_provider)(void *ctx, struct rmsgpack_dom_value *out);
 
 int libretrodb_create(RFILE *fd, libretrodb_value_provider value_provider, void *ctx);
@@ -54,6 +66,8 @@ int libretrodb_open(const char *path, libretrodb_t *db, bool write);
 int libretrodb_create_index(libretrodb_t *db, const char *name,
       const char *field_name);
 
+int libretrodb_create_default_indexes(libretrodb_t *db);
+
 int libretrodb_find_entry(libretrodb_t *db, const char *index_name,
         const void *key, struct rmsgpack_dom_value *out);
 
@@ -105,6 +119,68 @@ void libretrodb_query_free(void *q);
 int libretrodb_cursor_read_item(libretrodb_cursor_t *cursor,
       struct rmsgpack_dom_value *out);
 
+/**
+ * libretrodb_cursor_read_view:
+ * @cursor              : Handle to database cursor.
+ * @out                 : View of the next (map) item.
+ *
+ * Like libretrodb_cursor_read_item(), but without decoding
+ * the item into a tree of allocated values. Databases opened
+ * read-only are memory-mapped, and the view points straight
+ * into the mapping. The view is valid until the next read
+ * or until the cursor is closed.
+ *
+ * Returns: 0 if successful, EOF at the end, otherwise negative.
+ **/
+int libretrodb_cursor_read_view(libretrodb_cursor_t *cursor,
+      libretrodb_view_t *out);
+
+/**
+ * libretrodb_view_next:
+ * @view                : View from libretrodb_cursor_read_view().
+ * @key                 : Field name.
+ * @value               : Field value.
+ *
+ * Decodes the next field of @view.
+ *
+ * Returns: false once all fields have been read.
+ **/
+bool libretrodb_view_next(libretrodb_view_t *view,
+      struct rmsgpack_view_value *key, struct rmsgpack_view_value *value);
+
+/**
+ * libretrodb_view_string:
+ * @view                : View from libretrodb_cursor_read_view().
+ * @value               : String or binary field value of @view.
+ *
+ * Returns: NUL-terminated copy of @value in a scratch buffer
+ * owned by the cursor (valid as long as @view), or NULL if
+ * @value is not a string/binary. Allocates nothing.
+ **/
+const char *libretrodb_view_string(libretrodb_view_t *view,
+      const struct rmsgpack_view_value *value);
+
+/**
+ * libretrodb_cursor_tell:
+ * @cursor              : Handle to database cursor.
+ *
+ * Returns: file offset of the next item the cursor reads,
+ * which can be handed to libretrodb_cursor_seek() later.
+ **/
+uint64_t libretrodb_cursor_tell(libretrodb_cursor_t *cursor);
+
+/**
+ * libretrodb_cursor_seek:
+ * @cursor              : Handle to database cursor.
+ * @offset              : Item offset from libretrodb_cursor_tell().
+ *
+ * Moves the cursor to the item at @offset; reading then
+ * continues sequentially, even for an index-driven query.
+ *
+ * Returns: 0 if successful, otherwise negative.
+ **/
+int libretrodb_cursor_seek(libretrodb_cursor_t *cursor, uint64_t offset);
+
 RETRO_END_DECLS
 
 #endif
@@ -45,7 +45,7 @@ int main(int argc, char ** argv)
       printf("Usage: %s <db file> <command> [extra args...]\n", argv[0]);
       printf("Available Commands:\n");
       printf("\tlist\n");
-      printf("\tcreate-index <index name> <field name>\n");
+      printf("\tcreate-index [<index name> <field name>]\n");
       printf("\tfind <query expression>\n");
       printf("\tget-names <query expression>\n");
       return 1;
@@ -163,16 +163,24 @@ int main(int argc, char ** argv)
    {
       const char * index_name, * field_name;
 
-      if (argc != 5)
+      /* Without arguments, create the indexes RetroArch queries */
+      if (argc == 3)
       {
-         printf("Usage: %s <db file> create-index <index name> <field name>\n", argv[0]);
+         if (libretrodb_create_default_indexes(db) < 0)
+            printf("Could not create indexes\n");
+      }
+      else if (argc != 5)
+      {
+         printf("Usage: %s <db file> create-index [<index name> <field name>]\n", argv[0]);
          goto error;
       }
+      else
+      {
+         index_name = argv[3];
+         field_name = argv[4];
 
-      index_name = argv[3];
-      field_name = argv[4];
-
-      libretrodb_create_index(db, index_name, field_name);
+         libretrodb_create_index(db, index_name, field_name);
+      }
    }
    else
    {
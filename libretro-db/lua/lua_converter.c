@@ -112,5 +112,21 @@ int main(int argc, char ** argv)
 clean:
    lua_close(L);
    filestream_close(dst);
+
+   /* Index the fields RetroArch looks entries up by */
+   if (dst && rv >= 0)
+   {
+      libretrodb_t *db = libretrodb_new();
+
+      if (!db || libretrodb_open(db_file, db, true) != 0
+            || libretrodb_create_default_indexes(db) < 0)
+         printf("Could not create indexes for '%s'\n", db_file);
+
+      if (db)
+      {
+         libretrodb_close(db);
+         libretrodb_free(db);
+      }
+   }
    return rv;
 }
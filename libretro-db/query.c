@@ -984,6 +984,64 @@ void libretrodb_query_inc_ref(libretrodb_query_t *q)
       rq->ref_count += 1;
 }
 
+static bool query_value_is_indexable(const struct argument *arg)
+{
+   return arg->type == AT_VALUE
+      && (  arg->a.value.type == RDT_STRING
+         || arg->a.value.type == RDT_BINARY);
+}
+
+int libretrodb_query_get_keys(libretrodb_query_t *q, const char *field,
+      const struct rmsgpack_dom_value **keys, unsigned max_keys)
+{
+   unsigned i, j;
+   struct invocation *root = &((struct query*)q)->root;
+
+   /* Only a top-level table ({field: value, ...}) requires
+    * every one of its fields to match */
+   if (root->func != query_func_all_map)
+      return -1;
+
+   for (i = 0; i + 1 < root->argc; i += 2)
+   {
+      const struct argument *name  = &root->argv[i];
+      const struct argument *match = &root->argv[i + 1];
+
+      if (     name->type              != AT_VALUE
+            || name->a.value.type      != RDT_STRING
+            || !string_is_equal(name->a.value.val.string.buff, field))
+         continue;
+
+      /* field: value */
+      if (query_value_is_indexable(match))
+      {
+         if (max_keys < 1)
+            return -1;
+         keys[0] = &match->a.value;
+         return 1;
+      }
+
+      /* field: or(value, value, ...) */
+      if (     match->type                  != AT_FUNCTION
+            || match->a.invocation.func     != query_func_operator_or
+            || match->a.invocation.argc     == 0
+            || match->a.invocation.argc     >  max_keys)
+         continue;
+
+      for (j = 0; j < match->a.invocation.argc; j++)
+      {
+         if (!query_value_is_indexable(&match->a.invocation.argv[j]))
+            break;
+         keys[j] = &match->a.invocation.argv[j].a.value;
+      }
+
+      if (j == match->a.invocation.argc)
+         return (int)j;
+   }
+
+   return -1;
+}
+
 int libretrodb_query_filter(libretrodb_query_t *q,
       struct rmsgpack_dom_value *v)
 {
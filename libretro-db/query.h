@@ -38,6 +38,23 @@ void libretrodb_query_dec_ref(libretrodb_query_t *q);
 
 int libretrodb_query_filter(libretrodb_query_t *q, struct rmsgpack_dom_value *v);
 
+/**
+ * libretrodb_query_get_keys:
+ * @q                   : Compiled query.
+ * @field               : Field name.
+ * @keys                : Receives the values (owned by @q).
+ * @max_keys            : Size of @keys.
+ *
+ * Used by the cursor to plan index lookups: finds the string
+ * or binary values that @field must equal for an item to
+ * match @q, i.e. {field: value} or {field: or(value, ...)}.
+ *
+ * Returns: number of values, or -1 if @q does not restrict
+ * @field to a set of string/binary values.
+ **/
+int libretrodb_query_get_keys(libretrodb_query_t *q, const char *field,
+      const struct rmsgpack_dom_value **keys, unsigned max_keys);
+
 RETRO_END_DECLS
 
 #endif
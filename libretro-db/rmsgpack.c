@@ -593,3 +593,269 @@ end:
       free(buff);
    return 0;
 }
+
+/* Nesting limit when skipping over maps and arrays */
+#define RMSGPACK_VIEW_MAX_DEPTH 32
+
+enum rmsgpack_header_kind
+{
+   RMSGPACK_HEADER_SCALAR = 0,
+   RMSGPACK_HEADER_BYTES,
+   RMSGPACK_HEADER_MAP,
+   RMSGPACK_HEADER_ARRAY
+};
+
+/* Classifies a type byte. @size receives the length of the
+ * number/length field that follows it, @len the length or
+ * element count of fixed-size types. */
+static int rmsgpack_header(uint8_t type, enum rmsgpack_dom_type *dom_type,
+      enum rmsgpack_header_kind *kind, size_t *size, uint64_t *len)
+{
+   *size = 0;
+   *len  = 0;
+   *kind = RMSGPACK_HEADER_SCALAR;
+
+   if (type < MPF_FIXMAP || type > MPF_MAP32)
+   {
+      *dom_type = RDT_INT;
+      return 0;
+   }
+   else if (type < MPF_FIXARRAY)
+   {
+      *dom_type = RDT_MAP;
+      *kind     = RMSGPACK_HEADER_MAP;
+      *len      = type - MPF_FIXMAP;
+      return 0;
+   }
+   else if (type < MPF_FIXSTR)
+   {
+      *dom_type = RDT_ARRAY;
+      *kind     = RMSGPACK_HEADER_ARRAY;
+      *len      = type - MPF_FIXARRAY;
+      return 0;
+   }
+   else if (type < MPF_NIL)
+   {
+      *dom_type = RDT_STRING;
+      *kind     = RMSGPACK_HEADER_BYTES;
+      *len      = type - MPF_FIXSTR;
+      return 0;
+   }
+
+   switch (type)
+   {
+      case _MPF_NIL:
+         *dom_type = RDT_NULL;
+         return 0;
+      case _MPF_FALSE:
+      case _MPF_TRUE:
+         *dom_type = RDT_BOOL;
+         return 0;
+      case _MPF_BIN8:
+      case _MPF_BIN16:
+      case _MPF_BIN32:
+         *dom_type = RDT_BINARY;
+         *kind     = RMSGPACK_HEADER_BYTES;
+         *size     = (size_t)1 << (type - _MPF_BIN8);
+         return 0;
+      case _MPF_UINT8:
+      case _MPF_UINT16:
+      case _MPF_UINT32:
+      case _MPF_UINT64:
+         *dom_type = RDT_UINT;
+         *size     = (size_t)1 << (type - _MPF_UINT8);
+         return 0;
+      case _MPF_INT8:
+      case _MPF_INT16:
+      case _MPF_INT32:
+      case _MPF_INT64:
+         *dom_type = RDT_INT;
+         *size     = (size_t)1 << (type - _MPF_INT8);
+         return 0;
+      case _MPF_STR8:
+      case _MPF_STR16:
+      case _MPF_STR32:
+         *dom_type = RDT_STRING;
+         *kind     = RMSGPACK_HEADER_BYTES;
+         *size     = (size_t)1 << (type - _MPF_STR8);
+         return 0;
+      case _MPF_ARRAY16:
+      case _MPF_ARRAY32:
+         *dom_type = RDT_ARRAY;
+         *kind     = RMSGPACK_HEADER_ARRAY;
+         *size     = (size_t)2 << (type - _MPF_ARRAY16);
+         return 0;
+      case _MPF_MAP16:
+      case _MPF_MAP32:
+         *dom_type = RDT_MAP;
+         *kind     = RMSGPACK_HEADER_MAP;
+         *size     = (size_t)2 << (type - _MPF_MAP16);
+         return 0;
+   }
+
+   return -1;
+}
+
+static uint64_t rmsgpack_be(const uint8_t *data, size_t size)
+{
+   size_t i;
+   uint64_t v = 0;
+   for (i = 0; i < size; i++)
+      v = (v << 8) | data[i];
+   return v;
+}
+
+static const uint8_t *rmsgpack_view_read_depth(const uint8_t *data,
+      const uint8_t *end, struct rmsgpack_view_value *out, unsigned depth)
+{
+   uint64_t i, len, count;
+   size_t size;
+   uint8_t type;
+   enum rmsgpack_header_kind kind;
+   enum rmsgpack_dom_type dom_type;
+   struct rmsgpack_view_value item;
+
+   if (data >= end || depth > RMSGPACK_VIEW_MAX_DEPTH)
+      return NULL;
+
+   type = *data++;
+
+   if (rmsgpack_header(type, &dom_type, &kind, &size, &len) < 0)
+      return NULL;
+   if ((size_t)(end - data) < size)
+      return NULL;
+
+   out->type = dom_type;
+
+   switch (kind)
+   {
+      case RMSGPACK_HEADER_SCALAR:
+         if (dom_type == RDT_BOOL)
+            out->val.bool_ = (type == _MPF_TRUE);
+         else if (dom_type == RDT_UINT)
+            out->val.uint_ = rmsgpack_be(data, size);
+         else if (dom_type == RDT_INT)
+         {
+            if (size == 0)
+               out->val.int_ = (int8_t)type;
+            else
+            {
+               /* Sign-extend */
+               uint64_t v = rmsgpack_be(data, size);
+               if (size < 8 && (v >> (size * 8 - 1)))
+                  v |= ~UINT64_C(0) << (size * 8);
+               out->val.int_ = (int64_t)v;
+            }
+         }
+         return data + size;
+      case RMSGPACK_HEADER_BYTES:
+         if (size)
+            len = rmsgpack_be(data, size);
+         data += size;
+         if ((uint64_t)(end - data) < len)
+            return NULL;
+         out->val.string.len  = (uint32_t)len;
+         out->val.string.buff = (const char*)data;
+         return data + len;
+      case RMSGPACK_HEADER_MAP:
+      case RMSGPACK_HEADER_ARRAY:
+         if (size)
+            len = rmsgpack_be(data, size);
+         data               += size;
+         out->val.map.len    = (uint32_t)len;
+         out->val.map.items  = data;
+         count               = (kind == RMSGPACK_HEADER_MAP) ? len * 2 : len;
+         for (i = 0; i < count && data; i++)
+            data = rmsgpack_view_read_depth(data, end, &item, depth + 1);
+         return data;
+   }
+
+   return NULL;
+}
+
+const uint8_t *rmsgpack_view_read(const uint8_t *data, const uint8_t *end,
+      struct rmsgpack_view_value *out)
+{
+   return rmsgpack_view_read_depth(data, end, out, 0);
+}
+
+bool rmsgpack_view_string_is(const struct rmsgpack_view_value *v,
+      const char *s)
+{
+   size_t len = strlen(s);
+   return v->type == RDT_STRING
+      && v->val.string.len == len
+      && memcmp(v->val.string.buff, s, len) == 0;
+}
+
+static int rmsgpack_read_raw_append(RFILE *fd, uint8_t **buff, size_t *len,
+      size_t *capacity, uint64_t size)
+{
+   if (*len + size > *capacity)
+   {
+      size_t new_capacity = *capacity ? *capacity : 256;
+      uint8_t *new_buff;
+
+      while (new_capacity < *len + size)
+         new_capacity *= 2;
+
+      if (!(new_buff = (uint8_t*)realloc(*buff, new_capacity)))
+         return -1;
+      *buff     = new_buff;
+      *capacity = new_capacity;
+   }
+
+   if (size && filestream_read(fd, *buff + *len, (int64_t)size)
+         != (int64_t)size)
+      return -1;
+   *len += (size_t)size;
+   return 0;
+}
+
+static int rmsgpack_read_raw_depth(RFILE *fd, uint8_t **buff, size_t *len,
+      size_t *capacity, unsigned depth)
+{
+   uint64_t i, count, value_len;
+   size_t size;
+   uint8_t type;
+   enum rmsgpack_header_kind kind;
+   enum rmsgpack_dom_type dom_type;
+
+   if (depth > RMSGPACK_VIEW_MAX_DEPTH)
+      return -1;
+
+   if (rmsgpack_read_raw_append(fd, buff, len, capacity, 1) < 0)
+      return -1;
+   type = (*buff)[*len - 1];
+
+   if (rmsgpack_header(type, &dom_type, &kind, &size, &value_len) < 0)
+      return -1;
+   if (rmsgpack_read_raw_append(fd, buff, len, capacity, size) < 0)
+      return -1;
+   if (size)
+      value_len = rmsgpack_be(*buff + *len - size, size);
+
+   switch (kind)
+   {
+      case RMSGPACK_HEADER_SCALAR:
+         break;
+      case RMSGPACK_HEADER_BYTES:
+         return rmsgpack_read_raw_append(fd, buff, len, capacity, value_len);
+      case RMSGPACK_HEADER_MAP:
+      case RMSGPACK_HEADER_ARRAY:
+         count = (kind == RMSGPACK_HEADER_MAP) ? value_len * 2 : value_len;
+         for (i = 0; i < count; i++)
+            if (rmsgpack_read_raw_depth(fd, buff, len, capacity,
+                     depth + 1) < 0)
+               return -1;
+         break;
+   }
+
+   return 0;
+}
+
+int rmsgpack_read_raw(RFILE *fd, uint8_t **buff, size_t *len,
+      size_t *capacity)
+{
+   return rmsgpack_read_raw_depth(fd, buff, len, capacity, 0);
+}
@@ -25,8 +25,11 @@
 
 #include <stdint.h>
 
+#include <boolean.h>
 #include <streams/file_stream.h>
 
+#include "rmsgpack_dom.h"
+
 struct rmsgpack_read_callbacks
 {
    int (*read_nil        )(void *);
@@ -57,4 +60,73 @@ int rmsgpack_write_uint(RFILE *fd, uint64_t value );
 
 int rmsgpack_read(RFILE *fd, struct rmsgpack_read_callbacks *callbacks, void *data);
 
+/* A value decoded in place from an encoded buffer.
+ * Strings and binaries point into the buffer and are
+ * not NUL-terminated; maps and arrays point at their
+ * encoded elements. */
+struct rmsgpack_view_value
+{
+   union
+   {
+      uint64_t uint_;
+      int64_t int_;
+      int bool_;
+      struct
+      {
+         uint32_t len;
+         const char *buff;
+      } string;
+      struct
+      {
+         uint32_t len;
+         const char *buff;
+      } binary;
+      struct
+      {
+         uint32_t len;
+         const uint8_t *items;
+      } map;
+      struct
+      {
+         uint32_t len;
+         const uint8_t *items;
+      } array;
+   } val;
+   enum rmsgpack_dom_type type;
+};
+
+/**
+ * rmsgpack_view_read:
+ * @data                : Encoded value.
+ * @end                 : End of the buffer.
+ * @out                 : Decoded value.
+ *
+ * Decodes the value at @data without copying or allocating.
+ *
+ * Returns: pointer past the whole value (including the
+ * elements of a map or array), or NULL if it is malformed
+ * or truncated.
+ **/
+const uint8_t *rmsgpack_view_read(const uint8_t *data, const uint8_t *end,
+      struct rmsgpack_view_value *out);
+
+/* Returns true if @v is a string equal to @s */
+bool rmsgpack_view_string_is(const struct rmsgpack_view_value *v,
+      const char *s);
+
+/**
+ * rmsgpack_read_raw:
+ * @fd                  : File to read from.
+ * @buff                : Buffer (grown as needed).
+ * @len                 : Bytes used in @buff.
+ * @capacity            : Size of @buff.
+ *
+ * Appends the encoded bytes of the next value in @fd to @buff,
+ * for reading with rmsgpack_view_read().
+ *
+ * Returns: 0 if successful, otherwise negative.
+ **/
+int rmsgpack_read_raw(RFILE *fd, uint8_t **buff, size_t *len,
+      size_t *capacity);
+
 #endif
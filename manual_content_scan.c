@@ -24,6 +24,9 @@
 #include <file/archive_file.h>
 #include <string/stdstring.h>
 #include <lists/dir_list.h>
+#include <streams/file_stream.h>
+#include <array/rbuf.h>
+#include <array/rhmap.h>
 #include <retro_miscellaneous.h>
 
 #include "msg_hash.h"
@@ -1336,46 +1339,509 @@ static bool manual_content_scan_get_playlist_content_label(
    return true;
 }
 
+/* Scan cache
+ *
+ * Layout of the cache file (native byte order, every
+ * block padded to 4 bytes):
+ * - header: magic, version, flags, DAT file size and
+ *   mtime, file extensions and DAT file path
+ * - record count, then per record: size, mtime, content
+ *   path, playlist path and label
+ * > An empty playlist path marks invalid content, an
+ *   empty label marks content excluded by the DAT file */
+#define MANUAL_SCAN_CACHE_MAGIC           0x43534D52 /* 'RMSC' */
+#define MANUAL_SCAN_CACHE_VERSION         1
+#define MANUAL_SCAN_CACHE_SEARCH_ARCHIVES (1 << 0)
+#define MANUAL_SCAN_CACHE_FILTER_DAT      (1 << 1)
+
+typedef struct
+{
+   char *playlist_path; /* NULL if content is invalid */
+   char *label;         /* NULL if content is skipped */
+   int64_t size;
+   int64_t mtime;
+   bool used;
+} manual_content_scan_cache_entry_t;
+
+struct manual_content_scan_cache
+{
+   /* Hash map, keyed by content path */
+   manual_content_scan_cache_entry_t *entries;
+   char path[PATH_MAX_LENGTH];
+   const char *file_exts;
+   const char *dat_file_path;
+   int64_t dat_size;
+   int64_t dat_mtime;
+   size_t num_used;
+   uint32_t flags;
+   bool modified;
+};
+
+typedef struct
+{
+   const uint8_t *pos;
+   const uint8_t *end;
+   bool ok;
+} manual_content_scan_cache_reader_t;
+
+static const void *manual_content_scan_cache_read(
+      manual_content_scan_cache_reader_t *r, size_t len)
+{
+   const uint8_t *p = r->pos;
+   size_t padded    = (len + 3) & ~(size_t)3;
+   if (!r->ok || padded < len || (size_t)(r->end - r->pos) < padded)
+   {
+      r->ok = false;
+      return NULL;
+   }
+   r->pos += padded;
+   return p;
+}
+
+static uint32_t manual_content_scan_cache_read_u32(
+      manual_content_scan_cache_reader_t *r)
+{
+   const uint32_t *p = (const uint32_t*)
+      manual_content_scan_cache_read(r, sizeof(uint32_t));
+   return p ? *p : 0;
+}
+
+static int64_t manual_content_scan_cache_read_i64(
+      manual_content_scan_cache_reader_t *r)
+{
+   uint32_t lo = manual_content_scan_cache_read_u32(r);
+   uint32_t hi = manual_content_scan_cache_read_u32(r);
+   return (int64_t)(((uint64_t)hi << 32) | lo);
+}
+
+/* Strings are stored with their length (including
+ * the terminating NUL); returns NULL on error */
+static const char *manual_content_scan_cache_read_string(
+      manual_content_scan_cache_reader_t *r)
+{
+   uint32_t len    = manual_content_scan_cache_read_u32(r);
+   const char *str = (const char*)manual_content_scan_cache_read(r, len);
+   if (!str || !len || str[len - 1] != '\0')
+   {
+      r->ok = false;
+      return NULL;
+   }
+   return str;
+}
+
+static void manual_content_scan_cache_put(uint8_t **buf,
+      const void *data, size_t len)
+{
+   size_t pos = RBUF_LEN(*buf);
+   if (!len)
+      return;
+   RBUF_RESIZE(*buf, pos + len);
+   memcpy(*buf + pos, data, len);
+}
+
+static void manual_content_scan_cache_put_u32(uint8_t **buf, uint32_t val)
+{
+   manual_content_scan_cache_put(buf, &val, sizeof(val));
+}
+
+static void manual_content_scan_cache_put_i64(uint8_t **buf, int64_t val)
+{
+   manual_content_scan_cache_put_u32(buf, (uint32_t)((uint64_t)val & 0xFFFFFFFF));
+   manual_content_scan_cache_put_u32(buf, (uint32_t)((uint64_t)val >> 32));
+}
+
+static void manual_content_scan_cache_put_string(uint8_t **buf,
+      const char *str)
+{
+   uint32_t len = (uint32_t)strlen(str ? str : "") + 1;
+   manual_content_scan_cache_put_u32(buf, len);
+   manual_content_scan_cache_put(buf, str ? str : "", len);
+   while (RBUF_LEN(*buf) & 3)
+      RBUF_PUSH(*buf, 0);
+}
+
+static void manual_content_scan_cache_clear(
+      manual_content_scan_cache_t *cache)
+{
+   size_t i, cap = RHMAP_CAP(cache->entries);
+
+   for (i = 0; i < cap; i++)
+   {
+      if (!RHMAP_KEY(cache->entries, i))
+         continue;
+      if (cache->entries[i].playlist_path)
+         free(cache->entries[i].playlist_path);
+      if (cache->entries[i].label)
+         free(cache->entries[i].label);
+   }
+
+   RHMAP_FREE(cache->entries);
+   cache->num_used = 0;
+}
+
+/* Adds a record to the cache, replacing any existing
+ * record of the same content path */
+static void manual_content_scan_cache_set(
+      manual_content_scan_cache_t *cache, const char *content_path,
+      int64_t size, int64_t mtime,
+      const char *playlist_path, const char *label)
+{
+   manual_content_scan_cache_entry_t *entry;
+   ptrdiff_t idx = RHMAP_IDX_STR(cache->entries, content_path);
+
+   if (idx >= 0)
+   {
+      entry = &cache->entries[idx];
+      if (entry->playlist_path)
+         free(entry->playlist_path);
+      if (entry->label)
+         free(entry->label);
+      if (entry->used)
+         cache->num_used--;
+   }
+   else
+   {
+      if (!RHMAP_TRYFIT(cache->entries, RHMAP_LEN(cache->entries) + 1))
+         return;
+      entry = RHMAP_PTR_STR(cache->entries, content_path);
+   }
+
+   entry->playlist_path = string_is_empty(playlist_path)
+         ? NULL : strdup(playlist_path);
+   entry->label         = (!entry->playlist_path || string_is_empty(label))
+         ? NULL : strdup(label);
+   entry->size          = size;
+   entry->mtime         = mtime;
+   entry->used          = true;
+   cache->num_used++;
+   cache->modified      = true;
+}
+
+static bool manual_content_scan_cache_load(
+      manual_content_scan_cache_t *cache)
+{
+   uint32_t i, count;
+   manual_content_scan_cache_reader_t r;
+   void *buf   = NULL;
+   int64_t len = 0;
+
+   if (   !path_is_valid(cache->path)
+       || !filestream_read_file(cache->path, &buf, &len))
+      return false;
+
+   r.pos = (const uint8_t*)buf;
+   r.end = (const uint8_t*)buf + len;
+   r.ok  = true;
+
+   /* Records are only usable if the previous scan
+    * was performed with the same parameters */
+   if (     manual_content_scan_cache_read_u32(&r) != MANUAL_SCAN_CACHE_MAGIC
+         || manual_content_scan_cache_read_u32(&r) != MANUAL_SCAN_CACHE_VERSION
+         || manual_content_scan_cache_read_u32(&r) != cache->flags
+         || manual_content_scan_cache_read_i64(&r) != cache->dat_size
+         || manual_content_scan_cache_read_i64(&r) != cache->dat_mtime
+         || !string_is_equal(manual_content_scan_cache_read_string(&r),
+               cache->file_exts)
+         || !string_is_equal(manual_content_scan_cache_read_string(&r),
+               cache->dat_file_path))
+      goto error;
+
+   count = manual_content_scan_cache_read_u32(&r);
+
+   for (i = 0; i < count && r.ok; i++)
+   {
+      int64_t size              = manual_content_scan_cache_read_i64(&r);
+      int64_t mtime             = manual_content_scan_cache_read_i64(&r);
+      const char *content_path  = manual_content_scan_cache_read_string(&r);
+      const char *playlist_path = manual_content_scan_cache_read_string(&r);
+      const char *label         = manual_content_scan_cache_read_string(&r);
+
+      if (!r.ok || string_is_empty(content_path))
+         break;
+
+      manual_content_scan_cache_set(cache, content_path,
+            size, mtime, playlist_path, label);
+   }
+
+   if (!r.ok)
+      goto error;
+
+   /* Nothing has been seen by the current scan yet */
+   for (i = 0; i < RHMAP_CAP(cache->entries); i++)
+      if (RHMAP_KEY(cache->entries, i))
+         cache->entries[i].used = false;
+   cache->num_used = 0;
+   cache->modified = false;
+
+   free(buf);
+   return true;
+
+error:
+   manual_content_scan_cache_clear(cache);
+   free(buf);
+   return false;
+}
+
+/* Loads the scan cache associated with the playlist
+ * of the specified task
+ * > Returns an empty cache if no valid cache file
+ *   exists, or NULL in the event of failure */
+manual_content_scan_cache_t *manual_content_scan_cache_init(
+      manual_content_scan_task_config_t *task_config)
+{
+   manual_content_scan_cache_t *cache = NULL;
+
+   if (   !task_config
+       || string_is_empty(task_config->playlist_file))
+      return NULL;
+
+   if (!(cache = (manual_content_scan_cache_t*)calloc(1, sizeof(*cache))))
+      return NULL;
+
+   fill_pathname(cache->path, task_config->playlist_file,
+         FILE_PATH_MANUAL_SCAN_CACHE_EXTENSION, sizeof(cache->path));
+
+   /* Record the scan parameters that affect the
+    * way in which individual files are handled */
+   cache->file_exts     = task_config->file_exts;
+   cache->dat_file_path = task_config->dat_file_path;
+   if (task_config->search_archives)
+      cache->flags     |= MANUAL_SCAN_CACHE_SEARCH_ARCHIVES;
+   if (task_config->filter_dat_content)
+      cache->flags     |= MANUAL_SCAN_CACHE_FILTER_DAT;
+   if (!string_is_empty(task_config->dat_file_path))
+   {
+      cache->dat_size   = path_get_size(task_config->dat_file_path);
+      cache->dat_mtime  = path_get_mtime(task_config->dat_file_path);
+   }
+
+   manual_content_scan_cache_load(cache);
+
+   return cache;
+}
+
+/* Returns the cache record of the specified content
+ * file if its size and modification time match, and
+ * marks it as seen by the current scan */
+static manual_content_scan_cache_entry_t *manual_content_scan_cache_find(
+      manual_content_scan_cache_t *cache, const char *content_path,
+      int64_t size, int64_t mtime)
+{
+   manual_content_scan_cache_entry_t *entry;
+   ptrdiff_t idx = RHMAP_IDX_STR(cache->entries, content_path);
+
+   if (idx < 0)
+      return NULL;
+
+   entry = &cache->entries[idx];
+
+   if (   (entry->size  != size)
+       || (entry->mtime != mtime))
+      return NULL;
+
+   if (!entry->used)
+   {
+      entry->used = true;
+      cache->num_used++;
+   }
+
+   return entry;
+}
+
+/* Returns true if playlist entry path @path was produced
+ * by a previous scan of a file that has not changed since */
+bool manual_content_scan_cache_path_is_valid(
+      manual_content_scan_cache_t *cache, const char *path)
+{
+   char archive_path[PATH_MAX_LENGTH];
+   const char *delim = NULL;
+   ptrdiff_t idx;
+   const manual_content_scan_cache_entry_t *entry;
+
+   if (   !cache
+       || string_is_empty(path)
+       || !(delim = path_get_archive_delim(path))
+       || ((size_t)(delim - path) >= sizeof(archive_path)))
+      return false;
+
+   strlcpy(archive_path, path, (size_t)(delim - path) + 1);
+
+   if ((idx = RHMAP_IDX_STR(cache->entries, archive_path)) < 0)
+      return false;
+
+   entry = &cache->entries[idx];
+
+   return entry->playlist_path
+       && string_is_equal(entry->playlist_path, path)
+       && (entry->size  == path_get_size(archive_path))
+       && (entry->mtime == path_get_mtime(archive_path));
+}
+
+/* Writes scan cache to disk, if it has changed */
+bool manual_content_scan_cache_write(manual_content_scan_cache_t *cache)
+{
+   size_t i, cap;
+   bool success = false;
+   uint8_t *buf = NULL;
+
+   if (!cache)
+      return false;
+
+   /* Nothing to do if no record was added, updated
+    * or dropped (i.e. if every record was seen) */
+   if (   !cache->modified
+       && (cache->num_used == RHMAP_LEN(cache->entries)))
+      return true;
+
+   manual_content_scan_cache_put_u32(&buf, MANUAL_SCAN_CACHE_MAGIC);
+   manual_content_scan_cache_put_u32(&buf, MANUAL_SCAN_CACHE_VERSION);
+   manual_content_scan_cache_put_u32(&buf, cache->flags);
+   manual_content_scan_cache_put_i64(&buf, cache->dat_size);
+   manual_content_scan_cache_put_i64(&buf, cache->dat_mtime);
+   manual_content_scan_cache_put_string(&buf, cache->file_exts);
+   manual_content_scan_cache_put_string(&buf, cache->dat_file_path);
+   manual_content_scan_cache_put_u32(&buf, (uint32_t)cache->num_used);
+
+   cap = RHMAP_CAP(cache->entries);
+   for (i = 0; i < cap; i++)
+   {
+      const manual_content_scan_cache_entry_t *entry = &cache->entries[i];
+
+      if (!RHMAP_KEY(cache->entries, i) || !entry->used)
+         continue;
+
+      manual_content_scan_cache_put_i64(&buf, entry->size);
+      manual_content_scan_cache_put_i64(&buf, entry->mtime);
+      manual_content_scan_cache_put_string(&buf,
+            RHMAP_KEY_STR(cache->entries, i));
+      manual_content_scan_cache_put_string(&buf, entry->playlist_path);
+      manual_content_scan_cache_put_string(&buf, entry->label);
+   }
+
+   if (buf)
+      success = filestream_write_file(cache->path, buf, RBUF_LEN(buf));
+
+   RBUF_FREE(buf);
+
+   if (success)
+      cache->modified = false;
+
+   return success;
+}
+
+void manual_content_scan_cache_free(manual_content_scan_cache_t *cache)
+{
+   if (!cache)
+      return;
+
+   manual_content_scan_cache_clear(cache);
+   free(cache);
+}
+
+/* Deletes the scan cache associated with the
+ * specified playlist file, if any */
+void manual_content_scan_cache_delete(const char *playlist_path)
+{
+   char cache_path[PATH_MAX_LENGTH];
+
+   if (string_is_empty(playlist_path))
+      return;
+
+   fill_pathname(cache_path, playlist_path,
+         FILE_PATH_MANUAL_SCAN_CACHE_EXTENSION, sizeof(cache_path));
+
+   if (path_is_valid(cache_path))
+      filestream_delete(cache_path);
+}
+
 /* Adds specified content to playlist, if not already
  * present */
 void manual_content_scan_add_content_to_playlist(
       manual_content_scan_task_config_t *task_config,
       playlist_t *playlist, const char *content_path,
-      int content_type, logiqx_dat_t *dat_file)
+      int content_type, logiqx_dat_t *dat_file,
+      manual_content_scan_cache_t *cache)
 {
    char playlist_content_path[PATH_MAX_LENGTH];
+   char label[PATH_MAX_LENGTH];
+   const char *entry_path                    = playlist_content_path;
+   const char *entry_label                   = label;
+   manual_content_scan_cache_entry_t *cached = NULL;
+   int64_t content_size                      = 0;
+   int64_t content_mtime                     = 0;
 
    /* Sanity check */
-   if (!task_config || !playlist)
+   if (!task_config || !playlist || string_is_empty(content_path))
       return;
 
-   /* Get 'actual' content path */
-   if (!manual_content_scan_get_playlist_content_path(
-         task_config, content_path, content_type,
-         playlist_content_path, sizeof(playlist_content_path)))
-      return;
+   /* Check whether this file is unchanged since
+    * the last scan */
+   if (cache)
+   {
+      if ((content_size = path_get_size(content_path)) < 0)
+         return;
+      content_mtime = path_get_mtime(content_path);
+      cached        = manual_content_scan_cache_find(cache,
+            content_path, content_size, content_mtime);
+   }
 
-   /* Check whether content is already included
-    * in playlist */
-   if (!playlist_entry_exists(playlist, playlist_content_path))
+   if (cached)
    {
-      struct playlist_entry entry = {0};
-      char label[PATH_MAX_LENGTH];
+      if (!cached->playlist_path || !cached->label)
+         return;
+
+      entry_path  = cached->playlist_path;
+      entry_label = cached->label;
+   }
+   else
+   {
+      bool path_valid  = false;
+      bool label_valid = false;
+
+      /* Get 'actual' content path */
+      path_valid = manual_content_scan_get_playlist_content_path(
+            task_config, content_path, content_type,
+            playlist_content_path, sizeof(playlist_content_path));
+
+      /* Get entry label
+       * > When caching, the label is determined even
+       *   if the content is already included in the
+       *   playlist, so that the next scan can skip
+       *   this file entirely */
+      if (path_valid)
+      {
+         if (!cache && playlist_entry_exists(playlist,
+                  playlist_content_path))
+            return;
+
+         label[0]    = '\0';
+         label_valid = manual_content_scan_get_playlist_content_label(
+               playlist_content_path, dat_file,
+               task_config->filter_dat_content,
+               label, sizeof(label));
+      }
 
-      label[0] = '\0';
+      if (cache)
+         manual_content_scan_cache_set(cache, content_path,
+               content_size, content_mtime,
+               path_valid  ? playlist_content_path : NULL,
+               label_valid ? label : NULL);
 
-      /* Get entry label */
-      if (!manual_content_scan_get_playlist_content_label(
-            playlist_content_path, dat_file,
-            task_config->filter_dat_content,
-            label, sizeof(label)))
+      if (!label_valid)
          return;
+   }
+
+   /* Check whether content is already included
+    * in playlist */
+   if (!playlist_entry_exists(playlist, entry_path))
+   {
+      struct playlist_entry entry = {0};
 
       /* Configure playlist entry
        * > The push function reads our entry as const,
        *   so these casts are safe */
-      entry.path       = (char*)playlist_content_path;
-      entry.label      = label;
+      entry.path       = (char*)entry_path;
+      entry.label      = (char*)entry_label;
       entry.core_path  = (char*)FILE_PATH_DETECT;
       entry.core_name  = (char*)FILE_PATH_DETECT;
       entry.crc32      = (char*)"00000000|crc";
@@ -99,6 +99,11 @@ typedef struct
    bool validate_entries;
 } manual_content_scan_task_config_t;
 
+/* Holds the outcome of previous scans of the
+ * files in a content directory (see
+ * manual_content_scan_cache_init()) */
+typedef struct manual_content_scan_cache manual_content_scan_cache_t;
+
 /*****************/
 /* Configuration */
 /*****************/
@@ -267,11 +272,50 @@ struct string_list *manual_content_scan_get_content_list(
       manual_content_scan_task_config_t *task_config);
 
 /* Adds specified content to playlist, if not already
- * present */
+ * present
+ * > If @cache is not NULL, content that is unchanged
+ *   since the last scan is not inspected again */
 void manual_content_scan_add_content_to_playlist(
       manual_content_scan_task_config_t *task_config,
       playlist_t *playlist, const char *content_path,
-      int content_type, logiqx_dat_t *dat_file);
+      int content_type, logiqx_dat_t *dat_file,
+      manual_content_scan_cache_t *cache);
+
+/* Scan cache */
+
+/* Loads the scan cache associated with the playlist
+ * of the specified task
+ * > The cache records, for every content file, the
+ *   playlist path and label it resolved to along with
+ *   its size and modification time
+ * > Records are discarded if the scan parameters
+ *   (file extensions, archive handling, DAT file)
+ *   differ from those of the previous scan
+ * > Returns an empty cache if no valid cache file
+ *   exists, or NULL in the event of failure
+ * > Returned object must be freed using
+ *   manual_content_scan_cache_free() */
+manual_content_scan_cache_t *manual_content_scan_cache_init(
+      manual_content_scan_task_config_t *task_config);
+
+/* Returns true if playlist entry path @path was produced
+ * by a previous scan of a file that has not changed since,
+ * i.e. if it is known to be valid without opening the
+ * file (only applies to content inside archives) */
+bool manual_content_scan_cache_path_is_valid(
+      manual_content_scan_cache_t *cache, const char *path);
+
+/* Writes scan cache to disk, if it has changed
+ * > Only records of content files passed to
+ *   manual_content_scan_add_content_to_playlist()
+ *   since the cache was loaded are kept */
+bool manual_content_scan_cache_write(manual_content_scan_cache_t *cache);
+
+void manual_content_scan_cache_free(manual_content_scan_cache_t *cache);
+
+/* Deletes the scan cache associated with the
+ * specified playlist file, if any */
+void manual_content_scan_cache_delete(const char *playlist_path);
 
 RETRO_END_DECLS
 
@@ -2655,6 +2655,7 @@ static int action_ok_playlist_entry_collection(const char *path,
    playlist_config.capacity               = COLLECTION_SIZE;
    playlist_config.old_format             = settings->bools.playlist_use_old_format;
    playlist_config.compress               = settings->bools.playlist_compression;
+   playlist_config.binary                 = settings->bools.playlist_binary_format;
    playlist_config.fuzzy_archive_match    = settings->bools.playlist_fuzzy_archive_match;
    playlist_config_set_base_content_directory(&playlist_config, settings->bools.playlist_portable_paths ? settings->paths.directory_menu_content : NULL);
 
@@ -7986,6 +7987,7 @@ static int action_ok_manual_content_scan_start(const char *path,
    playlist_config.capacity            = COLLECTION_SIZE;
    playlist_config.old_format          = settings->bools.playlist_use_old_format;
    playlist_config.compress            = settings->bools.playlist_compression;
+   playlist_config.binary              = settings->bools.playlist_binary_format;
    playlist_config.fuzzy_archive_match = settings->bools.playlist_fuzzy_archive_match;
    playlist_config_set_base_content_directory(&playlist_config,
          settings->bools.playlist_portable_paths ?
@@ -8372,6 +8374,7 @@ static int action_ok_delete_playlist(const char *path,
    path = playlist_get_conf_path(playlist);
 
    filestream_delete(path);
+   manual_content_scan_cache_delete(path);
 
    if (menu_st->driver_ctx->environ_cb)
       menu_st->driver_ctx->environ_cb(MENU_ENVIRON_RESET_HORIZONTAL_LIST,
@@ -8395,6 +8398,7 @@ static int action_ok_pl_content_thumbnails(const char *path,
       playlist_config.capacity            = COLLECTION_SIZE;
       playlist_config.old_format          = settings->bools.playlist_use_old_format;
       playlist_config.compress            = settings->bools.playlist_compression;
+      playlist_config.binary              = settings->bools.playlist_binary_format;
       playlist_config.fuzzy_archive_match = settings->bools.playlist_fuzzy_archive_match;
 
       if (!string_is_empty(path_dir_playlist))
@@ -8576,6 +8580,7 @@ static int action_ok_playlist_refresh(const char *path,
    playlist_config->capacity            = COLLECTION_SIZE;
    playlist_config->old_format          = settings->bools.playlist_use_old_format;
    playlist_config->compress            = settings->bools.playlist_compression;
+   playlist_config->binary              = settings->bools.playlist_binary_format;
    playlist_config->fuzzy_archive_match = settings->bools.playlist_fuzzy_archive_match;
    playlist_config_set_base_content_directory(playlist_config,
          settings->bools.playlist_portable_paths ?
@@ -7718,6 +7718,9 @@ static void materialui_set_thumbnail_dimensions(materialui_handle_t *mui)
          mui->thumbnail_width_max  = 0;
          break;
    }
+
+   gfx_thumbnail_set_target_size(
+         mui->thumbnail_width_max, mui->thumbnail_height_max);
 }
 
 /* Checks global 'Secondary Thumbnail' option - if
@@ -10333,7 +10336,7 @@ static void materialui_list_insert(
       node->thumbnails.primary.height        = 0;
       node->thumbnails.primary.alpha         = 0.0f;
       node->thumbnails.primary.delay_timer   = 0.0f;
-      node->thumbnails.primary.flags        &= ~GFX_THUMB_FLAG_FADE_ACTIVE;
+      node->thumbnails.primary.flags         = 0;
 
       node->thumbnails.secondary.status      = GFX_THUMBNAIL_STATUS_UNKNOWN;
       node->thumbnails.secondary.texture     = 0;
@@ -10341,7 +10344,7 @@ static void materialui_list_insert(
       node->thumbnails.secondary.height      = 0;
       node->thumbnails.secondary.alpha       = 0.0f;
       node->thumbnails.secondary.delay_timer = 0.0f;
-      node->thumbnails.secondary.flags      &= ~GFX_THUMB_FLAG_FADE_ACTIVE;
+      node->thumbnails.secondary.flags       = 0;
    }
    else
    {
@@ -6103,6 +6103,8 @@ static void ozone_draw_thumbnail_bar(
    float scale_factor                = ozone->last_scale_factor;
    gfx_display_ctx_driver_t *dispctx = p_disp->dispctx;
 
+   gfx_thumbnail_set_target_size(thumbnail_width, thumbnail_height);
+
    /* Background */
    if (thumbnail_height)
    {
@@ -5715,6 +5715,14 @@ static void xmb_frame(void *data, video_frame_info_t *video_info)
    thumbnail_margin_height_full            = (float)video_height - xmb->margins_title_top - ((xmb->icon_size / 4.0f) * 2.0f);
    left_thumbnail_margin_x                 = xmb->icon_size / 6.0f;
    right_thumbnail_margin_x                = (float)video_width - (xmb->icon_size / 6.0f) - right_thumbnail_margin_width;
+
+   /* The right thumbnail area is the largest one
+    * outside of fullscreen view */
+   if (     (right_thumbnail_margin_width > 0.0f)
+         && (thumbnail_margin_height_full > 0.0f))
+      gfx_thumbnail_set_target_size(
+            (unsigned)right_thumbnail_margin_width,
+            (unsigned)thumbnail_margin_height_full);
    xmb->margins_title                      = (float)settings->ints.menu_xmb_title_margin * 10.0f;
    xmb->margins_title_horizontal_offset    = (float)settings->ints.menu_xmb_title_margin_horizontal_offset * 10.0f;
 
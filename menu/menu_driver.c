@@ -65,6 +65,7 @@
 #endif
 
 #include "../gfx/gfx_animation.h"
+#include "../gfx/gfx_thumbnail.h"
 #include "../input/input_driver.h"
 #include "../input/input_remapping.h"
 #include "../performance_counters.h"
@@ -6614,6 +6615,10 @@ bool menu_driver_ctl(enum rarch_menu_ctl_state state, void *data)
                && menu_st->driver_ctx->context_destroy)
             menu_st->driver_ctx->context_destroy(menu_st->userdata);
 
+         /* All thumbnails have been reset by now, so
+          * textures left in the cache are unused */
+         gfx_thumbnail_flush_cache();
+
          if (menu_st->flags & MENU_ST_FLAG_DATA_OWN)
             return true;
 
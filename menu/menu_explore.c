@@ -20,6 +20,8 @@
 #include <compat/strl.h>
 #include <array/rbuf.h>
 #include <array/rhmap.h>
+#include <file/file_path.h>
+#include <streams/file_stream.h>
 #include <formats/rjson.h>
 #include <formats/rjson_helpers.h>
 #include <retro_endianness.h>
@@ -450,29 +452,786 @@ static void explore_load_icons(explore_state_t *state)
    }
 }
 
+struct explore_source
+{
+   const struct playlist_entry *source;
+   uint32_t entry_index, meta_count;
+};
+
+struct explore_rdb
+{
+   libretrodb_t *handle;
+   struct explore_source *playlist_crcs;
+   struct explore_source *playlist_names;
+   size_t count;
+   int64_t size, mtime;
+   char path[PATH_MAX_LENGTH];
+   char systemname[256];
+};
+
+/* Explore cache
+ *
+ * The database metadata that was matched to the playlist entries
+ * of each RDB is kept in FILE_PATH_EXPLORE_CACHE inside the playlist
+ * directory. On the next initialisation an RDB only has to be read
+ * again when its size or modification time changed, or when the
+ * playlists reference entries that were never looked up in it.
+ *
+ * Layout (native byte order, every block padded to 4 bytes):
+ * - header: magic, version, category count, UI language, RDB count
+ * - per category: string count, byte size and the NUL separated
+ *   strings in sorted order, so a string id is its sort index
+ * - per RDB: path, size, mtime, row count and a pool of labels,
+ *   then one column per field (crc, label offset, meta count,
+ *   one string id per category, split list offset) followed by
+ *   the pool of (category, string id) split lists
+ *
+ * Boolean categories hold the localized "Yes"/"No" strings,
+ * so the cache is only valid for the language it was
+ * written in. */
+#define EXPLORE_CACHE_MAGIC   0x58454152 /* 'RAEX' */
+#define EXPLORE_CACHE_VERSION 2
+#define EXPLORE_CACHE_NONE    0xFFFFFFFF
+
+typedef struct
+{
+   const char *path;
+   const char *labels;
+   const uint32_t *crc;
+   const uint32_t *label;
+   const uint32_t *meta_count;
+   const uint32_t *by[EXPLORE_CAT_COUNT];
+   const uint32_t *split;
+   const uint32_t *split_pool;
+   int64_t size, mtime;
+   uint32_t count;
+   uint32_t labels_len;
+   uint32_t split_pool_len;
+} explore_cache_rdb_t;
+
+typedef struct
+{
+   uint8_t *data;
+   const char **strings[EXPLORE_CAT_COUNT];
+   /* Interned strings, filled in when a cached row is used */
+   explore_string_t **interned[EXPLORE_CAT_COUNT];
+   explore_cache_rdb_t *rdbs;
+} explore_cache_t;
+
+typedef struct
+{
+   const uint8_t *pos;
+   const uint8_t *end;
+   bool ok;
+} explore_cache_reader_t;
+
+static const void *explore_cache_read(explore_cache_reader_t *r,
+      size_t len)
+{
+   const uint8_t *p = r->pos;
+   size_t padded    = (len + 3) & ~(size_t)3;
+   if (!r->ok || padded < len || (size_t)(r->end - r->pos) < padded)
+   {
+      r->ok = false;
+      return NULL;
+   }
+   r->pos += padded;
+   return p;
+}
+
+static uint32_t explore_cache_read_u32(explore_cache_reader_t *r)
+{
+   const uint32_t *p = (const uint32_t*)
+      explore_cache_read(r, sizeof(uint32_t));
+   return p ? *p : 0;
+}
+
+static int64_t explore_cache_read_i64(explore_cache_reader_t *r)
+{
+   uint32_t lo = explore_cache_read_u32(r);
+   uint32_t hi = explore_cache_read_u32(r);
+   return (int64_t)(((uint64_t)hi << 32) | lo);
+}
+
+static const uint32_t *explore_cache_read_column(
+      explore_cache_reader_t *r, uint32_t count)
+{
+   if (r->ok && (size_t)count
+         > (size_t)(r->end - r->pos) / sizeof(uint32_t))
+      r->ok = false;
+   return (const uint32_t*)explore_cache_read(r,
+         (size_t)count * sizeof(uint32_t));
+}
+
+static bool explore_cache_check_id(const explore_cache_t *cache,
+      uint32_t cat, uint32_t id)
+{
+   return id == EXPLORE_CACHE_NONE
+      || (cat < EXPLORE_CAT_COUNT && id < RBUF_LEN(cache->strings[cat]));
+}
+
+/* Makes sure every id and offset of a cached RDB can be
+ * used without further checks */
+static bool explore_cache_check_rdb(const explore_cache_t *cache,
+      const explore_cache_rdb_t *c)
+{
+   uint32_t row, cat, i;
+
+   if (c->split_pool_len & 1)
+      return false;
+
+   for (i = 0; i < c->split_pool_len; i += 2)
+      if (c->split_pool[i] != EXPLORE_CACHE_NONE
+            && (c->split_pool[i] >= EXPLORE_CAT_COUNT
+               || !explore_cache_check_id(cache,
+                  c->split_pool[i], c->split_pool[i + 1])))
+         return false;
+
+   for (row = 0; row < c->count; row++)
+   {
+      if (c->label[row] != EXPLORE_CACHE_NONE
+            && c->label[row] >= c->labels_len)
+         return false;
+
+      for (cat = 0; cat < EXPLORE_CAT_COUNT; cat++)
+         if (!explore_cache_check_id(cache, cat, c->by[cat][row]))
+            return false;
+
+      if (c->split[row] == EXPLORE_CACHE_NONE)
+         continue;
+
+      /* Split lists are terminated by a NONE category */
+      for (i = c->split[row]; ; i += 2)
+      {
+         if ((i & 1) || i >= c->split_pool_len)
+            return false;
+         if (c->split_pool[i] == EXPLORE_CACHE_NONE)
+            break;
+      }
+   }
+
+   return true;
+}
+
+static void explore_cache_free(explore_cache_t *cache)
+{
+   unsigned cat;
+   for (cat = 0; cat < EXPLORE_CAT_COUNT; cat++)
+   {
+      RBUF_FREE(cache->strings[cat]);
+      RBUF_FREE(cache->interned[cat]);
+   }
+   RBUF_FREE(cache->rdbs);
+   free(cache->data);
+   cache->data = NULL;
+}
+
+static bool explore_cache_load(explore_cache_t *cache, const char *path)
+{
+   uint32_t i, rdb_count;
+   unsigned cat;
+   explore_cache_reader_t r;
+   void *buf   = NULL;
+   int64_t len = 0;
+
+   if (   !path_is_valid(path)
+       || !filestream_read_file(path, &buf, &len))
+      return false;
+
+   cache->data = (uint8_t*)buf;
+   r.pos       = cache->data;
+   r.end       = cache->data + len;
+   r.ok        = true;
+
+   if (     explore_cache_read_u32(&r) != EXPLORE_CACHE_MAGIC
+         || explore_cache_read_u32(&r) != EXPLORE_CACHE_VERSION
+         || explore_cache_read_u32(&r) != EXPLORE_CAT_COUNT
+         || explore_cache_read_u32(&r)
+            != *msg_hash_get_uint(MSG_HASH_USER_LANGUAGE))
+      goto error;
+
+   rdb_count = explore_cache_read_u32(&r);
+
+   for (cat = 0; cat < EXPLORE_CAT_COUNT; cat++)
+   {
+      uint32_t count  = explore_cache_read_u32(&r);
+      uint32_t size   = explore_cache_read_u32(&r);
+      const char *str = (const char*)explore_cache_read(&r, size);
+      const char *end = str + size;
+
+      if (!r.ok || (size && end[-1] != '\0') || count > size)
+         goto error;
+
+      for (i = 0; i < count; i++)
+      {
+         if (str >= end)
+            goto error;
+         RBUF_PUSH(cache->strings[cat], str);
+         str += strlen(str) + 1;
+      }
+
+      if (count)
+      {
+         RBUF_RESIZE(cache->interned[cat], count);
+         memset(cache->interned[cat], 0,
+               RBUF_SIZEOF(cache->interned[cat]));
+      }
+   }
+
+   for (i = 0; i < rdb_count && r.ok; i++)
+   {
+      explore_cache_rdb_t c;
+      uint32_t path_len  = explore_cache_read_u32(&r);
+      c.path             = (const char*)explore_cache_read(&r, path_len);
+      c.size             = explore_cache_read_i64(&r);
+      c.mtime            = explore_cache_read_i64(&r);
+      c.count            = explore_cache_read_u32(&r);
+      c.labels_len       = explore_cache_read_u32(&r);
+      c.labels           = (const char*)explore_cache_read(&r,
+            c.labels_len);
+      c.crc              = explore_cache_read_column(&r, c.count);
+      c.label            = explore_cache_read_column(&r, c.count);
+      c.meta_count       = explore_cache_read_column(&r, c.count);
+      for (cat = 0; cat < EXPLORE_CAT_COUNT; cat++)
+         c.by[cat]       = explore_cache_read_column(&r, c.count);
+      c.split            = explore_cache_read_column(&r, c.count);
+      c.split_pool_len   = explore_cache_read_u32(&r);
+      c.split_pool       = explore_cache_read_column(&r,
+            c.split_pool_len);
+
+      if (     !r.ok
+            || !path_len
+            || c.path[path_len - 1] != '\0'
+            || (c.labels_len && c.labels[c.labels_len - 1] != '\0')
+            || !explore_cache_check_rdb(cache, &c))
+         goto error;
+
+      RBUF_PUSH(cache->rdbs, c);
+   }
+
+   if (r.ok)
+      return true;
+
+error:
+   explore_cache_free(cache);
+   return false;
+}
+
+static explore_string_t *explore_cache_string(explore_state_t *state,
+      explore_cache_t *cache,
+      explore_string_t** maps[EXPLORE_CAT_COUNT],
+      uint32_t cat, uint32_t id)
+{
+   explore_string_t *entry;
+
+   if (id == EXPLORE_CACHE_NONE)
+      return NULL;
+
+   if (!(entry = cache->interned[cat][id]))
+   {
+      const char *str = cache->strings[cat][id];
+      size_t len      = strlen(str);
+      uint32_t hash   = ex_hash32_nocase_filtered(
+            (unsigned char*)str, len, '0', 255);
+
+      /* Share the string with entries read from other RDBs */
+      if (!(entry = RHMAP_GET(maps[cat], hash)))
+      {
+         entry                = (explore_string_t*)
+            ex_arena_alloc(&state->arena,
+                  sizeof(explore_string_t) + len);
+         memcpy(entry->str, str, len + 1);
+         RBUF_PUSH(state->by[cat], entry);
+         RHMAP_SET(maps[cat], hash, entry);
+      }
+
+      cache->interned[cat][id] = entry;
+   }
+
+   return entry;
+}
+
+static void explore_cache_add_entry(explore_state_t *state,
+      explore_cache_t *cache,
+      explore_string_t** maps[EXPLORE_CAT_COUNT],
+      explore_string_t ***split_buf,
+      const explore_cache_rdb_t *c, uint32_t row,
+      struct explore_source *src)
+{
+   unsigned cat;
+   uint32_t split;
+   explore_entry_t *e;
+
+   /* The entry was looked up but is not in the RDB */
+   if (c->meta_count[row] == EXPLORE_CACHE_NONE)
+      return;
+
+   src->entry_index  = (uint32_t)RBUF_LEN(state->entries);
+   src->meta_count   = c->meta_count[row];
+   RBUF_RESIZE(state->entries, src->entry_index + 1);
+   e                 = &state->entries[src->entry_index];
+   e->playlist_entry = src->source;
+   e->split          = NULL;
+
+   for (cat = 0; cat < EXPLORE_CAT_COUNT; cat++)
+   {
+      e->by[cat] = explore_cache_string(state, cache, maps,
+            cat, c->by[cat][row]);
+      if (!e->by[cat])
+         state->has_unknown[cat] = true;
+   }
+
+   if ((split = c->split[row]) != EXPLORE_CACHE_NONE)
+   {
+      size_t len;
+
+      for (; c->split_pool[split] != EXPLORE_CACHE_NONE; split += 2)
+         RBUF_PUSH(*split_buf, explore_cache_string(state, cache, maps,
+                  c->split_pool[split], c->split_pool[split + 1]));
+
+      RBUF_PUSH(*split_buf, NULL); /* terminator */
+      len      = RBUF_SIZEOF(*split_buf);
+      e->split = (explore_string_t **)
+         ex_arena_alloc(&state->arena, len);
+      memcpy(e->split, *split_buf, len);
+      RBUF_CLEAR(*split_buf);
+   }
+}
+
+/* Restores the entries of an RDB from the cache.
+ * Returns false if the RDB has to be read again. */
+static bool explore_cache_apply(explore_state_t *state,
+      explore_cache_t *cache,
+      explore_string_t** maps[EXPLORE_CAT_COUNT],
+      explore_string_t ***split_buf,
+      struct explore_rdb *rdb)
+{
+   size_t i, cap;
+   uint32_t row;
+   uint32_t *crc_rows             = NULL;
+   uint32_t *label_rows           = NULL;
+   const explore_cache_rdb_t *c   = NULL;
+   bool complete                  = true;
+
+   for (i = 0; i < RBUF_LEN(cache->rdbs); i++)
+   {
+      if (     cache->rdbs[i].size  == rdb->size
+            && cache->rdbs[i].mtime == rdb->mtime
+            && string_is_equal(cache->rdbs[i].path, rdb->path))
+      {
+         c = &cache->rdbs[i];
+         break;
+      }
+   }
+
+   if (!c)
+      return false;
+
+   /* Row numbers are stored off by one, 0 means not cached */
+   for (row = 0; row < c->count; row++)
+   {
+      if (c->crc[row])
+         RHMAP_SET(crc_rows, c->crc[row], row + 1);
+      else if (c->label[row] != EXPLORE_CACHE_NONE)
+         RHMAP_SET_STR(label_rows, c->labels + c->label[row], row + 1);
+   }
+
+   /* Every playlist entry must have been looked up before */
+   for (i = 0, cap = RHMAP_CAP(rdb->playlist_crcs); i != cap; i++)
+      if (     RHMAP_KEY(rdb->playlist_crcs, i)
+            && !RHMAP_HAS(crc_rows, RHMAP_KEY(rdb->playlist_crcs, i)))
+         complete = false;
+   for (i = 0, cap = RHMAP_CAP(rdb->playlist_names); i != cap; i++)
+      if (     RHMAP_KEY(rdb->playlist_names, i)
+            && !RHMAP_HAS_STR(label_rows,
+               RHMAP_KEY_STR(rdb->playlist_names, i)))
+         complete = false;
+
+   if (complete)
+   {
+      for (i = 0, cap = RHMAP_CAP(rdb->playlist_crcs); i != cap; i++)
+         if (RHMAP_KEY(rdb->playlist_crcs, i))
+            explore_cache_add_entry(state, cache, maps, split_buf, c,
+                  RHMAP_GET(crc_rows,
+                     RHMAP_KEY(rdb->playlist_crcs, i)) - 1,
+                  &rdb->playlist_crcs[i]);
+      for (i = 0, cap = RHMAP_CAP(rdb->playlist_names); i != cap; i++)
+         if (RHMAP_KEY(rdb->playlist_names, i))
+            explore_cache_add_entry(state, cache, maps, split_buf, c,
+                  RHMAP_GET_STR(label_rows,
+                     RHMAP_KEY_STR(rdb->playlist_names, i)) - 1,
+                  &rdb->playlist_names[i]);
+   }
+
+   RHMAP_FREE(crc_rows);
+   RHMAP_FREE(label_rows);
+   return complete;
+}
+
+static void explore_cache_put(uint8_t **buf, const void *data, size_t len)
+{
+   size_t pos = RBUF_LEN(*buf);
+   if (!len)
+      return;
+   RBUF_RESIZE(*buf, pos + len);
+   memcpy(*buf + pos, data, len);
+}
+
+static void explore_cache_put_u32(uint8_t **buf, uint32_t val)
+{
+   explore_cache_put(buf, &val, sizeof(val));
+}
+
+static void explore_cache_put_i64(uint8_t **buf, int64_t val)
+{
+   explore_cache_put_u32(buf, (uint32_t)((uint64_t)val & 0xFFFFFFFF));
+   explore_cache_put_u32(buf, (uint32_t)((uint64_t)val >> 32));
+}
+
+static void explore_cache_align(uint8_t **buf)
+{
+   while (RBUF_LEN(*buf) & 3)
+      RBUF_PUSH(*buf, 0);
+}
+
+static void explore_cache_put_source(uint8_t **buf,
+      const explore_state_t *state, const struct explore_source *src,
+      unsigned cat)
+{
+   const explore_entry_t *e;
+   if (src->entry_index == (uint32_t)-1)
+      explore_cache_put_u32(buf, EXPLORE_CACHE_NONE);
+   else if (!(e = &state->entries[src->entry_index])->by[cat])
+      explore_cache_put_u32(buf, EXPLORE_CACHE_NONE);
+   else
+      explore_cache_put_u32(buf, e->by[cat]->idx);
+}
+
+/* Must be called after the category strings were sorted
+ * and before the entries get sorted */
+static void explore_cache_write(const explore_state_t *state,
+      struct explore_rdb *rdbs, const char *path)
+{
+   size_t i, j;
+   unsigned cat;
+   uint8_t *buf                   = NULL;
+   const struct explore_source **rows = NULL;
+   uint32_t *split_pool           = NULL;
+
+   explore_cache_put_u32(&buf, EXPLORE_CACHE_MAGIC);
+   explore_cache_put_u32(&buf, EXPLORE_CACHE_VERSION);
+   explore_cache_put_u32(&buf, EXPLORE_CAT_COUNT);
+   explore_cache_put_u32(&buf, *msg_hash_get_uint(MSG_HASH_USER_LANGUAGE));
+   explore_cache_put_u32(&buf, (uint32_t)RBUF_LEN(rdbs));
+
+   for (cat = 0; cat < EXPLORE_CAT_COUNT; cat++)
+   {
+      size_t size = 0;
+      size_t len  = RBUF_LEN(state->by[cat]);
+      for (i = 0; i < len; i++)
+         size    += strlen(state->by[cat][i]->str) + 1;
+      explore_cache_put_u32(&buf, (uint32_t)len);
+      explore_cache_put_u32(&buf, (uint32_t)size);
+      for (i = 0; i < len; i++)
+         explore_cache_put(&buf, state->by[cat][i]->str,
+               strlen(state->by[cat][i]->str) + 1);
+      explore_cache_align(&buf);
+   }
+
+   for (i = 0; i < RBUF_LEN(rdbs); i++)
+   {
+      size_t cap;
+      uint32_t labels_len       = 0;
+      struct explore_rdb *rdb   = &rdbs[i];
+
+      RBUF_CLEAR(rows);
+      for (j = 0, cap = RHMAP_CAP(rdb->playlist_crcs); j != cap; j++)
+         if (RHMAP_KEY(rdb->playlist_crcs, j))
+            RBUF_PUSH(rows, &rdb->playlist_crcs[j]);
+      for (j = 0, cap = RHMAP_CAP(rdb->playlist_names); j != cap; j++)
+         if (RHMAP_KEY(rdb->playlist_names, j))
+         {
+            RBUF_PUSH(rows, &rdb->playlist_names[j]);
+            labels_len += (uint32_t)strlen(
+                  RHMAP_KEY_STR(rdb->playlist_names, j)) + 1;
+         }
+
+      explore_cache_put_u32(&buf, (uint32_t)strlen(rdb->path) + 1);
+      explore_cache_put(&buf, rdb->path, strlen(rdb->path) + 1);
+      explore_cache_align(&buf);
+      explore_cache_put_i64(&buf, rdb->size);
+      explore_cache_put_i64(&buf, rdb->mtime);
+      explore_cache_put_u32(&buf, (uint32_t)RBUF_LEN(rows));
+
+      /* Rows keyed by crc come first, then the ones keyed by label */
+      explore_cache_put_u32(&buf, labels_len);
+      for (j = 0, cap = RHMAP_CAP(rdb->playlist_names); j != cap; j++)
+         if (RHMAP_KEY(rdb->playlist_names, j))
+            explore_cache_put(&buf, RHMAP_KEY_STR(rdb->playlist_names, j),
+                  strlen(RHMAP_KEY_STR(rdb->playlist_names, j)) + 1);
+      explore_cache_align(&buf);
+
+      for (j = 0, cap = RHMAP_CAP(rdb->playlist_crcs); j != cap; j++)
+         if (RHMAP_KEY(rdb->playlist_crcs, j))
+            explore_cache_put_u32(&buf, RHMAP_KEY(rdb->playlist_crcs, j));
+      for (j = 0, cap = RHMAP_CAP(rdb->playlist_names); j != cap; j++)
+         if (RHMAP_KEY(rdb->playlist_names, j))
+            explore_cache_put_u32(&buf, 0);
+
+      labels_len = 0;
+      for (j = 0, cap = RHMAP_CAP(rdb->playlist_crcs); j != cap; j++)
+         if (RHMAP_KEY(rdb->playlist_crcs, j))
+            explore_cache_put_u32(&buf, EXPLORE_CACHE_NONE);
+      for (j = 0, cap = RHMAP_CAP(rdb->playlist_names); j != cap; j++)
+         if (RHMAP_KEY(rdb->playlist_names, j))
+         {
+            explore_cache_put_u32(&buf, labels_len);
+            labels_len += (uint32_t)strlen(
+                  RHMAP_KEY_STR(rdb->playlist_names, j)) + 1;
+         }
+
+      for (j = 0; j < RBUF_LEN(rows); j++)
+         explore_cache_put_u32(&buf,
+               rows[j]->entry_index == (uint32_t)-1
+               ? EXPLORE_CACHE_NONE : rows[j]->meta_count);
+
+      for (cat = 0; cat < EXPLORE_CAT_COUNT; cat++)
+         for (j = 0; j < RBUF_LEN(rows); j++)
+            explore_cache_put_source(&buf, state, rows[j], cat);
+
+      RBUF_CLEAR(split_pool);
+      for (j = 0; j < RBUF_LEN(rows); j++)
+      {
+         explore_string_t **split;
+
+         if (     rows[j]->entry_index == (uint32_t)-1
+               || !(split = state->entries[rows[j]->entry_index].split))
+         {
+            explore_cache_put_u32(&buf, EXPLORE_CACHE_NONE);
+            continue;
+         }
+
+         explore_cache_put_u32(&buf, (uint32_t)RBUF_LEN(split_pool));
+         for (; *split; split++)
+         {
+            /* Split strings do not know their category */
+            for (cat = 0; cat < EXPLORE_CAT_COUNT; cat++)
+               if (     (*split)->idx < RBUF_LEN(state->by[cat])
+                     && state->by[cat][(*split)->idx] == *split)
+                  break;
+            RBUF_PUSH(split_pool, cat);
+            RBUF_PUSH(split_pool, (*split)->idx);
+         }
+         RBUF_PUSH(split_pool, EXPLORE_CACHE_NONE);
+         RBUF_PUSH(split_pool, EXPLORE_CACHE_NONE);
+      }
+
+      explore_cache_put_u32(&buf, (uint32_t)RBUF_LEN(split_pool));
+      explore_cache_put(&buf, split_pool, RBUF_SIZEOF(split_pool));
+   }
+
+   if (!filestream_write_file(path, buf, (int64_t)RBUF_LEN(buf)))
+      RARCH_WARN("[Explore] Failed to write cache \"%s\".\n", path);
+
+   RBUF_FREE(split_pool);
+   RBUF_FREE(rows);
+   RBUF_FREE(buf);
+}
+
+/* Loads the meta data strings of every entry found in an RDB */
+static void explore_read_rdb(explore_state_t *state,
+      struct explore_rdb *rdb,
+      explore_string_t** maps[EXPLORE_CAT_COUNT],
+      explore_string_t ***split_buf)
+{
+   libretrodb_view_t view;
+   libretrodb_cursor_t *cur = libretrodb_cursor_new();
+   bool more                =
+      (
+       libretrodb_cursor_open(rdb->handle, cur, NULL) == 0
+       && libretrodb_cursor_read_view(cur, &view) == 0);
+
+   /* Items are read in place from the mapped database;
+    * strings are only copied once they are kept */
+   for (; more; more = (libretrodb_cursor_read_view(cur, &view) == 0))
+   {
+      unsigned k, l, cat;
+      struct rmsgpack_view_value key;
+      struct rmsgpack_view_value value;
+      explore_entry_t* e;
+      const char *fields[EXPLORE_CAT_COUNT];
+      char numeric_buf[EXPLORE_CAT_COUNT][16];
+      uint32_t crc32                     = 0;
+      uint32_t meta_count                = 0;
+      const char *name                   = NULL;
+#ifdef EXPLORE_SHOW_ORIGINAL_TITLE
+      const char *original_title         = NULL;
+#endif
+      struct explore_source* src         = NULL;
+
+      for (k = 0; k < EXPLORE_CAT_COUNT; k++)
+         fields[k]                       = NULL;
+
+      while (libretrodb_view_next(&view, &key, &value))
+      {
+         const char *key_str                   = NULL;
+         const struct rmsgpack_view_value *val = &value;
+         if (key.type != RDT_STRING
+               || !(key_str = libretrodb_view_string(&view, &key)))
+            continue;
+
+         if (string_is_equal(key_str, "crc"))
+         {
+            /* Big-endian; the view may be unaligned */
+            const uint8_t *crc = (const uint8_t*)val->val.binary.buff;
+            switch (val->val.binary.len)
+            {
+               case 1:
+                  crc32 = crc[0];
+                  break;
+               case 2:
+                  crc32 = ((uint32_t)crc[0] << 8) | crc[1];
+                  break;
+               case 4:
+                  crc32 = ((uint32_t)crc[0] << 24)
+                     | ((uint32_t)crc[1] << 16)
+                     | ((uint32_t)crc[2] <<  8)
+                     |  (uint32_t)crc[3];
+                  break;
+               default:
+                  crc32 = 0;
+                  break;
+            }
+
+            continue;
+         }
+         else if (string_is_equal(key_str, "name"))
+         {
+            name = libretrodb_view_string(&view, val);
+            continue;
+         }
+#ifdef EXPLORE_SHOW_ORIGINAL_TITLE
+         else if (string_is_equal(key_str, "original_title"))
+         {
+            original_title = libretrodb_view_string(&view, val);
+            continue;
+         }
+#endif
+
+         for (cat = 0; cat != EXPLORE_CAT_COUNT; cat++)
+         {
+            if (!string_is_equal(key_str, explore_by_info[cat].rdbkey))
+               continue;
+
+            meta_count++;
+            if (explore_by_info[cat].is_numeric)
+            {
+               if (val->type >= RDT_STRING)
+                  break;
+               snprintf(numeric_buf[cat],
+                     sizeof(numeric_buf[cat]),
+                     "%d", (int)val->val.int_);
+               fields[cat] = numeric_buf[cat];
+               break;
+            }
+            if (explore_by_info[cat].is_boolean)
+            {
+               if (val->type >= RDT_STRING)
+                  break;
+               fields[cat] = msg_hash_to_str(val->val.int_ ?
+                     MENU_ENUM_LABEL_VALUE_YES : MENU_ENUM_LABEL_VALUE_NO);
+               break;
+            }
+            if (val->type != RDT_STRING)
+               break;
+            fields[cat] = libretrodb_view_string(&view, val);
+            break;
+         }
+      }
+
+      if (crc32)
+      {
+         ptrdiff_t idx = RHMAP_IDX(rdb->playlist_crcs, crc32);
+         src = (idx != -1 ? &rdb->playlist_crcs[idx] : NULL);
+      }
+      if (!src && name)
+      {
+         ptrdiff_t idx = RHMAP_IDX_STR(rdb->playlist_names, name);
+         src = (idx != -1 ? &rdb->playlist_names[idx] : NULL);
+      }
+      if (!src)
+         continue;
+      if (src->entry_index != (uint32_t)-1 && src->meta_count >= meta_count)
+         continue;
+
+      if (src->entry_index == (uint32_t)-1)
+      {
+         src->entry_index = (uint32_t)RBUF_LEN(state->entries);
+         RBUF_RESIZE(state->entries, src->entry_index + 1);
+      }
+      e = &state->entries[src->entry_index];
+      src->meta_count = meta_count;
+      e->playlist_entry = src->source;
+      for (l = 0; l < EXPLORE_CAT_COUNT; l++)
+         e->by[l]       = NULL;
+      e->split          = NULL;
+#ifdef EXPLORE_SHOW_ORIGINAL_TITLE
+      e->original_title = NULL;
+#endif
+
+      fields[EXPLORE_BY_SYSTEM] = rdb->systemname;
+
+      for (cat = 0; cat != EXPLORE_CAT_COUNT; cat++)
+      {
+         explore_add_unique_string(state,
+               maps, e, cat,
+               fields[cat], split_buf);
+      }
+
+#ifdef EXPLORE_SHOW_ORIGINAL_TITLE
+      if (original_title && *original_title)
+      {
+         size_t len        = strlen(original_title) + 1;
+         e->original_title = (char*)
+            ex_arena_alloc(&state->arena, len);
+         memcpy(e->original_title, original_title, len);
+      }
+#endif
+
+      if (RBUF_LEN(*split_buf))
+      {
+         size_t len;
+
+         RBUF_PUSH(*split_buf, NULL); /* terminator */
+         len        = RBUF_SIZEOF(*split_buf);
+         e->split   = (explore_string_t **)
+            ex_arena_alloc(&state->arena, len);
+         memcpy(e->split, *split_buf, len);
+         RBUF_CLEAR(*split_buf);
+      }
+
+      /* if all entries have found connections, we can leave early */
+      if (--rdb->count == 0)
+         break;
+   }
+
+   libretrodb_cursor_close(cur);
+   libretrodb_cursor_free(cur);
+}
+
 explore_state_t *menu_explore_build_list(const char *directory_playlist,
       const char *directory_database)
 {
    unsigned i;
    char tmp[PATH_MAX_LENGTH];
-   struct explore_source
-   {
-      const struct playlist_entry *source;
-      uint32_t entry_index, meta_count;
-   };
-   struct explore_rdb
-   {
-      libretrodb_t *handle;
-      struct explore_source *playlist_crcs;
-      struct explore_source *playlist_names;
-      size_t count;
-      char systemname[256];
-   }
-   *rdbs                                          = NULL;
+   char cache_path[PATH_MAX_LENGTH];
+   explore_cache_t cache;
+   struct explore_rdb *rdbs                       = NULL;
    int *rdb_indices                               = NULL;
    explore_string_t **cat_maps[EXPLORE_CAT_COUNT] = {NULL};
    explore_string_t **split_buf                   = NULL;
    libretro_vfs_implementation_dir *dir           = NULL;
+   bool cache_dirty                               = false;
 
    explore_state_t *state = (explore_state_t*)calloc(1, sizeof(*state));
 
@@ -482,6 +1241,13 @@ explore_state_t *menu_explore_build_list(const char *directory_playlist,
    state->label_explore_item_str    = 
       msg_hash_to_str(MENU_ENUM_LABEL_EXPLORE_ITEM);
 
+   memset(&cache, 0, sizeof(cache));
+   fill_pathname_join_special(cache_path, directory_playlist,
+         FILE_PATH_EXPLORE_CACHE, sizeof(cache_path));
+#ifndef EXPLORE_SHOW_ORIGINAL_TITLE
+   /* Original titles are not cached, always read the RDBs */
+   explore_cache_load(&cache, cache_path);
+#endif
    /* Index all playlists */
    for (dir = retro_vfs_opendir_impl(directory_playlist, false); dir;)
    {
@@ -497,6 +1263,7 @@ explore_state_t *menu_explore_build_list(const char *directory_playlist,
       playlist_config.capacity                  = 0;
       playlist_config.old_format                = false;
       playlist_config.compress                  = false;
+      playlist_config.binary                    = false;
       playlist_config.fuzzy_archive_match       = false;
       playlist_config.autofix_paths             = false;
 
@@ -583,6 +1350,10 @@ explore_state_t *menu_explore_build_list(const char *directory_playlist,
                ext_path[3] = 'b';
             }
 
+            strlcpy(newrdb.path, tmp, sizeof(newrdb.path));
+            newrdb.size           = path_get_size(tmp);
+            newrdb.mtime          = path_get_mtime(tmp);
+
             if (libretrodb_open(tmp, newrdb.handle, false) != 0)
             {
                /* Invalid RDB file */
@@ -621,191 +1392,23 @@ explore_state_t *menu_explore_build_list(const char *directory_playlist,
          playlist_free(playlist);
    }
 
-   /* Loop through all RDBs referenced in the playlists 
-    * and load meta data strings */
+   /* Loop through all RDBs referenced in the playlists
+    * and load meta data strings, from the cache if possible */
    for (i = 0; i != RBUF_LEN(rdbs); i++)
    {
-      struct rmsgpack_dom_value item;
       struct explore_rdb* rdb  = &rdbs[i];
-      libretrodb_cursor_t *cur = libretrodb_cursor_new();
-      bool more                = 
-         (
-          libretrodb_cursor_open(rdb->handle, cur, NULL) == 0
-          && libretrodb_cursor_read_item(cur, &item) == 0);
-
-      for (; more; more = (rmsgpack_dom_value_free(&item),
-               libretrodb_cursor_read_item(cur, &item) == 0))
-      {
-         unsigned k, l, cat;
-         explore_entry_t* e;
-         const char *fields[EXPLORE_CAT_COUNT];
-         char numeric_buf[EXPLORE_CAT_COUNT][16];
-         uint32_t crc32                     = 0;
-         uint32_t meta_count                = 0;
-         char *name                         = NULL;
-#ifdef EXPLORE_SHOW_ORIGINAL_TITLE
-         char *original_title               = NULL;
-#endif
-         struct explore_source* src         = NULL;
-
-         if (item.type != RDT_MAP)
-            continue;
-
-         for (k = 0; k < EXPLORE_CAT_COUNT; k++)
-            fields[k]                       = NULL;
-
-         for (k = 0; k < item.val.map.len; k++)
-         {
-            const char *key_str             = NULL;
-            struct rmsgpack_dom_value *key  = &item.val.map.items[k].key;
-            struct rmsgpack_dom_value *val  = &item.val.map.items[k].value;
-            if (!key || !val || key->type != RDT_STRING)
-               continue;
-
-            key_str                         = key->val.string.buff;
-            if (string_is_equal(key_str, "crc"))
-            {
-               switch (val->val.binary.len)
-               {
-                  case 1:
-                     crc32 = *(uint8_t*)val->val.binary.buff;
-                     break;
-                  case 2:
-                     crc32 = swap_if_little16(*(uint16_t*)val->val.binary.buff);
-                     break;
-                  case 4:
-                     crc32 = swap_if_little32(*(uint32_t*)val->val.binary.buff);
-                     break;
-                  default:
-                     crc32 = 0;
-                     break;
-               }
 
-               continue;
-            }
-            else if (string_is_equal(key_str, "name"))
-            {
-               name = val->val.string.buff;
-               continue;
-            }
-#ifdef EXPLORE_SHOW_ORIGINAL_TITLE
-            else if (string_is_equal(key_str, "original_title"))
-            {
-               original_title = val->val.string.buff;
-               continue;
-            }
-#endif
-
-            for (cat = 0; cat != EXPLORE_CAT_COUNT; cat++)
-            {
-               if (!string_is_equal(key_str, explore_by_info[cat].rdbkey))
-                  continue;
-
-               meta_count++;
-               if (explore_by_info[cat].is_numeric)
-               {
-                  if (val->type >= RDT_STRING)
-                     break;
-                  snprintf(numeric_buf[cat],
-                        sizeof(numeric_buf[cat]),
-                        "%d", (int)val->val.int_);
-                  fields[cat] = numeric_buf[cat];
-                  break;
-               }
-               if (explore_by_info[cat].is_boolean)
-               {
-                  if (val->type >= RDT_STRING)
-                     break;
-                  fields[cat] = msg_hash_to_str(val->val.int_ ?
-                        MENU_ENUM_LABEL_VALUE_YES : MENU_ENUM_LABEL_VALUE_NO);
-                  break;
-               }
-               if (val->type != RDT_STRING)
-                  break;
-               fields[cat] = val->val.string.buff;
-               break;
-            }
-         }
-
-         if (crc32)
-         {
-            ptrdiff_t idx = RHMAP_IDX(rdb->playlist_crcs, crc32);
-            src = (idx != -1 ? &rdb->playlist_crcs[idx] : NULL);
-         }
-         if (!src && name)
-         {
-            ptrdiff_t idx = RHMAP_IDX_STR(rdb->playlist_names, name);
-            src = (idx != -1 ? &rdb->playlist_names[idx] : NULL);
-         }
-         if (!src)
-            continue;
-         if (src->entry_index != (uint32_t)-1 && src->meta_count >= meta_count)
-            continue;
-
-         if (src->entry_index == (uint32_t)-1)
-         {
-            src->entry_index = (uint32_t)RBUF_LEN(state->entries);
-            RBUF_RESIZE(state->entries, src->entry_index + 1);
-         }
-         e = &state->entries[src->entry_index];
-         src->meta_count = meta_count;
-         e->playlist_entry = src->source;
-         for (l = 0; l < EXPLORE_CAT_COUNT; l++)
-            e->by[l]       = NULL;
-         e->split          = NULL;
-#ifdef EXPLORE_SHOW_ORIGINAL_TITLE
-         e->original_title = NULL;
-#endif
-
-         fields[EXPLORE_BY_SYSTEM] = rdb->systemname;
-
-         for (cat = 0; cat != EXPLORE_CAT_COUNT; cat++)
-         {
-            explore_add_unique_string(state,
-                  cat_maps, e, cat,
-                  fields[cat], &split_buf);
-         }
-
-#ifdef EXPLORE_SHOW_ORIGINAL_TITLE
-         if (original_title && *original_title)
-         {
-            size_t len        = strlen(original_title) + 1;
-            e->original_title = (char*)
-               ex_arena_alloc(&state->arena, len);
-            memcpy(e->original_title, original_title, len);
-         }
-#endif
-
-         if (RBUF_LEN(split_buf))
-         {
-            size_t len;
-
-            RBUF_PUSH(split_buf, NULL); /* terminator */
-            len        = RBUF_SIZEOF(split_buf);
-            e->split   = (explore_string_t **)
-               ex_arena_alloc(&state->arena, len);
-            memcpy(e->split, split_buf, len);
-            RBUF_CLEAR(split_buf);
-         }
-
-         /* if all entries have found connections, we can leave early */
-         if (--rdb->count == 0)
-         {
-            rmsgpack_dom_value_free(&item);
-            break;
-         }
+      if (!explore_cache_apply(state, &cache, cat_maps, &split_buf, rdb))
+      {
+         explore_read_rdb(state, rdb, cat_maps, &split_buf);
+         cache_dirty = true;
       }
 
-      libretrodb_cursor_close(cur);
-      libretrodb_cursor_free(cur);
       libretrodb_close(rdb->handle);
       libretrodb_free(rdb->handle);
-      RHMAP_FREE(rdb->playlist_crcs);
-      RHMAP_FREE(rdb->playlist_names);
    }
    RBUF_FREE(split_buf);
    RHMAP_FREE(rdb_indices);
-   RBUF_FREE(rdbs);
 
    for (i = 0; i != EXPLORE_CAT_COUNT; i++)
    {
@@ -822,6 +1425,20 @@ explore_state_t *menu_explore_build_list(const char *directory_playlist,
 
       RHMAP_FREE(cat_maps[i]);
    }
+
+#ifndef EXPLORE_SHOW_ORIGINAL_TITLE
+   if (cache_dirty)
+      explore_cache_write(state, rdbs, cache_path);
+#endif
+   explore_cache_free(&cache);
+
+   for (i = 0; i != RBUF_LEN(rdbs); i++)
+   {
+      RHMAP_FREE(rdbs[i].playlist_crcs);
+      RHMAP_FREE(rdbs[i].playlist_names);
+   }
+   RBUF_FREE(rdbs);
+
    /* NULL is not a valid value as a first argument for qsort */
    if (state->entries)
       qsort(state->entries,
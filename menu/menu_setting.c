@@ -9134,6 +9134,15 @@ static void runahead_change_handler(rarch_setting_t *setting)
          /* fall-through */
       case MENU_ENUM_LABEL_RUN_AHEAD_FRAMES:
 #if (defined(HAVE_DYNAMIC) || defined(HAVE_DYLIB))
+#ifdef HAVE_THREADS
+      case MENU_ENUM_LABEL_RUN_AHEAD_SPECULATIONS:
+         /* Speculative instances are made along with
+          * the second instance, so start over */
+         if (     setting->enum_idx == MENU_ENUM_LABEL_RUN_AHEAD_SPECULATIONS
+               && retroarch_ctl(RARCH_CTL_IS_SECOND_CORE_LOADED, NULL))
+            runahead_secondary_core_destroy(runloop_state_get_ptr());
+         /* fall-through */
+#endif
       case MENU_ENUM_LABEL_RUN_AHEAD_SECONDARY_INSTANCE:
          /* If any changes here will cause second
           * instance runahead to be enabled, must
@@ -9189,7 +9198,13 @@ static void preempt_change_handler(rarch_setting_t *setting)
          break;
       case MENU_ENUM_LABEL_PREEMPT_FRAMES:
          if (     preempt
-               && preempt->frames != settings->uints.run_ahead_frames
+               && preempt->max_frames != settings->uints.run_ahead_frames
+               && !netplay_enabled)
+            command_event(CMD_EVENT_PREEMPT_UPDATE, NULL);
+         break;
+      case MENU_ENUM_LABEL_PREEMPT_ADAPTIVE:
+         if (     preempt
+               && preempt->adaptive != settings->bools.preemptive_frames_adaptive
                && !netplay_enabled)
             command_event(CMD_EVENT_PREEMPT_UPDATE, NULL);
          break;
@@ -12073,6 +12088,55 @@ static bool setting_append_list(
             (*list)[list_info->index - 1].offset_by     = 1;
             menu_settings_list_current_add_range(list, list_info, 1, 100, 1, true, true);
 
+#ifdef HAVE_THREADS
+            CONFIG_UINT(
+                  list, list_info,
+                  &settings->uints.rewind_threads,
+                  MENU_ENUM_LABEL_REWIND_THREADS,
+                  MENU_ENUM_LABEL_VALUE_REWIND_THREADS,
+                  DEFAULT_REWIND_THREADS,
+                  &group_info,
+                  &subgroup_info,
+                  parent_group,
+                  general_write_handler,
+                  general_read_handler);
+            (*list)[list_info->index - 1].action_ok     = &setting_action_ok_uint;
+            (*list)[list_info->index - 1].offset_by     = 1;
+            menu_settings_list_current_add_range(list, list_info, 1, 16, 1, true, true);
+#endif
+
+#ifdef HAVE_ZLIB
+            CONFIG_BOOL(
+                  list, list_info,
+                  &settings->bools.rewind_compress,
+                  MENU_ENUM_LABEL_REWIND_COMPRESS,
+                  MENU_ENUM_LABEL_VALUE_REWIND_COMPRESS,
+                  DEFAULT_REWIND_COMPRESS,
+                  MENU_ENUM_LABEL_VALUE_OFF,
+                  MENU_ENUM_LABEL_VALUE_ON,
+                  &group_info,
+                  &subgroup_info,
+                  parent_group,
+                  general_write_handler,
+                  general_read_handler,
+                  SD_FLAG_NONE);
+#endif
+
+            CONFIG_BOOL(
+                  list, list_info,
+                  &settings->bools.rewind_dirty_pages,
+                  MENU_ENUM_LABEL_REWIND_DIRTY_PAGES,
+                  MENU_ENUM_LABEL_VALUE_REWIND_DIRTY_PAGES,
+                  DEFAULT_REWIND_DIRTY_PAGES,
+                  MENU_ENUM_LABEL_VALUE_OFF,
+                  MENU_ENUM_LABEL_VALUE_ON,
+                  &group_info,
+                  &subgroup_info,
+                  parent_group,
+                  general_write_handler,
+                  general_read_handler,
+                  SD_FLAG_NONE);
+
          END_SUB_GROUP(list, list_info, parent_group);
          END_GROUP(list, list_info, parent_group);
          break;
@@ -16364,8 +16428,42 @@ static bool setting_append_list(
                SD_FLAG_NONE
                );
          (*list)[list_info->index - 1].change_handler = runahead_change_handler;
+
+#ifdef HAVE_THREADS
+         CONFIG_UINT(
+            list, list_info,
+            &settings->uints.run_ahead_speculations,
+            MENU_ENUM_LABEL_RUN_AHEAD_SPECULATIONS,
+            MENU_ENUM_LABEL_VALUE_RUN_AHEAD_SPECULATIONS,
+            DEFAULT_RUN_AHEAD_SPECULATIONS,
+            &group_info,
+            &subgroup_info,
+            parent_group,
+            general_write_handler,
+            general_read_handler);
+         (*list)[list_info->index - 1].action_ok      = &setting_action_ok_uint;
+         (*list)[list_info->index - 1].change_handler = runahead_change_handler;
+         SETTINGS_DATA_LIST_CURRENT_ADD_FLAGS(list, list_info, SD_FLAG_ADVANCED);
+         menu_settings_list_current_add_range(list, list_info, 0, RUNAHEAD_MAX_SPECULATIONS, 1, true, true);
+#endif
 #endif
 
+         CONFIG_BOOL(
+               list, list_info,
+               &settings->bools.run_ahead_keep_timeline,
+               MENU_ENUM_LABEL_RUN_AHEAD_KEEP_TIMELINE,
+               MENU_ENUM_LABEL_VALUE_RUN_AHEAD_KEEP_TIMELINE,
+               DEFAULT_RUN_AHEAD_KEEP_TIMELINE,
+               MENU_ENUM_LABEL_VALUE_OFF,
+               MENU_ENUM_LABEL_VALUE_ON,
+               &group_info,
+               &subgroup_info,
+               parent_group,
+               general_write_handler,
+               general_read_handler,
+               SD_FLAG_ADVANCED
+               );
+
          CONFIG_BOOL(
                list, list_info,
                &settings->bools.run_ahead_hide_warnings,
@@ -16415,6 +16513,23 @@ static bool setting_append_list(
          (*list)[list_info->index - 1].change_handler = preempt_change_handler;
          menu_settings_list_current_add_range(list, list_info, 1, MAX_RUNAHEAD_FRAMES, 1, true, true);
 
+         CONFIG_BOOL(
+               list, list_info,
+               &settings->bools.preemptive_frames_adaptive,
+               MENU_ENUM_LABEL_PREEMPT_ADAPTIVE,
+               MENU_ENUM_LABEL_VALUE_PREEMPT_ADAPTIVE,
+               DEFAULT_PREEMPT_ADAPTIVE,
+               MENU_ENUM_LABEL_VALUE_OFF,
+               MENU_ENUM_LABEL_VALUE_ON,
+               &group_info,
+               &subgroup_info,
+               parent_group,
+               general_write_handler,
+               general_read_handler,
+               SD_FLAG_ADVANCED
+               );
+         (*list)[list_info->index - 1].change_handler = preempt_change_handler;
+
          CONFIG_BOOL(
                list, list_info,
                &settings->bools.preemptive_frames_hide_warnings,
@@ -19936,6 +20051,20 @@ static bool setting_append_list(
                   general_read_handler);
             (*list)[list_info->index - 1].action_ok = &setting_action_ok_uint_special;
             menu_settings_list_current_add_range(list, list_info, 0, 1024, 256, true, true);
+
+            CONFIG_UINT(
+                  list, list_info,
+                  &settings->uints.gfx_thumbnail_cache_size,
+                  MENU_ENUM_LABEL_MENU_THUMBNAIL_CACHE_SIZE,
+                  MENU_ENUM_LABEL_VALUE_MENU_THUMBNAIL_CACHE_SIZE,
+                  DEFAULT_GFX_THUMBNAIL_CACHE_SIZE,
+                  &group_info,
+                  &subgroup_info,
+                  parent_group,
+                  general_write_handler,
+                  general_read_handler);
+            (*list)[list_info->index - 1].action_ok = &setting_action_ok_uint;
+            menu_settings_list_current_add_range(list, list_info, 0, 4096, 64, true, true);
          }
 
          if (string_is_equal(settings->arrays.menu_driver, "rgui"))
@@ -21695,6 +21824,22 @@ static bool setting_append_list(
                );
 #endif
 
+         CONFIG_BOOL(
+               list, list_info,
+               &settings->bools.playlist_binary_format,
+               MENU_ENUM_LABEL_PLAYLIST_BINARY_FORMAT,
+               MENU_ENUM_LABEL_VALUE_PLAYLIST_BINARY_FORMAT,
+               DEFAULT_PLAYLIST_BINARY_FORMAT,
+               MENU_ENUM_LABEL_VALUE_OFF,
+               MENU_ENUM_LABEL_VALUE_ON,
+               &group_info,
+               &subgroup_info,
+               parent_group,
+               general_write_handler,
+               general_read_handler,
+               SD_FLAG_NONE
+               );
+
          CONFIG_BOOL(
                list, list_info,
                &settings->bools.playlist_show_sublabels,
@@ -1625,6 +1625,7 @@ enum msg_hash_enums
    MENU_LABEL(MENU_XMB_TITLE_MARGIN),
    MENU_LABEL(MENU_XMB_TITLE_MARGIN_HORIZONTAL_OFFSET),
    MENU_LABEL(MENU_THUMBNAIL_UPSCALE_THRESHOLD),
+   MENU_LABEL(MENU_THUMBNAIL_CACHE_SIZE),
    MENU_LABEL(MENU_RGUI_INLINE_THUMBNAILS),
    MENU_LABEL(MENU_RGUI_SWAP_THUMBNAILS),
    MENU_LABEL(MENU_RGUI_THUMBNAIL_DOWNSCALER),
@@ -2360,6 +2361,9 @@ enum msg_hash_enums
    MENU_LABEL(REWIND_GRANULARITY),
    MENU_LABEL(REWIND_BUFFER_SIZE),
    MENU_LABEL(REWIND_BUFFER_SIZE_STEP),
+   MENU_LABEL(REWIND_THREADS),
+   MENU_LABEL(REWIND_COMPRESS),
+   MENU_LABEL(REWIND_DIRTY_PAGES),
    /* TODO/FIXME: INPUT_META_REWIND is incorrectly defined;
     * the LABEL/SUBLABEL enums should be entered 'manually',
     * like all the other hotkeys. Moreover, the resultant
@@ -2760,11 +2764,14 @@ enum msg_hash_enums
    MENU_LABEL(RUN_AHEAD_UNSUPPORTED),
    MENU_LABEL(RUN_AHEAD_ENABLED),
    MENU_LABEL(RUN_AHEAD_SECONDARY_INSTANCE),
+   MENU_LABEL(RUN_AHEAD_KEEP_TIMELINE),
+   MENU_LABEL(RUN_AHEAD_SPECULATIONS),
    MENU_LABEL(RUN_AHEAD_HIDE_WARNINGS),
    MENU_LABEL(RUN_AHEAD_FRAMES),
    MENU_LABEL(PREEMPT_UNSUPPORTED),
    MENU_LABEL(PREEMPT_ENABLE),
    MENU_LABEL(PREEMPT_FRAMES),
+   MENU_LABEL(PREEMPT_ADAPTIVE),
    MENU_LABEL(PREEMPT_HIDE_WARNINGS),
    MENU_LABEL(INPUT_BLOCK_TIMEOUT),
    MENU_LABEL(TURBO),
@@ -4114,6 +4121,7 @@ enum msg_hash_enums
 
    MENU_LABEL(PLAYLIST_USE_OLD_FORMAT),
    MENU_LABEL(PLAYLIST_COMPRESSION),
+   MENU_LABEL(PLAYLIST_BINARY_FORMAT),
    MENU_LABEL(MENU_SOUNDS),
    MENU_LABEL(MENU_SOUND_OK),
    MENU_LABEL(MENU_SOUND_CANCEL),
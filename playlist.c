@@ -25,11 +25,13 @@
 #include <compat/posix_string.h>
 #include <string/stdstring.h>
 #include <streams/interface_stream.h>
+#include <streams/file_stream.h>
 #include <file/file_path.h>
 #include <file/archive_file.h>
 #include <lists/string_list.h>
 #include <formats/rjson.h>
 #include <array/rbuf.h>
+#include <array/rhmap.h>
 
 #include "playlist.h"
 #include "verbosity.h"
@@ -61,6 +63,17 @@ typedef struct
    bool overwrite_playlist;
 } playlist_manual_scan_record_t;
 
+/* Links of the path index hash chains (value is the
+ * next entry in the chain as 'reverse index + 1', or
+ * 0 at the end of the chain). Stored by reverse index
+ * (size - 1 - index), so that pushing an entry to the
+ * top of the playlist leaves existing links valid */
+typedef struct
+{
+   uint32_t path;
+   uint32_t archive;
+} playlist_path_link_t;
+
 struct content_playlist
 {
    char *default_core_path;
@@ -69,8 +82,29 @@ struct content_playlist
 
    struct playlist_entry *entries;
 
+   /* Binary format: file image that entry strings
+    * point into, and records not yet appended to disk */
+   uint8_t *bin_data;
+   uint8_t *bin_journal;
+
+   /* Path index: chain heads by real path hash and by
+    * parent archive hash of entries inside archives */
+   uint32_t *path_index;
+   uint32_t *archive_index;
+   playlist_path_link_t *path_links;
+
    playlist_manual_scan_record_t scan_record; /* ptr alignment */
    playlist_config_t config;                  /* size_t alignment */
+   size_t bin_size;
+
+   /* Size and modification time of the binary file as
+    * this instance last read or wrote it. Records are
+    * only appended if the file still matches, since
+    * another instance may have rewritten it meanwhile */
+   int64_t bin_file_size;
+   int64_t bin_file_mtime;
+
+   unsigned bin_records;
 
    enum playlist_label_display_mode label_display_mode;
    enum playlist_thumbnail_mode right_thumbnail_mode;
@@ -82,6 +116,11 @@ struct content_playlist
    bool old_format;
    bool compressed;
    bool cached_external;
+   bool binary;
+   bool bin_journal_valid;
+   bool bin_meta_modified;
+   bool bin_unsupported;
+   bool path_index_valid;
 };
 
 typedef struct
@@ -171,6 +210,7 @@ bool playlist_config_copy(const playlist_config_t *src,
    dst->capacity            = src->capacity;
    dst->old_format          = src->old_format;
    dst->compress            = src->compress;
+   dst->binary              = src->binary;
    dst->fuzzy_archive_match = src->fuzzy_archive_match;
    dst->autofix_paths       = src->autofix_paths;
 
@@ -483,6 +523,189 @@ static bool playlist_path_matches_entry(playlist_path_id_t *path_id,
    return false;
 }
 
+/* Drops the path index; it gets rebuilt on the next
+ * lookup. Required whenever entries change position
+ * (other than by pushing a new entry to the top) or
+ * an entry path changes */
+static void playlist_path_index_invalidate(playlist_t *playlist)
+{
+   RHMAP_FREE(playlist->path_index);
+   RHMAP_FREE(playlist->archive_index);
+   RBUF_FREE(playlist->path_links);
+   playlist->path_index_valid = false;
+}
+
+/* Adds entry 'idx' to the path index. Entries must be
+ * added from the bottom of the playlist up, i.e. the
+ * entry must be the topmost not yet indexed entry */
+static bool playlist_path_index_add(playlist_t *playlist, size_t idx)
+{
+   playlist_path_link_t link;
+   struct playlist_entry *entry = &playlist->entries[idx];
+   uint32_t rev                 = (uint32_t)RBUF_LEN(playlist->path_links);
+
+   if (!entry->path_id && !(entry->path_id = playlist_path_id_init(entry->path)))
+      return false;
+   if (!RBUF_TRYFIT(playlist->path_links, rev + 1))
+      return false;
+
+   link.path    = 0;
+   link.archive = 0;
+
+   if (!string_is_empty(entry->path_id->real_path))
+   {
+      if (!RHMAP_TRYFIT(playlist->path_index, RHMAP_LEN(playlist->path_index) + 1))
+         return false;
+      link.path = RHMAP_GET(playlist->path_index, entry->path_id->real_path_hash);
+      RHMAP_SET(playlist->path_index, entry->path_id->real_path_hash, rev + 1);
+   }
+
+   if (     entry->path_id->is_in_archive
+         && !string_is_empty(entry->path_id->archive_path))
+   {
+      if (!RHMAP_TRYFIT(playlist->archive_index, RHMAP_LEN(playlist->archive_index) + 1))
+         return false;
+      link.archive = RHMAP_GET(playlist->archive_index, entry->path_id->archive_path_hash);
+      RHMAP_SET(playlist->archive_index, entry->path_id->archive_path_hash, rev + 1);
+   }
+
+   RBUF_PUSH(playlist->path_links, link);
+   return true;
+}
+
+static bool playlist_path_index_build(playlist_t *playlist)
+{
+   size_t i;
+
+   if (playlist->path_index_valid)
+      return true;
+
+   playlist_path_index_invalidate(playlist);
+
+   for (i = RBUF_LEN(playlist->entries); i-- > 0;)
+   {
+      if (!playlist_path_index_add(playlist, i))
+      {
+         playlist_path_index_invalidate(playlist);
+         return false;
+      }
+   }
+
+   playlist->path_index_valid = true;
+   return true;
+}
+
+/* Walks a path index chain (which runs from the top
+ * of the playlist down) and lowers 'best' to the first
+ * entry at or after 'from' that matches 'path_id' */
+static void playlist_path_index_walk(playlist_t *playlist,
+      playlist_path_id_t *path_id, uint32_t link, bool archive_chain,
+      size_t from, size_t *best)
+{
+   size_t len = RBUF_LEN(playlist->entries);
+
+   while (link)
+   {
+      uint32_t rev = link - 1;
+      size_t i     = len - 1 - rev;
+
+      if (i >= *best)
+         break;
+
+      if (     i >= from
+            && playlist_path_matches_entry(path_id,
+                  &playlist->entries[i], &playlist->config))
+      {
+         *best = i;
+         break;
+      }
+
+      link = archive_chain
+            ? playlist->path_links[rev].archive
+            : playlist->path_links[rev].path;
+   }
+}
+
+/**
+ * playlist_find_path:
+ * @playlist          : Playlist handle.
+ * @path_id           : Path identity to search for
+ * @match_empty       : Whether an empty search path should
+ *                      match entries without a path
+ * @idx               : Index to start searching from; receives
+ *                      the index of the first matching entry
+ *
+ * Returns 'true' if an entry at or after @idx matches
+ * 'path_id' (as per playlist_path_matches_entry()).
+ * Uses the path index, so this does not have to touch
+ * every entry of the playlist.
+ **/
+static bool playlist_find_path(playlist_t *playlist,
+      playlist_path_id_t *path_id, bool match_empty, size_t *idx)
+{
+   size_t i, len = RBUF_LEN(playlist->entries);
+
+   if (string_is_empty(path_id->real_path))
+   {
+      if (match_empty)
+      {
+         for (i = *idx; i < len; i++)
+         {
+            if (string_is_empty(playlist->entries[i].path))
+            {
+               *idx = i;
+               return true;
+            }
+         }
+      }
+      return false;
+   }
+
+   if (playlist_path_index_build(playlist))
+   {
+      size_t best = len;
+
+      playlist_path_index_walk(playlist, path_id,
+            RHMAP_GET(playlist->path_index, path_id->real_path_hash),
+            false, *idx, &best);
+
+#ifdef RARCH_INTERNAL
+      if (playlist->config.fuzzy_archive_match)
+#endif
+      {
+         /* Archive given without file name, matching
+          * entries inside that archive */
+         if (path_id->is_archive && !path_id->is_in_archive)
+            playlist_path_index_walk(playlist, path_id,
+                  RHMAP_GET(playlist->archive_index, path_id->archive_path_hash),
+                  true, *idx, &best);
+         /* ...or vice versa */
+         else if (path_id->is_in_archive)
+            playlist_path_index_walk(playlist, path_id,
+                  RHMAP_GET(playlist->path_index, path_id->archive_path_hash),
+                  false, *idx, &best);
+      }
+
+      if (best >= len)
+         return false;
+      *idx = best;
+      return true;
+   }
+
+   /* Out of memory - fall back to a linear search */
+   for (i = *idx; i < len; i++)
+   {
+      if (playlist_path_matches_entry(path_id,
+            &playlist->entries[i], &playlist->config))
+      {
+         *idx = i;
+         return true;
+      }
+   }
+
+   return false;
+}
+
 /**
  * playlist_core_path_equal:
  * @real_core_path  : 'Real' search path, generated by path_resolve_realpath()
@@ -562,33 +785,47 @@ void playlist_get_index(playlist_t *playlist,
    *entry = &playlist->entries[idx];
 }
 
+/* Entries loaded from a binary playlist reference
+ * strings inside the file image instead of owning
+ * a copy - those must not be passed to free() */
+static void playlist_free_string(playlist_t *playlist, char *str)
+{
+   if (     playlist->bin_data
+         && (uint8_t*)str >= playlist->bin_data
+         && (uint8_t*)str <  playlist->bin_data + playlist->bin_size)
+      return;
+   free(str);
+}
+
 /**
  * playlist_free_entry:
+ * @playlist            : Playlist handle.
  * @entry               : Playlist entry handle.
  *
  * Frees playlist entry.
  **/
-static void playlist_free_entry(struct playlist_entry *entry)
+static void playlist_free_entry(playlist_t *playlist,
+      struct playlist_entry *entry)
 {
    if (!entry)
       return;
 
    if (entry->path)
-      free(entry->path);
+      playlist_free_string(playlist, entry->path);
    if (entry->label)
-      free(entry->label);
+      playlist_free_string(playlist, entry->label);
    if (entry->core_path)
-      free(entry->core_path);
+      playlist_free_string(playlist, entry->core_path);
    if (entry->core_name)
-      free(entry->core_name);
+      playlist_free_string(playlist, entry->core_name);
    if (entry->db_name)
-      free(entry->db_name);
+      playlist_free_string(playlist, entry->db_name);
    if (entry->crc32)
-      free(entry->crc32);
+      playlist_free_string(playlist, entry->crc32);
    if (entry->subsystem_ident)
-      free(entry->subsystem_ident);
+      playlist_free_string(playlist, entry->subsystem_ident);
    if (entry->subsystem_name)
-      free(entry->subsystem_name);
+      playlist_free_string(playlist, entry->subsystem_name);
    if (entry->runtime_str)
       free(entry->runtime_str);
    if (entry->last_played_str)
@@ -623,6 +860,603 @@ static void playlist_free_entry(struct playlist_entry *entry)
    entry->last_played_second = 0;
 }
 
+/* Binary playlist format
+ * ----------------------
+ * Native endian, all values 32 bit and 4 byte aligned.
+ * The file starts with PLAYLIST_BIN_MAGIC and
+ * PLAYLIST_BIN_VERSION, followed by a sequence of
+ * records (type, payload size, payload). A full write
+ * produces one META and one ENTRIES record; small
+ * changes are appended as INSERT/REPLACE/DELETE/MOVE
+ * records and replayed on load, until the number of
+ * appended records makes a full rewrite worthwhile.
+ * String values are stored in a pool at the end of
+ * each record and referenced by offset. */
+#define PLAYLIST_BIN_MAGIC       0x424C5052 /* "RPLB" */
+#define PLAYLIST_BIN_VERSION     1
+#define PLAYLIST_BIN_NONE        0xFFFFFFFF
+#define PLAYLIST_BIN_ENTRY_WORDS 11
+#define PLAYLIST_BIN_META_WORDS  12
+#define PLAYLIST_BIN_MAX_RECORDS(entries) (64 + (entries) / 4)
+
+enum playlist_bin_record_type
+{
+   PLAYLIST_BIN_RECORD_META = 1,
+   PLAYLIST_BIN_RECORD_ENTRIES,
+   PLAYLIST_BIN_RECORD_INSERT,
+   PLAYLIST_BIN_RECORD_REPLACE,
+   PLAYLIST_BIN_RECORD_DELETE,
+   PLAYLIST_BIN_RECORD_MOVE
+};
+
+typedef struct
+{
+   uint8_t *words;  /* RBUF: fixed size part of the record */
+   char *pool;      /* RBUF: string pool */
+   uint32_t *map;   /* RHMAP: pooled string -> offset + 1 */
+} playlist_bin_writer_t;
+
+static void playlist_bin_put(uint8_t **buf, const void *data, size_t len)
+{
+   size_t pos = RBUF_LEN(*buf);
+   if (!len)
+      return;
+   RBUF_RESIZE(*buf, pos + len);
+   memcpy(*buf + pos, data, len);
+}
+
+static void playlist_bin_put_u32(uint8_t **buf, uint32_t val)
+{
+   playlist_bin_put(buf, &val, sizeof(val));
+}
+
+static uint32_t playlist_bin_put_string(playlist_bin_writer_t *w,
+      const char *str)
+{
+   size_t pos, len;
+   uint32_t ofs;
+
+   if (string_is_empty(str))
+      return PLAYLIST_BIN_NONE;
+   if ((ofs = RHMAP_GET_STR(w->map, str)))
+      return ofs - 1;
+
+   pos = RBUF_LEN(w->pool);
+   len = strlen(str) + 1;
+   RBUF_RESIZE(w->pool, pos + len);
+   memcpy(w->pool + pos, str, len);
+   RHMAP_SET_STR(w->map, str, (uint32_t)pos + 1);
+   return (uint32_t)pos;
+}
+
+static void playlist_bin_put_entry(playlist_bin_writer_t *w,
+      const struct playlist_entry *entry)
+{
+   uint32_t words[PLAYLIST_BIN_ENTRY_WORDS];
+   const struct string_list *roms = entry->subsystem_roms;
+
+   words[0]  = playlist_bin_put_string(w, entry->path);
+   words[1]  = playlist_bin_put_string(w, entry->label);
+   words[2]  = playlist_bin_put_string(w, entry->core_path);
+   words[3]  = playlist_bin_put_string(w, entry->core_name);
+   words[4]  = playlist_bin_put_string(w, entry->crc32);
+   words[5]  = playlist_bin_put_string(w, entry->db_name);
+   words[6]  = playlist_bin_put_string(w, entry->subsystem_ident);
+   words[7]  = playlist_bin_put_string(w, entry->subsystem_name);
+   words[8]  = entry->entry_slot;
+   words[9]  = 0;
+   words[10] = PLAYLIST_BIN_NONE;
+
+   /* Subsystem ROMs are stored as consecutive
+    * strings, so they bypass deduplication.
+    * Empty paths are dropped, as when reading JSON */
+   if (roms)
+   {
+      size_t i;
+      for (i = 0; i < roms->size; i++)
+      {
+         size_t pos, len;
+         const char *rom = roms->elems[i].data;
+
+         if (string_is_empty(rom))
+            continue;
+         if (!words[9]++)
+            words[10] = (uint32_t)RBUF_LEN(w->pool);
+
+         pos = RBUF_LEN(w->pool);
+         len = strlen(rom) + 1;
+         RBUF_RESIZE(w->pool, pos + len);
+         memcpy(w->pool + pos, rom, len);
+      }
+   }
+
+   playlist_bin_put(&w->words, words, sizeof(words));
+}
+
+/* Appends the record collected in 'w' to 'buf'
+ * and resets the writer */
+static void playlist_bin_put_record(uint8_t **buf,
+      enum playlist_bin_record_type type, playlist_bin_writer_t *w)
+{
+   while (RBUF_LEN(w->pool) & 3)
+      RBUF_PUSH(w->pool, 0);
+
+   playlist_bin_put_u32(buf, (uint32_t)type);
+   playlist_bin_put_u32(buf,
+         (uint32_t)(RBUF_LEN(w->words) + RBUF_LEN(w->pool)));
+   playlist_bin_put(buf, w->words, RBUF_LEN(w->words));
+   playlist_bin_put(buf, w->pool,  RBUF_LEN(w->pool));
+
+   RBUF_CLEAR(w->words);
+   RBUF_CLEAR(w->pool);
+   RHMAP_FREE(w->map);
+}
+
+static void playlist_bin_writer_free(playlist_bin_writer_t *w)
+{
+   RBUF_FREE(w->words);
+   RBUF_FREE(w->pool);
+   RHMAP_FREE(w->map);
+}
+
+static void playlist_bin_put_meta(playlist_t *playlist, uint8_t **buf)
+{
+   uint32_t words[PLAYLIST_BIN_META_WORDS];
+   playlist_bin_writer_t w = {0};
+
+   words[0]  = (uint32_t)playlist->label_display_mode;
+   words[1]  = (uint32_t)playlist->right_thumbnail_mode;
+   words[2]  = (uint32_t)playlist->left_thumbnail_mode;
+   words[3]  = (uint32_t)playlist->thumbnail_match_mode;
+   words[4]  = (uint32_t)playlist->sort_mode;
+   words[5]  = (playlist->scan_record.search_recursively ? 1 : 0)
+             | (playlist->scan_record.search_archives    ? 2 : 0)
+             | (playlist->scan_record.filter_dat_content ? 4 : 0)
+             | (playlist->scan_record.overwrite_playlist ? 8 : 0);
+   words[6]  = playlist_bin_put_string(&w, playlist->default_core_path);
+   words[7]  = playlist_bin_put_string(&w, playlist->default_core_name);
+   words[8]  = playlist_bin_put_string(&w, playlist->base_content_directory);
+   words[9]  = playlist_bin_put_string(&w, playlist->scan_record.content_dir);
+   words[10] = playlist_bin_put_string(&w, playlist->scan_record.file_exts);
+   words[11] = playlist_bin_put_string(&w, playlist->scan_record.dat_file_path);
+
+   playlist_bin_put(&w.words, words, sizeof(words));
+   playlist_bin_put_record(buf, PLAYLIST_BIN_RECORD_META, &w);
+   playlist_bin_writer_free(&w);
+}
+
+/* Changes can only be appended while the file on
+ * disk is a binary playlist and every modification
+ * since it was last written has been recorded */
+static bool playlist_bin_journaling(playlist_t *playlist)
+{
+   return playlist->binary && playlist->bin_journal_valid;
+}
+
+static void playlist_bin_journal_invalidate(playlist_t *playlist)
+{
+   playlist->bin_journal_valid = false;
+   RBUF_FREE(playlist->bin_journal);
+}
+
+/* Records a change to the entry list.
+ * INSERT/REPLACE store the current state of entry 'idx',
+ * DELETE removes 'idx', MOVE moves 'idx' to 'to' */
+static void playlist_bin_journal(playlist_t *playlist,
+      enum playlist_bin_record_type type, size_t idx, size_t to)
+{
+   playlist_bin_writer_t w = {0};
+
+   if (!playlist_bin_journaling(playlist))
+      return;
+
+   playlist_bin_put_u32(&w.words, (uint32_t)idx);
+   if (type == PLAYLIST_BIN_RECORD_MOVE)
+      playlist_bin_put_u32(&w.words, (uint32_t)to);
+   else if (type != PLAYLIST_BIN_RECORD_DELETE)
+      playlist_bin_put_entry(&w, &playlist->entries[idx]);
+
+   playlist_bin_put_record(&playlist->bin_journal, type, &w);
+   playlist_bin_writer_free(&w);
+   playlist->bin_records++;
+}
+
+static uint8_t *playlist_bin_snapshot(playlist_t *playlist)
+{
+   size_t i, len;
+   uint8_t *buf            = NULL;
+   playlist_bin_writer_t w = {0};
+
+   playlist_bin_put_u32(&buf, PLAYLIST_BIN_MAGIC);
+   playlist_bin_put_u32(&buf, PLAYLIST_BIN_VERSION);
+   playlist_bin_put_meta(playlist, &buf);
+
+   len = RBUF_LEN(playlist->entries);
+   playlist_bin_put_u32(&w.words, (uint32_t)len);
+   for (i = 0; i < len; i++)
+      playlist_bin_put_entry(&w, &playlist->entries[i]);
+   playlist_bin_put_record(&buf, PLAYLIST_BIN_RECORD_ENTRIES, &w);
+   playlist_bin_writer_free(&w);
+
+   return buf;
+}
+
+static void playlist_bin_stamp(playlist_t *playlist, int64_t size)
+{
+   playlist->bin_file_size  = size;
+   playlist->bin_file_mtime = path_get_mtime(playlist->config.path);
+}
+
+static bool playlist_bin_append(playlist_t *playlist)
+{
+   int64_t len;
+   bool success;
+   RFILE *file = filestream_open(playlist->config.path,
+         RETRO_VFS_FILE_ACCESS_READ_WRITE
+         | RETRO_VFS_FILE_ACCESS_UPDATE_EXISTING,
+         RETRO_VFS_FILE_ACCESS_HINT_NONE);
+
+   if (!file)
+      return false;
+
+   /* Records refer to entries by index, so they are
+    * only valid on top of the file they were made for */
+   if (     (filestream_get_size(file) != playlist->bin_file_size)
+         || (path_get_mtime(playlist->config.path)
+            != playlist->bin_file_mtime))
+   {
+      RARCH_WARN("[Playlist]: Playlist file changed on disk, "
+            "rewriting it: \"%s\".\n", playlist->config.path);
+      filestream_close(file);
+      return false;
+   }
+
+   len     = (int64_t)RBUF_LEN(playlist->bin_journal);
+   success =    filestream_seek(file, 0, RETRO_VFS_SEEK_POSITION_END) == 0
+             && filestream_write(file, playlist->bin_journal, len) == len;
+   if (filestream_close(file) != 0)
+      success = false;
+
+   if (success)
+      playlist_bin_stamp(playlist, playlist->bin_file_size + len);
+   return success;
+}
+
+static void playlist_bin_write_file(playlist_t *playlist)
+{
+   size_t len = RBUF_LEN(playlist->entries);
+
+   if (playlist_bin_journaling(playlist) && playlist->bin_meta_modified)
+   {
+      playlist_bin_put_meta(playlist, &playlist->bin_journal);
+      playlist->bin_records++;
+   }
+
+   if (     playlist_bin_journaling(playlist)
+         && RBUF_LEN(playlist->bin_journal)
+         && playlist->bin_records <= PLAYLIST_BIN_MAX_RECORDS(len)
+         && playlist_bin_append(playlist))
+      RARCH_LOG("[Playlist]: Appended to playlist file: \"%s\".\n",
+            playlist->config.path);
+   else
+   {
+      uint8_t *buf = playlist_bin_snapshot(playlist);
+      int64_t size = (int64_t)RBUF_LEN(buf);
+      bool success = filestream_write_file(playlist->config.path,
+            buf, size);
+
+      RBUF_FREE(buf);
+      if (!success)
+      {
+         RARCH_ERR("Failed to write to playlist file: \"%s\".\n",
+               playlist->config.path);
+         playlist_bin_journal_invalidate(playlist);
+         return;
+      }
+
+      playlist_bin_stamp(playlist, size);
+      playlist->bin_records = 0;
+      RARCH_LOG("[Playlist]: Written to playlist file: \"%s\".\n",
+            playlist->config.path);
+   }
+
+   RBUF_FREE(playlist->bin_journal);
+   playlist->bin_journal_valid = true;
+   playlist->bin_meta_modified = false;
+   playlist->binary            = true;
+   playlist->old_format        = false;
+   playlist->compressed        = false;
+   playlist->modified          = false;
+}
+
+static bool playlist_bin_get_string(char *pool, size_t pool_size,
+      uint32_t ofs, char **s)
+{
+   if (ofs == PLAYLIST_BIN_NONE)
+      *s = NULL;
+   else if (ofs < pool_size)
+      *s = pool + ofs;
+   else
+      return false;
+   return true;
+}
+
+static bool playlist_bin_read_entry(const uint32_t *words,
+      char *pool, size_t pool_size, struct playlist_entry *entry)
+{
+   memset(entry, 0, sizeof(*entry));
+
+   if (     !playlist_bin_get_string(pool, pool_size, words[0], &entry->path)
+         || !playlist_bin_get_string(pool, pool_size, words[1], &entry->label)
+         || !playlist_bin_get_string(pool, pool_size, words[2], &entry->core_path)
+         || !playlist_bin_get_string(pool, pool_size, words[3], &entry->core_name)
+         || !playlist_bin_get_string(pool, pool_size, words[4], &entry->crc32)
+         || !playlist_bin_get_string(pool, pool_size, words[5], &entry->db_name)
+         || !playlist_bin_get_string(pool, pool_size, words[6], &entry->subsystem_ident)
+         || !playlist_bin_get_string(pool, pool_size, words[7], &entry->subsystem_name))
+      return false;
+
+   entry->entry_slot = words[8];
+
+   if (words[9])
+   {
+      uint32_t i;
+      size_t ofs                             = words[10];
+      union string_list_elem_attr attributes = {0};
+
+      if (!(entry->subsystem_roms = string_list_new()))
+         return false;
+
+      for (i = 0; i < words[9]; i++)
+      {
+         if (     ofs >= pool_size
+               || !string_list_append(entry->subsystem_roms,
+                  pool + ofs, attributes))
+         {
+            string_list_free(entry->subsystem_roms);
+            entry->subsystem_roms = NULL;
+            return false;
+         }
+         ofs += strlen(pool + ofs) + 1;
+      }
+   }
+
+   return true;
+}
+
+static bool playlist_bin_read_meta(playlist_t *playlist,
+      const uint32_t *words, char *pool, size_t pool_size)
+{
+   size_t i;
+   char *strings[6];
+   char **targets[6];
+
+   targets[0] = &playlist->default_core_path;
+   targets[1] = &playlist->default_core_name;
+   targets[2] = &playlist->base_content_directory;
+   targets[3] = &playlist->scan_record.content_dir;
+   targets[4] = &playlist->scan_record.file_exts;
+   targets[5] = &playlist->scan_record.dat_file_path;
+
+   for (i = 0; i < 6; i++)
+      if (!playlist_bin_get_string(pool, pool_size, words[6 + i], &strings[i]))
+         return false;
+
+   playlist->label_display_mode   = (enum playlist_label_display_mode)words[0];
+   playlist->right_thumbnail_mode = (enum playlist_thumbnail_mode)words[1];
+   playlist->left_thumbnail_mode  = (enum playlist_thumbnail_mode)words[2];
+   playlist->thumbnail_match_mode = (enum playlist_thumbnail_match_mode)words[3];
+   playlist->sort_mode            = (enum playlist_sort_mode)words[4];
+   playlist->scan_record.search_recursively = (words[5] & 1) != 0;
+   playlist->scan_record.search_archives    = (words[5] & 2) != 0;
+   playlist->scan_record.filter_dat_content = (words[5] & 4) != 0;
+   playlist->scan_record.overwrite_playlist = (words[5] & 8) != 0;
+
+   /* Metadata strings are few, so they are copied
+    * to keep the setters free of ownership checks */
+   for (i = 0; i < 6; i++)
+   {
+      if (*targets[i])
+         free(*targets[i]);
+      *targets[i] = strings[i] ? strdup(strings[i]) : NULL;
+   }
+
+   return true;
+}
+
+/* Replays a single record on top of the current
+ * playlist state. Returns false on malformed data */
+static bool playlist_bin_apply_record(playlist_t *playlist,
+      uint32_t type, uint8_t *data, size_t size)
+{
+   size_t count, words, i, len = RBUF_LEN(playlist->entries);
+   const uint32_t *word        = (const uint32_t*)data;
+   char *pool;
+   size_t pool_size;
+
+   switch (type)
+   {
+      case PLAYLIST_BIN_RECORD_META:
+         words = PLAYLIST_BIN_META_WORDS;
+         count = 0;
+         break;
+      case PLAYLIST_BIN_RECORD_ENTRIES:
+         if (size < sizeof(uint32_t))
+            return false;
+         count = word[0];
+         if (count > (size - sizeof(uint32_t))
+               / (PLAYLIST_BIN_ENTRY_WORDS * sizeof(uint32_t)))
+            return false;
+         words = 1 + count * PLAYLIST_BIN_ENTRY_WORDS;
+         break;
+      case PLAYLIST_BIN_RECORD_INSERT:
+      case PLAYLIST_BIN_RECORD_REPLACE:
+         words = 1 + PLAYLIST_BIN_ENTRY_WORDS;
+         count = 1;
+         break;
+      case PLAYLIST_BIN_RECORD_DELETE:
+         words = 1;
+         count = 0;
+         break;
+      case PLAYLIST_BIN_RECORD_MOVE:
+         words = 2;
+         count = 0;
+         break;
+      default:
+         return false;
+   }
+
+   if (size < words * sizeof(uint32_t))
+      return false;
+
+   pool      = (char*)data + words * sizeof(uint32_t);
+   pool_size = size - words * sizeof(uint32_t);
+   if (pool_size && pool[pool_size - 1])
+      return false;
+
+   switch (type)
+   {
+      case PLAYLIST_BIN_RECORD_META:
+         return playlist_bin_read_meta(playlist, word, pool, pool_size);
+      case PLAYLIST_BIN_RECORD_ENTRIES:
+         for (i = 0; i < len; i++)
+            playlist_free_entry(playlist, &playlist->entries[i]);
+         RBUF_CLEAR(playlist->entries);
+         if (!RBUF_TRYFIT(playlist->entries, count))
+            return false;
+         for (i = 0; i < count; i++)
+         {
+            if (!playlist_bin_read_entry(
+                     word + 1 + i * PLAYLIST_BIN_ENTRY_WORDS,
+                     pool, pool_size, &playlist->entries[i]))
+               return false;
+            RBUF_RESIZE(playlist->entries, i + 1);
+         }
+         /* Journal records count from the last snapshot */
+         playlist->bin_records = 0;
+         return true;
+      case PLAYLIST_BIN_RECORD_INSERT:
+         {
+            struct playlist_entry entry;
+
+            if (     word[0] > len
+                  || !RBUF_TRYFIT(playlist->entries, len + 1)
+                  || !playlist_bin_read_entry(word + 1, pool, pool_size,
+                     &entry))
+               return false;
+
+            RBUF_RESIZE(playlist->entries, len + 1);
+            memmove(playlist->entries + word[0] + 1,
+                  playlist->entries + word[0],
+                  (len - word[0]) * sizeof(struct playlist_entry));
+            playlist->entries[word[0]] = entry;
+         }
+         break;
+      case PLAYLIST_BIN_RECORD_REPLACE:
+         if (word[0] >= len)
+            return false;
+         playlist_free_entry(playlist, &playlist->entries[word[0]]);
+         if (!playlist_bin_read_entry(word + 1, pool, pool_size,
+                  &playlist->entries[word[0]]))
+            return false;
+         break;
+      case PLAYLIST_BIN_RECORD_DELETE:
+         if (word[0] >= len)
+            return false;
+         playlist_free_entry(playlist, &playlist->entries[word[0]]);
+         memmove(playlist->entries + word[0],
+               playlist->entries + word[0] + 1,
+               (len - 1 - word[0]) * sizeof(struct playlist_entry));
+         RBUF_RESIZE(playlist->entries, len - 1);
+         break;
+      case PLAYLIST_BIN_RECORD_MOVE:
+         {
+            struct playlist_entry tmp;
+            uint32_t from = word[0];
+            uint32_t to   = word[1];
+
+            if (from >= len || to >= len)
+               return false;
+
+            tmp = playlist->entries[from];
+            if (from > to)
+               memmove(playlist->entries + to + 1, playlist->entries + to,
+                     (from - to) * sizeof(struct playlist_entry));
+            else
+               memmove(playlist->entries + from, playlist->entries + from + 1,
+                     (to - from) * sizeof(struct playlist_entry));
+            playlist->entries[to] = tmp;
+         }
+         break;
+   }
+
+   playlist->bin_records++;
+   return true;
+}
+
+/* Takes ownership of 'data'. Entry strings keep
+ * pointing into it until the playlist is freed */
+static void playlist_bin_read_file(playlist_t *playlist,
+      uint8_t *data, size_t size)
+{
+   size_t pos   = 2 * sizeof(uint32_t);
+   bool corrupt = false;
+
+   playlist->bin_data          = data;
+   playlist->bin_size          = size;
+   playlist->bin_records       = 0;
+   playlist_bin_stamp(playlist, (int64_t)size);
+
+   while (pos < size)
+   {
+      uint32_t header[2];
+
+      if (size - pos < sizeof(header))
+      {
+         corrupt = true;
+         break;
+      }
+
+      memcpy(header, data + pos, sizeof(header));
+      pos += sizeof(header);
+
+      if (     (header[1] & 3)
+            || header[1] > size - pos
+            || !playlist_bin_apply_record(playlist,
+               header[0], data + pos, header[1]))
+      {
+         corrupt = true;
+         break;
+      }
+
+      pos += header[1];
+   }
+
+   playlist->binary            = true;
+   playlist->bin_journal_valid = true;
+
+   /* Keep whatever could be restored; the next
+    * write replaces the damaged file */
+   if (corrupt)
+   {
+      RARCH_WARN("[Playlist]: Binary playlist is damaged, "
+            "recovered %u entries: \"%s\".\n",
+            (unsigned)RBUF_LEN(playlist->entries), playlist->config.path);
+      playlist_bin_journal_invalidate(playlist);
+      playlist->modified = true;
+   }
+
+   if (RBUF_LEN(playlist->entries) > playlist->config.capacity)
+   {
+      size_t i, len = RBUF_LEN(playlist->entries);
+      for (i = playlist->config.capacity; i < len; i++)
+         playlist_free_entry(playlist, &playlist->entries[i]);
+      RBUF_RESIZE(playlist->entries, playlist->config.capacity);
+      playlist_bin_journal_invalidate(playlist);
+      playlist->modified = true;
+   }
+}
+
 /**
  * playlist_delete_index:
  * @playlist            : Playlist handle.
@@ -646,7 +1480,7 @@ void playlist_delete_index(playlist_t *playlist,
    /* Free unwanted entry */
    entry_to_delete = (struct playlist_entry *)(playlist->entries + idx);
    if (entry_to_delete)
-      playlist_free_entry(entry_to_delete);
+      playlist_free_entry(playlist, entry_to_delete);
 
    /* Shift remaining entries to fill the gap */
    memmove(playlist->entries + idx, playlist->entries + idx + 1,
@@ -655,6 +1489,8 @@ void playlist_delete_index(playlist_t *playlist,
    RBUF_RESIZE(playlist->entries, len - 1);
 
    playlist->modified = true;
+   playlist_path_index_invalidate(playlist);
+   playlist_bin_journal(playlist, PLAYLIST_BIN_RECORD_DELETE, idx, 0);
 }
 
 /**
@@ -669,6 +1505,7 @@ void playlist_delete_by_path(playlist_t *playlist,
       const char *search_path)
 {
    playlist_path_id_t *path_id = NULL;
+   size_t *matches             = NULL;
    size_t i                    = 0;
 
    if (!playlist || string_is_empty(search_path))
@@ -677,22 +1514,17 @@ void playlist_delete_by_path(playlist_t *playlist,
    if (!(path_id = playlist_path_id_init(search_path)))
       return;
 
-   while (i < RBUF_LEN(playlist->entries))
-   {
-      if (!playlist_path_matches_entry(path_id,
-            &playlist->entries[i], &playlist->config))
-      {
-         i++;
-         continue;
-      }
-
-      /* Paths are equal - delete entry */
-      playlist_delete_index(playlist, i);
+   /* Collect all matches first - deleting an entry
+    * invalidates the path index */
+   for (i = 0; playlist_find_path(playlist, path_id, false, &i); i++)
+      RBUF_PUSH(matches, i);
 
-      /* Entries are shifted up by the delete
-       * operation - *do not* increment i */
-   }
+   /* Delete from the bottom up, so that the
+    * remaining indices stay valid */
+   for (i = RBUF_LEN(matches); i-- > 0;)
+      playlist_delete_index(playlist, matches[i]);
 
+   RBUF_FREE(matches);
    playlist_path_id_free(path_id);
 }
 
@@ -701,7 +1533,7 @@ void playlist_get_index_by_path(playlist_t *playlist,
       const struct playlist_entry **entry)
 {
    playlist_path_id_t *path_id = NULL;
-   size_t i, len;
+   size_t i                    = 0;
 
    if (!playlist || !entry || string_is_empty(search_path))
       return;
@@ -709,15 +1541,8 @@ void playlist_get_index_by_path(playlist_t *playlist,
    if (!(path_id = playlist_path_id_init(search_path)))
       return;
 
-   for (i = 0, len = RBUF_LEN(playlist->entries); i < len; i++)
-   {
-      if (!playlist_path_matches_entry(path_id,
-            &playlist->entries[i], &playlist->config))
-         continue;
-
+   if (playlist_find_path(playlist, path_id, false, &i))
       *entry = &playlist->entries[i];
-      break;
-   }
 
    playlist_path_id_free(path_id);
 }
@@ -726,7 +1551,8 @@ bool playlist_entry_exists(playlist_t *playlist,
       const char *path)
 {
    playlist_path_id_t *path_id = NULL;
-   size_t i, len;
+   size_t i                    = 0;
+   bool found;
 
    if (!playlist || string_is_empty(path))
       return false;
@@ -734,24 +1560,17 @@ bool playlist_entry_exists(playlist_t *playlist,
    if (!(path_id = playlist_path_id_init(path)))
       return false;
 
-   for (i = 0, len = RBUF_LEN(playlist->entries); i < len; i++)
-   {
-      if (playlist_path_matches_entry(path_id,
-            &playlist->entries[i], &playlist->config))
-      {
-         playlist_path_id_free(path_id);
-         return true;
-      }
-   }
+   found = playlist_find_path(playlist, path_id, false, &i);
 
    playlist_path_id_free(path_id);
-   return false;
+   return found;
 }
 
 void playlist_update(playlist_t *playlist, size_t idx,
       const struct playlist_entry *update_entry)
 {
    struct playlist_entry *entry = NULL;
+   bool updated                 = false;
 
    if (!playlist || idx >= RBUF_LEN(playlist->entries))
       return;
@@ -761,7 +1580,7 @@ void playlist_update(playlist_t *playlist, size_t idx,
    if (update_entry->path && (update_entry->path != entry->path))
    {
       if (entry->path)
-         free(entry->path);
+         playlist_free_string(playlist, entry->path);
       entry->path        = strdup(update_entry->path);
 
       if (entry->path_id)
@@ -769,49 +1588,56 @@ void playlist_update(playlist_t *playlist, size_t idx,
          playlist_path_id_free(entry->path_id);
          entry->path_id  = NULL;
       }
+      playlist_path_index_invalidate(playlist);
 
-      playlist->modified = true;
+      updated            = true;
    }
 
    if (update_entry->label && (update_entry->label != entry->label))
    {
       if (entry->label)
-         free(entry->label);
+         playlist_free_string(playlist, entry->label);
       entry->label       = strdup(update_entry->label);
-      playlist->modified = true;
+      updated            = true;
    }
 
    if (update_entry->core_path && (update_entry->core_path != entry->core_path))
    {
       if (entry->core_path)
-         free(entry->core_path);
+         playlist_free_string(playlist, entry->core_path);
       entry->core_path   = NULL;
       entry->core_path   = strdup(update_entry->core_path);
-      playlist->modified = true;
+      updated            = true;
    }
 
    if (update_entry->core_name && (update_entry->core_name != entry->core_name))
    {
       if (entry->core_name)
-         free(entry->core_name);
+         playlist_free_string(playlist, entry->core_name);
       entry->core_name   = strdup(update_entry->core_name);
-      playlist->modified = true;
+      updated            = true;
    }
 
    if (update_entry->db_name && (update_entry->db_name != entry->db_name))
    {
       if (entry->db_name)
-         free(entry->db_name);
+         playlist_free_string(playlist, entry->db_name);
       entry->db_name     = strdup(update_entry->db_name);
-      playlist->modified = true;
+      updated            = true;
    }
 
    if (update_entry->crc32 && (update_entry->crc32 != entry->crc32))
    {
       if (entry->crc32)
-         free(entry->crc32);
+         playlist_free_string(playlist, entry->crc32);
       entry->crc32       = strdup(update_entry->crc32);
+      updated            = true;
+   }
+
+   if (updated)
+   {
       playlist->modified = true;
+      playlist_bin_journal(playlist, PLAYLIST_BIN_RECORD_REPLACE, idx, 0);
    }
 }
 
@@ -820,6 +1646,7 @@ void playlist_update_runtime(playlist_t *playlist, size_t idx,
       bool register_update)
 {
    struct playlist_entry *entry = NULL;
+   bool paths_updated           = false;
 
    if (!playlist || idx >= RBUF_LEN(playlist->entries))
       return;
@@ -829,7 +1656,7 @@ void playlist_update_runtime(playlist_t *playlist, size_t idx,
    if (update_entry->path && (update_entry->path != entry->path))
    {
       if (entry->path)
-         free(entry->path);
+         playlist_free_string(playlist, entry->path);
       entry->path        = strdup(update_entry->path);
 
       if (entry->path_id)
@@ -837,19 +1664,26 @@ void playlist_update_runtime(playlist_t *playlist, size_t idx,
          playlist_path_id_free(entry->path_id);
          entry->path_id  = NULL;
       }
+      playlist_path_index_invalidate(playlist);
 
       playlist->modified = playlist->modified || register_update;
+      paths_updated      = true;
    }
 
    if (update_entry->core_path && (update_entry->core_path != entry->core_path))
    {
       if (entry->core_path)
-         free(entry->core_path);
+         playlist_free_string(playlist, entry->core_path);
       entry->core_path   = NULL;
       entry->core_path   = strdup(update_entry->core_path);
       playlist->modified = playlist->modified || register_update;
+      paths_updated      = true;
    }
 
+   /* Runtime values are not stored in the playlist file */
+   if (paths_updated)
+      playlist_bin_journal(playlist, PLAYLIST_BIN_RECORD_REPLACE, idx, 0);
+
    if (update_entry->runtime_status != entry->runtime_status)
    {
       entry->runtime_status = update_entry->runtime_status;
@@ -963,17 +1797,9 @@ bool playlist_push_runtime(playlist_t *playlist,
    }
 
    len = RBUF_LEN(playlist->entries);
-   for (i = 0; i < len; i++)
+   for (i = 0; playlist_find_path(playlist, path_id, true, &i); i++)
    {
       struct playlist_entry tmp;
-      bool equal_path  = (string_is_empty(path_id->real_path)
-            && string_is_empty(playlist->entries[i].path));
-
-      equal_path       = equal_path || playlist_path_matches_entry(
-            path_id, &playlist->entries[i], &playlist->config);
-
-      if (!equal_path)
-         continue;
 
       /* Core name can have changed while still being the same core.
        * Differentiate based on the core path only. */
@@ -990,6 +1816,8 @@ bool playlist_push_runtime(playlist_t *playlist,
       memmove(playlist->entries + 1, playlist->entries,
             i * sizeof(struct playlist_entry));
       playlist->entries[0] = tmp;
+      playlist_path_index_invalidate(playlist);
+      playlist_bin_journal(playlist, PLAYLIST_BIN_RECORD_MOVE, i, 0);
 
       goto success;
    }
@@ -1000,8 +1828,10 @@ bool playlist_push_runtime(playlist_t *playlist,
    if (len == playlist->config.capacity)
    {
       struct playlist_entry *last_entry = &playlist->entries[len - 1];
-      playlist_free_entry(last_entry);
+      playlist_free_entry(playlist, last_entry);
       len--;
+      playlist_path_index_invalidate(playlist);
+      playlist_bin_journal(playlist, PLAYLIST_BIN_RECORD_DELETE, len, 0);
    }
    else
    {
@@ -1045,6 +1875,11 @@ bool playlist_push_runtime(playlist_t *playlist,
          playlist->entries[0].runtime_str     = strdup(entry->runtime_str);
       if (!string_is_empty(entry->last_played_str))
          playlist->entries[0].last_played_str = strdup(entry->last_played_str);
+
+      if (     playlist->path_index_valid
+            && !playlist_path_index_add(playlist, 0))
+         playlist_path_index_invalidate(playlist);
+      playlist_bin_journal(playlist, PLAYLIST_BIN_RECORD_INSERT, 0, 0);
    }
 
 success:
@@ -1327,17 +2162,9 @@ bool playlist_push(playlist_t *playlist,
    }
 
    len = RBUF_LEN(playlist->entries);
-   for (i = 0; i < len; i++)
+   for (i = 0; playlist_find_path(playlist, path_id, true, &i); i++)
    {
       struct playlist_entry tmp;
-      bool equal_path  = (string_is_empty(path_id->real_path)
-                       && string_is_empty(playlist->entries[i].path));
-
-      equal_path       = equal_path || playlist_path_matches_entry(
-            path_id, &playlist->entries[i], &playlist->config);
-
-      if (!equal_path)
-         continue;
 
       /* Core name can have changed while still being the same core.
        * Differentiate based on the core path only. */
@@ -1432,6 +2259,9 @@ bool playlist_push(playlist_t *playlist,
          entry_updated                    = true;
       }
 
+      if (entry_updated)
+         playlist_bin_journal(playlist, PLAYLIST_BIN_RECORD_REPLACE, i, 0);
+
       /* If top entry, we don't want to push a new entry since
        * the top and the entry to be pushed are the same. */
       if (i == 0)
@@ -1447,6 +2277,8 @@ bool playlist_push(playlist_t *playlist,
       memmove(playlist->entries + 1, playlist->entries,
             i * sizeof(struct playlist_entry));
       playlist->entries[0] = tmp;
+      playlist_path_index_invalidate(playlist);
+      playlist_bin_journal(playlist, PLAYLIST_BIN_RECORD_MOVE, i, 0);
 
       goto success;
    }
@@ -1457,8 +2289,10 @@ bool playlist_push(playlist_t *playlist,
    if (len == playlist->config.capacity)
    {
       struct playlist_entry *last_entry = &playlist->entries[len - 1];
-      playlist_free_entry(last_entry);
+      playlist_free_entry(playlist, last_entry);
       len--;
+      playlist_path_index_invalidate(playlist);
+      playlist_bin_journal(playlist, PLAYLIST_BIN_RECORD_DELETE, len, 0);
    }
    else
    {
@@ -1527,6 +2361,11 @@ bool playlist_push(playlist_t *playlist,
          for (i = 0; i < entry->subsystem_roms->size; i++)
             string_list_append(playlist->entries[0].subsystem_roms, entry->subsystem_roms->elems[i].data, attributes);
       }
+
+      if (     playlist->path_index_valid
+            && !playlist_path_index_add(playlist, 0))
+         playlist_path_index_invalidate(playlist);
+      playlist_bin_journal(playlist, PLAYLIST_BIN_RECORD_INSERT, 0, 0);
    }
 
 success:
@@ -1691,6 +2530,8 @@ void playlist_write_runtime_file(playlist_t *playlist)
    playlist->modified        = false;
    playlist->old_format      = false;
    playlist->compressed      = false;
+   playlist->binary          = false;
+   playlist_bin_journal_invalidate(playlist);
 
    RARCH_LOG("[Playlist]: Written to playlist file: \"%s\".\n", playlist->config.path);
 end:
@@ -1698,6 +2539,22 @@ end:
    free(file);
 }
 
+/* Returns true if the format of the playlist file
+ * on disk does not match the requested settings.
+ * The binary format is not compressed, and is
+ * ignored when the old format is requested */
+static bool playlist_format_mismatch(playlist_t *playlist)
+{
+   if (playlist->config.binary && !playlist->config.old_format)
+      return !playlist->binary;
+
+   return playlist->binary ||
+#if defined(HAVE_ZLIB)
+        (playlist->compressed != playlist->config.compress) ||
+#endif
+        (playlist->old_format != playlist->config.old_format);
+}
+
 void playlist_write_file(playlist_t *playlist)
 {
    size_t i, len;
@@ -1707,18 +2564,27 @@ void playlist_write_file(playlist_t *playlist)
    /* Playlist will be written if any of the
     * following are true:
     * > 'modified' flag is set
-    * > Current playlist format (old/new) does not
-    *   match requested
+    * > Current playlist format (old/new/binary)
+    *   does not match requested
     * > Current playlist compression status does
     *   not match requested */
    if (!playlist ||
-       !(playlist->modified ||
-#if defined(HAVE_ZLIB)
-        (playlist->compressed != playlist->config.compress) ||
-#endif
-        (playlist->old_format != playlist->config.old_format)))
+       !(playlist->modified || playlist_format_mismatch(playlist)))
       return;
 
+   if (playlist->bin_unsupported)
+   {
+      RARCH_ERR("[Playlist]: Refusing to overwrite unreadable "
+            "binary playlist: \"%s\".\n", playlist->config.path);
+      return;
+   }
+
+   if (playlist->config.binary && !playlist->config.old_format)
+   {
+      playlist_bin_write_file(playlist);
+      return;
+   }
+
 #if defined(HAVE_ZLIB)
    if (playlist->config.compress)
       file = intfstream_open_rzip_file(playlist->config.path,
@@ -2088,6 +2954,8 @@ void playlist_write_file(playlist_t *playlist)
 
    playlist->modified   = false;
    playlist->compressed = compressed;
+   playlist->binary     = false;
+   playlist_bin_journal_invalidate(playlist);
 
    RARCH_LOG("[Playlist]: Written to playlist file: \"%s\".\n", playlist->config.path);
 end:
@@ -2139,12 +3007,17 @@ void playlist_free(playlist_t *playlist)
          struct playlist_entry *entry = &playlist->entries[i];
 
          if (entry)
-            playlist_free_entry(entry);
+            playlist_free_entry(playlist, entry);
       }
 
       RBUF_FREE(playlist->entries);
    }
 
+   RBUF_FREE(playlist->bin_journal);
+   if (playlist->bin_data)
+      free(playlist->bin_data);
+   playlist_path_index_invalidate(playlist);
+
    free(playlist);
 }
 
@@ -2165,9 +3038,11 @@ void playlist_clear(playlist_t *playlist)
       struct playlist_entry *entry = &playlist->entries[i];
 
       if (entry)
-         playlist_free_entry(entry);
+         playlist_free_entry(playlist, entry);
    }
    RBUF_CLEAR(playlist->entries);
+   playlist_path_index_invalidate(playlist);
+   playlist_bin_journal_invalidate(playlist);
 }
 
 /**
@@ -2563,20 +3438,69 @@ static void playlist_get_old_format_metadata_value(
    strlcpy(value, start, len);
 }
 
+/* Returns true if the playlist file is in
+ * binary format, loading it if so */
+static bool playlist_bin_try_read_file(playlist_t *playlist)
+{
+   uint32_t header[2];
+   void *data      = NULL;
+   int64_t size    = 0;
+   RFILE *file     = filestream_open(playlist->config.path,
+         RETRO_VFS_FILE_ACCESS_READ,
+         RETRO_VFS_FILE_ACCESS_HINT_NONE);
+
+   if (!file)
+      return false;
+
+   if (     filestream_read(file, header, sizeof(header)) != sizeof(header)
+         || header[0] != PLAYLIST_BIN_MAGIC)
+   {
+      filestream_close(file);
+      return false;
+   }
+   filestream_close(file);
+
+   /* The playlist stays empty, and must never be written
+    * back: that would replace the file (possibly from a
+    * newer version of RetroArch) with nothing */
+   if (header[1] != PLAYLIST_BIN_VERSION)
+   {
+      RARCH_ERR("[Playlist]: Unsupported binary playlist version %u, "
+            "not modifying it: \"%s\".\n",
+            (unsigned)header[1], playlist->config.path);
+      playlist->bin_unsupported = true;
+   }
+   else if (!filestream_read_file(playlist->config.path, &data, &size))
+   {
+      RARCH_ERR("[Playlist]: Failed to read binary playlist, "
+            "not modifying it: \"%s\".\n", playlist->config.path);
+      playlist->bin_unsupported = true;
+   }
+   else
+      playlist_bin_read_file(playlist, (uint8_t*)data, (size_t)size);
+
+   return true;
+}
+
 static bool playlist_read_file(playlist_t *playlist)
 {
    unsigned i;
    int test_char;
    bool res             = true;
+   intfstream_t *file   = NULL;
+
+   if (playlist_bin_try_read_file(playlist))
+      return true;
+
 #if defined(HAVE_ZLIB)
       /* Always use RZIP interface when reading playlists
        * > this will automatically handle uncompressed
        *   data */
-   intfstream_t *file   = intfstream_open_rzip_file(
+   file                 = intfstream_open_rzip_file(
          playlist->config.path,
          RETRO_VFS_FILE_ACCESS_READ);
 #else
-   intfstream_t *file   = intfstream_open_file(
+   file                 = intfstream_open_file(
          playlist->config.path,
          RETRO_VFS_FILE_ACCESS_READ,
          RETRO_VFS_FILE_ACCESS_HINT_NONE);
@@ -2873,11 +3797,7 @@ bool playlist_init_cached(const playlist_config_t *config)
    /* If playlist format/compression state
     * does not match requested settings, update
     * file on disk immediately */
-   if (
-#if defined(HAVE_ZLIB)
-       (playlist->compressed != playlist->config.compress) ||
-#endif
-       (playlist->old_format != playlist->config.old_format))
+   if (playlist_format_mismatch(playlist))
       playlist_write_file(playlist);
 
    playlist_cached      = playlist;
@@ -2903,6 +3823,20 @@ playlist_t *playlist_init(const playlist_config_t *config)
    playlist->old_format             = false;
    playlist->compressed             = false;
    playlist->cached_external        = false;
+   playlist->binary                 = false;
+   playlist->bin_journal_valid      = false;
+   playlist->bin_meta_modified      = false;
+   playlist->bin_data               = NULL;
+   playlist->bin_journal            = NULL;
+   playlist->bin_size               = 0;
+   playlist->bin_file_size          = -1;
+   playlist->bin_file_mtime         = 0;
+   playlist->bin_records            = 0;
+   playlist->bin_unsupported        = false;
+   playlist->path_index             = NULL;
+   playlist->archive_index          = NULL;
+   playlist->path_links             = NULL;
+   playlist->path_index_valid       = false;
    playlist->default_core_name      = NULL;
    playlist->default_core_path      = NULL;
    playlist->base_content_directory = NULL;
@@ -2916,6 +3850,7 @@ playlist_t *playlist_init(const playlist_config_t *config)
    playlist->scan_record.search_recursively = false;
    playlist->scan_record.search_archives    = false;
    playlist->scan_record.filter_dat_content = false;
+   playlist->scan_record.overwrite_playlist = false;
    playlist->scan_record.content_dir        = NULL;
    playlist->scan_record.file_exts          = NULL;
    playlist->scan_record.dat_file_path      = NULL;
@@ -2953,9 +3888,15 @@ playlist_t *playlist_init(const playlist_config_t *config)
                   playlist->base_content_directory, playlist->config.base_content_directory,
                   sizeof(tmp_entry_path));
 
-            free(entry->path);
+            playlist_free_string(playlist, entry->path);
             entry->path = strdup(tmp_entry_path);
 
+            if (entry->path_id)
+            {
+               playlist_path_id_free(entry->path_id);
+               entry->path_id = NULL;
+            }
+
             /* Fix subsystem roms paths*/
             if (     (entry->subsystem_roms)
                   && (entry->subsystem_roms->size > 0))
@@ -3026,6 +3967,8 @@ playlist_t *playlist_init(const playlist_config_t *config)
 
       /* Save playlist */
       playlist->modified = true;
+      playlist_path_index_invalidate(playlist);
+      playlist_bin_journal_invalidate(playlist);
       playlist_write_file(playlist);
    }
 
@@ -3126,9 +4069,25 @@ void playlist_qsort(playlist_t *playlist)
        || (playlist->sort_mode == PLAYLIST_SORT_MODE_OFF))
       return;
 
+   /* Reordering cannot be appended to a binary
+    * playlist - avoid forcing a full rewrite when
+    * the entries are already sorted */
+   if (playlist_bin_journaling(playlist))
+   {
+      size_t i, len = RBUF_LEN(playlist->entries);
+      for (i = 1; i < len; i++)
+         if (playlist_qsort_func(&playlist->entries[i - 1],
+               &playlist->entries[i]) > 0)
+            break;
+      if (i >= len)
+         return;
+      playlist_bin_journal_invalidate(playlist);
+   }
+
    qsort(playlist->entries, RBUF_LEN(playlist->entries),
          sizeof(struct playlist_entry),
          (int (*)(const void *, const void *))playlist_qsort_func);
+   playlist_path_index_invalidate(playlist);
 }
 
 void command_playlist_push_write(
@@ -3422,6 +4381,7 @@ void playlist_set_default_core_path(playlist_t *playlist,
          free(playlist->default_core_path);
       playlist->default_core_path  = strdup(real_core_path);
       playlist->modified           = true;
+      playlist->bin_meta_modified  = true;
    }
 }
 
@@ -3437,6 +4397,7 @@ void playlist_set_default_core_name(
          free(playlist->default_core_name);
       playlist->default_core_name  = strdup(core_name);
       playlist->modified           = true;
+      playlist->bin_meta_modified  = true;
    }
 }
 
@@ -3447,6 +4408,7 @@ void playlist_set_label_display_mode(playlist_t *playlist,
    {
       playlist->label_display_mode = label_display_mode;
       playlist->modified           = true;
+      playlist->bin_meta_modified  = true;
    }
 }
 
@@ -3462,10 +4424,12 @@ void playlist_set_thumbnail_mode(
       case PLAYLIST_THUMBNAIL_RIGHT:
          playlist->right_thumbnail_mode = thumbnail_mode;
          playlist->modified             = true;
+         playlist->bin_meta_modified    = true;
          break;
       case PLAYLIST_THUMBNAIL_LEFT:
          playlist->left_thumbnail_mode = thumbnail_mode;
          playlist->modified            = true;
+         playlist->bin_meta_modified   = true;
          break;
    }
 }
@@ -3475,8 +4439,9 @@ void playlist_set_sort_mode(playlist_t *playlist,
 {
    if (playlist && playlist->sort_mode != sort_mode)
    {
-      playlist->sort_mode = sort_mode;
-      playlist->modified  = true;
+      playlist->sort_mode         = sort_mode;
+      playlist->modified          = true;
+      playlist->bin_meta_modified = true;
    }
 }
 
@@ -3497,7 +4462,10 @@ void playlist_set_scan_content_dir(playlist_t *playlist, const char *content_dir
    if (    (current_string_empty && !new_string_empty)
        || (!current_string_empty &&  new_string_empty)
        || !string_is_equal(playlist->scan_record.content_dir, content_dir))
-      playlist->modified = true;
+   {
+      playlist->modified          = true;
+      playlist->bin_meta_modified = true;
+   }
    else
       return; /* Strings are identical; do nothing */
 
@@ -3528,7 +4496,10 @@ void playlist_set_scan_file_exts(playlist_t *playlist, const char *file_exts)
    if (   ( current_string_empty && !new_string_empty)
        || (!current_string_empty &&  new_string_empty)
        || !string_is_equal(playlist->scan_record.file_exts, file_exts))
-      playlist->modified = true;
+   {
+      playlist->modified          = true;
+      playlist->bin_meta_modified = true;
+   }
    else
       return; /* Strings are identical; do nothing */
 
@@ -3559,7 +4530,10 @@ void playlist_set_scan_dat_file_path(playlist_t *playlist, const char *dat_file_
    if (   ( current_string_empty && !new_string_empty)
        || (!current_string_empty &&  new_string_empty)
        || !string_is_equal(playlist->scan_record.dat_file_path, dat_file_path))
-      playlist->modified = true;
+   {
+      playlist->modified          = true;
+      playlist->bin_meta_modified = true;
+   }
    else
       return; /* Strings are identical; do nothing */
 
@@ -3579,6 +4553,7 @@ void playlist_set_scan_search_recursively(playlist_t *playlist, bool search_recu
    {
       playlist->scan_record.search_recursively = search_recursively;
       playlist->modified = true;
+      playlist->bin_meta_modified = true;
    }
 }
 
@@ -3588,6 +4563,7 @@ void playlist_set_scan_search_archives(playlist_t *playlist, bool search_archive
    {
       playlist->scan_record.search_archives = search_archives;
       playlist->modified = true;
+      playlist->bin_meta_modified = true;
    }
 }
 
@@ -3597,6 +4573,7 @@ void playlist_set_scan_filter_dat_content(playlist_t *playlist, bool filter_dat_
    {
       playlist->scan_record.filter_dat_content = filter_dat_content;
       playlist->modified = true;
+      playlist->bin_meta_modified = true;
    }
 }
 
@@ -3606,6 +4583,7 @@ void playlist_set_scan_overwrite_playlist(playlist_t *playlist, bool overwrite_p
    {
       playlist->scan_record.overwrite_playlist = overwrite_playlist;
       playlist->modified = true;
+      playlist->bin_meta_modified = true;
    }
 }
 
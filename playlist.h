@@ -148,6 +148,7 @@ typedef struct
    size_t capacity;
    bool old_format;
    bool compress;
+   bool binary;
    bool fuzzy_archive_match;
    bool autofix_paths;   
    char path[PATH_MAX_LENGTH];
@@ -482,6 +482,8 @@ static bool ffmpeg_init_video(ffmpeg_t *handle)
    video->codec->pix_fmt             = video->pix_fmt;
 
    video->codec->thread_count = params->threads;
+   /* Scale on as many threads as the encoder uses */
+   video->scaler.threads      = params->threads;
 
    if (params->video_qscale)
    {
@@ -3792,6 +3792,9 @@ bool command_event(enum event_command cmd, void *data)
          {
             bool rewind_enable        = settings->bools.rewind_enable;
             size_t rewind_buf_size    = settings->sizes.rewind_buffer_size;
+            unsigned rewind_threads   = settings->uints.rewind_threads;
+            bool rewind_compress      = settings->bools.rewind_compress;
+            bool rewind_dirty_pages   = settings->bools.rewind_dirty_pages;
             bool core_type_is_dummy   = runloop_st->current_core_type == CORE_TYPE_DUMMY;
 
             if (core_type_is_dummy)
@@ -3814,7 +3817,8 @@ bool command_event(enum event_command cmd, void *data)
 #endif
                {
                   state_manager_event_init(&runloop_st->rewind_st,
-                        (unsigned)rewind_buf_size);
+                        (unsigned)rewind_buf_size, rewind_threads,
+                        rewind_compress, rewind_dirty_pages);
                }
             }
          }
@@ -4097,6 +4101,7 @@ bool command_event(enum event_command cmd, void *data)
             playlist_config.capacity               = settings->uints.content_history_size;
             playlist_config.old_format             = settings->bools.playlist_use_old_format;
             playlist_config.compress               = settings->bools.playlist_compression;
+            playlist_config.binary                 = settings->bools.playlist_binary_format;
             playlist_config.fuzzy_archive_match    = settings->bools.playlist_fuzzy_archive_match;
             /* don't use relative paths for content, music, video, and image histories */
             playlist_config_set_base_content_directory(&playlist_config, NULL);
@@ -4490,6 +4495,7 @@ bool command_event(enum event_command cmd, void *data)
                   playlist_config.capacity            = COLLECTION_SIZE;
                   playlist_config.old_format          = settings->bools.playlist_use_old_format;
                   playlist_config.compress            = settings->bools.playlist_compression;
+                  playlist_config.binary              = settings->bools.playlist_binary_format;
                   playlist_config.fuzzy_archive_match = settings->bools.playlist_fuzzy_archive_match;
                   playlist_config_set_base_content_directory(&playlist_config,
                         settings->bools.playlist_portable_paths
@@ -8420,6 +8426,7 @@ void retroarch_favorites_init(void)
    playlist_config.capacity            = COLLECTION_SIZE;
    playlist_config.old_format          = settings ? settings->bools.playlist_use_old_format : false;
    playlist_config.compress            = settings ? settings->bools.playlist_compression : false;
+   playlist_config.binary              = settings ? settings->bools.playlist_binary_format : false;
    playlist_config.fuzzy_archive_match = settings ? settings->bools.playlist_fuzzy_archive_match : false;
    playlist_config_set_base_content_directory(&playlist_config, NULL);
 
@@ -26,30 +26,33 @@
 #include <string/stdstring.h>
 #include <streams/file_stream.h>
 #include <time/rtime.h>
+#ifdef HAVE_THREADS
+#include <rthreads/rthreads.h>
+#endif
 
 #include "content.h"
 #include "core.h"
+#include "core_option_manager.h"
 #include "dynamic.h"
 #include "driver.h"
 #include "audio/audio_driver.h"
 #include "gfx/video_driver.h"
 #include "paths.h"
+#include "performance_counters.h"
 #include "runloop.h"
 #include "verbosity.h"
 
-static int16_t input_state_get_last(unsigned port,
-      unsigned device, unsigned index, unsigned id)
+static int16_t runahead_input_list_get(const my_list *list,
+      unsigned port, unsigned device, unsigned index, unsigned id)
 {
-   runloop_state_t      *runloop_st = runloop_state_get_ptr();
-
-   if (runloop_st->input_state_list)
+   if (list)
    {
       int i;
       /* find list item */
-      for (i = 0; i < runloop_st->input_state_list->size; i++)
+      for (i = 0; i < list->size; i++)
       {
          input_list_element *element =
-            (input_list_element*)runloop_st->input_state_list->data[i];
+            (input_list_element*)list->data[i];
 
          if (     (element->port   == port)
                && (element->device == device)
@@ -65,6 +68,14 @@ static int16_t input_state_get_last(unsigned port,
    return 0;
 }
 
+static int16_t input_state_get_last(unsigned port,
+      unsigned device, unsigned index, unsigned id)
+{
+   runloop_state_t      *runloop_st = runloop_state_get_ptr();
+   return runahead_input_list_get(runloop_st->input_state_list,
+         port, device, index, id);
+}
+
 static void free_retro_ctx_load_content_info(struct
       retro_ctx_load_content_info *dest)
 {
@@ -139,6 +150,67 @@ void runahead_set_load_content_info(void *data,
 
 /* RUNAHEAD - SECONDARY CORE  */
 #if defined(HAVE_DYNAMIC) || defined(HAVE_DYLIB)
+#if defined(HAVE_DYNAMIC) && defined(HAVE_THREADS)
+/* Speculative run-ahead instance - another copy of the core
+ * that runs the lookahead on its own thread, assuming a
+ * different input than the secondary instance does. */
+typedef struct runahead_speculation
+{
+   struct retro_core_t core;                  /* uint64_t alignment */
+   const retro_ctx_serialize_info_t *state;   /* real frame to start from */
+   const my_list *input;                      /* input it assumes */
+   void *frame;                               /* last frame it output */
+   char *library_path;
+   dylib_t lib_handle;
+   sthread_t *thread;
+   slock_t *lock;
+   scond_t *cond;
+   size_t frame_size;
+   size_t pitch;
+   unsigned width;
+   unsigned height;
+   unsigned frames;
+   unsigned frame_number;
+   bool busy;
+   bool quit;
+   bool dispatched;
+   bool has_frame;
+   bool variable_update;
+} runahead_speculation_t;
+
+/* Core option value as of the last dispatch */
+typedef struct runahead_speculation_option
+{
+   char *key;
+   char *value;
+} runahead_speculation_option_t;
+
+struct runahead_speculation_state
+{
+   runahead_speculation_t instances[RUNAHEAD_MAX_SPECULATIONS];
+   /* Last distinct input, and the ones before it (newest first) */
+   my_list *current;
+   my_list *history[RUNAHEAD_MAX_SPECULATIONS - 1];
+   /* Copy of the core options for the worker threads, which
+    * must not read runloop_st->core_options while the main
+    * thread may be changing them */
+   runahead_speculation_option_t *options;
+   size_t options_size;
+   unsigned count;
+   /* Last dispatched round has not been used yet */
+   bool waiting;
+};
+
+static void runahead_speculation_init(runloop_state_t *runloop_st,
+      settings_t *settings);
+static void runahead_speculation_destroy(runloop_state_t *runloop_st);
+static void runahead_speculation_wait(runahead_speculation_t *spec);
+static void runahead_speculation_wait_all(runloop_state_t *runloop_st);
+static void runahead_speculation_invalidate(runloop_state_t *runloop_st);
+static bool runahead_speculation_environment(runloop_state_t *runloop_st,
+      unsigned cmd, void *data, bool *result);
+#endif
+
 static void strcat_alloc(char **dst, const char *s)
 {
    size_t len1;
@@ -180,6 +252,9 @@ static void strcat_alloc(char **dst, const char *s)
 void runahead_secondary_core_destroy(void *data)
 {
    runloop_state_t *runloop_st      = (runloop_state_t*)data;
+#if defined(HAVE_DYNAMIC) && defined(HAVE_THREADS)
+   runahead_speculation_destroy(runloop_st);
+#endif
    if (!runloop_st->secondary_lib_handle)
       return;
 
@@ -393,7 +468,15 @@ static bool runloop_environment_secondary_core_hook(
       unsigned cmd, void *data)
 {
    runloop_state_t *runloop_st    = runloop_state_get_ptr();
-   bool result                    = runloop_environment_cb(cmd, data);
+   bool result;
+
+#if defined(HAVE_DYNAMIC) && defined(HAVE_THREADS)
+   /* Speculative instances running on a worker thread */
+   if (runahead_speculation_environment(runloop_st, cmd, data, &result))
+      return result;
+#endif
+
+   result                         = runloop_environment_cb(cmd, data);
 
    if (runloop_st->flags & RUNLOOP_FLAG_HAS_VARIABLE_UPDATE)
    {
@@ -418,48 +501,44 @@ void runahead_clear_controller_port_map(void *data)
       runloop_st->port_map[port] = -1;
 }
 
-static bool secondary_core_create(runloop_state_t *runloop_st,
-      settings_t *settings)
+/* Loads another copy of the current core and content,
+ * for use as a secondary instance */
+static bool runahead_core_copy_load(runloop_state_t *runloop_st,
+      settings_t *settings, struct retro_core_t *core,
+      dylib_t *lib_handle, char **library_path)
 {
-   const enum rarch_core_type
-      last_core_type             = runloop_st->last_core_type;
    rarch_system_info_t *sys_info = &runloop_st->system;
    unsigned num_active_users     = settings->uints.input_max_users;
    uint8_t flags                 = content_get_flags();
 
-   if (     (last_core_type != CORE_TYPE_PLAIN)
-         || (!runloop_st->load_content_info)
-         || ( runloop_st->load_content_info->special))
-      return false;
-
-   if (runloop_st->secondary_library_path)
-      free(runloop_st->secondary_library_path);
-   runloop_st->secondary_library_path = NULL;
-   runloop_st->secondary_library_path = copy_core_to_temp_file(
+   if (*library_path)
+      free(*library_path);
+   *library_path = NULL;
+   *library_path = copy_core_to_temp_file(
 		   path_get(RARCH_PATH_CORE),
 		   settings->paths.directory_libretro);
 
-   if (!runloop_st->secondary_library_path)
+   if (!*library_path)
       return false;
 
    /* Load Core */
    if (!runloop_init_libretro_symbols(runloop_st,
-            CORE_TYPE_PLAIN, &runloop_st->secondary_core,
-            runloop_st->secondary_library_path,
-            &runloop_st->secondary_lib_handle))
+            CORE_TYPE_PLAIN, core,
+            *library_path,
+            lib_handle))
       return false;
 
-   runloop_st->secondary_core.flags |= RETRO_CORE_FLAG_SYMBOLS_INITED;
-   runloop_st->secondary_core.retro_set_environment(
+   core->flags |= RETRO_CORE_FLAG_SYMBOLS_INITED;
+   core->retro_set_environment(
          runloop_environment_secondary_core_hook);
    runloop_st->flags                |= RUNLOOP_FLAG_HAS_VARIABLE_UPDATE;
 
-   runloop_st->secondary_core.retro_init();
+   core->retro_init();
 
    if (flags & CONTENT_ST_FLAG_IS_INITED)
-      runloop_st->secondary_core.flags |=  RETRO_CORE_FLAG_INITED;
+      core->flags |=  RETRO_CORE_FLAG_INITED;
    else
-      runloop_st->secondary_core.flags &= ~RETRO_CORE_FLAG_INITED;
+      core->flags &= ~RETRO_CORE_FLAG_INITED;
 
    /* Load Content */
    /* disabled due to crashes */
@@ -470,40 +549,28 @@ static bool secondary_core_create(runloop_state_t *runloop_st,
    if ( (   runloop_st->load_content_info->content->size > 0)
          && runloop_st->load_content_info->content->elems[0].data)
    {
-      if (!runloop_st->secondary_core.retro_load_game(
+      if (!core->retro_load_game(
                runloop_st->load_content_info->info))
       {
-         runloop_st->secondary_core.flags &= ~RETRO_CORE_FLAG_GAME_LOADED;
-         goto error;
+         core->flags &= ~RETRO_CORE_FLAG_GAME_LOADED;
+         return false;
       }
-      runloop_st->secondary_core.flags    |=  RETRO_CORE_FLAG_GAME_LOADED;
+      core->flags    |=  RETRO_CORE_FLAG_GAME_LOADED;
    }
    else if (flags & CONTENT_ST_FLAG_CORE_DOES_NOT_NEED_CONTENT)
    {
-      if (!runloop_st->secondary_core.retro_load_game(NULL))
+      if (!core->retro_load_game(NULL))
       {
-         runloop_st->secondary_core.flags &= ~RETRO_CORE_FLAG_GAME_LOADED;
-         goto error;
+         core->flags &= ~RETRO_CORE_FLAG_GAME_LOADED;
+         return false;
       }
-      runloop_st->secondary_core.flags    |=  RETRO_CORE_FLAG_GAME_LOADED;
+      core->flags    |=  RETRO_CORE_FLAG_GAME_LOADED;
    }
    else
-      runloop_st->secondary_core.flags    &= ~RETRO_CORE_FLAG_GAME_LOADED;
+      core->flags    &= ~RETRO_CORE_FLAG_GAME_LOADED;
 
-   if (!(runloop_st->secondary_core.flags & RETRO_CORE_FLAG_INITED))
-      goto error;
-
-   core_set_default_callbacks(&runloop_st->secondary_callbacks);
-   runloop_st->secondary_core.retro_set_video_refresh(
-         runloop_st->secondary_callbacks.frame_cb);
-   runloop_st->secondary_core.retro_set_audio_sample(
-         runloop_st->secondary_callbacks.sample_cb);
-   runloop_st->secondary_core.retro_set_audio_sample_batch(
-         runloop_st->secondary_callbacks.sample_batch_cb);
-   runloop_st->secondary_core.retro_set_input_state(
-         runloop_st->secondary_callbacks.state_cb);
-   runloop_st->secondary_core.retro_set_input_poll(
-         runloop_st->secondary_callbacks.poll_cb);
+   if (!(core->flags & RETRO_CORE_FLAG_INITED))
+      return false;
 
    if (sys_info)
    {
@@ -515,12 +582,49 @@ static bool secondary_core_create(runloop_state_t *runloop_st,
             unsigned device = (port < (ssize_t)num_active_users)
                   ? runloop_st->port_map[port]
                   : RETRO_DEVICE_NONE;
-            runloop_st->secondary_core.retro_set_controller_port_device(
+            core->retro_set_controller_port_device(
                   (unsigned)port, device);
          }
       }
    }
 
+   return true;
+}
+
+static bool secondary_core_create(runloop_state_t *runloop_st,
+      settings_t *settings)
+{
+   const enum rarch_core_type
+      last_core_type             = runloop_st->last_core_type;
+
+   if (     (last_core_type != CORE_TYPE_PLAIN)
+         || (!runloop_st->load_content_info)
+         || ( runloop_st->load_content_info->special))
+      return false;
+
+   if (!runahead_core_copy_load(runloop_st, settings,
+            &runloop_st->secondary_core,
+            &runloop_st->secondary_lib_handle,
+            &runloop_st->secondary_library_path))
+      goto error;
+
+   core_set_default_callbacks(&runloop_st->secondary_callbacks);
+   runloop_st->secondary_core.retro_set_video_refresh(
+         runloop_st->secondary_callbacks.frame_cb);
+   runloop_st->secondary_core.retro_set_audio_sample(
+         runloop_st->secondary_callbacks.sample_cb);
+   runloop_st->secondary_core.retro_set_audio_sample_batch(
+         runloop_st->secondary_callbacks.sample_batch_cb);
+   runloop_st->secondary_core.retro_set_input_state(
+         runloop_st->secondary_callbacks.state_cb);
+   runloop_st->secondary_core.retro_set_input_poll(
+         runloop_st->secondary_callbacks.poll_cb);
+
+#if defined(HAVE_DYNAMIC) && defined(HAVE_THREADS)
+   /* Uses the same controller port map, must come first */
+   runahead_speculation_init(runloop_st, settings);
+#endif
+
 #if defined(HAVE_DYNAMIC) || defined(HAVE_DYLIB)
    runahead_clear_controller_port_map(runloop_st);
 #endif
@@ -608,6 +712,23 @@ void runahead_remember_controller_port_device(void *data,
    if (     runloop_st->secondary_lib_handle
          && runloop_st->secondary_core.retro_set_controller_port_device)
       runloop_st->secondary_core.retro_set_controller_port_device((unsigned)port, (unsigned)device);
+#if defined(HAVE_DYNAMIC) && defined(HAVE_THREADS)
+   if (runloop_st->speculation)
+   {
+      unsigned i;
+      struct runahead_speculation_state *spec_st = runloop_st->speculation;
+
+      for (i = 0; i < spec_st->count; i++)
+      {
+         runahead_speculation_t *spec = &spec_st->instances[i];
+         runahead_speculation_wait(spec);
+         spec->dispatched = false;
+         if (spec->core.retro_set_controller_port_device)
+            spec->core.retro_set_controller_port_device(
+                  (unsigned)port, (unsigned)device);
+      }
+   }
+#endif
 }
 
 #else
@@ -726,6 +847,8 @@ static void *input_list_element_constructor(void)
    element->index              = 0;
    element->state              = (int16_t*)calloc(NAME_MAX_LENGTH,
          sizeof(int16_t));
+   element->requested          = (uint8_t*)calloc(NAME_MAX_LENGTH,
+         sizeof(uint8_t));
    element->state_size         = NAME_MAX_LENGTH;
 
    return ptr;
@@ -739,8 +862,12 @@ static void input_list_element_realloc(
    {
       element->state = (int16_t*)realloc(element->state,
             new_size * sizeof(int16_t));
+      element->requested = (uint8_t*)realloc(element->requested,
+            new_size * sizeof(uint8_t));
       memset(&element->state[element->state_size], 0,
             (new_size - element->state_size) * sizeof(int16_t));
+      memset(&element->requested[element->state_size], 0,
+            (new_size - element->state_size) * sizeof(uint8_t));
       element->state_size = new_size;
    }
 }
@@ -763,6 +890,7 @@ static void input_list_element_destructor(void* element_ptr)
       return;
 
    free(element->state);
+   free(element->requested);
    free(element_ptr);
 }
 
@@ -790,7 +918,8 @@ static void runahead_input_state_set_last(
       {
          if (id >= element->state_size)
             input_list_element_expand(element, id);
-         element->state[id] = value;
+         element->state[id]     = value;
+         element->requested[id] = 1;
          return;
       }
    }
@@ -806,7 +935,8 @@ static void runahead_input_state_set_last(
       element->index        = index;
       if (id >= element->state_size)
          input_list_element_expand(element, id);
-      element->state[id]    = value;
+      element->state[id]     = value;
+      element->requested[id] = 1;
    }
 }
 
@@ -834,16 +964,24 @@ static int16_t runahead_input_state_with_logging(unsigned port,
 
 static void runahead_reset_hook(void)
 {
-   runloop_state_t *runloop_st = runloop_state_get_ptr();
-   runloop_st->flags          |= RUNLOOP_FLAG_INPUT_IS_DIRTY;
+   runloop_state_t *runloop_st          = runloop_state_get_ptr();
+   runloop_st->flags                   |= RUNLOOP_FLAG_INPUT_IS_DIRTY;
+   runloop_st->runahead_timeline_frames = 0;
+#if defined(HAVE_DYNAMIC) && defined(HAVE_THREADS)
+   runahead_speculation_invalidate(runloop_st);
+#endif
    if (runloop_st->retro_reset_callback_original)
       runloop_st->retro_reset_callback_original();
 }
 
 static bool runahead_unserialize_hook(const void *buf, size_t size)
 {
-   runloop_state_t *runloop_st = runloop_state_get_ptr();
-   runloop_st->flags          |= RUNLOOP_FLAG_INPUT_IS_DIRTY;
+   runloop_state_t *runloop_st          = runloop_state_get_ptr();
+   runloop_st->flags                   |= RUNLOOP_FLAG_INPUT_IS_DIRTY;
+   runloop_st->runahead_timeline_frames = 0;
+#if defined(HAVE_DYNAMIC) && defined(HAVE_THREADS)
+   runahead_speculation_invalidate(runloop_st);
+#endif
    if (runloop_st->retro_unserialize_callback_original)
       return runloop_st->retro_unserialize_callback_original(buf, size);
    return false;
@@ -967,6 +1105,10 @@ static void runahead_remove_hooks(runloop_state_t *runloop_st)
 
 static void runahead_destroy(runloop_state_t *runloop_st)
 {
+#if defined(HAVE_DYNAMIC) && defined(HAVE_THREADS)
+   /* Instances may still be reading the last save state */
+   runahead_speculation_wait_all(runloop_st);
+#endif
    mylist_destroy(&runloop_st->runahead_save_state_list);
    runahead_remove_hooks(runloop_st);
    runahead_clear_variables(runloop_st);
@@ -1012,139 +1154,992 @@ static void runahead_add_hooks(runloop_state_t *runloop_st)
    runahead_add_input_state_hook(runloop_st);
 }
 
-/* Runahead Code */
+/* Speculative run-ahead */
+#if defined(HAVE_DYNAMIC) && defined(HAVE_THREADS)
+static void runahead_input_list_copy(my_list **dst_p, const my_list *src)
+{
+   int i;
 
-static void runahead_error(runloop_state_t *runloop_st)
+   mylist_create(dst_p, src ? src->size : 0,
+         input_list_element_constructor,
+         input_list_element_destructor);
+
+   if (!src || !*dst_p)
+      return;
+
+   for (i = 0; i < src->size; i++)
+   {
+      const input_list_element *element =
+         (const input_list_element*)src->data[i];
+      input_list_element *copy          =
+         (input_list_element*)mylist_add_element(*dst_p);
+
+      copy->port   = element->port;
+      copy->device = element->device;
+      copy->index  = element->index;
+      input_list_element_realloc(copy, element->state_size);
+      memcpy(copy->state, element->state,
+            element->state_size * sizeof(int16_t));
+      memcpy(copy->requested, element->requested,
+            element->state_size * sizeof(uint8_t));
+   }
+}
+
+/* Whether everything the core asked for in @list has the
+ * value @assumed gives it. Anything @assumed lacks is
+ * taken as released. */
+static bool runahead_input_list_matches(const my_list *list,
+      const my_list *assumed)
 {
-   runloop_st->flags &= ~RUNLOOP_FLAG_RUNAHEAD_AVAILABLE;
-   mylist_destroy(&runloop_st->runahead_save_state_list);
-   runahead_remove_hooks(runloop_st);
-   runloop_st->runahead_save_state_size       = 0;
-   runloop_st->flags                         |= RUNLOOP_FLAG_RUNAHEAD_SAVE_STATE_SIZE_KNOWN;
+   int i;
+
+   if (!list)
+      return true;
+
+   for (i = 0; i < list->size; i++)
+   {
+      unsigned id;
+      const input_list_element *element =
+         (const input_list_element*)list->data[i];
+
+      for (id = 0; id < element->state_size; id++)
+      {
+         if (     element->requested[id]
+               && element->state[id] != runahead_input_list_get(assumed,
+                  element->port, element->device, element->index, id))
+            return false;
+      }
+   }
+
+   return true;
 }
 
-static bool runahead_create(runloop_state_t *runloop_st)
+static runahead_speculation_t *runahead_speculation_current(
+      runloop_state_t *runloop_st)
 {
-   /* get savestate size and allocate buffer */
-   video_driver_state_t *video_st = video_state_get_ptr();
-   size_t info_size               = core_serialize_size_special();
+   unsigned i;
+   struct runahead_speculation_state *spec_st = runloop_st->speculation;
 
-   runahead_save_state_list_init(runloop_st, info_size);
-   if (video_st->flags & VIDEO_FLAG_ACTIVE)
-      video_st->flags |=  VIDEO_FLAG_RUNAHEAD_IS_ACTIVE;
-   else
-      video_st->flags &= ~VIDEO_FLAG_RUNAHEAD_IS_ACTIVE;
+   if (!spec_st)
+      return NULL;
 
-   if (      (runloop_st->runahead_save_state_size == 0)
-         || !(runloop_st->flags & RUNLOOP_FLAG_RUNAHEAD_SAVE_STATE_SIZE_KNOWN))
+   for (i = 0; i < spec_st->count; i++)
    {
-      runahead_error(runloop_st);
+      runahead_speculation_t *spec = &spec_st->instances[i];
+      if (spec->thread && sthread_isself(spec->thread))
+         return spec;
+   }
+
+   return NULL;
+}
+
+static bool runahead_speculation_environment(runloop_state_t *runloop_st,
+      unsigned cmd, void *data, bool *result)
+{
+   runahead_speculation_t *spec = runahead_speculation_current(runloop_st);
+
+   if (!spec)
       return false;
+
+   *result = true;
+
+   switch (cmd)
+   {
+      case RETRO_ENVIRONMENT_GET_SAVESTATE_CONTEXT:
+         if (data)
+            *(int*)data = RETRO_SAVESTATE_CONTEXT_RUNAHEAD_SAME_BINARY;
+         break;
+      case RETRO_ENVIRONMENT_GET_AUDIO_VIDEO_ENABLE:
+         if (data)
+         {
+            /* Only the last frame can ever be shown */
+            enum retro_av_enable_flags av = RETRO_AV_ENABLE_HARD_DISABLE_AUDIO;
+            if (spec->frame_number == spec->frames)
+               av = (enum retro_av_enable_flags)(av | RETRO_AV_ENABLE_VIDEO);
+            *(enum retro_av_enable_flags*)data = av;
+         }
+         break;
+      case RETRO_ENVIRONMENT_GET_VARIABLE_UPDATE:
+         if (data)
+            *(bool*)data = spec->variable_update;
+         spec->variable_update = false;
+         break;
+      case RETRO_ENVIRONMENT_GET_VARIABLE:
+         {
+            size_t i;
+            struct retro_variable *var = (struct retro_variable*)data;
+            struct runahead_speculation_state
+               *spec_st                = runloop_st->speculation;
+
+            if (!var)
+               break;
+
+            /* Values point into the snapshot, which is only
+             * replaced once all instances are idle again */
+            var->value = NULL;
+            for (i = 0; i < spec_st->options_size; i++)
+            {
+               if (string_is_equal(var->key, spec_st->options[i].key))
+               {
+                  var->value = spec_st->options[i].value;
+                  break;
+               }
+            }
+         }
+         break;
+      default:
+         /* Everything else touches frontend state
+          * that is owned by the main thread */
+         *result = false;
+         break;
    }
 
-   runahead_add_hooks(runloop_st);
-   runloop_st->flags |= RUNLOOP_FLAG_RUNAHEAD_FORCE_INPUT_DIRTY;
-   if (runloop_st->runahead_save_state_list)
-      mylist_resize(runloop_st->runahead_save_state_list, 1, true);
    return true;
 }
 
-static bool runahead_save_state(runloop_state_t *runloop_st)
+static void runahead_speculation_frame(const void *data,
+      unsigned width, unsigned height, size_t pitch)
 {
-   retro_ctx_serialize_info_t *serialize_info;
+   size_t size;
+   runahead_speculation_t *spec =
+      runahead_speculation_current(runloop_state_get_ptr());
 
-   if (!runloop_st->runahead_save_state_list)
-      return false;
+   /* NULL is a dupe, keep the last frame */
+   if (!spec || !data)
+      return;
 
-   serialize_info                  =
-      (retro_ctx_serialize_info_t*)runloop_st->runahead_save_state_list->data[0];
+   if (data == RETRO_HW_FRAME_BUFFER_VALID)
+   {
+      spec->has_frame = false;
+      return;
+   }
 
-   if (core_serialize_special(serialize_info))
-      return true;
+   size = height * pitch;
+   if (size > spec->frame_size)
+   {
+      void *frame = realloc(spec->frame, size);
+      if (!frame)
+      {
+         spec->has_frame = false;
+         return;
+      }
+      spec->frame      = frame;
+      spec->frame_size = size;
+   }
 
-   runahead_error(runloop_st);
-   return false;
+   memcpy(spec->frame, data, size);
+   spec->width     = width;
+   spec->height    = height;
+   spec->pitch     = pitch;
+   spec->has_frame = true;
 }
 
-static bool runahead_load_state(runloop_state_t *runloop_st)
+static void runahead_speculation_audio_sample(int16_t left, int16_t right) { }
+
+static size_t runahead_speculation_audio_sample_batch(
+      const int16_t *data, size_t frames)
 {
-   retro_ctx_serialize_info_t *serialize_info =
-      (retro_ctx_serialize_info_t*)
-      runloop_st->runahead_save_state_list->data[0];
-   bool last_dirty                            = (runloop_st->flags & RUNLOOP_FLAG_INPUT_IS_DIRTY) ? true : false;
-   bool ret                                   = core_unserialize_special(serialize_info);
-   if (last_dirty)
-      runloop_st->flags                      |=  RUNLOOP_FLAG_INPUT_IS_DIRTY;
-   else
-      runloop_st->flags                      &= ~RUNLOOP_FLAG_INPUT_IS_DIRTY;
+   return frames;
+}
 
-   if (!ret)
-      runahead_error(runloop_st);
+static int16_t runahead_speculation_input_state(unsigned port,
+      unsigned device, unsigned index, unsigned id)
+{
+   runahead_speculation_t *spec =
+      runahead_speculation_current(runloop_state_get_ptr());
 
-   return ret;
+   if (!spec)
+      return 0;
+   return runahead_input_list_get(spec->input, port, device, index, id);
 }
 
-#if HAVE_DYNAMIC
-static bool runahead_load_state_secondary(runloop_state_t *runloop_st, settings_t *settings)
+static void runahead_speculation_set_callbacks(struct retro_core_t *core)
 {
-   retro_ctx_serialize_info_t *serialize_info =
-      (retro_ctx_serialize_info_t*)runloop_st->runahead_save_state_list->data[0];
+   core->retro_set_video_refresh(runahead_speculation_frame);
+   core->retro_set_audio_sample(runahead_speculation_audio_sample);
+   core->retro_set_audio_sample_batch(
+         runahead_speculation_audio_sample_batch);
+   core->retro_set_input_state(runahead_speculation_input_state);
+   core->retro_set_input_poll(secondary_core_input_poll_null);
+}
 
-   if (!secondary_core_deserialize(runloop_st,
-            settings, serialize_info->data_const,
-            serialize_info->size))
+static void runahead_speculation_thread(void *data)
+{
+   runahead_speculation_t *spec = (runahead_speculation_t*)data;
+
+   slock_lock(spec->lock);
+
+   for (;;)
    {
-      runloop_st->flags &= ~RUNLOOP_FLAG_RUNAHEAD_SECONDARY_CORE_AVAILABLE;
-      runahead_error(runloop_st);
+      while (!spec->busy && !spec->quit)
+         scond_wait(spec->cond, spec->lock);
 
-      return false;
+      if (spec->quit)
+         break;
+
+      slock_unlock(spec->lock);
+
+      /* Real frame, then the lookahead, all with
+       * the input this instance assumes */
+      spec->has_frame    = false;
+      spec->frame_number = 0;
+      if (spec->core.retro_unserialize(
+               spec->state->data_const, spec->state->size))
+      {
+         for (; spec->frame_number <= spec->frames; spec->frame_number++)
+            spec->core.retro_run();
+      }
+
+      slock_lock(spec->lock);
+      spec->busy = false;
+      scond_signal(spec->cond);
    }
 
-   return true;
+   slock_unlock(spec->lock);
 }
-#endif
 
-static void runahead_core_run_use_last_input(runloop_state_t *runloop_st)
+static void runahead_speculation_wait(runahead_speculation_t *spec)
 {
-   struct retro_callbacks *cbs            = &runloop_st->retro_ctx;
-   retro_input_poll_t old_poll_function   = cbs->poll_cb;
-   retro_input_state_t old_input_function = cbs->state_cb;
-
-   cbs->poll_cb                           = retro_input_poll_null;
-   cbs->state_cb                          = input_state_get_last;
+   if (!spec->thread)
+      return;
 
-   runloop_st->current_core.retro_set_input_poll(cbs->poll_cb);
-   runloop_st->current_core.retro_set_input_state(cbs->state_cb);
+   slock_lock(spec->lock);
+   while (spec->busy)
+      scond_wait(spec->cond, spec->lock);
+   slock_unlock(spec->lock);
+}
 
-   runloop_st->current_core.retro_run();
+static void runahead_speculation_wait_all(runloop_state_t *runloop_st)
+{
+   unsigned i;
+   struct runahead_speculation_state *spec_st = runloop_st->speculation;
 
-   cbs->poll_cb                           = old_poll_function;
-   cbs->state_cb                          = old_input_function;
+   if (!spec_st)
+      return;
 
-   runloop_st->current_core.retro_set_input_poll(cbs->poll_cb);
-   runloop_st->current_core.retro_set_input_state(cbs->state_cb);
+   for (i = 0; i < spec_st->count; i++)
+      runahead_speculation_wait(&spec_st->instances[i]);
 }
 
-void runahead_run(void *data,
-      int runahead_count,
-      bool runahead_hide_warnings,
-      bool use_secondary)
+/* Results no longer follow from the main core's state */
+static void runahead_speculation_invalidate(runloop_state_t *runloop_st)
 {
-   runloop_state_t *runloop_st = (runloop_state_t*)data;
-   int frame_number        = 0;
-   bool last_frame         = false;
-   bool suspended_frame    = false;
-#if defined(HAVE_DYNAMIC) || defined(HAVE_DYLIB)
-   const bool have_dynamic = true;
-   settings_t *settings    = config_get_ptr();
-#else
-   const bool have_dynamic = false;
-#endif
-   video_driver_state_t
-      *video_st            = video_state_get_ptr();
-   uint64_t frame_count    = video_st->frame_count;
-   audio_driver_state_t
-      *audio_st            = audio_state_get_ptr();
+   unsigned i;
+   struct runahead_speculation_state *spec_st = runloop_st->speculation;
+
+   if (!spec_st)
+      return;
+
+   for (i = 0; i < spec_st->count; i++)
+      spec_st->instances[i].dispatched = false;
+}
+
+static void runahead_speculation_options_free(
+      struct runahead_speculation_state *spec_st)
+{
+   size_t i;
+
+   for (i = 0; i < spec_st->options_size; i++)
+   {
+      free(spec_st->options[i].key);
+      free(spec_st->options[i].value);
+   }
+
+   free(spec_st->options);
+   spec_st->options      = NULL;
+   spec_st->options_size = 0;
+}
+
+static void runahead_speculation_free(runahead_speculation_t *spec)
+{
+   if (spec->thread)
+   {
+      slock_lock(spec->lock);
+      spec->quit = true;
+      scond_signal(spec->cond);
+      slock_unlock(spec->lock);
+      sthread_join(spec->thread);
+      spec->thread = NULL;
+   }
+
+   if (spec->cond)
+      scond_free(spec->cond);
+   if (spec->lock)
+      slock_free(spec->lock);
+
+   if (spec->lib_handle)
+   {
+      if (spec->core.retro_unload_game)
+         spec->core.retro_unload_game();
+      if (spec->core.retro_deinit)
+         spec->core.retro_deinit();
+      dylib_close(spec->lib_handle);
+   }
+
+   if (spec->library_path)
+   {
+      filestream_delete(spec->library_path);
+      free(spec->library_path);
+   }
+
+   free(spec->frame);
+   memset(spec, 0, sizeof(*spec));
+}
+
+static void runahead_speculation_destroy(runloop_state_t *runloop_st)
+{
+   unsigned i;
+   struct runahead_speculation_state *spec_st = runloop_st->speculation;
+
+   if (!spec_st)
+      return;
+
+   for (i = 0; i < spec_st->count; i++)
+      runahead_speculation_free(&spec_st->instances[i]);
+
+   mylist_destroy(&spec_st->current);
+   for (i = 0; i < RUNAHEAD_MAX_SPECULATIONS - 1; i++)
+      mylist_destroy(&spec_st->history[i]);
+   runahead_speculation_options_free(spec_st);
+
+   free(spec_st);
+   runloop_st->speculation = NULL;
+}
+
+static void runahead_speculation_init(runloop_state_t *runloop_st,
+      settings_t *settings)
+{
+   unsigned i;
+   struct runahead_speculation_state *spec_st = NULL;
+   video_driver_state_t *video_st             = video_state_get_ptr();
+   unsigned count                             =
+      settings->uints.run_ahead_speculations;
+
+   runahead_speculation_destroy(runloop_st);
+
+   if (count > RUNAHEAD_MAX_SPECULATIONS)
+      count = RUNAHEAD_MAX_SPECULATIONS;
+
+   /* Hardware rendered frames can't be captured
+    * from another thread */
+   if (     !count
+         || (video_st->hw_render.context_type != RETRO_HW_CONTEXT_NONE))
+      return;
+
+   if (!(spec_st = (struct runahead_speculation_state*)
+            calloc(1, sizeof(*spec_st))))
+      return;
+
+   runloop_st->speculation = spec_st;
+
+   for (i = 0; i < count; i++)
+   {
+      runahead_speculation_t *spec = &spec_st->instances[i];
+
+      spec_st->count = i + 1;
+
+      if (    !runahead_core_copy_load(runloop_st, settings,
+               &spec->core, &spec->lib_handle, &spec->library_path)
+            || !(spec->lock = slock_new())
+            || !(spec->cond = scond_new()))
+         goto error;
+
+      runahead_speculation_set_callbacks(&spec->core);
+
+      if (!(spec->thread = sthread_create(
+                  runahead_speculation_thread, spec)))
+         goto error;
+   }
+
+   RARCH_LOG("[Run-Ahead]: Created %u speculative instance(s).\n", count);
+   return;
+
+error:
+   RARCH_WARN("[Run-Ahead]: Failed to create speculative instance.\n");
+   runahead_speculation_destroy(runloop_st);
+}
+
+/* Brings the instances' copy of the core options up to
+ * date. Must only be called while all of them are idle. */
+static void runahead_speculation_options_update(
+      runloop_state_t *runloop_st)
+{
+   size_t i;
+   struct runahead_speculation_state *spec_st = runloop_st->speculation;
+   core_option_manager_t *opts                = runloop_st->core_options;
+   size_t size                                = opts ? opts->size : 0;
+
+   if (size != spec_st->options_size)
+   {
+      runahead_speculation_option_t *options = NULL;
+
+      runahead_speculation_options_free(spec_st);
+      if (!size || !(options = (runahead_speculation_option_t*)
+               calloc(size, sizeof(*options))))
+         return;
+      spec_st->options      = options;
+      spec_st->options_size = size;
+   }
+
+   /* Nothing to copy unless something changed */
+   for (i = 0; i < size; i++)
+   {
+      runahead_speculation_option_t *option = &spec_st->options[i];
+      const char *key   = opts->opts[i].key;
+      const char *value = core_option_manager_get_val(opts, i);
+
+      if (!string_is_equal(option->key, key))
+      {
+         free(option->key);
+         option->key    = key ? strdup(key) : NULL;
+      }
+
+      if (!string_is_equal(option->value, value))
+      {
+         free(option->value);
+         option->value  = value ? strdup(value) : NULL;
+      }
+   }
+}
+
+/* Starts each instance on the real frame that was just
+ * saved, with the input it assumes for the next one. */
+static void runahead_speculation_dispatch(runloop_state_t *runloop_st,
+      int runahead_count)
+{
+   unsigned i;
+   const retro_ctx_serialize_info_t *state    = NULL;
+   struct runahead_speculation_state *spec_st = runloop_st->speculation;
+
+   if (!spec_st || !runloop_st->runahead_save_state_list)
+      return;
+
+   state = (const retro_ctx_serialize_info_t*)
+      runloop_st->runahead_save_state_list->data[0];
+
+   runahead_speculation_options_update(runloop_st);
+   spec_st->waiting = true;
+
+   /* Remember the last few distinct inputs */
+   if (     !spec_st->current
+         || !runahead_input_list_matches(runloop_st->input_state_list,
+            spec_st->current))
+   {
+      mylist_destroy(&spec_st->history[RUNAHEAD_MAX_SPECULATIONS - 2]);
+      for (i = RUNAHEAD_MAX_SPECULATIONS - 2; i > 0; i--)
+         spec_st->history[i] = spec_st->history[i - 1];
+      spec_st->history[0] = spec_st->current;
+      spec_st->current    = NULL;
+      runahead_input_list_copy(&spec_st->current,
+            runloop_st->input_state_list);
+   }
+
+   for (i = 0; i < spec_st->count; i++)
+   {
+      runahead_speculation_t *spec = &spec_st->instances[i];
+      /* First instance assumes everything gets released,
+       * the others go back to earlier inputs */
+      const my_list *input         = (i > 0)
+         ? spec_st->history[i - 1]
+         : NULL;
+
+      spec->dispatched             = false;
+
+      if (i > 0 && !input)
+         continue;
+      /* That one is the secondary instance's job */
+      if (runahead_input_list_matches(runloop_st->input_state_list, input))
+         continue;
+
+      spec->state                  = state;
+      spec->input                  = input;
+      spec->frames                 = (unsigned)runahead_count;
+      spec->dispatched             = true;
+
+      slock_lock(spec->lock);
+      spec->busy                   = true;
+      scond_signal(spec->cond);
+      slock_unlock(spec->lock);
+   }
+}
+
+/* Swaps in the instance that assumed the input the real
+ * frame actually got. It already ran the lookahead, so
+ * there is no state to load and nothing to run again. */
+static bool runahead_speculation_take(runloop_state_t *runloop_st,
+      int runahead_count)
+{
+   unsigned i;
+   struct runahead_speculation_state *spec_st = runloop_st->speculation;
+
+   if (!spec_st)
+      return false;
+
+   for (i = 0; i < spec_st->count; i++)
+   {
+      struct retro_core_t core;
+      dylib_t lib_handle;
+      char *library_path;
+      bool variable_update;
+      runahead_speculation_t *spec = &spec_st->instances[i];
+
+      if (     !spec->dispatched
+            || !spec->has_frame
+            ||  spec->frames != (unsigned)runahead_count
+            || !runahead_input_list_matches(runloop_st->input_state_list,
+               spec->input))
+         continue;
+
+      runloop_st->secondary_callbacks.frame_cb(spec->frame,
+            spec->width, spec->height, spec->pitch);
+
+      core                               = runloop_st->secondary_core;
+      lib_handle                         = runloop_st->secondary_lib_handle;
+      library_path                       = runloop_st->secondary_library_path;
+      variable_update                    =
+         (runloop_st->flags & RUNLOOP_FLAG_HAS_VARIABLE_UPDATE) ? true : false;
+
+      runloop_st->secondary_core         = spec->core;
+      runloop_st->secondary_lib_handle   = spec->lib_handle;
+      runloop_st->secondary_library_path = spec->library_path;
+      if (spec->variable_update)
+         runloop_st->flags              |=  RUNLOOP_FLAG_HAS_VARIABLE_UPDATE;
+      else
+         runloop_st->flags              &= ~RUNLOOP_FLAG_HAS_VARIABLE_UPDATE;
+
+      spec->core                         = core;
+      spec->lib_handle                   = lib_handle;
+      spec->library_path                 = library_path;
+      spec->variable_update              = variable_update;
+
+      runloop_st->secondary_core.retro_set_video_refresh(
+            runloop_st->secondary_callbacks.frame_cb);
+      runloop_st->secondary_core.retro_set_audio_sample(
+            runloop_st->secondary_callbacks.sample_cb);
+      runloop_st->secondary_core.retro_set_audio_sample_batch(
+            runloop_st->secondary_callbacks.sample_batch_cb);
+      runloop_st->secondary_core.retro_set_input_state(
+            runloop_st->secondary_callbacks.state_cb);
+      runloop_st->secondary_core.retro_set_input_poll(
+            runloop_st->secondary_callbacks.poll_cb);
+      runahead_speculation_set_callbacks(&spec->core);
+
+      runahead_speculation_invalidate(runloop_st);
+      spec_st->waiting                   = false;
+      return true;
+   }
+
+   return false;
+}
+
+static void runahead_speculation_variable_update(runloop_state_t *runloop_st)
+{
+   unsigned i;
+   struct runahead_speculation_state *spec_st = runloop_st->speculation;
+
+   for (i = 0; i < spec_st->count; i++)
+      spec_st->instances[i].variable_update = true;
+}
+
+void runahead_speculation_set_cheat(void *data,
+      unsigned index, bool enabled, const char *code)
+{
+   unsigned i;
+   runloop_state_t *runloop_st                = (runloop_state_t*)data;
+   struct runahead_speculation_state *spec_st = runloop_st->speculation;
+
+   if (!spec_st)
+      return;
+
+   runahead_speculation_wait_all(runloop_st);
+   runahead_speculation_invalidate(runloop_st);
+
+   for (i = 0; i < spec_st->count; i++)
+      if (spec_st->instances[i].core.retro_cheat_set)
+         spec_st->instances[i].core.retro_cheat_set(index, enabled, code);
+}
+
+void runahead_speculation_reset_cheat(void *data)
+{
+   unsigned i;
+   runloop_state_t *runloop_st                = (runloop_state_t*)data;
+   struct runahead_speculation_state *spec_st = runloop_st->speculation;
+
+   if (!spec_st)
+      return;
+
+   runahead_speculation_wait_all(runloop_st);
+   runahead_speculation_invalidate(runloop_st);
+
+   for (i = 0; i < spec_st->count; i++)
+      if (spec_st->instances[i].core.retro_cheat_reset)
+         spec_st->instances[i].core.retro_cheat_reset();
+}
+#else
+void runahead_speculation_set_cheat(void *data,
+      unsigned index, bool enabled, const char *code) { }
+void runahead_speculation_reset_cheat(void *data) { }
+#endif
+
+/* Runahead Code */
+
+static void runahead_error(runloop_state_t *runloop_st)
+{
+#if defined(HAVE_DYNAMIC) && defined(HAVE_THREADS)
+   runahead_speculation_wait_all(runloop_st);
+   runahead_speculation_invalidate(runloop_st);
+#endif
+   runloop_st->flags &= ~RUNLOOP_FLAG_RUNAHEAD_AVAILABLE;
+   mylist_destroy(&runloop_st->runahead_save_state_list);
+   runahead_remove_hooks(runloop_st);
+   runloop_st->runahead_save_state_size       = 0;
+   runloop_st->runahead_timeline_frames       = 0;
+   runloop_st->flags                         |= RUNLOOP_FLAG_RUNAHEAD_SAVE_STATE_SIZE_KNOWN;
+}
+
+static bool runahead_create(runloop_state_t *runloop_st)
+{
+   /* get savestate size and allocate buffer */
+   video_driver_state_t *video_st = video_state_get_ptr();
+   size_t info_size               = core_serialize_size_special();
+
+   runahead_save_state_list_init(runloop_st, info_size);
+   if (video_st->flags & VIDEO_FLAG_ACTIVE)
+      video_st->flags |=  VIDEO_FLAG_RUNAHEAD_IS_ACTIVE;
+   else
+      video_st->flags &= ~VIDEO_FLAG_RUNAHEAD_IS_ACTIVE;
+
+   if (      (runloop_st->runahead_save_state_size == 0)
+         || !(runloop_st->flags & RUNLOOP_FLAG_RUNAHEAD_SAVE_STATE_SIZE_KNOWN))
+   {
+      runahead_error(runloop_st);
+      return false;
+   }
+
+   runahead_add_hooks(runloop_st);
+   runloop_st->flags |= RUNLOOP_FLAG_RUNAHEAD_FORCE_INPUT_DIRTY;
+   if (runloop_st->runahead_save_state_list)
+      mylist_resize(runloop_st->runahead_save_state_list, 1, true);
+   return true;
+}
+
+static bool runahead_save_state(runloop_state_t *runloop_st)
+{
+   retro_ctx_serialize_info_t *serialize_info;
+
+   if (!runloop_st->runahead_save_state_list)
+      return false;
+
+   serialize_info                  =
+      (retro_ctx_serialize_info_t*)runloop_st->runahead_save_state_list->data[0];
+
+   if (core_serialize_special(serialize_info))
+      return true;
+
+   runahead_error(runloop_st);
+   return false;
+}
+
+static bool runahead_load_state(runloop_state_t *runloop_st)
+{
+   retro_ctx_serialize_info_t *serialize_info =
+      (retro_ctx_serialize_info_t*)
+      runloop_st->runahead_save_state_list->data[0];
+   bool last_dirty                            = (runloop_st->flags & RUNLOOP_FLAG_INPUT_IS_DIRTY) ? true : false;
+   bool ret                                   = core_unserialize_special(serialize_info);
+   if (last_dirty)
+      runloop_st->flags                      |=  RUNLOOP_FLAG_INPUT_IS_DIRTY;
+   else
+      runloop_st->flags                      &= ~RUNLOOP_FLAG_INPUT_IS_DIRTY;
+
+   if (!ret)
+      runahead_error(runloop_st);
+
+   return ret;
+}
+
+#if HAVE_DYNAMIC
+static bool runahead_load_state_secondary(runloop_state_t *runloop_st, settings_t *settings)
+{
+   retro_ctx_serialize_info_t *serialize_info =
+      (retro_ctx_serialize_info_t*)runloop_st->runahead_save_state_list->data[0];
+
+   if (!secondary_core_deserialize(runloop_st,
+            settings, serialize_info->data_const,
+            serialize_info->size))
+   {
+      runloop_st->flags &= ~RUNLOOP_FLAG_RUNAHEAD_SECONDARY_CORE_AVAILABLE;
+      runahead_error(runloop_st);
+
+      return false;
+   }
+
+   return true;
+}
+#endif
+
+/* Lookahead frames of the kept timeline assume the last real
+ * input. Anything the core reads there is marked as requested
+ * (as 0 if it was never read before), so that the next frame
+ * checks it against real input like everything else. */
+static int16_t runahead_input_state_lookahead(unsigned port,
+      unsigned device, unsigned index, unsigned id)
+{
+   runloop_state_t *runloop_st = runloop_state_get_ptr();
+   int16_t last_input          =
+      input_state_get_last(port, device, index, id);
+   /*arbitrary limit of up to 65536 elements in state array*/
+   if (id < 65536)
+      runahead_input_state_set_last(runloop_st,
+            port, device, index, id, last_input);
+   return last_input;
+}
+
+static void runahead_core_run_use_last_input(runloop_state_t *runloop_st,
+      bool log_requests)
+{
+   struct retro_callbacks *cbs            = &runloop_st->retro_ctx;
+   retro_input_poll_t old_poll_function   = cbs->poll_cb;
+   retro_input_state_t old_input_function = cbs->state_cb;
+
+   cbs->poll_cb                           = retro_input_poll_null;
+   cbs->state_cb                          = log_requests
+      ? runahead_input_state_lookahead
+      : input_state_get_last;
+
+   runloop_st->current_core.retro_set_input_poll(cbs->poll_cb);
+   runloop_st->current_core.retro_set_input_state(cbs->state_cb);
+
+   runloop_st->current_core.retro_run();
+
+   cbs->poll_cb                           = old_poll_function;
+   cbs->state_cb                          = old_input_function;
+
+   runloop_st->current_core.retro_set_input_poll(cbs->poll_cb);
+   runloop_st->current_core.retro_set_input_state(cbs->state_cb);
+}
+
+/* Kept timeline - single instance run-ahead that carries the
+ * lookahead frames over to the next frame instead of loading
+ * state and running all of them again.
+ *
+ * runahead_save_state_list is used as a ring of
+ * (runahead_count + 1) states, one per frame of the lookahead.
+ * The oldest one, at runahead_timeline_start, is the last real
+ * frame. As long as input matches what the lookahead assumed,
+ * a frame costs one core run and one serialize; once it differs,
+ * the oldest state is loaded and the lookahead is replayed. */
+
+static bool runahead_input_changed(runloop_state_t *runloop_st)
+{
+   int i;
+   my_list *list                = runloop_st->input_state_list;
+   retro_input_state_t state_cb = runloop_st->input_state_callback_original;
+
+   if (!state_cb)
+      return true;
+   /* Core has not asked for any input yet */
+   if (!list)
+      return false;
+
+   for (i = 0; i < list->size; i++)
+   {
+      unsigned id;
+      input_list_element *element = (input_list_element*)list->data[i];
+
+      for (id = 0; id < element->state_size; id++)
+      {
+         if (     element->requested[id]
+               && state_cb(element->port, element->device,
+                  element->index, id) != element->state[id])
+            return true;
+      }
+   }
+
+   return false;
+}
+
+/* Same as core_run(), but reuses the input poll
+ * runahead_timeline_run() already did for this frame */
+static void runahead_core_run_polled(runloop_state_t *runloop_st)
+{
+   struct retro_callbacks *cbs            = &runloop_st->retro_ctx;
+   retro_input_poll_t old_poll_function   = cbs->poll_cb;
+
+   cbs->poll_cb                           = retro_input_poll_null;
+   runloop_st->current_core.retro_set_input_poll(cbs->poll_cb);
+   /* Keeps late polling cores from polling on first read */
+   runloop_st->current_core.flags        |= RETRO_CORE_FLAG_INPUT_POLLED;
+
+   runloop_st->current_core.retro_run();
+
+   cbs->poll_cb                           = old_poll_function;
+   runloop_st->current_core.retro_set_input_poll(cbs->poll_cb);
+}
+
+static bool runahead_timeline_save(runloop_state_t *runloop_st,
+      unsigned slot)
+{
+   retro_ctx_serialize_info_t *serialize_info =
+      (retro_ctx_serialize_info_t*)
+      runloop_st->runahead_save_state_list->data[slot];
+
+   const char *runahead_failed_str;
+
+   if (core_serialize_special(serialize_info))
+      return true;
+
+   runahead_error(runloop_st);
+   runahead_failed_str = msg_hash_to_str(MSG_RUNAHEAD_FAILED_TO_SAVE_STATE);
+   runloop_msg_queue_push(runahead_failed_str, 0, 3 * 60, true, NULL, MESSAGE_QUEUE_ICON_DEFAULT, MESSAGE_QUEUE_CATEGORY_INFO);
+   RARCH_WARN("[Run-Ahead]: %s\n", runahead_failed_str);
+   return false;
+}
+
+static bool runahead_timeline_load(runloop_state_t *runloop_st,
+      unsigned slot)
+{
+   retro_ctx_serialize_info_t *serialize_info =
+      (retro_ctx_serialize_info_t*)
+      runloop_st->runahead_save_state_list->data[slot];
+   unsigned frames = runloop_st->runahead_timeline_frames;
+   bool ret        = core_unserialize_special(serialize_info);
+
+   /* Our own load must not invalidate the timeline */
+   runloop_st->runahead_timeline_frames = frames;
+
+   if (!ret)
+   {
+      const char *runahead_failed_str =
+         msg_hash_to_str(MSG_RUNAHEAD_FAILED_TO_LOAD_STATE);
+      runahead_error(runloop_st);
+      runloop_msg_queue_push(runahead_failed_str, 0, 3 * 60, true, NULL, MESSAGE_QUEUE_ICON_DEFAULT, MESSAGE_QUEUE_CATEGORY_INFO);
+      RARCH_WARN("[Run-Ahead]: %s\n", runahead_failed_str);
+   }
+
+   return ret;
+}
+
+static bool runahead_timeline_run(runloop_state_t *runloop_st,
+      int runahead_count)
+{
+   int frame_number;
+   unsigned start;
+   bool polled                    = false;
+   video_driver_state_t *video_st = video_state_get_ptr();
+   audio_driver_state_t *audio_st = audio_state_get_ptr();
+   my_list *list                  = runloop_st->runahead_save_state_list;
+   unsigned num_states            = (unsigned)runahead_count + 1;
+
+   if (list->size != (int)num_states)
+   {
+      mylist_resize(list, (int)num_states, true);
+      runloop_st->runahead_timeline_frames = 0;
+   }
+
+   if (runloop_st->flags & RUNLOOP_FLAG_RUNAHEAD_FORCE_INPUT_DIRTY)
+      runloop_st->runahead_timeline_frames = 0;
+
+   if (runloop_st->runahead_timeline_frames == num_states)
+   {
+      start  = runloop_st->runahead_timeline_start;
+
+      /* Input has to be checked before the frame runs, so poll
+       * here once and let the frame below use the same poll */
+      input_driver_poll();
+      polled = true;
+
+      if (     !(runloop_st->flags & RUNLOOP_FLAG_INPUT_IS_DIRTY)
+            && !runahead_input_changed(runloop_st))
+      {
+         /* The oldest state is no longer needed to roll back,
+          * the newest lookahead frame takes its place */
+         runahead_core_run_polled(runloop_st);
+         if (!runahead_timeline_save(runloop_st, start))
+            return false;
+         runloop_st->runahead_timeline_start = (start + 1) % num_states;
+         return true;
+      }
+
+      if (!runahead_timeline_load(runloop_st, start))
+         return false;
+   }
+   else
+   {
+      /* Nothing to roll back to, current state is the real one */
+      start                               = 0;
+      runloop_st->runahead_timeline_start = 0;
+   }
+
+   for (frame_number = 0; frame_number <= runahead_count; frame_number++)
+   {
+      bool suspended_frame = frame_number != runahead_count;
+
+      if (suspended_frame)
+      {
+         audio_st->flags     |=  AUDIO_FLAG_SUSPENDED;
+         video_st->flags     &= ~VIDEO_FLAG_ACTIVE;
+      }
+
+      if (frame_number != 0)
+         runahead_core_run_use_last_input(runloop_st, true);
+      else if (polled)
+         runahead_core_run_polled(runloop_st);
+      else
+         core_run();
+
+      if (suspended_frame)
+      {
+         if (video_st->flags & VIDEO_FLAG_RUNAHEAD_IS_ACTIVE)
+            video_st->flags |=  VIDEO_FLAG_ACTIVE;
+         else
+            video_st->flags &= ~VIDEO_FLAG_ACTIVE;
+
+         audio_st->flags    &= ~AUDIO_FLAG_SUSPENDED;
+      }
+
+      /* The lookahead is based on the input read just now */
+      if (frame_number == 0)
+         runloop_st->flags  &= ~RUNLOOP_FLAG_INPUT_IS_DIRTY;
+
+      if (!runahead_timeline_save(runloop_st,
+               (start + frame_number) % num_states))
+         return false;
+   }
+
+   runloop_st->runahead_timeline_frames = num_states;
+   return true;
+}
+
+void runahead_run(void *data,
+      int runahead_count,
+      bool runahead_hide_warnings,
+      bool use_secondary,
+      bool keep_timeline)
+{
+   runloop_state_t *runloop_st = (runloop_state_t*)data;
+   int frame_number        = 0;
+   bool last_frame         = false;
+   bool suspended_frame    = false;
+#if defined(HAVE_DYNAMIC) || defined(HAVE_DYLIB)
+   bool speculated         = false;
+   bool saved              = false;
+   bool variable_update    = false;
+   const bool have_dynamic = true;
+   settings_t *settings    = config_get_ptr();
+#else
+   const bool have_dynamic = false;
+#endif
+   video_driver_state_t
+      *video_st            = video_state_get_ptr();
+   uint64_t frame_count    = video_st->frame_count;
+   audio_driver_state_t
+      *audio_st            = audio_state_get_ptr();
+
+#if defined(HAVE_DYNAMIC) && defined(HAVE_THREADS)
+   /* Finish last frame's speculation before touching any state */
+   runahead_speculation_wait_all(runloop_st);
+#endif
 
    if (      runahead_count <= 0
          || !(runloop_st->flags & RUNLOOP_FLAG_RUNAHEAD_AVAILABLE))
@@ -1190,12 +2185,32 @@ void runahead_run(void *data,
 
    runloop_st->runahead_last_frame_count  = frame_count;
 
-   if (     !use_secondary
-         || !have_dynamic
-         || !(runloop_st->flags & RUNLOOP_FLAG_RUNAHEAD_SECONDARY_CORE_AVAILABLE))
+#ifdef HAVE_BSV_MOVIE
+   /* Checking input outside of retro_run would end up in the movie */
+   if (input_state_get_ptr()->bsv_movie_state_handle)
+      keep_timeline = false;
+#endif
+
+   if (     keep_timeline
+         && (   !use_secondary
+             || !have_dynamic
+             || !(runloop_st->flags & RUNLOOP_FLAG_RUNAHEAD_SECONDARY_CORE_AVAILABLE)))
    {
-      /* TODO: multiple savestates for higher performance
-       * when not using secondary core */
+#if defined(HAVE_DYNAMIC) && defined(HAVE_THREADS)
+      runahead_speculation_invalidate(runloop_st);
+#endif
+      if (!runahead_timeline_run(runloop_st, runahead_count))
+         return;
+   }
+   else if (   !use_secondary
+            || !have_dynamic
+            || !(runloop_st->flags & RUNLOOP_FLAG_RUNAHEAD_SECONDARY_CORE_AVAILABLE))
+   {
+      runloop_st->runahead_timeline_frames = 0;
+#if defined(HAVE_DYNAMIC) && defined(HAVE_THREADS)
+      runahead_speculation_invalidate(runloop_st);
+#endif
+
       for (frame_number = 0; frame_number <= runahead_count; frame_number++)
       {
          last_frame      = frame_number == runahead_count;
@@ -1210,7 +2225,7 @@ void runahead_run(void *data,
          if (frame_number == 0)
             core_run();
          else
-            runahead_core_run_use_last_input(runloop_st);
+            runahead_core_run_use_last_input(runloop_st, false);
 
          if (suspended_frame)
          {
@@ -1250,6 +2265,8 @@ void runahead_run(void *data,
    else
    {
 #if HAVE_DYNAMIC
+      runloop_st->runahead_timeline_frames = 0;
+
       if (!secondary_core_ensure_exists(runloop_st, config_get_ptr()))
       {
          const char *runahead_failed_str =
@@ -1261,6 +2278,10 @@ void runahead_run(void *data,
          goto force_input_dirty;
       }
 
+#ifdef HAVE_THREADS
+      variable_update  = (runloop_st->flags & RUNLOOP_FLAG_HAS_VARIABLE_UPDATE) ? true : false;
+#endif
+
       /* run main core with video suspended */
       video_st->flags &= ~VIDEO_FLAG_ACTIVE;
       core_run();
@@ -1269,10 +2290,33 @@ void runahead_run(void *data,
       else
          video_st->flags &= ~VIDEO_FLAG_ACTIVE;
 
+#ifdef HAVE_THREADS
+      if (runloop_st->speculation)
+      {
+         /* Main core picked up new core options,
+          * which the speculation didn't have */
+         if (      !variable_update
+               && (runloop_st->flags & RUNLOOP_FLAG_HAS_VARIABLE_UPDATE))
+         {
+            runahead_speculation_variable_update(runloop_st);
+            runahead_speculation_invalidate(runloop_st);
+         }
+
+         if (      (runloop_st->flags & RUNLOOP_FLAG_INPUT_IS_DIRTY)
+               && !(runloop_st->flags & RUNLOOP_FLAG_RUNAHEAD_FORCE_INPUT_DIRTY)
+               && runahead_speculation_take(runloop_st, runahead_count))
+         {
+            runloop_st->flags &= ~RUNLOOP_FLAG_INPUT_IS_DIRTY;
+            speculated         = true;
+         }
+      }
+#endif
+
       if (     (runloop_st->flags & RUNLOOP_FLAG_INPUT_IS_DIRTY)
             || (runloop_st->flags & RUNLOOP_FLAG_RUNAHEAD_FORCE_INPUT_DIRTY))
       {
          runloop_st->flags &= ~RUNLOOP_FLAG_INPUT_IS_DIRTY;
+         saved              = true;
 
          if (!runahead_save_state(runloop_st))
          {
@@ -1309,20 +2353,50 @@ void runahead_run(void *data,
                video_st->flags          &= ~VIDEO_FLAG_ACTIVE;
          }
       }
-      audio_st->flags                   |= AUDIO_FLAG_SUSPENDED
+
+      if (!speculated)
+      {
+         audio_st->flags                |= AUDIO_FLAG_SUSPENDED
                                          | AUDIO_FLAG_HARD_DISABLE;
-      if (secondary_core_run_use_last_input(runloop_st))
-         runloop_st->flags              |=  RUNLOOP_FLAG_RUNAHEAD_SECONDARY_CORE_AVAILABLE;
-      else
-         runloop_st->flags              &= ~RUNLOOP_FLAG_RUNAHEAD_SECONDARY_CORE_AVAILABLE;
-      audio_st->flags                   &= ~(AUDIO_FLAG_SUSPENDED
+         if (secondary_core_run_use_last_input(runloop_st))
+            runloop_st->flags           |=  RUNLOOP_FLAG_RUNAHEAD_SECONDARY_CORE_AVAILABLE;
+         else
+            runloop_st->flags           &= ~RUNLOOP_FLAG_RUNAHEAD_SECONDARY_CORE_AVAILABLE;
+         audio_st->flags                &= ~(AUDIO_FLAG_SUSPENDED
                                          | AUDIO_FLAG_HARD_DISABLE);
+      }
+
+#ifdef HAVE_THREADS
+      /* Input has not changed since the last round, which
+       * went unused. Running another one would only cost a
+       * serialize of the main core, so hold off until the
+       * input changes and the state gets saved anyway. */
+      if (     runloop_st->speculation
+            && runloop_st->speculation->waiting
+            && !saved)
+         runahead_speculation_invalidate(runloop_st);
+      else if (runloop_st->speculation)
+      {
+         if (!saved && !runahead_save_state(runloop_st))
+         {
+            const char *runahead_failed_str =
+               msg_hash_to_str(MSG_RUNAHEAD_FAILED_TO_SAVE_STATE);
+            runloop_msg_queue_push(runahead_failed_str, 0, 3 * 60, true, NULL, MESSAGE_QUEUE_ICON_DEFAULT, MESSAGE_QUEUE_CATEGORY_INFO);
+            RARCH_WARN("[Run-Ahead]: %s\n", runahead_failed_str);
+            return;
+         }
+         runahead_speculation_dispatch(runloop_st, runahead_count);
+      }
+#endif
 #endif
    }
    runloop_st->flags &= ~RUNLOOP_FLAG_RUNAHEAD_FORCE_INPUT_DIRTY;
    return;
 
 force_input_dirty:
+#if defined(HAVE_DYNAMIC) && defined(HAVE_THREADS)
+   runahead_speculation_invalidate(runloop_st);
+#endif
    core_run();
    runloop_st->flags |=  RUNLOOP_FLAG_RUNAHEAD_FORCE_INPUT_DIRTY;
 }
@@ -1360,8 +2434,12 @@ static int16_t preempt_input_state(unsigned port,
    return input_driver_state_wrapper(port, device, index, id);
 }
 
+static struct retro_perf_counter preempt_perf_serialize   = {0};
+static struct retro_perf_counter preempt_perf_unserialize = {0};
+static struct retro_perf_counter preempt_perf_replay      = {0};
+
 static const char* preempt_allocate(runloop_state_t *runloop_st,
-      const uint8_t frames)
+      const uint8_t frames, bool adaptive)
 {
    uint8_t i;
    size_t info_size;
@@ -1376,6 +2454,8 @@ static const char* preempt_allocate(runloop_state_t *runloop_st,
 
    preempt->state_size = info_size;
    preempt->frames     = frames;
+   preempt->max_frames = frames;
+   preempt->adaptive   = adaptive;
 
    for (i = 0; i < frames; i++)
    {
@@ -1403,7 +2483,7 @@ void preempt_deinit(void *data)
       return;
 
    /* Free memory */
-   for (i = 0; i < preempt->frames; i++)
+   for (i = 0; i < preempt->max_frames; i++)
       free(preempt->buffer[i]);
 
    free(preempt);
@@ -1455,11 +2535,17 @@ bool preempt_init(void *data)
    if (video_state_get_ptr()->frame_count == 0)
       runloop_st->current_core.retro_run();
 
-   /* Allocate - same 'frames' setting as runahead */
+   /* Allocate - same 'frames' setting as runahead,
+    * which is the upper limit in adaptive mode */
    if ((failed_str = preempt_allocate(runloop_st,
-               settings->uints.run_ahead_frames)))
+               settings->uints.run_ahead_frames,
+               settings->bools.preemptive_frames_adaptive)))
       goto error;
 
+   performance_counter_init(preempt_perf_serialize,   "preempt_serialize");
+   performance_counter_init(preempt_perf_unserialize, "preempt_unserialize");
+   performance_counter_init(preempt_perf_replay,      "preempt_replay");
+
    /* Only poll in preempt_run() */
    runloop_st->current_core.retro_set_input_poll(retro_input_poll_null);
    /* Track requested analog states and pointing device types */
@@ -1611,6 +2697,99 @@ static INLINE void preempt_input_poll(preempt_t *preempt,
 /* macro for preempt_run */
 #define PREEMPT_NEXT_PTR(x) ((x + 1) % preempt->frames)
 
+/* Percentage of the frame period a replay may take in adaptive mode,
+ * leaving the rest for the frontend and the video driver */
+#define PREEMPT_ADAPTIVE_BUDGET   75
+/* Frames between adjustments of the adaptive frame count */
+#define PREEMPT_ADAPTIVE_INTERVAL 60
+
+static INLINE retro_time_t preempt_time_start(preempt_t *preempt)
+{
+   return preempt->adaptive ? cpu_features_get_time_usec() : 0;
+}
+
+static INLINE void preempt_time_sample(retro_time_t *average,
+      retro_time_t sample)
+{
+   /* Running average weighing roughly the last 8 samples */
+   if (*average)
+      *average += (sample - *average) / 8;
+   else
+      *average  = sample;
+}
+
+static INLINE void preempt_time_stop(preempt_t *preempt,
+      retro_time_t *average, retro_time_t start)
+{
+   if (preempt->adaptive)
+      preempt_time_sample(average,
+            cpu_features_get_time_usec() - start);
+}
+
+/* Predicted cost of a frame with dirty input: load the oldest
+ * state, rerun 'frames' frames saving all but the first,
+ * then save and run the current frame. */
+static retro_time_t preempt_replay_cost(preempt_t *preempt,
+      unsigned frames)
+{
+   retro_time_t unserialize_time = preempt->unserialize_time
+         ? preempt->unserialize_time
+         : preempt->serialize_time;
+
+   return unserialize_time
+         + (frames + 1) * preempt->run_time
+         +  frames      * preempt->serialize_time;
+}
+
+/**
+ * preempt_adapt:
+ * @preempt : pointer to preemptive frames object
+ *
+ * Picks the largest frame count up to the configured
+ * maximum whose replay fits in the frame budget. Lowering
+ * takes effect at once, raising goes one frame at a time.
+ **/
+static void preempt_adapt(preempt_t *preempt,
+      video_driver_state_t *video_st)
+{
+   unsigned frames;
+   retro_time_t budget;
+   double fps = video_st->av_info.timing.fps;
+
+   if (++preempt->adapt_counter < PREEMPT_ADAPTIVE_INTERVAL)
+      return;
+   preempt->adapt_counter = 0;
+
+   if (fps <= 0.0 || !preempt->run_time || !preempt->serialize_time)
+      return;
+
+   budget = (retro_time_t)(1000000.0 / fps)
+         * PREEMPT_ADAPTIVE_BUDGET / 100;
+
+   for (frames = preempt->max_frames; frames > 1; frames--)
+      if (preempt_replay_cost(preempt, frames) <= budget)
+         break;
+
+   if (frames > (unsigned)preempt->frames + 1)
+      frames = preempt->frames + 1;
+
+   if (frames == preempt->frames)
+      return;
+
+   /* Ring size changed; refill it before the next replay */
+   preempt->frames      = (uint8_t)frames;
+   preempt->start_ptr   = 0;
+   preempt->frame_count = 0;
+
+   RARCH_LOG("[Preemptive Frames]: Adjusted to %u frame(s), "
+         "replay %.2f ms of %.2f ms budget, "
+         "saving %.1f ms of input latency.\n",
+         frames,
+         preempt_replay_cost(preempt, frames) / 1000.0,
+         budget / 1000.0,
+         frames * 1000.0 / fps);
+}
+
 /**
  * preempt_run:
  * @preempt : pointer to preemptive frames object
@@ -1625,6 +2804,8 @@ void preempt_run(preempt_t *preempt, void *data)
    settings_t *settings              = config_get_ptr();
    audio_driver_state_t *audio_st    = audio_state_get_ptr();
    video_driver_state_t *video_st    = video_state_get_ptr();
+   bool perfcnt_enable               = runloop_st->perfcnt_enable;
+   retro_time_t time_start;
 
    /* Poll and check for dirty input */
    preempt_input_poll(preempt, runloop_st, settings);
@@ -1634,44 +2815,74 @@ void preempt_run(preempt_t *preempt, void *data)
    if ((runloop_st->flags & RUNLOOP_FLAG_INPUT_IS_DIRTY)
          && preempt->frame_count >= preempt->frames)
    {
+      retro_time_t replay_time = 0;
+
       /* Suspend A/V and run preemptive frames */
       audio_st->flags |=  AUDIO_FLAG_SUSPENDED;
       video_st->flags &= ~VIDEO_FLAG_ACTIVE;
 
+      performance_counter_start_plus(perfcnt_enable, preempt_perf_replay);
+      performance_counter_start_plus(perfcnt_enable, preempt_perf_unserialize);
+      time_start = preempt_time_start(preempt);
       if (!current_core->retro_unserialize(
             preempt->buffer[preempt->start_ptr], preempt->state_size))
       {
+         performance_counter_stop_plus(perfcnt_enable, preempt_perf_unserialize);
+         performance_counter_stop_plus(perfcnt_enable, preempt_perf_replay);
          failed_str = msg_hash_to_str(MSG_PREEMPT_FAILED_TO_LOAD_STATE);
          goto error;
       }
+      preempt_time_stop(preempt, &preempt->unserialize_time, time_start);
+      performance_counter_stop_plus(perfcnt_enable, preempt_perf_unserialize);
 
+      /* Only these runs are timed: with A/V suspended they
+       * measure the core alone, while the visible run below
+       * also waits on the video driver (vsync) */
+      time_start           = preempt_time_start(preempt);
       current_core->retro_run();
-      preempt->replay_ptr = PREEMPT_NEXT_PTR(preempt->start_ptr);
+      if (preempt->adaptive)
+         replay_time      += cpu_features_get_time_usec() - time_start;
+      preempt->replay_ptr  = PREEMPT_NEXT_PTR(preempt->start_ptr);
 
       while (preempt->replay_ptr != preempt->start_ptr)
       {
          if (!current_core->retro_serialize(
                preempt->buffer[preempt->replay_ptr], preempt->state_size))
          {
+            performance_counter_stop_plus(perfcnt_enable, preempt_perf_replay);
             failed_str = msg_hash_to_str(MSG_PREEMPT_FAILED_TO_SAVE_STATE);
             goto error;
          }
 
+         time_start           = preempt_time_start(preempt);
          current_core->retro_run();
-         preempt->replay_ptr = PREEMPT_NEXT_PTR(preempt->replay_ptr);
+         if (preempt->adaptive)
+            replay_time      += cpu_features_get_time_usec() - time_start;
+         preempt->replay_ptr  = PREEMPT_NEXT_PTR(preempt->replay_ptr);
       }
+      performance_counter_stop_plus(perfcnt_enable, preempt_perf_replay);
+
+      if (preempt->adaptive)
+         preempt_time_sample(&preempt->run_time,
+               replay_time / preempt->frames);
 
       audio_st->flags &= ~AUDIO_FLAG_SUSPENDED;
       video_st->flags |=  VIDEO_FLAG_ACTIVE;
    }
 
    /* Save current state and set start_ptr to oldest state */
+   performance_counter_start_plus(perfcnt_enable, preempt_perf_serialize);
+   time_start = preempt_time_start(preempt);
    if (!current_core->retro_serialize(
          preempt->buffer[preempt->start_ptr], preempt->state_size))
    {
+      performance_counter_stop_plus(perfcnt_enable, preempt_perf_serialize);
       failed_str = msg_hash_to_str(MSG_PREEMPT_FAILED_TO_SAVE_STATE);
       goto error;
    }
+   preempt_time_stop(preempt, &preempt->serialize_time, time_start);
+   performance_counter_stop_plus(perfcnt_enable, preempt_perf_serialize);
+
    preempt->start_ptr = PREEMPT_NEXT_PTR(preempt->start_ptr);
    runloop_st->flags &= ~(RUNLOOP_FLAG_REQUEST_SPECIAL_SAVESTATE
          | RUNLOOP_FLAG_INPUT_IS_DIRTY);
@@ -1679,6 +2890,9 @@ void preempt_run(preempt_t *preempt, void *data)
    /* Run normal frame */
    current_core->retro_run();
    preempt->frame_count++;
+
+   if (preempt->adaptive)
+      preempt_adapt(preempt, video_st);
    return;
 
 error:
@@ -1706,4 +2920,6 @@ void runahead_clear_variables(void *data)
                                           | RUNLOOP_FLAG_RUNAHEAD_SECONDARY_CORE_AVAILABLE
                                           | RUNLOOP_FLAG_RUNAHEAD_FORCE_INPUT_DIRTY;
    runloop_st->runahead_last_frame_count  = 0;
+   runloop_st->runahead_timeline_start    = 0;
+   runloop_st->runahead_timeline_frames   = 0;
 }
@@ -25,6 +25,8 @@
 #include "core.h"
 
 #define MAX_RUNAHEAD_FRAMES 12
+/* Maximum number of speculative run-ahead instances */
+#define RUNAHEAD_MAX_SPECULATIONS 3
 
 typedef void *(*constructor_t)(void);
 typedef void  (*destructor_t )(void*);
@@ -47,6 +49,15 @@ typedef struct preemptive_frames_data
    /* Frame count since buffer init/reset */
    uint64_t frame_count;
 
+   /* Adaptive mode: running averages of measured costs (usec).
+    * run_time is per frame, measured on the (A/V suspended)
+    * replays, so nothing is known until input first changes */
+   retro_time_t run_time;
+   retro_time_t serialize_time;
+   retro_time_t unserialize_time;
+   /* Frames since the frame count was last evaluated */
+   unsigned adapt_counter;
+
    /* Mask of analog states requested */
    uint32_t analog_mask[MAX_USERS];
 
@@ -62,6 +73,10 @@ typedef struct preemptive_frames_data
    uint8_t replay_ptr;
    /* Number of latency frames to remove */
    uint8_t frames;
+   /* Number of allocated savestate buffers */
+   uint8_t max_frames;
+   /* Tune 'frames' to the measured frame budget */
+   bool adaptive;
 } preempt_t;
 
 RETRO_BEGIN_DECLS
@@ -72,7 +87,8 @@ void runahead_run(
       void *data,
       int runahead_count,
       bool runahead_hide_warnings,
-      bool use_secondary);
+      bool use_secondary,
+      bool keep_timeline);
 
 void runahead_clear_variables(void *data);
 
@@ -86,6 +102,10 @@ void runahead_set_load_content_info(
 
 void runahead_secondary_core_destroy(void *data);
 
+void runahead_speculation_set_cheat(void *data,
+      unsigned index, bool enabled, const char *code);
+void runahead_speculation_reset_cheat(void *data);
+
 bool preempt_init(void *data);
 void preempt_deinit(void *data);
 
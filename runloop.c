@@ -7102,6 +7102,7 @@ int runloop_iterate(void)
       unsigned run_ahead_num_frames     = settings->uints.run_ahead_frames;
       bool run_ahead_hide_warnings      = settings->bools.run_ahead_hide_warnings;
       bool run_ahead_secondary_instance = settings->bools.run_ahead_secondary_instance;
+      bool run_ahead_keep_timeline      = settings->bools.run_ahead_keep_timeline;
       /* Run Ahead Feature replaces the call to core_run in this loop */
       bool want_runahead                = run_ahead_enabled
             && (run_ahead_num_frames > 0)
@@ -7116,7 +7117,8 @@ int runloop_iterate(void)
                runloop_st,
                run_ahead_num_frames,
                run_ahead_hide_warnings,
-               run_ahead_secondary_instance);
+               run_ahead_secondary_instance,
+               run_ahead_keep_timeline);
       else if (runloop_st->preempt_data)
          preempt_run(runloop_st->preempt_data, runloop_st);
       else
@@ -7553,8 +7555,12 @@ bool core_set_cheat(retro_ctx_cheat_info_t *info)
          && (runloop_st->flags & RUNLOOP_FLAG_RUNAHEAD_SECONDARY_CORE_AVAILABLE)
          && (secondary_core_ensure_exists(runloop_st, settings))
          && (runloop_st->secondary_core.retro_cheat_set))
+   {
       runloop_st->secondary_core.retro_cheat_set(
             info->index, info->enabled, info->code);
+      runahead_speculation_set_cheat(runloop_st,
+            info->index, info->enabled, info->code);
+   }
 #endif
 
    return true;
@@ -7593,7 +7599,10 @@ bool core_reset_cheat(void)
        && (runloop_st->flags & RUNLOOP_FLAG_RUNAHEAD_SECONDARY_CORE_AVAILABLE)
        && (secondary_core_ensure_exists(runloop_st, settings))
        && (runloop_st->secondary_core.retro_cheat_reset))
+   {
       runloop_st->secondary_core.retro_cheat_reset();
+      runahead_speculation_reset_cheat(runloop_st);
+   }
 #endif
 
    return true;
@@ -184,6 +184,9 @@ struct runloop
 #endif
    my_list *runahead_save_state_list;
    my_list *input_state_list;
+#if defined(HAVE_DYNAMIC) || defined(HAVE_DYLIB)
+   struct runahead_speculation_state *speculation;
+#endif
    preempt_t *preempt_data;
 #endif
 
@@ -253,6 +256,10 @@ struct runloop
    unsigned subsystem_current_count;
    unsigned entry_state_slot;
    unsigned video_swap_interval_auto;
+#if defined(HAVE_RUNAHEAD)
+   unsigned runahead_timeline_start;
+   unsigned runahead_timeline_frames;
+#endif
 
    fastmotion_overrides_t fastmotion_override; /* float alignment */
 
@@ -36,6 +36,9 @@
 #include "content.h"
 #include "audio/audio_driver.h"
 
+#define XXH_INLINE_ALL
+#include "deps/xxHash/xxhash.h"
+
 #ifdef HAVE_NETWORKING
 #include "network/netplay/netplay.h"
 #endif
@@ -65,6 +68,51 @@
 #include <emmintrin.h>
 #endif
 
+#if __AVX2__
+#include <immintrin.h>
+#endif
+
+#if defined(__ARM_NEON__) || defined(__ARM_NEON)
+#include <arm_neon.h>
+#define STATE_MANAGER_NEON
+#endif
+
+#ifdef HAVE_ZLIB
+#include <streams/trans_stream.h>
+#endif
+
+/* Up to this many keyframes, taking at most 1/8 of the
+ * rewind buffer. Spacing starts at STATE_MANAGER_KEYFRAME_INTERVAL
+ * pushes and doubles whenever they run out. */
+#define STATE_MANAGER_MAX_KEYFRAMES 16
+#define STATE_MANAGER_KEYFRAME_INTERVAL 32
+
+#ifdef HAVE_THREADS
+#include <rthreads/tpool.h>
+
+/* Smallest slice of the savestate worth handing to
+ * a worker thread; below this the wakeup costs more
+ * than the diff itself. Counted in uint16 units. */
+#define STATE_MANAGER_MIN_CHUNK16 (128 * 1024)
+#endif
+
+/* Extra uint16s a slice can add to the patch on top of
+ * state_manager_raw_maxsize(): a 32-bit skip record to
+ * reach the slice, a changed record that got split at the
+ * slice boundary and one more block of rounding. */
+#define STATE_MANAGER_CHUNK_SLACK16 8
+
+/* Bytes of padding behind the sentinel, enough for the
+ * widest load find_change() does (32 bytes with AVX2) */
+#define STATE_MANAGER_SCAN_PAD 32
+
+/* Granularity of dirty page tracking, in uint16 units (4KB) */
+#define STATE_MANAGER_PAGE16 2048
+
+/* Slices start on a page, the last one takes the remainder */
+#define STATE_MANAGER_CHUNK16(num16s, num_chunks) \
+   (((num16s) / (num_chunks)) & ~((size_t)STATE_MANAGER_PAGE16 - 1))
+
 /* Format per frame (pseudocode): */
 #if 0
 size nextstart;
@@ -89,7 +137,28 @@ size thisstart;
  * std::mismatch exists, but it's not optimized at all. */
 static size_t find_change(const uint16_t *a, const uint16_t *b)
 {
-#if __SSE2__
+#if __AVX2__
+   const __m256i *a256 = (const __m256i*)a;
+   const __m256i *b256 = (const __m256i*)b;
+
+   for (;;)
+   {
+      __m256i v0    = _mm256_loadu_si256(a256);
+      __m256i v1    = _mm256_loadu_si256(b256);
+      __m256i c     = _mm256_cmpeq_epi8(v0, v1);
+      uint32_t mask = (uint32_t)_mm256_movemask_epi8(c);
+
+      if (mask != 0xffffffffu)
+      {
+         size_t ret = (((uint8_t*)a256 - (uint8_t*)a) |
+               (compat_ctz(~mask)));
+         return (ret >> 1);
+      }
+
+      a256++;
+      b256++;
+   }
+#elif __SSE2__
    const __m128i *a128 = (const __m128i*)a;
    const __m128i *b128 = (const __m128i*)b;
 
@@ -113,6 +182,31 @@ static size_t find_change(const uint16_t *a, const uint16_t *b)
       a128++;
       b128++;
    }
+#elif defined(STATE_MANAGER_NEON)
+   const uint16_t *a_org = a;
+
+   for (;;)
+   {
+      uint8x16_t c   = vceqq_u8(
+            vld1q_u8((const uint8_t*)a), vld1q_u8((const uint8_t*)b));
+      uint64x2_t c64 = vreinterpretq_u64_u8(c);
+
+      /* Something has changed somewhere in these 8 words,
+       * the scalar loop below pinpoints it. */
+      if ((vgetq_lane_u64(c64, 0) & vgetq_lane_u64(c64, 1))
+            != (uint64_t)-1)
+         break;
+
+      a += 8;
+      b += 8;
+   }
+
+   while (*a == *b)
+   {
+      a++;
+      b++;
+   }
+   return a - a_org;
 #else
    const uint16_t *a_org = a;
 #ifdef NO_UNALIGNED_MEM
@@ -185,6 +279,70 @@ static size_t find_same(const uint16_t *a, const uint16_t *b)
    return a - a_org;
 }
 
+/* Bounded variants of find_change()/find_same() for diffing a
+ * slice or a run of pages of the savestate. Those don't end on a
+ * sentinel, and scanning past the end would walk all the
+ * unchanged data behind them. */
+static size_t find_change_bounded(const uint16_t *a,
+      const uint16_t *b, size_t len)
+{
+   size_t i = 0;
+#if __AVX2__
+   for (; i + 16 <= len; i += 16)
+   {
+      __m256i v0    = _mm256_loadu_si256((const __m256i*)(a + i));
+      __m256i v1    = _mm256_loadu_si256((const __m256i*)(b + i));
+      uint32_t mask = (uint32_t)_mm256_movemask_epi8(
+            _mm256_cmpeq_epi8(v0, v1));
+
+      if (mask != 0xffffffffu)
+         return i + (compat_ctz(~mask) >> 1);
+   }
+#elif __SSE2__
+   for (; i + 8 <= len; i += 8)
+   {
+      __m128i v0    = _mm_loadu_si128((const __m128i*)(a + i));
+      __m128i v1    = _mm_loadu_si128((const __m128i*)(b + i));
+      uint32_t mask = _mm_movemask_epi8(_mm_cmpeq_epi8(v0, v1));
+
+      if (mask != 0xffff)
+         return i + (compat_ctz(~mask) >> 1);
+   }
+#elif defined(STATE_MANAGER_NEON)
+   for (; i + 8 <= len; i += 8)
+   {
+      uint8x16_t c   = vceqq_u8(
+            vld1q_u8((const uint8_t*)(a + i)),
+            vld1q_u8((const uint8_t*)(b + i)));
+      uint64x2_t c64 = vreinterpretq_u64_u8(c);
+
+      if ((vgetq_lane_u64(c64, 0) & vgetq_lane_u64(c64, 1))
+            != (uint64_t)-1)
+         break;
+   }
+#endif
+   while (i < len && a[i] == b[i])
+      i++;
+   return i;
+}
+
+static size_t find_same_bounded(const uint16_t *a,
+      const uint16_t *b, size_t len)
+{
+   size_t i = 0;
+
+   /* Same trade-off as find_same(): look for two identical
+    * words in a row, a lone one isn't worth a new block. */
+   while (i + 2 <= len && (a[i] != b[i] || a[i + 1] != b[i + 1]))
+      i += 2;
+
+   if (i + 2 > len)
+      return len;
+   if (i && a[i - 1] == b[i - 1])
+      i--;
+   return i;
+}
+
 /* Returns the maximum compressed size of a savestate.
  * It is very likely to compress to far less. */
 static size_t state_manager_raw_maxsize(size_t uncomp)
@@ -206,7 +364,8 @@ static size_t state_manager_raw_maxsize(size_t uncomp)
 static void *state_manager_raw_alloc(size_t len, uint16_t uniq)
 {
    size_t  len16 = (len + sizeof(uint16_t) - 1) & -sizeof(uint16_t);
-   uint16_t *ret = (uint16_t*)calloc(len16 + sizeof(uint16_t) * 4 + 16, 1);
+   uint16_t *ret = (uint16_t*)calloc(len16 + sizeof(uint16_t) * 4
+         + STATE_MANAGER_SCAN_PAD, 1);
 
    if (!ret)
       return NULL;
@@ -217,11 +376,10 @@ static void *state_manager_raw_alloc(size_t len, uint16_t uniq)
     * There is also a large amount of data that's the same, to stop
     * the other scan.
     *
-    * There is also some padding at the end. This is so we don't
-    * read outside the buffer end if we're reading in large blocks;
-    *
-    * It doesn't make any difference to us, but sacrificing 16 bytes to get
-    * Valgrind happy is worth it. */
+    * There is also some padding at the end. find_change() reads
+    * whole vectors until it hits the sentinel, and the last of
+    * them may start on the sentinel itself, so the padding must
+    * cover a full vector past it (STATE_MANAGER_SCAN_PAD). */
    ret[len16/sizeof(uint16_t) + 3] = uniq;
 
    return ret;
@@ -293,6 +451,209 @@ static size_t state_manager_raw_compress(const void *src,
    return (uint8_t*)(compressed16 + 3) - (uint8_t*)patch;
 }
 
+/* One slice of a savestate, diffed on its own (by a worker,
+ * if there's more than one). The slice patch has no terminator
+ * and its offsets are relative to 'old16';
+ * state_manager_raw_compress_chunked() stitches the slices
+ * back into one regular patch. */
+struct state_manager_chunk
+{
+   const uint16_t *old16;
+   const uint16_t *new16;
+   uint16_t *patch16;
+   /* Hashes of the STATE_MANAGER_PAGE16 sized pages of
+    * 'old16', replaced with those of 'new16'.
+    * NULL if dirty pages aren't tracked. */
+   uint64_t *pagehash;
+   /* Size of this slice */
+   size_t num16s;
+   /* uint16s written to 'patch16' */
+   size_t patch16s;
+   /* Position right after the last block of the patch,
+    * relative to the start of the slice */
+   size_t end16;
+   /* Whether 'pagehash' matches 'old16'; if not, the
+    * hashes are only computed and every page is diffed */
+   bool pagehash_valid;
+};
+
+/* Appends the changes between 'start' and 'end' to the patch */
+static void state_manager_raw_compress_range(
+      struct state_manager_chunk *chunk, size_t start, size_t end)
+{
+   const uint16_t  *old16 = chunk->old16;
+   const uint16_t  *new16 = chunk->new16;
+   uint16_t *compressed16 = chunk->patch16 + chunk->patch16s;
+   size_t             pos = start;
+
+   while (pos < end)
+   {
+      size_t i, changed, skip;
+
+      pos += find_change_bounded(old16 + pos, new16 + pos, end - pos);
+      if (pos >= end)
+         break;
+
+      for (skip = pos - chunk->end16; skip > UINT16_MAX; )
+      {
+         size_t big      = (skip > UINT32_MAX) ? UINT32_MAX : skip;
+         *compressed16++ = 0;
+         *compressed16++ = big;
+         *compressed16++ = big >> 16;
+         skip           -= big;
+      }
+
+      changed         = find_same_bounded(old16 + pos,
+            new16 + pos, end - pos);
+      if (changed > UINT16_MAX)
+         changed = UINT16_MAX;
+
+      *compressed16++ = changed;
+      *compressed16++ = skip;
+
+      for (i = 0; i < changed; i++)
+         compressed16[i] = old16[pos + i];
+
+      pos            += changed;
+      compressed16   += changed;
+      chunk->end16    = pos;
+   }
+
+   chunk->patch16s = compressed16 - chunk->patch16;
+}
+
+static void state_manager_raw_compress_chunk(void *data)
+{
+   size_t page, start, num_pages;
+   struct state_manager_chunk *chunk = (struct state_manager_chunk*)data;
+
+   chunk->patch16s = 0;
+   chunk->end16    = 0;
+
+   if (!chunk->pagehash)
+   {
+      state_manager_raw_compress_range(chunk, 0, chunk->num16s);
+      return;
+   }
+
+   /* Only diff runs of pages whose hash changed. A page
+    * that hashes the same is taken to be unchanged, which
+    * saves reading it from 'old16' at all. */
+   num_pages = (chunk->num16s + STATE_MANAGER_PAGE16 - 1)
+      / STATE_MANAGER_PAGE16;
+
+   for (page = 0, start = 0; page < num_pages; page++)
+   {
+      size_t pos   = page * STATE_MANAGER_PAGE16;
+      size_t len   = chunk->num16s - pos;
+      uint64_t old = chunk->pagehash[page];
+
+      if (len > STATE_MANAGER_PAGE16)
+         len       = STATE_MANAGER_PAGE16;
+
+      chunk->pagehash[page] = XXH3_64bits(chunk->new16 + pos,
+            len * sizeof(uint16_t));
+
+      if (chunk->pagehash_valid && chunk->pagehash[page] == old)
+      {
+         if (start < pos)
+            state_manager_raw_compress_range(chunk, start, pos);
+         start = pos + len;
+      }
+   }
+
+   if (start < chunk->num16s)
+      state_manager_raw_compress_range(chunk, start, chunk->num16s);
+}
+
+/*
+ * Same as state_manager_raw_compress(), but the savestate is split
+ * into 'num_chunks' slices that are diffed in parallel on 'pool'
+ * (if not NULL); the calling thread takes the first slice itself,
+ * writing it straight to 'patch'.
+ * The resulting patch has the exact same format.
+ *
+ * 'patch' must be size 'state_manager_raw_maxsize(len)' plus
+ * STATE_MANAGER_CHUNK_SLACK16 uint16s per slice or more.
+ */
+static size_t state_manager_raw_compress_chunked(struct tpool *pool,
+      struct state_manager_chunk *chunks, unsigned num_chunks,
+      bool pagehash_valid,
+      const void *src, const void *dst, size_t len, void *patch)
+{
+   unsigned i;
+   const uint16_t  *old16 = (const uint16_t*)src;
+   const uint16_t  *new16 = (const uint16_t*)dst;
+   uint16_t *compressed16 = (uint16_t*)patch;
+   size_t          num16s = (len + sizeof(uint16_t) - 1)
+      / sizeof(uint16_t);
+   size_t       per_chunk = STATE_MANAGER_CHUNK16(num16s, num_chunks);
+   size_t             pos;
+
+   chunks[0].patch16 = compressed16;
+
+   for (i = 0; i < num_chunks; i++)
+   {
+      chunks[i].old16          = old16 + i * per_chunk;
+      chunks[i].new16          = new16 + i * per_chunk;
+      chunks[i].num16s         = (i == num_chunks - 1)
+         ? num16s - i * per_chunk
+         : per_chunk;
+      chunks[i].pagehash_valid = pagehash_valid;
+   }
+
+   for (i = 1; i < num_chunks; i++)
+   {
+#ifdef HAVE_THREADS
+      if (pool && tpool_add_work(pool, state_manager_raw_compress_chunk,
+               &chunks[i]))
+         continue;
+#endif
+      state_manager_raw_compress_chunk(&chunks[i]);
+   }
+   state_manager_raw_compress_chunk(&chunks[0]);
+#ifdef HAVE_THREADS
+   if (pool)
+      tpool_wait(pool);
+#endif
+
+   /* The first slice is already in place */
+   compressed16 += chunks[0].patch16s;
+   pos           = chunks[0].end16;
+
+   for (i = 1; i < num_chunks; i++)
+   {
+      size_t j;
+      size_t gap;
+
+      if (!chunks[i].patch16s)
+         continue;
+
+      /* Walk from the end of the previous slice's
+       * last block to the start of this slice. */
+      for (gap = i * per_chunk - pos; gap; )
+      {
+         size_t skip     = (gap > UINT32_MAX) ? UINT32_MAX : gap;
+         *compressed16++ = 0;
+         *compressed16++ = skip;
+         *compressed16++ = skip >> 16;
+         gap            -= skip;
+      }
+
+      for (j = 0; j < chunks[i].patch16s; j++)
+         compressed16[j] = chunks[i].patch16[j];
+
+      compressed16 += chunks[i].patch16s;
+      pos           = i * per_chunk + chunks[i].end16;
+   }
+
+   compressed16[0]  = 0;
+   compressed16[1]  = 0;
+   compressed16[2]  = 0;
+
+   return (uint8_t*)(compressed16 + 3) - (uint8_t*)patch;
+}
+
 /*
  * Takes 'patch' from a previous call to 'state_manager_raw_compress'
  * and applies it to 'data' ('src' from that call),
@@ -340,6 +701,35 @@ static void state_manager_raw_decompress(const void *patch,
    }
 }
 
+#ifdef HAVE_ZLIB
+/*
+ * Returns the size in bytes of a patch from state_manager_raw_compress(),
+ * terminator included.
+ */
+static size_t state_manager_raw_patchsize(const void *patch)
+{
+   const uint16_t *patch16 = (const uint16_t*)patch;
+
+   for (;;)
+   {
+      uint16_t numchanged  = *(patch16++);
+
+      if (numchanged)
+         patch16 += numchanged + 1;
+      else
+      {
+         uint32_t numunchanged = patch16[0] | (patch16[1] << 16);
+
+         patch16 += 2;
+         if (!numunchanged)
+            break;
+      }
+   }
+
+   return (const uint8_t*)patch16 - (const uint8_t*)patch;
+}
+#endif
+
 /* The start offsets point to 'nextstart' of any given compressed frame.
  * Each uint16 is stored native endian; anything that claims any other
  * endianness refers to the endianness of this specific item.
@@ -375,6 +765,323 @@ static INLINE size_t read_size_t(const void *ptr)
    return ret;
 }
 
+#ifdef HAVE_ZLIB
+/* Compressed history tier.
+ *
+ * Patches that fall off the tail of the ring buffer are not
+ * discarded but appended to 'acc' as [size_t len][patch] records,
+ * oldest first. Once 'acc' is full it is deflated into a segment
+ * (on a worker thread if we have them), and segments are kept
+ * oldest first until 'capacity' compressed bytes are used up.
+ *
+ * When rewinding empties the ring buffer, the newest cold patches
+ * (whatever is in 'acc', otherwise the newest segment, inflated)
+ * are moved back into the ring buffer. */
+#ifdef HAVE_THREADS
+/* Plenty of time to get it small on a worker */
+#define STATE_MANAGER_COLD_LEVEL 6
+#else
+#define STATE_MANAGER_COLD_LEVEL 1
+#endif
+
+struct state_manager_segment
+{
+   uint8_t *data;
+   size_t size;
+   /* Size once inflated, 0 if 'data' is stored as-is */
+   size_t rawsize;
+};
+
+struct state_manager_cold
+{
+   struct state_manager_segment *segments;
+   uint8_t *acc;
+   void *deflate_stream;
+   void *inflate_stream;
+#ifdef HAVE_THREADS
+   tpool_t *pool;
+   /* Segment being deflated on 'pool' */
+   uint8_t *jobdata;
+   size_t jobsize;
+   struct state_manager_segment job;
+#endif
+   size_t acc_size;
+   size_t acc_capacity;
+   size_t num_segments;
+   size_t cap_segments;
+   /* Bytes held by 'segments' */
+   size_t bytes;
+   size_t capacity;
+#ifdef HAVE_THREADS
+   bool job_pending;
+#endif
+};
+
+static void state_manager_cold_free(struct state_manager_cold *cold)
+{
+   size_t i;
+   const struct trans_stream_backend *backend =
+      trans_stream_get_zlib_deflate_backend();
+
+#ifdef HAVE_THREADS
+   /* Wait for the worker before pulling the stream from under it */
+   if (cold->pool)
+      tpool_destroy(cold->pool);
+   if (cold->jobdata)
+      free(cold->jobdata);
+   if (cold->job.data)
+      free(cold->job.data);
+#endif
+   for (i = 0; i < cold->num_segments; i++)
+      free(cold->segments[i].data);
+   if (cold->segments)
+      free(cold->segments);
+   if (cold->acc)
+      free(cold->acc);
+   if (cold->deflate_stream)
+      backend->stream_free(cold->deflate_stream);
+   if (cold->inflate_stream)
+      backend->reverse->stream_free(cold->inflate_stream);
+   free(cold);
+}
+
+static struct state_manager_cold *state_manager_cold_new(
+      size_t segment_size, size_t capacity)
+{
+   const struct trans_stream_backend *backend =
+      trans_stream_get_zlib_deflate_backend();
+   struct state_manager_cold *cold = (struct state_manager_cold*)
+      calloc(1, sizeof(*cold));
+
+   if (!cold)
+      return NULL;
+
+   cold->acc_capacity   = segment_size;
+   cold->capacity       = capacity;
+   cold->acc            = (uint8_t*)malloc(segment_size);
+   cold->deflate_stream = backend->stream_new();
+   cold->inflate_stream = backend->reverse->stream_new();
+
+   if (!cold->acc || !cold->deflate_stream || !cold->inflate_stream)
+      goto error;
+
+#ifdef HAVE_THREADS
+   cold->jobdata        = (uint8_t*)malloc(segment_size);
+   cold->pool           = tpool_create(1);
+   if (!cold->jobdata || !cold->pool)
+      goto error;
+#endif
+   backend->define(cold->deflate_stream, "level", STATE_MANAGER_COLD_LEVEL);
+
+   return cold;
+
+error:
+   state_manager_cold_free(cold);
+   return NULL;
+}
+
+/* Deflates 'len' bytes of 'in' into 'seg'. If the data
+ * doesn't shrink, it's kept as-is. Safe to run on a worker. */
+static void state_manager_cold_deflate(struct state_manager_cold *cold,
+      const uint8_t *in, size_t len, struct state_manager_segment *seg)
+{
+   uint32_t rd, wn;
+   enum trans_stream_error err;
+   const struct trans_stream_backend *backend =
+      trans_stream_get_zlib_deflate_backend();
+   uint8_t *out = (uint8_t*)malloc(len);
+
+   seg->data    = NULL;
+   seg->size    = 0;
+   seg->rawsize = 0;
+
+   if (!out)
+      return;
+
+   if (cold->deflate_stream)
+   {
+      backend->set_in(cold->deflate_stream, in, (uint32_t)len);
+      backend->set_out(cold->deflate_stream, out, (uint32_t)len);
+
+      if (     backend->trans(cold->deflate_stream, true, &rd, &wn, &err)
+            && err == TRANS_STREAM_ERROR_NONE)
+      {
+         uint8_t *shrunk = (uint8_t*)realloc(out, wn);
+         seg->data       = shrunk ? shrunk : out;
+         seg->size       = wn;
+         seg->rawsize    = len;
+         return;
+      }
+
+      /* Didn't shrink, start over with a fresh stream next time */
+      backend->stream_free(cold->deflate_stream);
+      if ((cold->deflate_stream = backend->stream_new()))
+         backend->define(cold->deflate_stream, "level",
+               STATE_MANAGER_COLD_LEVEL);
+   }
+
+   memcpy(out, in, len);
+   seg->data = out;
+   seg->size = len;
+}
+
+#ifdef HAVE_THREADS
+static void state_manager_cold_job(void *data)
+{
+   struct state_manager_cold *cold = (struct state_manager_cold*)data;
+   state_manager_cold_deflate(cold, cold->jobdata, cold->jobsize, &cold->job);
+}
+#endif
+
+static void state_manager_cold_append(struct state_manager_cold *cold,
+      struct state_manager_segment *seg)
+{
+   if (!seg->data)
+      return;
+
+   if (cold->num_segments == cold->cap_segments)
+   {
+      size_t cap = cold->cap_segments ? cold->cap_segments * 2 : 16;
+      struct state_manager_segment *segments =
+         (struct state_manager_segment*)realloc(cold->segments,
+               cap * sizeof(*segments));
+
+      if (!segments)
+      {
+         free(seg->data);
+         seg->data = NULL;
+         return;
+      }
+      cold->segments     = segments;
+      cold->cap_segments = cap;
+   }
+
+   cold->segments[cold->num_segments++] = *seg;
+   cold->bytes                         += seg->size;
+   seg->data                            = NULL;
+
+   /* Forget the oldest history once over budget */
+   while (cold->bytes > cold->capacity && cold->num_segments > 1)
+   {
+      cold->bytes -= cold->segments[0].size;
+      free(cold->segments[0].data);
+      memmove(cold->segments, cold->segments + 1,
+            --cold->num_segments * sizeof(*cold->segments));
+   }
+}
+
+#ifdef HAVE_THREADS
+static void state_manager_cold_collect(struct state_manager_cold *cold)
+{
+   if (!cold->job_pending)
+      return;
+   tpool_wait(cold->pool);
+   cold->job_pending = false;
+   state_manager_cold_append(cold, &cold->job);
+}
+#endif
+
+static void state_manager_cold_flush(struct state_manager_cold *cold)
+{
+   if (!cold->acc_size)
+      return;
+
+#ifdef HAVE_THREADS
+   {
+      uint8_t *swap;
+
+      /* Normally long done, 'acc' takes many frames to fill up */
+      state_manager_cold_collect(cold);
+
+      swap              = cold->jobdata;
+      cold->jobdata     = cold->acc;
+      cold->jobsize     = cold->acc_size;
+      cold->acc         = swap;
+      cold->acc_size    = 0;
+
+      if (tpool_add_work(cold->pool, state_manager_cold_job, cold))
+      {
+         cold->job_pending = true;
+         return;
+      }
+      state_manager_cold_job(cold);
+      state_manager_cold_append(cold, &cold->job);
+   }
+#else
+   {
+      struct state_manager_segment seg;
+      state_manager_cold_deflate(cold, cold->acc, cold->acc_size, &seg);
+      state_manager_cold_append(cold, &seg);
+      cold->acc_size = 0;
+   }
+#endif
+}
+
+static void state_manager_cold_store(struct state_manager_cold *cold,
+      const uint8_t *patch, size_t len)
+{
+   if (cold->acc_size + sizeof(size_t) + len > cold->acc_capacity)
+      state_manager_cold_flush(cold);
+
+   write_size_t(cold->acc + cold->acc_size, len);
+   memcpy(cold->acc + cold->acc_size + sizeof(size_t), patch, len);
+   cold->acc_size += sizeof(size_t) + len;
+}
+
+/* Makes 'acc' hold the newest cold patches.
+ * Returns false if there's no history left. */
+static bool state_manager_cold_take(struct state_manager_cold *cold)
+{
+   struct state_manager_segment *seg;
+
+   if (cold->acc_size)
+      return true;
+
+#ifdef HAVE_THREADS
+   state_manager_cold_collect(cold);
+#endif
+
+   if (!cold->num_segments)
+      return false;
+
+   seg = &cold->segments[cold->num_segments - 1];
+
+   if (seg->rawsize && cold->inflate_stream)
+   {
+      uint32_t rd, wn;
+      enum trans_stream_error err;
+      const struct trans_stream_backend *backend =
+         trans_stream_get_zlib_inflate_backend();
+
+      backend->set_in(cold->inflate_stream, seg->data, (uint32_t)seg->size);
+      backend->set_out(cold->inflate_stream, cold->acc,
+            (uint32_t)cold->acc_capacity);
+
+      if (     backend->trans(cold->inflate_stream, true, &rd, &wn, &err)
+            && err == TRANS_STREAM_ERROR_NONE
+            && wn == seg->rawsize)
+         cold->acc_size = wn;
+      else
+      {
+         RARCH_ERR("[Rewind]: Failed to inflate rewind history.\n");
+         backend->stream_free(cold->inflate_stream);
+         cold->inflate_stream = backend->stream_new();
+      }
+   }
+   else if (!seg->rawsize)
+   {
+      memcpy(cold->acc, seg->data, seg->size);
+      cold->acc_size = seg->size;
+   }
+
+   cold->bytes -= seg->size;
+   free(seg->data);
+   cold->num_segments--;
+
+   return cold->acc_size != 0;
+}
+#endif
+
 static void state_manager_free(state_manager_t *state)
 {
    if (!state)
@@ -391,15 +1098,126 @@ static void state_manager_free(state_manager_t *state)
       free(state->debugblock);
    state->debugblock = NULL;
 #endif
+#ifdef HAVE_THREADS
+   if (state->pool)
+      tpool_destroy(state->pool);
+#endif
+   if (state->chunks)
+      free(state->chunks);
+   if (state->chunkdata)
+      free(state->chunkdata);
+   if (state->pagehash)
+      free(state->pagehash);
+   state->pool       = NULL;
+   state->chunks     = NULL;
+   state->chunkdata  = NULL;
+   state->pagehash   = NULL;
+#ifdef HAVE_ZLIB
+   if (state->cold)
+      state_manager_cold_free(state->cold);
+   state->cold       = NULL;
+#endif
+   if (state->keyframes)
+      free(state->keyframes);
+   if (state->keyframedata)
+      free(state->keyframedata);
+   state->keyframes    = NULL;
+   state->keyframedata = NULL;
    state->data       = NULL;
    state->thisblock  = NULL;
    state->nextblock  = NULL;
 }
 
+static void state_manager_init_chunks(state_manager_t *state,
+      unsigned threads, bool dirty_pages)
+{
+   unsigned i;
+   size_t per_chunk, chunk16s, chunk_patch16s;
+   size_t num16s       = state->blocksize / sizeof(uint16_t);
+   unsigned num_chunks = 1;
+
+#ifdef HAVE_THREADS
+   num_chunks          = (unsigned)(num16s / STATE_MANAGER_MIN_CHUNK16);
+   if (num_chunks > threads)
+      num_chunks = threads;
+   if (num_chunks < 1)
+      num_chunks = 1;
+#endif
+   if (num_chunks < 2 && !dirty_pages)
+      return;
+
+   per_chunk       = STATE_MANAGER_CHUNK16(num16s, num_chunks);
+   /* The last slice also takes the remainder */
+   chunk16s        = num16s - (num_chunks - 1) * per_chunk;
+   chunk_patch16s  = state_manager_raw_maxsize(
+         chunk16s * sizeof(uint16_t)) / sizeof(uint16_t)
+      + STATE_MANAGER_CHUNK_SLACK16;
+
+   state->chunks    = (struct state_manager_chunk*)
+      calloc(num_chunks, sizeof(*state->chunks));
+   /* The first slice is written straight to the ring buffer */
+   if (num_chunks > 1)
+      state->chunkdata = (uint16_t*)malloc(
+            (num_chunks - 1) * chunk_patch16s * sizeof(uint16_t));
+   if (dirty_pages)
+      state->pagehash  = (uint64_t*)calloc(
+            (num16s + STATE_MANAGER_PAGE16 - 1) / STATE_MANAGER_PAGE16,
+            sizeof(uint64_t));
+#ifdef HAVE_THREADS
+   /* The main thread diffs the first slice itself */
+   if (num_chunks > 1)
+      state->pool      = tpool_create(num_chunks - 1);
+#endif
+
+   if (     !state->chunks
+         || (num_chunks > 1 && (!state->chunkdata || !state->pool))
+         || (dirty_pages && !state->pagehash))
+   {
+      RARCH_WARN("[Rewind]: Failed to set up savestate slices, "
+            "diffing the whole state on the main thread.\n");
+#ifdef HAVE_THREADS
+      if (state->pool)
+         tpool_destroy(state->pool);
+#endif
+      if (state->chunks)
+         free(state->chunks);
+      if (state->chunkdata)
+         free(state->chunkdata);
+      if (state->pagehash)
+         free(state->pagehash);
+      state->pool      = NULL;
+      state->chunks    = NULL;
+      state->chunkdata = NULL;
+      state->pagehash  = NULL;
+      return;
+   }
+
+   for (i = 1; i < num_chunks; i++)
+      state->chunks[i].patch16  = state->chunkdata
+         + (i - 1) * chunk_patch16s;
+   if (state->pagehash)
+      for (i = 0; i < num_chunks; i++)
+         state->chunks[i].pagehash = state->pagehash
+            + i * per_chunk / STATE_MANAGER_PAGE16;
+
+   state->num_chunks   = num_chunks;
+   state->maxcompsize += num_chunks
+      * STATE_MANAGER_CHUNK_SLACK16 * sizeof(uint16_t);
+
+   if (num_chunks > 1)
+      RARCH_LOG("[Rewind]: Diffing savestates in %u slices.\n", num_chunks);
+   if (state->pagehash)
+      RARCH_LOG("[Rewind]: Tracking dirty savestate pages.\n");
+}
+
 static state_manager_t *state_manager_new(
-      size_t state_size, size_t buffer_size)
+      size_t state_size, size_t buffer_size, unsigned threads,
+      bool compress, bool dirty_pages)
 {
    size_t max_comp_size, block_size;
+#ifdef HAVE_ZLIB
+   struct state_manager_cold *cold = NULL;
+#endif
    uint8_t *next_block    = NULL;
    uint8_t *this_block    = NULL;
    uint8_t *state_data    = NULL;
@@ -411,6 +1229,45 @@ static state_manager_t *state_manager_new(
    block_size         = (state_size + sizeof(uint16_t) - 1) & -sizeof(uint16_t);
    /* the compressed data is surrounded by pointers to the other side */
    max_comp_size      = state_manager_raw_maxsize(state_size) + sizeof(size_t) * 2;
+
+   state->max_keyframes = (unsigned)((buffer_size / 8) / block_size);
+   if (state->max_keyframes > STATE_MANAGER_MAX_KEYFRAMES)
+      state->max_keyframes = STATE_MANAGER_MAX_KEYFRAMES;
+   if (state->max_keyframes < 2)
+      state->max_keyframes = 0;
+   else
+   {
+      unsigned i;
+      state->keyframes    = (struct state_manager_keyframe*)calloc(
+            state->max_keyframes, sizeof(*state->keyframes));
+      state->keyframedata = (uint8_t*)malloc(
+            state->max_keyframes * block_size);
+      if (!state->keyframes || !state->keyframedata)
+         goto error;
+      for (i = 0; i < state->max_keyframes; i++)
+         state->keyframes[i].data = state->keyframedata + i * block_size;
+      buffer_size        -= state->max_keyframes * block_size;
+   }
+   state->keyframe_interval = STATE_MANAGER_KEYFRAME_INTERVAL;
+   state->tail_serial       = 1;
+
+#ifdef HAVE_ZLIB
+   /* A quarter of the budget stays raw for instant stepping,
+    * two 1/32 slices are segments being (de)compressed and
+    * the rest holds compressed segments. */
+   if (compress)
+   {
+      size_t ring_size    = buffer_size / 4;
+      size_t segment_size = buffer_size / 32;
+
+      if (segment_size < max_comp_size * 2)
+         RARCH_WARN("[Rewind]: Buffer too small to compress history.\n");
+      else if ((cold = state_manager_cold_new(segment_size,
+                  buffer_size - ring_size - segment_size * 2)))
+         buffer_size = ring_size;
+   }
+#endif
+
    state_data         = (uint8_t*)malloc(buffer_size);
 
    if (!state_data)
@@ -432,6 +1289,13 @@ static state_manager_t *state_manager_new(
    state->head        = state->data + sizeof(size_t);
    state->tail        = state->data + sizeof(size_t);
 
+#ifdef HAVE_ZLIB
+   state->cold        = cold;
+   cold               = NULL;
+#endif
+
+   state_manager_init_chunks(state, threads, dirty_pages);
+
 #if STRICT_BUF_SIZE
    state->debugsize   = state_size;
    state->debugblock  = (uint8_t*)malloc(state_size);
@@ -442,12 +1306,140 @@ static state_manager_t *state_manager_new(
 error:
    if (state_data)
       free(state_data);
+#ifdef HAVE_ZLIB
+   if (cold)
+      state_manager_cold_free(cold);
+#endif
    state_manager_free(state);
    free(state);
 
    return NULL;
 }
 
+/* Drops the oldest patch from the ring buffer,
+ * handing it to the compressed tier if there is one. */
+static void state_manager_discard_tail(state_manager_t *state)
+{
+   size_t next = read_size_t(state->tail);
+#ifdef HAVE_ZLIB
+   if (state->cold)
+   {
+      const uint8_t *patch = state->tail + sizeof(size_t);
+      state_manager_cold_store(state->cold, patch,
+            state_manager_raw_patchsize(patch));
+   }
+#endif
+   state->tail = state->data + next;
+   state->tail_serial++;
+}
+
+/* Links a patch that was written at head + sizeof(size_t)
+ * and ends right before 'compressed' into the ring buffer. */
+static void state_manager_link_entry(state_manager_t *state,
+      uint8_t *compressed)
+{
+   if (compressed - state->data + state->maxcompsize > state->capacity)
+   {
+      compressed     = state->data;
+      if (state->tail == state->data + sizeof(size_t))
+         state_manager_discard_tail(state);
+   }
+   write_size_t(compressed, state->head-state->data);
+   compressed       += sizeof(size_t);
+   write_size_t(state->head, compressed-state->data);
+   state->head       = compressed;
+}
+
+#ifdef HAVE_ZLIB
+/* Moves the newest compressed history back into
+ * the (empty) ring buffer. */
+static bool state_manager_refill(state_manager_t *state)
+{
+   size_t pos                      = 0;
+   size_t count                    = 0;
+   struct state_manager_cold *cold = state->cold;
+
+   if (!cold || !state_manager_cold_take(cold))
+      return false;
+
+   state->head = state->data + sizeof(size_t);
+   state->tail = state->data + sizeof(size_t);
+
+   while (pos < cold->acc_size)
+   {
+      size_t len = read_size_t(cold->acc + pos);
+
+      pos       += sizeof(size_t);
+      memcpy(state->head + sizeof(size_t), cold->acc + pos, len);
+      state_manager_link_entry(state, state->head + sizeof(size_t) + len);
+      state->entries++;
+      pos       += len;
+      count++;
+   }
+
+   cold->acc_size = 0;
+
+   /* Everything moved around */
+   state->num_keyframes = 0;
+   state->tail_serial   = state->serial + 1 - count;
+   return state->head != state->tail;
+}
+#endif
+
+/* Drops keyframes that are off the tail of the ring buffer or
+ * not on a multiple of 'interval', keeping the rest at the front
+ * in order without losing track of their buffers. */
+static void state_manager_keyframes_compact(state_manager_t *state,
+      size_t interval)
+{
+   unsigned i, j;
+
+   for (i = j = 0; i < state->num_keyframes; i++)
+   {
+      struct state_manager_keyframe kf = state->keyframes[i];
+
+      /* Fell off the tail of the ring buffer */
+      if (kf.serial + 1 < state->tail_serial)
+         continue;
+      if (kf.serial % interval)
+         continue;
+
+      state->keyframes[i] = state->keyframes[j];
+      state->keyframes[j] = kf;
+      j++;
+   }
+
+   state->num_keyframes = j;
+}
+
+static void state_manager_push_keyframe(state_manager_t *state)
+{
+   struct state_manager_keyframe *kf;
+
+   if (     !state->max_keyframes
+         || (state->serial % state->keyframe_interval))
+      return;
+
+   if (state->num_keyframes == state->max_keyframes)
+   {
+      state_manager_keyframes_compact(state, state->keyframe_interval);
+
+      /* Still full, thin them out */
+      if (state->num_keyframes == state->max_keyframes)
+      {
+         state->keyframe_interval *= 2;
+         state_manager_keyframes_compact(state, state->keyframe_interval);
+         if (state->serial % state->keyframe_interval)
+            return;
+      }
+   }
+
+   kf         = &state->keyframes[state->num_keyframes++];
+   kf->serial = state->serial;
+   kf->head   = state->head - state->data;
+   memcpy(kf->data, state->thisblock, state->blocksize);
+}
+
 static bool state_manager_pop(state_manager_t *state, const void **data)
 {
    size_t start;
@@ -466,7 +1458,12 @@ static bool state_manager_pop(state_manager_t *state, const void **data)
 
    *data                        = state->thisblock;
    if (state->head == state->tail)
-      return false;
+   {
+#ifdef HAVE_ZLIB
+      if (!state_manager_refill(state))
+#endif
+         return false;
+   }
 
    start                        = read_size_t(state->head - sizeof(size_t));
    state->head                  = state->data + start;
@@ -475,11 +1472,83 @@ static bool state_manager_pop(state_manager_t *state, const void **data)
 
    state_manager_raw_decompress(compressed,
          state->maxcompsize, out, state->blocksize);
+   state->pagehash_valid        = false;
+
+   state->serial--;
+   /* Keyframes past this point are about to be overwritten */
+   while (     state->num_keyframes
+         && state->keyframes[state->num_keyframes - 1].serial > state->serial)
+      state->num_keyframes--;
 
    state->entries--;
    return true;
 }
 
+/*
+ * Same as calling state_manager_pop() 'steps' times,
+ * but starting from the closest keyframe.
+ */
+static bool state_manager_seek_do(state_manager_t *state,
+      size_t steps, const void **data)
+{
+   unsigned i;
+   size_t target;
+   const struct state_manager_keyframe *best = NULL;
+
+   *data = state->thisblock;
+
+   if (!steps)
+      return false;
+
+   /* The first pop only hands out thisblock */
+   if (state->thisblock_valid)
+   {
+      state->thisblock_valid = false;
+      state->entries--;
+      steps--;
+   }
+   else if (state->head == state->tail
+#ifdef HAVE_ZLIB
+         && !state->cold
+#endif
+         )
+      return false;
+
+   target = (steps > state->serial) ? 0 : state->serial - steps;
+
+   for (i = 0; i < state->num_keyframes; i++)
+   {
+      const struct state_manager_keyframe *kf = &state->keyframes[i];
+
+      if (     kf->serial >= target
+            && kf->serial <  state->serial
+            && kf->serial + 1 >= state->tail_serial)
+      {
+         best = kf;
+         break;
+      }
+   }
+
+   if (best)
+   {
+      state->entries       -= (unsigned)(state->serial - best->serial);
+      state->serial         = best->serial;
+      state->head           = state->data + best->head;
+      state->num_keyframes  = (unsigned)(best - state->keyframes) + 1;
+      memcpy(state->thisblock, best->data, state->blocksize);
+      state->pagehash_valid = false;
+   }
+
+   while (state->serial > target)
+   {
+      const void *ignored;
+      if (!state_manager_pop(state, &ignored))
+         break;
+   }
+
+   return true;
+}
+
 static void state_manager_push_where(state_manager_t *state, void **data)
 {
    /* We need to ensure we have an uncompressed copy of the last
@@ -528,7 +1597,7 @@ recheckcapacity:;
 
       if (remaining <= state->maxcompsize)
       {
-         state->tail = state->data + read_size_t(state->tail);
+         state_manager_discard_tail(state);
          state->entries--;
          goto recheckcapacity;
       }
@@ -537,28 +1606,36 @@ recheckcapacity:;
       newb              = state->nextblock;
       compressed        = state->head + sizeof(size_t);
 
-      compressed       += state_manager_raw_compress(oldb, newb,
-            state->blocksize, compressed);
+      if (state->chunks)
+         compressed    += state_manager_raw_compress_chunked(state->pool,
+               state->chunks, state->num_chunks, state->pagehash_valid,
+               oldb, newb, state->blocksize, compressed);
+      else
+         compressed    += state_manager_raw_compress(oldb, newb,
+               state->blocksize, compressed);
 
-      if (compressed - state->data + state->maxcompsize > state->capacity)
-      {
-         compressed     = state->data;
-         if (state->tail == state->data + sizeof(size_t))
-            state->tail = state->data + read_size_t(state->tail);
-      }
-      write_size_t(compressed, state->head-state->data);
-      compressed       += sizeof(size_t);
-      write_size_t(state->head, compressed-state->data);
-      state->head       = compressed;
+      state_manager_link_entry(state, compressed);
+      state->serial++;
+      state->pagehash_valid = !!state->pagehash;
    }
    else
+   {
+      state->pagehash_valid  = false;
+      /* Replaces the state in thisblock, so does its keyframe */
+      while (     state->num_keyframes
+            && state->keyframes[state->num_keyframes - 1].serial
+               >= state->serial)
+         state->num_keyframes--;
       state->thisblock_valid = true;
+   }
 
    swap                      = state->thisblock;
    state->thisblock          = state->nextblock;
    state->nextblock          = swap;
 
    state->entries++;
+
+   state_manager_push_keyframe(state);
 }
 
 #if 0
@@ -581,7 +1658,8 @@ static void state_manager_capacity(state_manager_t *state,
 
 void state_manager_event_init(
       struct state_manager_rewind_state *rewind_st,
-      unsigned rewind_buffer_size)
+      unsigned rewind_buffer_size, unsigned rewind_threads,
+      bool rewind_compress, bool rewind_dirty_pages)
 {
    core_info_t *core_info = NULL;
    void *state            = NULL;
@@ -634,7 +1712,8 @@ void state_manager_event_init(
          (unsigned)(rewind_buffer_size / 1000000));
 
    rewind_st->state = state_manager_new(rewind_st->size,
-         rewind_buffer_size);
+         rewind_buffer_size, rewind_threads, rewind_compress,
+         rewind_dirty_pages);
 
    if (!rewind_st->state)
       RARCH_WARN("%s.\n", msg_hash_to_str(MSG_REWIND_INIT_FAILED));
@@ -687,6 +1766,68 @@ void state_manager_event_deinit(
    }
 }
 
+/* Loads a state taken from the rewind history into the core
+ * and marks the coming frame as reversed. The next call to
+ * state_manager_check_rewind() plays back the reversed audio
+ * and, unless rewind is still held, tells netplay that it may
+ * resync. 'was_reversed' is set if the previous frame already
+ * was a reversed one, netplay is desynced then already.
+ *
+ * Returns false if netplay does not allow going back. */
+static bool state_manager_rewind_load(
+      struct state_manager_rewind_state *rewind_st,
+      const void *buf, bool was_reversed)
+{
+#ifdef HAVE_NETWORKING
+   /* Make sure netplay isn't confused */
+   if (!was_reversed
+         && !netplay_driver_ctl(RARCH_NETPLAY_CTL_DESYNC_PUSH, NULL))
+      return false;
+#endif
+
+   rewind_st->flags |= STATE_MGR_REWIND_ST_FLAG_FRAME_IS_REVERSED;
+
+   audio_driver_setup_rewind();
+
+   content_deserialize_state(buf, rewind_st->size);
+
+#ifdef HAVE_BSV_MOVIE
+   bsv_movie_frame_rewind();
+#endif
+
+   return true;
+}
+
+bool state_manager_seek(struct state_manager_rewind_state *rewind_st,
+      unsigned steps)
+{
+   const void *buf = NULL;
+
+   if (!rewind_st || !rewind_st->state)
+      return false;
+
+#ifdef HAVE_BSV_MOVIE
+   /* Movies are rewound one frame at a time */
+   if (retroarch_ctl(RARCH_CTL_BSV_MOVIE_IS_INITED, NULL))
+      return false;
+#endif
+
+#ifdef HAVE_NETWORKING
+   /* Ask before walking the history, so that it is not
+    * consumed when state_manager_rewind_load() gets refused */
+   if (     !(rewind_st->flags & STATE_MGR_REWIND_ST_FLAG_FRAME_IS_REVERSED)
+         && !netplay_driver_ctl(RARCH_NETPLAY_CTL_ALLOW_TIMESKIP, NULL))
+      return false;
+#endif
+
+   if (!state_manager_seek_do(rewind_st->state, steps, &buf))
+      return false;
+
+   return state_manager_rewind_load(rewind_st, buf,
+         (rewind_st->flags & STATE_MGR_REWIND_ST_FLAG_FRAME_IS_REVERSED)
+         ? true : false);
+}
+
 /**
  * check_rewind:
  * @pressed              : was rewind key pressed or held?
@@ -747,27 +1888,13 @@ bool state_manager_check_rewind(
 
       if (state_manager_pop(rewind_st->state, &buf))
       {
-#ifdef HAVE_NETWORKING
-         /* Make sure netplay isn't confused */
-         if (!was_reversed
-               && !netplay_driver_ctl(RARCH_NETPLAY_CTL_DESYNC_PUSH, NULL))
+         if (!state_manager_rewind_load(rewind_st, buf, was_reversed))
             return false;
-#endif
-
-         rewind_st->flags |= STATE_MGR_REWIND_ST_FLAG_FRAME_IS_REVERSED;
-
-         audio_driver_setup_rewind();
 
          strlcpy(s, msg_hash_to_str(MSG_REWINDING), len);
 
          *time                  = is_paused ? 1 : 30;
          ret                    = true;
-
-         content_deserialize_state(buf, rewind_st->size);
-
-#ifdef HAVE_BSV_MOVIE
-         bsv_movie_frame_rewind();
-#endif
       }
       else
       {
@@ -36,6 +36,15 @@ enum state_manager_rewind_st_flags
    STATE_MGR_REWIND_ST_FLAG_HOTKEY_WAS_PRESSED    = (1 << 3)
 };
 
+struct state_manager_keyframe
+{
+   /* Full copy of the state */
+   uint8_t *data;
+   /* Offset of 'head' while this was the newest state */
+   size_t head;
+   size_t serial;
+};
+
 struct state_manager
 {
    uint8_t *data;
@@ -50,6 +59,25 @@ struct state_manager
    uint8_t *debugblock;
    size_t debugsize;
 #endif
+   /* Workers diffing slices of the state, NULL if
+    * the whole state is diffed on the main thread. */
+   struct tpool *pool;
+   /* Slices of the state, NULL if the state is diffed
+    * in one go without dirty page tracking. */
+   struct state_manager_chunk *chunks;
+   uint16_t *chunkdata;
+   /* Hash of each 4KB page of 'thisblock', NULL if
+    * dirty pages aren't tracked. */
+   uint64_t *pagehash;
+#ifdef HAVE_ZLIB
+   /* Compressed older history, NULL if disabled. */
+   struct state_manager_cold *cold;
+#endif
+   /* Full states at regular points in the history,
+    * oldest first, so seeking doesn't have to walk
+    * every patch in between. */
+   struct state_manager_keyframe *keyframes;
+   uint8_t *keyframedata;
 
    size_t capacity;
    /* This one is rounded up from reset::blocksize. */
@@ -59,8 +87,20 @@ struct state_manager
     * (yes, the math is a bit ugly). */
    size_t maxcompsize;
 
+   /* Number of the state in 'thisblock', counting pushes.
+    * Patch N turns state N into state N - 1. */
+   size_t serial;
+   /* Number of the oldest patch in the ring buffer */
+   size_t tail_serial;
+   /* Pushes between keyframes, doubles as history grows */
+   size_t keyframe_interval;
+
    unsigned entries;
+   unsigned num_keyframes;
+   unsigned max_keyframes;
+   unsigned num_chunks;
    bool thisblock_valid;
+   bool pagehash_valid;
 };
 
 typedef struct state_manager state_manager_t;
@@ -79,8 +119,22 @@ void state_manager_event_deinit(
       struct state_manager_rewind_state *rewind_st,
       struct retro_core_t *current_core);
 
+/**
+ * state_manager_event_init:
+ * @rewind_st            : rewind state.
+ * @rewind_buffer_size   : size of the rewind buffer, in bytes.
+ * @rewind_threads       : number of threads to diff savestates on.
+ *                         0 or 1 keeps everything on the main thread.
+ * @rewind_compress      : keep only the most recent part of the buffer
+ *                         raw and deflate older history.
+ * @rewind_dirty_pages   : hash savestates per page and only diff
+ *                         the pages that changed.
+ *
+ * Allocates the rewind buffer and pushes the initial state.
+ **/
 void state_manager_event_init(struct state_manager_rewind_state *rewind_st,
-      unsigned rewind_buffer_size);
+      unsigned rewind_buffer_size, unsigned rewind_threads,
+      bool rewind_compress, bool rewind_dirty_pages);
 
 /**
  * check_rewind:
@@ -95,6 +149,22 @@ bool state_manager_check_rewind(
       unsigned rewind_granularity, bool is_paused,
       char *s, size_t len, unsigned *time);
 
+/**
+ * state_manager_seek:
+ * @rewind_st            : rewind state.
+ * @steps                : number of rewind steps to go back.
+ *
+ * Jumps @steps entries back in the rewind history and loads
+ * the resulting state into the core. Same result as rewinding
+ * @steps times, but the history is walked from the nearest
+ * keyframe and the core only unserializes once. Netplay and
+ * the reversed audio are handled as for a single rewind frame.
+ *
+ * Returns: true if a state was loaded.
+ **/
+bool state_manager_seek(struct state_manager_rewind_state *rewind_st,
+      unsigned steps);
+
 RETRO_END_DECLS
 
 #endif
@@ -27,6 +27,10 @@
 #include <streams/file_stream.h>
 #include <streams/chd_stream.h>
 #include <streams/interface_stream.h>
+#include <features/features_cpu.h>
+#ifdef HAVE_THREADS
+#include <rthreads/rthreads.h>
+#endif
 #include "tasks_internal.h"
 
 #include "../core_info.h"
@@ -44,6 +48,40 @@
 #include "../verbosity.h"
 #include "task_database_cue.h"
 
+#ifdef HAVE_THREADS
+/* Number of content files ahead of the matcher whose
+ * CRC/serial are extracted on the helper threads */
+#define DATABASE_SCAN_WINDOW      32
+#define DATABASE_SCAN_MAX_THREADS 4
+
+typedef struct database_scan_job
+{
+   char *path;          /* NULL if the slot is free */
+   size_t index;        /* position in the content list */
+   uint32_t crc;
+   uint32_t archive_crc;
+   int ret;
+   enum database_type type;
+   bool running;
+   bool done;
+   char serial[4096];
+} database_scan_job_t;
+
+/* Extracts CRCs and serials on helper threads while the
+ * task handler matches them against the databases and
+ * writes playlists in content list order. */
+typedef struct database_scan
+{
+   database_scan_job_t jobs[DATABASE_SCAN_WINDOW];
+   sthread_t *threads[DATABASE_SCAN_MAX_THREADS];
+   slock_t *lock;
+   scond_t *cond;
+   size_t next_index;
+   unsigned thread_count;
+   bool quit;
+} database_scan_t;
+#endif
+
 typedef struct database_state_handle
 {
    database_info_list_t *info;
@@ -71,8 +109,13 @@ typedef struct db_handle
    char *content_database_path;
    char *fullpath;
    database_info_handle_t *handle;
+   database_info_index_t *index;
+#ifdef HAVE_THREADS
+   database_scan_t *scan;
+#endif
    database_state_handle_t state;
    playlist_config_t playlist_config; /* size_t alignment */
+   size_t index_ptr;
    unsigned status;
    uint8_t flags;
 } db_handle_t;
@@ -605,41 +648,48 @@ static enum msg_file_type extension_to_file_type(const char *ext)
    return FILE_TYPE_NONE;
 }
 
-static int task_database_iterate_playlist(
-      database_state_handle_t *db_state,
-      database_info_handle_t *db, const char *name)
+/**
+ * task_database_extract:
+ *
+ * Reads the serial and/or CRC of a content file and picks
+ * the lookup to match it with. Only touches its arguments,
+ * so it is safe to call from the scan helper threads.
+ **/
+static int task_database_extract(const char *name,
+      enum msg_file_type file_type,
+      enum database_type *type,
+      uint32_t *crc, uint32_t *archive_crc,
+      char *serial, size_t serial_len)
 {
-   switch (extension_to_file_type(path_get_extension(name)))
+   switch (file_type)
    {
       case FILE_TYPE_COMPRESSED:
 #ifdef HAVE_COMPRESSION
-         db->type = DATABASE_TYPE_CRC_LOOKUP;
+         *type = DATABASE_TYPE_CRC_LOOKUP;
          /* first check crc of archive itself */
          return intfstream_file_get_crc(name,
-               0, SIZE_MAX, &db_state->archive_crc);
+               0, SIZE_MAX, archive_crc);
 #else
          break;
 #endif
       case FILE_TYPE_CUE:
-         task_database_cue_prune(db, name);
-         db_state->serial[0] = '\0';
-         if (task_database_cue_get_serial(name, db_state->serial, sizeof(db_state->serial)))
-            db->type = DATABASE_TYPE_SERIAL_LOOKUP;
+         serial[0] = '\0';
+         if (task_database_cue_get_serial(name, serial, serial_len))
+            *type = DATABASE_TYPE_SERIAL_LOOKUP;
          else
          {
-            db->type = DATABASE_TYPE_CRC_LOOKUP;
-            return task_database_cue_get_crc(name, &db_state->crc);
+            *type = DATABASE_TYPE_CRC_LOOKUP;
+            return task_database_cue_get_crc(name, crc);
          }
          break;
       case FILE_TYPE_GDI:
-         gdi_prune(db, name);
-         db_state->serial[0] = '\0';
-         if (task_database_gdi_get_serial(name, db_state->serial, sizeof(db_state->serial)))
-            db->type = DATABASE_TYPE_SERIAL_LOOKUP;
+         serial[0] = '\0';
+         if (task_database_gdi_get_serial(name, serial, serial_len))
+            *type = DATABASE_TYPE_SERIAL_LOOKUP;
          else
          {
-            db->type = DATABASE_TYPE_CRC_LOOKUP;
-            return task_database_gdi_get_crc(name, &db_state->crc);
+            *type = DATABASE_TYPE_CRC_LOOKUP;
+            return task_database_gdi_get_crc(name, crc);
          }
          break;
       /* Consider WBFS, RVZ and WIA files similar to ISO files. */
@@ -647,32 +697,270 @@ static int task_database_iterate_playlist(
       case FILE_TYPE_RVZ:
       case FILE_TYPE_WIA:
       case FILE_TYPE_ISO:
-         db_state->serial[0] = '\0';
-         intfstream_file_get_serial(name, 0, SIZE_MAX, db_state->serial, sizeof(db_state->serial));
-         db->type            =  DATABASE_TYPE_SERIAL_LOOKUP;
+         serial[0] = '\0';
+         intfstream_file_get_serial(name, 0, SIZE_MAX, serial, serial_len);
+         *type     =  DATABASE_TYPE_SERIAL_LOOKUP;
          break;
       case FILE_TYPE_CHD:
-         db_state->serial[0] = '\0';
-         if (task_database_chd_get_serial(name, db_state->serial, sizeof(db_state->serial)))
-            db->type         = DATABASE_TYPE_SERIAL_LOOKUP;
+         serial[0] = '\0';
+         if (task_database_chd_get_serial(name, serial, serial_len))
+            *type  = DATABASE_TYPE_SERIAL_LOOKUP;
          else
          {
-            db->type         = DATABASE_TYPE_CRC_LOOKUP;
-            return task_database_chd_get_crc(name, &db_state->crc);
+            *type  = DATABASE_TYPE_CRC_LOOKUP;
+            return task_database_chd_get_crc(name, crc);
          }
          break;
       case FILE_TYPE_LUTRO:
-         db->type            = DATABASE_TYPE_ITERATE_LUTRO;
+         *type     = DATABASE_TYPE_ITERATE_LUTRO;
          break;
       default:
-         db_state->serial[0] = '\0';
-         db->type            = DATABASE_TYPE_CRC_LOOKUP;
-         return intfstream_file_get_crc(name, 0, SIZE_MAX, &db_state->crc);
+         serial[0] = '\0';
+         *type     = DATABASE_TYPE_CRC_LOOKUP;
+         return intfstream_file_get_crc(name, 0, SIZE_MAX, crc);
    }
 
    return 1;
 }
 
+/* Drops the track files a cue/gdi sheet refers to from the
+ * rest of the content list. Must run in list order. */
+static void task_database_prune(database_info_handle_t *db,
+      enum msg_file_type file_type, const char *name)
+{
+   if (file_type == FILE_TYPE_CUE)
+      task_database_cue_prune(db, name);
+   else if (file_type == FILE_TYPE_GDI)
+      gdi_prune(db, name);
+}
+
+static int task_database_iterate_playlist(
+      database_state_handle_t *db_state,
+      database_info_handle_t *db, const char *name)
+{
+   enum msg_file_type file_type =
+      extension_to_file_type(path_get_extension(name));
+
+   task_database_prune(db, file_type, name);
+
+   return task_database_extract(name, file_type, &db->type,
+         &db_state->crc, &db_state->archive_crc,
+         db_state->serial, sizeof(db_state->serial));
+}
+
+#ifdef HAVE_THREADS
+static void task_database_scan_thread(void *data)
+{
+   database_scan_t *scan = (database_scan_t*)data;
+
+   slock_lock(scan->lock);
+
+   while (!scan->quit)
+   {
+      size_t i;
+      database_scan_job_t *job = NULL;
+
+      /* Oldest pending file first, the matcher waits on it */
+      for (i = 0; i < DATABASE_SCAN_WINDOW; i++)
+      {
+         database_scan_job_t *j = &scan->jobs[i];
+         if (     j->path && !j->running && !j->done
+               && (!job || j->index < job->index))
+            job = j;
+      }
+
+      if (!job)
+      {
+         scond_wait(scan->cond, scan->lock);
+         continue;
+      }
+
+      job->running = true;
+      slock_unlock(scan->lock);
+
+      /* The slot is not touched by anyone else while running */
+      job->crc         = 0;
+      job->archive_crc = 0;
+      job->type        = DATABASE_TYPE_NONE;
+#ifdef HAVE_COMPRESSION
+      if (path_contains_compressed_file(job->path))
+      {
+         job->type     = DATABASE_TYPE_ITERATE_ARCHIVE;
+         job->crc      = file_archive_get_file_crc32(job->path);
+         job->ret      = 1;
+      }
+      else
+#endif
+         job->ret      = task_database_extract(job->path,
+               extension_to_file_type(path_get_extension(job->path)),
+               &job->type, &job->crc, &job->archive_crc,
+               job->serial, sizeof(job->serial));
+
+      slock_lock(scan->lock);
+      job->running = false;
+      job->done    = true;
+      scond_broadcast(scan->cond);
+   }
+
+   slock_unlock(scan->lock);
+}
+
+static void task_database_scan_free(database_scan_t *scan)
+{
+   unsigned i;
+
+   if (!scan)
+      return;
+
+   slock_lock(scan->lock);
+   scan->quit = true;
+   scond_broadcast(scan->cond);
+   slock_unlock(scan->lock);
+
+   for (i = 0; i < scan->thread_count; i++)
+      sthread_join(scan->threads[i]);
+
+   for (i = 0; i < DATABASE_SCAN_WINDOW; i++)
+      free(scan->jobs[i].path);
+
+   scond_free(scan->cond);
+   slock_free(scan->lock);
+   free(scan);
+}
+
+static database_scan_t *task_database_scan_new(void)
+{
+   unsigned i;
+   unsigned count        = cpu_features_get_core_amount();
+   database_scan_t *scan = (database_scan_t*)calloc(1, sizeof(*scan));
+
+   if (!scan)
+      return NULL;
+
+   /* Files mostly wait on storage, so use a few threads
+    * even on machines with a single core */
+   if (count < 2)
+      count = 2;
+   else if (count > DATABASE_SCAN_MAX_THREADS)
+      count = DATABASE_SCAN_MAX_THREADS;
+
+   scan->lock = slock_new();
+   scan->cond = scond_new();
+
+   if (!scan->lock || !scan->cond)
+      goto error;
+
+   for (i = 0; i < count; i++)
+   {
+      if (!(scan->threads[i] = sthread_create(
+            task_database_scan_thread, scan)))
+         break;
+      scan->thread_count++;
+   }
+
+   if (!scan->thread_count)
+      goto error;
+
+   return scan;
+
+error:
+   if (scan->cond)
+      scond_free(scan->cond);
+   if (scan->lock)
+      slock_free(scan->lock);
+   free(scan);
+   return NULL;
+}
+
+/* Queues the content files ahead of the current one,
+ * and frees jobs of files that have been passed. */
+static void task_database_scan_dispatch(database_scan_t *scan,
+      database_info_handle_t *db)
+{
+   bool queued = false;
+
+   slock_lock(scan->lock);
+
+   if (scan->next_index < db->list_ptr)
+      scan->next_index = db->list_ptr;
+
+   while (     scan->next_index < db->list->size
+            && scan->next_index < db->list_ptr + DATABASE_SCAN_WINDOW)
+   {
+      const char *name         = db->list->elems[scan->next_index].data;
+      database_scan_job_t *job = &scan->jobs[
+         scan->next_index % DATABASE_SCAN_WINDOW];
+
+      if (job->path)
+      {
+         /* Slot still holds a file the matcher has passed */
+         if (job->running)
+            break;
+         free(job->path);
+         job->path = NULL;
+      }
+
+      if (!string_is_empty(name))
+      {
+         job->path  = strdup(name);
+         job->index = scan->next_index;
+         job->done  = false;
+         queued     = true;
+      }
+
+      scan->next_index++;
+   }
+
+   if (queued)
+      scond_broadcast(scan->cond);
+
+   slock_unlock(scan->lock);
+}
+
+/**
+ * task_database_scan_take:
+ *
+ * Picks up the extraction result of the current file.
+ *
+ * @return 1 if @job was filled in, 0 if the file has to be
+ * read inline, -1 if it is still being extracted.
+ **/
+static int task_database_scan_take(database_scan_t *scan,
+      database_info_handle_t *db, const char *name,
+      database_scan_job_t *out)
+{
+   int ret                  = 0;
+   database_scan_job_t *job = &scan->jobs[db->list_ptr % DATABASE_SCAN_WINDOW];
+
+   slock_lock(scan->lock);
+
+   if (     job->path
+         && job->index == db->list_ptr
+         && string_is_equal(job->path, name))
+   {
+      /* Block a threaded task queue worker for a little while,
+       * but never the main thread */
+      if (!job->done && task_queue_is_threaded())
+         scond_wait_timeout(scan->cond, scan->lock, 20000);
+
+      if (job->done)
+      {
+         memcpy(out, job, sizeof(*out));
+         out->path = NULL;
+         free(job->path);
+         job->path = NULL;
+         ret       = 1;
+      }
+      else
+         ret       = -1;
+   }
+
+   slock_unlock(scan->lock);
+
+   return ret;
+}
+#endif
+
 static int database_info_list_iterate_end_no_match(
       database_info_handle_t *db,
       database_state_handle_t *db_state,
@@ -732,6 +1020,17 @@ static int database_info_list_iterate_end_no_match(
    return 0;
 }
 
+static void database_info_list_iterate_set(
+      database_state_handle_t *db_state, database_info_list_t *info)
+{
+   if (db_state->info)
+   {
+      database_info_list_free(db_state->info);
+      free(db_state->info);
+   }
+   db_state->info = info;
+}
+
 static int database_info_list_iterate_new(database_state_handle_t *db_state,
       const char *query)
 {
@@ -742,12 +1041,8 @@ static int database_info_list_iterate_new(database_state_handle_t *db_state,
          (unsigned)db_state->list_index,
          (unsigned)db_state->list->size, new_database);
 #endif
-   if (db_state->info)
-   {
-      database_info_list_free(db_state->info);
-      free(db_state->info);
-   }
-   db_state->info = database_info_list_new(new_database, query);
+   database_info_list_iterate_set(db_state,
+         database_info_list_new(new_database, query));
    return 0;
 }
 
@@ -953,6 +1248,23 @@ static int task_database_iterate_crc_lookup(
 
       query[0] = '\0';
 
+      /* Skip straight to the next database holding this CRC */
+      if (_db->index)
+      {
+         int rdb = database_info_index_find_crc(_db->index,
+               (unsigned)db_state->list_index,
+               db_state->crc, db_state->archive_crc);
+
+         if (rdb < 0)
+         {
+            db_state->list_index = db_state->list->size;
+            return database_info_list_iterate_end_no_match(db, db_state,
+                  name, path_contains_compressed_file);
+         }
+
+         db_state->list_index = rdb;
+      }
+
       if (!(_db->flags & DB_HANDLE_FLAG_SCAN_WITHOUT_CORE_MATCH))
       {
          /* don't scan files that can't be in this database.
@@ -972,11 +1284,26 @@ static int task_database_iterate_crc_lookup(
          }
       }
 
-      snprintf(query, sizeof(query),
-            "{crc:or(b\"%08lX\",b\"%08lX\")}",
-            (unsigned long)db_state->crc, (unsigned long)db_state->archive_crc);
+      if (_db->index)
+      {
+         database_info_list_iterate_set(db_state,
+               database_info_index_list_crc(_db->index,
+                  database_info_get_current_name(db_state),
+                  (unsigned)db_state->list_index,
+                  db_state->crc, db_state->archive_crc));
 
-      database_info_list_iterate_new(db_state, query);
+         if (!db_state->info)
+            return database_info_list_iterate_next(db_state);
+      }
+      else
+      {
+         snprintf(query, sizeof(query),
+               "{crc:or(b\"%08lX\",b\"%08lX\")}",
+               (unsigned long)db_state->crc,
+               (unsigned long)db_state->archive_crc);
+
+         database_info_list_iterate_new(db_state, query);
+      }
    }
 
    if (db_state->info)
@@ -1109,7 +1436,29 @@ static int task_database_iterate_serial_lookup(
       return database_info_list_iterate_end_no_match(db, db_state, name,
             path_contains_compressed_file);
 
-   if (db_state->entry_index == 0)
+   if (db_state->entry_index == 0 && _db->index)
+   {
+      /* Skip straight to the next database holding this serial */
+      int rdb = database_info_index_find_serial(_db->index,
+            (unsigned)db_state->list_index, db_state->serial);
+
+      if (rdb < 0)
+      {
+         db_state->list_index = db_state->list->size;
+         return database_info_list_iterate_end_no_match(db, db_state,
+               name, path_contains_compressed_file);
+      }
+
+      db_state->list_index = rdb;
+      database_info_list_iterate_set(db_state,
+            database_info_index_list_serial(_db->index,
+               database_info_get_current_name(db_state),
+               (unsigned)rdb, db_state->serial));
+
+      if (!db_state->info)
+         return database_info_list_iterate_next(db_state);
+   }
+   else if (db_state->entry_index == 0)
    {
       size_t _len;
       char query[50];
@@ -1315,6 +1664,32 @@ static void task_database_handler(retro_task_t *task)
                }
             }
          }
+         /* Scanning more than one file: read every database
+          * once up-front (one per iteration, so the task stays
+          * responsive) instead of once per scanned file. */
+         if (     !db->index
+               && dbstate->list
+               && dbstate->list->size > 0
+               && dbinfo->list
+               && dbinfo->list->size > 1)
+            db->index = database_info_index_new();
+
+         if (db->index && db->index_ptr < dbstate->list->size)
+         {
+            if (!database_info_index_add(db->index,
+                     dbstate->list->elems[db->index_ptr].data,
+                     (unsigned)db->index_ptr))
+               RARCH_WARN("[Scanner]: Failed to index \"%s\".\n",
+                     dbstate->list->elems[db->index_ptr].data);
+            db->index_ptr++;
+            task_set_progress(task,
+                  (int8_t)((db->index_ptr * 100) / dbstate->list->size));
+            break;
+         }
+#ifdef HAVE_THREADS
+         if (!db->scan && dbinfo->list && dbinfo->list->size > 1)
+            db->scan = task_database_scan_new();
+#endif
          dbinfo->status = DATABASE_STATUS_ITERATE_START;
          break;
       case DATABASE_STATUS_ITERATE_START:
@@ -1322,6 +1697,10 @@ static void task_database_handler(retro_task_t *task)
          task_database_cleanup_state(dbstate);
          dbstate->list_index  = 0;
          dbstate->entry_index = 0;
+#ifdef HAVE_THREADS
+         if (db->scan)
+            task_database_scan_dispatch(db->scan, dbinfo);
+#endif
          task_database_iterate_start(task, dbinfo, name);
          break;
       case DATABASE_STATUS_ITERATE:
@@ -1337,6 +1716,47 @@ static void task_database_handler(retro_task_t *task)
                if (dbinfo->type == DATABASE_TYPE_ITERATE)
                   dbinfo->type   = DATABASE_TYPE_ITERATE_ARCHIVE;
 
+#ifdef HAVE_THREADS
+            /* Use the CRC/serial read ahead by the helper threads */
+            if (     db->scan
+                  && (dbinfo->type == DATABASE_TYPE_ITERATE
+                     || (dbinfo->type == DATABASE_TYPE_ITERATE_ARCHIVE
+                        && !dbstate->crc
+                        && !dbstate->list_index
+                        && !dbstate->entry_index)))
+            {
+               database_scan_job_t job;
+               int ret = task_database_scan_take(db->scan, dbinfo, name, &job);
+
+               if (ret < 0)
+                  break;
+
+               if (ret > 0)
+               {
+                  if (dbinfo->type == DATABASE_TYPE_ITERATE_ARCHIVE)
+                     dbstate->crc = job.crc;
+                  else
+                  {
+                     task_database_prune(dbinfo,
+                           extension_to_file_type(path_get_extension(name)),
+                           name);
+                     dbinfo->type         = job.type;
+                     dbstate->crc         = job.crc;
+                     dbstate->archive_crc = job.archive_crc;
+                     strlcpy(dbstate->serial, job.serial,
+                           sizeof(dbstate->serial));
+
+                     if (!job.ret)
+                     {
+                        dbinfo->status = DATABASE_STATUS_ITERATE_NEXT;
+                        dbinfo->type   = DATABASE_TYPE_ITERATE;
+                     }
+                     break;
+                  }
+               }
+            }
+#endif
+
             if (task_database_iterate(db, name, dbstate, dbinfo,
                      path_contains_compressed_file) == 0)
             {
@@ -1394,6 +1814,10 @@ task_finished:
 
    if (db)
    {
+#ifdef HAVE_THREADS
+      task_database_scan_free(db->scan);
+#endif
+      database_info_index_free(db->index);
       if (!string_is_empty(db->playlist_directory))
          free(db->playlist_directory);
       if (!string_is_empty(db->content_database_path))
@@ -1439,6 +1863,7 @@ bool task_push_dbscan(
       goto error;
 
    t->handler                              = task_database_handler;
+   t->priority                             = TASK_PRIORITY_BACKGROUND;
    t->state                                = db;
    t->callback                             = cb;
    t->title                                = strdup(msg_hash_to_str(
@@ -1452,12 +1877,14 @@ bool task_push_dbscan(
    db->playlist_config.capacity            = COLLECTION_SIZE;
    db->playlist_config.old_format          = settings->bools.playlist_use_old_format;
    db->playlist_config.compress            = settings->bools.playlist_compression;
+   db->playlist_config.binary              = settings->bools.playlist_binary_format;
    db->playlist_config.fuzzy_archive_match = settings->bools.playlist_fuzzy_archive_match;
    playlist_config_set_base_content_directory(&db->playlist_config, settings->bools.playlist_portable_paths ? settings->paths.directory_menu_content : NULL);
 #else
    db->playlist_config.capacity            = COLLECTION_SIZE;
    db->playlist_config.old_format          = false;
    db->playlist_config.compress            = false;
+   db->playlist_config.binary              = false;
    db->playlist_config.fuzzy_archive_match = false;
    playlist_config_set_base_content_directory(&db->playlist_config, NULL);
 #endif
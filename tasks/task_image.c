@@ -18,16 +18,84 @@
 #include <string.h>
 
 #include <file/nbio.h>
+#include <file/file_path.h>
 #include <formats/image.h>
 #include <compat/strl.h>
+#include <encodings/crc32.h>
+#include <gfx/scaler/scaler.h>
+#include <lists/dir_list.h>
+#include <streams/file_stream.h>
 #include <string/stdstring.h>
 #include <retro_miscellaneous.h>
 #include <features/features_cpu.h>
+#include <lrc_hash.h>
+#ifdef HAVE_THREADS
+#include <rthreads/rthreads.h>
+#endif
 
 #include "task_file_transfer.h"
 #include "tasks_internal.h"
 
 #include "../configuration.h"
+#include "../file_path_special.h"
+
+/* Thumbnail cache
+ *
+ * Each cached image is a single file in the cache directory,
+ * named after a hash of the source path. It holds the decoded
+ * (and downscaled) pixels exactly as they are handed to the
+ * texture upload, so a cache hit costs one read.
+ *
+ * Layout (native byte order):
+ * - header (task_image_cache_header_t)
+ * - source path, without terminating NUL
+ * - zero padding up to a multiple of 16 bytes
+ * - width * height 32 bit pixels
+ *
+ * An entry is only used when the source path, its size and
+ * modification time, the pixel format and the target size
+ * all match; otherwise the image is decoded again and the
+ * entry replaced. */
+#define TASK_IMAGE_CACHE_MAGIC   0x43485452 /* 'RTHC' */
+#define TASK_IMAGE_CACHE_VERSION 1
+
+enum task_image_cache_flags
+{
+   TASK_IMAGE_CACHE_FLAG_RGBA = (1 << 0)
+};
+
+typedef struct
+{
+   uint32_t magic;
+   uint32_t version;
+   uint32_t width;
+   uint32_t height;
+   uint32_t max_width;
+   uint32_t max_height;
+   uint32_t flags;
+   uint32_t path_len;
+   int64_t  src_mtime;
+   int64_t  src_size;
+} task_image_cache_header_t;
+
+typedef struct
+{
+   int64_t mtime;
+   int64_t size;
+   size_t  idx;
+} task_image_cache_file_t;
+
+/* Bytes written to the cache since the last time
+ * its size was checked. Threaded tasks run on several
+ * workers at once, so these are guarded by
+ * task_image_cache_lock, and only one of them prunes
+ * the cache at a time (task_image_cache_pruning) */
+static uint64_t task_image_cache_written = 0;
+static bool task_image_cache_checked     = false;
+static bool task_image_cache_pruning     = false;
+#ifdef HAVE_THREADS
+static slock_t *task_image_cache_lock    = NULL;
+#endif
 
 enum image_status_enum
 {
@@ -49,11 +117,18 @@ struct nbio_image_handle
 {
    void *handle;
    transfer_cb_t  cb;
+   char *cache_dir;
+   char *cache_path;
    struct texture_image ti; /* ptr alignment */
+   uint64_t cache_size;
+   int64_t src_mtime;
+   int64_t src_size;
    size_t size;
    int processing_final_state;
    unsigned frame_duration;
    unsigned upscale_threshold;
+   unsigned max_width;
+   unsigned max_height;
    enum image_type_enum type;
    enum image_status_enum status;
    uint8_t flags;
@@ -170,6 +245,13 @@ static void task_image_cleanup(nbio_handle_t *nbio)
 
       image->handle  = NULL;
       image->cb      = NULL;
+
+      if (image->cache_dir)
+         free(image->cache_dir);
+      if (image->cache_path)
+         free(image->cache_path);
+      image->cache_dir  = NULL;
+      image->cache_path = NULL;
    }
    if (!string_is_empty(nbio->path))
       free(nbio->path);
@@ -211,6 +293,9 @@ static int cb_nbio_image_thumbnail(void *data, size_t len)
    ptr                             = nbio_get_ptr(nbio->handle, &len);
 
    image_transfer_set_buffer_ptr(image->handle, image->type, ptr, len);
+   /* Don't decode more detail than will be kept */
+   image_transfer_set_target_size(image->handle, image->type,
+         image->max_width, image->max_height);
 
    /* Set image size */
    image->size                     = len;
@@ -277,6 +362,372 @@ static bool upscale_image(
    return true;
 }
 
+/* Downscales image to fit within max_width x max_height,
+ * preserving its aspect ratio. Images that already fit
+ * are left untouched */
+static void downscale_image(
+      unsigned max_width, unsigned max_height,
+      struct texture_image *image)
+{
+   struct scaler_ctx scaler;
+   unsigned width, height;
+   uint32_t *pixels = NULL;
+
+   if (     !max_width
+         || !max_height
+         || !image->pixels
+         || ((image->width  <= max_width)
+          && (image->height <= max_height)))
+      return;
+
+   if ((uint64_t)image->width * max_height
+         > (uint64_t)image->height * max_width)
+   {
+      width  = max_width;
+      height = (unsigned)(((uint64_t)image->height * max_width
+               + (image->width >> 1)) / image->width);
+   }
+   else
+   {
+      height = max_height;
+      width  = (unsigned)(((uint64_t)image->width * max_height
+               + (image->height >> 1)) / image->height);
+   }
+
+   if (width < 1)
+      width  = 1;
+   if (height < 1)
+      height = 1;
+
+   if (!(pixels = (uint32_t*)malloc(width * height * sizeof(uint32_t))))
+      return;
+
+   memset(&scaler, 0, sizeof(scaler));
+   scaler.in_width    = image->width;
+   scaler.in_height   = image->height;
+   scaler.in_stride   = image->width * sizeof(uint32_t);
+   scaler.in_fmt      = SCALER_FMT_ARGB8888;
+   scaler.out_width   = width;
+   scaler.out_height  = height;
+   scaler.out_stride  = width * sizeof(uint32_t);
+   scaler.out_fmt     = SCALER_FMT_ARGB8888;
+   scaler.scaler_type = SCALER_TYPE_SINC;
+
+   if (!scaler_ctx_gen_filter(&scaler))
+   {
+      scaler_ctx_gen_reset(&scaler);
+      free(pixels);
+      return;
+   }
+
+   scaler_ctx_scale(&scaler, pixels, image->pixels);
+   scaler_ctx_gen_reset(&scaler);
+
+   free(image->pixels);
+   image->pixels = pixels;
+   image->width  = width;
+   image->height = height;
+}
+
+static size_t task_image_cache_pixels_offset(size_t path_len)
+{
+   return (sizeof(task_image_cache_header_t) + path_len + 15) & ~(size_t)15;
+}
+
+static int task_image_cache_file_cmp(const void *a, const void *b)
+{
+   const task_image_cache_file_t *file_a = (const task_image_cache_file_t*)a;
+   const task_image_cache_file_t *file_b = (const task_image_cache_file_t*)b;
+
+   if (file_a->mtime != file_b->mtime)
+      return (file_a->mtime < file_b->mtime) ? -1 : 1;
+   return 0;
+}
+
+/* Removes the oldest entries until the cache
+ * occupies no more than 3/4 of 'cache_size' */
+static void task_image_cache_prune(const char *cache_dir,
+      uint64_t cache_size)
+{
+   size_t i;
+   uint64_t total                 = 0;
+   task_image_cache_file_t *files = NULL;
+   struct string_list *list       = dir_list_new(cache_dir,
+         FILE_PATH_THUMBNAIL_CACHE_EXTENSION_NO_DOT,
+         false, false, false, false);
+
+   if (!list)
+      return;
+
+   if (list->size && (files = (task_image_cache_file_t*)
+            malloc(list->size * sizeof(*files))))
+   {
+      for (i = 0; i < list->size; i++)
+      {
+         const char *path = list->elems[i].data;
+         int32_t size     = path_get_size(path);
+
+         files[i].mtime   = path_get_mtime(path);
+         files[i].size    = (size > 0) ? size : 0;
+         files[i].idx     = i;
+         total           += (uint64_t)files[i].size;
+      }
+
+      if (total > cache_size)
+      {
+         uint64_t target = cache_size - (cache_size >> 2);
+
+         qsort(files, list->size, sizeof(*files),
+               task_image_cache_file_cmp);
+
+         for (i = 0; (i < list->size) && (total > target); i++)
+         {
+            if (!filestream_delete(list->elems[files[i].idx].data))
+               total -= (uint64_t)files[i].size;
+         }
+      }
+
+      free(files);
+   }
+
+   string_list_free(list);
+}
+
+/* Loads the cached pixels of 'path' into image->ti.
+ * Returns false if there is no entry, or if the entry
+ * does not match the source file and the requested
+ * size and format */
+static bool task_image_cache_read(struct nbio_image_handle *image,
+      const char *path)
+{
+   task_image_cache_header_t header;
+   char cached_path[PATH_MAX_LENGTH];
+   size_t offset;
+   size_t pixels_size;
+   bool ret          = false;
+   uint32_t *pixels  = NULL;
+   size_t path_len   = strlen(path);
+   uint32_t flags    = image->ti.supports_rgba
+         ? TASK_IMAGE_CACHE_FLAG_RGBA : 0;
+   RFILE *file       = NULL;
+
+   if ((image->src_mtime <= 0) || (image->src_size < 0))
+      return false;
+
+   if (!(file = filestream_open(image->cache_path,
+               RETRO_VFS_FILE_ACCESS_READ,
+               RETRO_VFS_FILE_ACCESS_HINT_NONE)))
+      return false;
+
+   if (     (filestream_read(file, &header, sizeof(header))
+               != sizeof(header))
+         || (header.magic      != TASK_IMAGE_CACHE_MAGIC)
+         || (header.version    != TASK_IMAGE_CACHE_VERSION)
+         || (header.max_width  != image->max_width)
+         || (header.max_height != image->max_height)
+         || (header.flags      != flags)
+         || (header.src_mtime  != image->src_mtime)
+         || (header.src_size   != image->src_size)
+         || (header.path_len   != path_len)
+         || (path_len >= sizeof(cached_path))
+         || (header.width  < 1)
+         || (header.height < 1)
+         || (header.width  > 0x4000)
+         || (header.height > 0x4000))
+      goto end;
+
+   if (     (filestream_read(file, cached_path, path_len)
+               != (int64_t)path_len)
+         || memcmp(cached_path, path, path_len))
+      goto end;
+
+   offset      = task_image_cache_pixels_offset(path_len);
+   pixels_size = header.width * header.height * sizeof(uint32_t);
+
+   if (     (filestream_get_size(file) != (int64_t)(offset + pixels_size))
+         || (filestream_seek(file, (int64_t)offset,
+               RETRO_VFS_SEEK_POSITION_START) != 0)
+         || !(pixels = (uint32_t*)malloc(pixels_size)))
+      goto end;
+
+   if (filestream_read(file, pixels, pixels_size) != (int64_t)pixels_size)
+   {
+      free(pixels);
+      goto end;
+   }
+
+   image->ti.pixels = pixels;
+   image->ti.width  = header.width;
+   image->ti.height = header.height;
+   ret              = true;
+
+end:
+   filestream_close(file);
+   return ret;
+}
+
+/* Stores the decoded pixels of 'path'. The entry is
+ * written to a temporary file first, so that a reader
+ * never sees a partial entry */
+static void task_image_cache_write(struct nbio_image_handle *image,
+      const char *path)
+{
+   task_image_cache_header_t header;
+   char tmp_path[PATH_MAX_LENGTH];
+   static const uint8_t padding[16] = {0};
+   size_t path_len                  = strlen(path);
+   size_t pad_len                   =
+         task_image_cache_pixels_offset(path_len)
+         - sizeof(header) - path_len;
+   size_t pixels_size               =
+         image->ti.width * image->ti.height * sizeof(uint32_t);
+   bool ok                          = false;
+   bool prune                       = false;
+   RFILE *file                      = NULL;
+
+   if (     !image->ti.pixels
+         || (image->src_mtime <= 0)
+         || (image->src_size < 0))
+      return;
+
+   if (     !path_is_directory(image->cache_dir)
+         && !path_mkdir(image->cache_dir))
+      return;
+
+   header.magic      = TASK_IMAGE_CACHE_MAGIC;
+   header.version    = TASK_IMAGE_CACHE_VERSION;
+   header.width      = image->ti.width;
+   header.height     = image->ti.height;
+   header.max_width  = image->max_width;
+   header.max_height = image->max_height;
+   header.flags      = image->ti.supports_rgba
+         ? TASK_IMAGE_CACHE_FLAG_RGBA : 0;
+   header.path_len   = (uint32_t)path_len;
+   header.src_mtime  = image->src_mtime;
+   header.src_size   = image->src_size;
+
+   /* Unique per load, as two workers may be writing
+    * the same entry at once */
+   snprintf(tmp_path, sizeof(tmp_path), "%s.%p.tmp",
+         image->cache_path, (void*)image);
+
+   if (!(file = filestream_open(tmp_path,
+               RETRO_VFS_FILE_ACCESS_WRITE,
+               RETRO_VFS_FILE_ACCESS_HINT_NONE)))
+      return;
+
+   ok = (filestream_write(file, &header, sizeof(header))
+               == sizeof(header))
+      && (filestream_write(file, path, path_len)
+               == (int64_t)path_len)
+      && (filestream_write(file, padding, pad_len)
+               == (int64_t)pad_len)
+      && (filestream_write(file, image->ti.pixels, pixels_size)
+               == (int64_t)pixels_size);
+
+   if (filestream_close(file) != 0)
+      ok = false;
+
+   if (ok)
+   {
+      filestream_delete(image->cache_path);
+      ok = (filestream_rename(tmp_path, image->cache_path) == 0);
+   }
+
+   if (!ok)
+   {
+      filestream_delete(tmp_path);
+      return;
+   }
+
+   /* Check the size of the cache once per session,
+    * and again whenever an eighth of its capacity
+    * has been written since */
+#ifdef HAVE_THREADS
+   slock_lock(task_image_cache_lock);
+#endif
+   task_image_cache_written += task_image_cache_pixels_offset(path_len)
+         + pixels_size;
+
+   if (     !task_image_cache_pruning
+         && (  !task_image_cache_checked
+            || (task_image_cache_written > (image->cache_size >> 3))))
+   {
+      task_image_cache_pruning = true;
+      task_image_cache_checked = true;
+      task_image_cache_written = 0;
+      prune                    = true;
+   }
+#ifdef HAVE_THREADS
+   slock_unlock(task_image_cache_lock);
+#endif
+
+   if (!prune)
+      return;
+
+   task_image_cache_prune(image->cache_dir, image->cache_size);
+
+#ifdef HAVE_THREADS
+   slock_lock(task_image_cache_lock);
+#endif
+   task_image_cache_pruning = false;
+#ifdef HAVE_THREADS
+   slock_unlock(task_image_cache_lock);
+#endif
+}
+
+/* Applies the upscale threshold and hands the final
+ * image over to the task callback */
+static void task_image_load_finish(retro_task_t *task,
+      struct nbio_image_handle *image)
+{
+   struct texture_image *img = (struct texture_image*)malloc(sizeof(struct texture_image));
+
+   if (img)
+   {
+      /* Upscale image, if required */
+      if (image->upscale_threshold > 0)
+      {
+         if (((image->ti.width > 0) && (image->ti.height > 0)) &&
+             ((image->ti.width  < image->upscale_threshold) ||
+              (image->ti.height < image->upscale_threshold)))
+         {
+            unsigned min_size                  = (image->ti.width < image->ti.height) ?
+                                                   image->ti.width : image->ti.height;
+            float scale_factor                 = (float)image->upscale_threshold /
+                                                   (float)min_size;
+            unsigned scale_factor_int          = (unsigned)scale_factor;
+            struct texture_image img_resampled = {
+               NULL,
+               0,
+               0,
+               false
+            };
+
+            if (scale_factor - (float)scale_factor_int > 0.0f)
+               scale_factor_int += 1;
+
+            if (upscale_image(scale_factor_int, &image->ti, &img_resampled))
+            {
+               image->ti.width  = img_resampled.width;
+               image->ti.height = img_resampled.height;
+
+               if (image->ti.pixels)
+                  free(image->ti.pixels);
+               image->ti.pixels = img_resampled.pixels;
+            }
+         }
+      }
+
+      img->width         = image->ti.width;
+      img->height        = image->ti.height;
+      img->pixels        = image->ti.pixels;
+      img->supports_rgba = image->ti.supports_rgba;
+   }
+
+   task_set_data(task, img);
+}
+
 bool task_image_load_handler(retro_task_t *task)
 {
    nbio_handle_t            *nbio  = (nbio_handle_t*)task->state;
@@ -334,59 +785,44 @@ bool task_image_load_handler(retro_task_t *task)
          && (image && (image->flags & IMAGE_FLAG_IS_FINISHED))
          && (!task_get_cancelled(task)))
    {
-      struct texture_image *img = (struct texture_image*)malloc(sizeof(struct texture_image));
-
-      if (img)
+      if (image->cache_path)
       {
-         /* Upscale image, if required */
-         if (image->upscale_threshold > 0)
-         {
-            if (((image->ti.width > 0) && (image->ti.height > 0)) &&
-                ((image->ti.width  < image->upscale_threshold) ||
-                 (image->ti.height < image->upscale_threshold)))
-            {
-               unsigned min_size                  = (image->ti.width < image->ti.height) ?
-                                                      image->ti.width : image->ti.height;
-               float scale_factor                 = (float)image->upscale_threshold /
-                                                      (float)min_size;
-               unsigned scale_factor_int          = (unsigned)scale_factor;
-               struct texture_image img_resampled = {
-                  NULL,
-                  0,
-                  0,
-                  false
-               };
-
-               if (scale_factor - (float)scale_factor_int > 0.0f)
-                  scale_factor_int += 1;
-
-               if (upscale_image(scale_factor_int, &image->ti, &img_resampled))
-               {
-                  image->ti.width  = img_resampled.width;
-                  image->ti.height = img_resampled.height;
-
-                  if (image->ti.pixels)
-                     free(image->ti.pixels);
-                  image->ti.pixels = img_resampled.pixels;
-               }
-            }
-         }
-
-         img->width         = image->ti.width;
-         img->height        = image->ti.height;
-         img->pixels        = image->ti.pixels;
-         img->supports_rgba = image->ti.supports_rgba;
+         downscale_image(image->max_width, image->max_height, &image->ti);
+         task_image_cache_write(image, nbio->path);
       }
 
-      task_set_data(task, img);
-
+      task_image_load_finish(task, image);
       return false;
    }
 
    return true;
 }
 
-bool task_push_image_load(const char *fullpath, 
+/* Handler of cached image loads: tries the cache
+ * first, and only falls back to a regular image
+ * load if there is no valid entry */
+static void task_image_cache_handler(retro_task_t *task)
+{
+   nbio_handle_t            *nbio  = (nbio_handle_t*)task->state;
+   struct nbio_image_handle *image = (struct nbio_image_handle*)nbio->data;
+
+   image->src_mtime = path_get_mtime(nbio->path);
+   image->src_size  = path_get_size(nbio->path);
+
+   if (     !task_get_cancelled(task)
+         && task_image_cache_read(image, nbio->path))
+   {
+      task_image_load_finish(task, image);
+      task_set_finished(task, true);
+      return;
+   }
+
+   task->handler = task_file_load_handler;
+}
+
+static bool task_image_load_push(const char *fullpath,
+      const char *cache_dir, uint64_t cache_size,
+      unsigned max_width, unsigned max_height,
       bool supports_rgba, unsigned upscale_threshold,
       retro_task_callback_t cb, void *user_data)
 {
@@ -431,6 +867,13 @@ bool task_push_image_load(const char *fullpath,
    image->size                       = 0;
    image->upscale_threshold          = upscale_threshold;
    image->handle                     = NULL;
+   image->cache_dir                  = NULL;
+   image->cache_path                 = NULL;
+   image->cache_size                 = cache_size;
+   image->src_mtime                  = 0;
+   image->src_size                   = -1;
+   image->max_width                  = max_width;
+   image->max_height                 = max_height;
 
    image->ti.width                   = 0;
    image->ti.height                  = 0;
@@ -457,10 +900,43 @@ bool task_push_image_load(const char *fullpath,
          break;
    }
 
+   /* Cache entries are named after the source path,
+    * and only ever hold images reduced to the target
+    * size, never full size ones */
+   if (     !string_is_empty(cache_dir)
+         && (max_width  > 0)
+         && (max_height > 0)
+         && (nbio->type != NBIO_TYPE_NONE))
+   {
+      char cache_file[32];
+      char cache_path[PATH_MAX_LENGTH];
+
+      snprintf(cache_file, sizeof(cache_file), "%08x%08x"
+            FILE_PATH_THUMBNAIL_CACHE_EXTENSION,
+            (unsigned)encoding_crc32(0, (const uint8_t*)fullpath,
+               strlen(fullpath)),
+            (unsigned)djb2_calculate(fullpath));
+      fill_pathname_join_special(cache_path, cache_dir, cache_file,
+            sizeof(cache_path));
+
+      image->cache_dir  = strdup(cache_dir);
+      image->cache_path = strdup(cache_path);
+
+#ifdef HAVE_THREADS
+      /* Created here, on the main thread, before
+       * any task can need it */
+      if (!task_image_cache_lock)
+         task_image_cache_lock = slock_new();
+#endif
+   }
+
    nbio->data          = (struct nbio_image_handle*)image;
 
    t->state           = nbio;
-   t->handler         = task_file_load_handler;
+   t->handler         = image->cache_path
+         ? task_image_cache_handler
+         : task_file_load_handler;
+   t->priority        = TASK_PRIORITY_INTERACTIVE;
    t->cleanup         = task_image_load_free;
    t->callback        = cb;
    t->user_data       = user_data;
@@ -469,3 +945,22 @@ bool task_push_image_load(const char *fullpath,
 
    return true;
 }
+
+bool task_push_image_load(const char *fullpath,
+      bool supports_rgba, unsigned upscale_threshold,
+      retro_task_callback_t cb, void *user_data)
+{
+   return task_image_load_push(fullpath, NULL, 0, 0, 0,
+         supports_rgba, upscale_threshold, cb, user_data);
+}
+
+bool task_push_image_load_cached(const char *fullpath,
+      const char *cache_dir, uint64_t cache_size,
+      unsigned max_width, unsigned max_height,
+      bool supports_rgba, unsigned upscale_threshold,
+      retro_task_callback_t cb, void *user_data)
+{
+   return task_image_load_push(fullpath, cache_dir, cache_size,
+         max_width, max_height,
+         supports_rgba, upscale_threshold, cb, user_data);
+}
@@ -57,6 +57,7 @@ typedef struct manual_scan_handle
    struct string_list *file_exts_list;
    struct string_list *content_list;
    logiqx_dat_t *dat_file;
+   manual_content_scan_cache_t *cache;
    struct string_list *m3u_list;
    playlist_config_t playlist_config; /* size_t alignment */
    size_t playlist_size;
@@ -109,6 +110,12 @@ static void free_manual_content_scan_handle(manual_scan_handle_t *manual_scan)
       manual_scan->dat_file = NULL;
    }
 
+   if (manual_scan->cache)
+   {
+      manual_content_scan_cache_free(manual_scan->cache);
+      manual_scan->cache = NULL;
+   }
+
    free(manual_scan);
    manual_scan = NULL;
 }
@@ -237,6 +244,12 @@ static void task_manual_content_scan_handler(retro_task_t *task)
                }
             }
 
+            /* Load results of previous scans
+             * > Failure is not an error, every file
+             *   will just be inspected */
+            manual_scan->cache = manual_content_scan_cache_init(
+                  manual_scan->task_config);
+
             /* Open playlist */
             if (!(manual_scan->playlist =
                      playlist_init(&manual_scan->playlist_config)))
@@ -322,8 +335,13 @@ static void task_manual_content_scan_handler(retro_task_t *task)
                      manual_scan->playlist_size);
 
                /* Check whether playlist content exists on
-                * the filesystem */
-               if (!playlist_content_path_is_valid(entry->path))
+                * the filesystem
+                * > Content inside archives that have not
+                *   changed since the last scan need not
+                *   be opened */
+               if (   !manual_content_scan_cache_path_is_valid(
+                        manual_scan->cache, entry->path)
+                   && !playlist_content_path_is_valid(entry->path))
                   delete_entry = true;
                /* If file exists, check whether it has a
                 * permitted file extension */
@@ -389,7 +407,8 @@ static void task_manual_content_scan_handler(retro_task_t *task)
                /* Add content to playlist */
                manual_content_scan_add_content_to_playlist(
                      manual_scan->task_config, manual_scan->playlist,
-                     content_path, content_type, manual_scan->dat_file);
+                     content_path, content_type, manual_scan->dat_file,
+                     manual_scan->cache);
 
                /* If this is an M3U file, add it to the
                 * M3U list for later processing */
@@ -487,6 +506,9 @@ static void task_manual_content_scan_handler(retro_task_t *task)
             /* Save playlist changes to disk */
             playlist_write_file(manual_scan->playlist);
 
+            /* Save scan results for next time */
+            manual_content_scan_cache_write(manual_scan->cache);
+
             /* Update progress display */
             task_free_title(task);
 
@@ -552,6 +574,7 @@ bool task_push_manual_content_scan(
    manual_scan->file_exts_list      = NULL;
    manual_scan->content_list        = NULL;
    manual_scan->dat_file            = NULL;
+   manual_scan->cache               = NULL;
    manual_scan->playlist_size       = 0;
    manual_scan->playlist_index      = 0;
    manual_scan->content_list_size   = 0;
@@ -609,6 +632,7 @@ bool task_push_manual_content_scan(
 
    /* > Configure task */
    task->handler                 = task_manual_content_scan_handler;
+   task->priority                = TASK_PRIORITY_BACKGROUND;
    task->state                   = manual_scan;
    task->title                   = strdup(task_title);
    task->alternative_look        = true;
@@ -801,6 +801,8 @@ bool task_push_netplay_crc_scan(uint32_t crc, const char *content,
       settings->bools.playlist_use_old_format;
    data->playlist_config.compress            =
       settings->bools.playlist_compression;
+   data->playlist_config.binary              =
+      settings->bools.playlist_binary_format;
    data->playlist_config.fuzzy_archive_match =
       settings->bools.playlist_fuzzy_archive_match;
    playlist_config_set_base_content_directory(&data->playlist_config,
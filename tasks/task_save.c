@@ -632,6 +632,8 @@ static bool task_push_undo_save_state(const char *path, void *data, size_t size)
       state->flags              |= SAVE_TASK_FLAG_MUTE;
 
    task->type                    = TASK_TYPE_BLOCKING;
+   task->priority                = TASK_PRIORITY_INTERACTIVE;
+   task->sequential              = true;
    task->state                   = state;
    task->handler                 = task_save_handler;
    task->callback                = undo_save_state_cb;
@@ -1200,6 +1202,8 @@ static void task_push_save_state(const char *path, void *data, size_t size, bool
       state->flags              |= SAVE_TASK_FLAG_MUTE;
 
    task->type                    = TASK_TYPE_BLOCKING;
+   task->priority                = TASK_PRIORITY_INTERACTIVE;
+   task->sequential              = true;
    task->state                   = state;
    task->handler                 = task_save_handler;
    task->callback                = save_state_cb;
@@ -1307,6 +1311,8 @@ static void task_push_load_and_save_state(const char *path, void *data,
 
    task->state                   = state;
    task->type                    = TASK_TYPE_BLOCKING;
+   task->priority                = TASK_PRIORITY_INTERACTIVE;
+   task->sequential              = true;
    task->handler                 = task_load_handler;
    task->callback                = content_load_and_save_state_cb;
    task->title                   = strdup(msg_hash_to_str(MSG_LOADING_STATE));
@@ -1591,6 +1597,8 @@ bool content_load_state(const char *path,
       state->flags             |= SAVE_TASK_FLAG_MUTE;
 
    task->type                   = TASK_TYPE_BLOCKING;
+   task->priority               = TASK_PRIORITY_INTERACTIVE;
+   task->sequential             = true;
    task->state                  = state;
    task->handler                = task_load_handler;
    task->callback               = content_load_state_cb;
@@ -215,6 +215,22 @@ bool task_push_image_load(const char *fullpath,
       bool supports_rgba, unsigned upscale_threshold,
       retro_task_callback_t cb, void *userdata);
 
+/* Same as task_push_image_load(), but images are
+ * downscaled to fit within 'max_width' x 'max_height'
+ * and kept as raw pixels in 'cache_dir', so that
+ * subsequent loads of an unchanged file skip decoding
+ * entirely. The total size of 'cache_dir' is kept
+ * below 'cache_size' bytes by removing the oldest
+ * entries.
+ * If 'cache_dir' is NULL, nothing is cached, and images
+ * are only reduced as far as the decoder can do so
+ * cheaply (JPEG) */
+bool task_push_image_load_cached(const char *fullpath,
+      const char *cache_dir, uint64_t cache_size,
+      unsigned max_width, unsigned max_height,
+      bool supports_rgba, unsigned upscale_threshold,
+      retro_task_callback_t cb, void *userdata);
+
 #ifdef HAVE_LIBRETRODB
 bool task_push_dbscan(
       const char *playlist_directory,